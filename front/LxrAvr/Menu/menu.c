@@ -197,6 +197,7 @@ const Name valueNames[NUM_NAMES] PROGMEM =
 		{SHORT_MODE, CAT_TRIGGER, LONG_TRIGGER_GATE_MODE}, //TEXT_TRIGGER_GATE_MODE
 		{SHORT_BAR_RESET_MODE, CAT_SEQUENCER, LONG_BAR_RESET_MODE}, // TEXT_BAR_RESET_MODE
 		{SHORT_CHANNEL, CAT_MIDI, LONG_MIDI_CHANNEL}, // TEXT_MIDI_CHAN_GLOBAL
+		{SHORT_GROOVE, CAT_SEQUENCER, LONG_GROOVE}, // TEXT_GROOVE
 
 };
 
@@ -477,6 +478,7 @@ const enum Datatypes PROGMEM parameter_dtypes[NUM_PARAMS] = {
 		/*PAR_TRIGGER_GATE_MODE*/	DTYPE_ON_OFF,
 	    /*PAR_BAR_RESET_MODE*/  DTYPE_ON_OFF,
 	    /*PAR_MIDI_CHAN_GLOBAL*/DTYPE_1B16,		//--AS global midi channel
+	    /*PAR_GROOVE*/			DTYPE_0B127,
 };
 
 
@@ -1039,6 +1041,11 @@ void menu_repaintGeneric()
 			memcpy(&editDisplayBuffer[1][4*i],valueAsText,3);
 
 		}	// for 1 to 4 .. each menu item
+
+		//reduced audio quality level of the mainboard cpu load governor, blank at full quality
+		editDisplayBuffer[1][15] = frontParser_cpuLevel ? (char)('0' + frontParser_cpuLevel) : ' ';
+		//full pattern memory has priority, recorded data is being lost
+		if(frontParser_poolFull) editDisplayBuffer[1][15] = '!';
 	} // if editmode not active
 }
 //-----------------------------------------------------------------
@@ -1646,10 +1653,14 @@ static void menu_encoderChangeParameter(int8_t inc)
 		break;
 	case DTYPE_MIX_FM://parameter_dtypes[paramNr] & 0x0F
 	case DTYPE_ON_OFF:
-	case DTYPE_0b1:
 		if(*paramValue > 1)
 			*paramValue = 1;
 		break;
+	case DTYPE_0b1:
+		//automation track 1/2, 3 records parameter locks
+		if(*paramValue > 2)
+			*paramValue = 2;
+		break;
 
 
 
@@ -2011,6 +2022,10 @@ void menu_parseGlobalParam(uint16_t paramNr, uint8_t value)
 		frontPanel_sendData(SEQ_CC,SEQ_SHUFFLE,value);
 		break;
 
+	case PAR_GROOVE:
+		frontPanel_sendData(SEQ_CC,SEQ_GROOVE,value);
+		break;
+
 	case PAR_AUTOM_TRACK:
 		frontPanel_sendData(SEQ_CC,SEQ_SET_AUTOM_TRACK,value);
 		break;
@@ -2287,9 +2302,11 @@ static uint8_t getDtypeValue(uint8_t value, uint16_t paramNr)
 		// These are 0 or 1
 	case DTYPE_MIX_FM:
 	case DTYPE_ON_OFF:
-	case DTYPE_0b1:
 		return frac>0.5f;
 		break;
+	case DTYPE_0b1:
+		return (uint8_t)(2.99f*frac);
+		break;
 	case DTYPE_MENU:
 	{
 		//get the used menu (upper 4 bit)
@@ -191,6 +191,7 @@ enum NamesEnum
 	TEXT_TRIGGER_GATE_MODE,
 	TEXT_BAR_RESET_MODE,
 	TEXT_MIDI_CHAN_GLOBAL,
+	TEXT_GROOVE,
 	NUM_NAMES
 };
 //-----------------------------------------------------------------
@@ -279,7 +280,8 @@ enum shortNamesEnum
 	SHORT_TRIGGER_IN,
 	SHORT_TRIGGER_OUT1,
 	SHORT_TRIGGER_OUT2,
-	SHORT_BAR_RESET_MODE
+	SHORT_BAR_RESET_MODE,
+	SHORT_GROOVE
 
 
 	
@@ -391,6 +393,7 @@ enum longNamesEnum
 	LONG_TRIGGER_OUT2,
 	LONG_TRIGGER_GATE_MODE,
 	LONG_BAR_RESET_MODE,
+	LONG_GROOVE,
 	
 };
 
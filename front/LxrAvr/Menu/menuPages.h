@@ -367,8 +367,8 @@ const Page menuPages[NUM_PAGES][NUM_SUB_PAGES] PROGMEM =
 			PAR_BPM,    PAR_QUANTISATION,  PAR_MIDI_CHAN_GLOBAL,  PAR_MIDI_FILT_TX,  PAR_MIDI_FILT_RX,  PAR_MIDI_ROUTING,  PAR_FETCH,  PAR_FOLLOW,
 		},
 		{ // -- AS GMENU 2nd sub page of global settings
-			TEXT_SCREENSAVER_ON_OFF, TEXT_BAR_RESET_MODE, TEXT_TRIGGER_IN_PPQ,TEXT_TRIGGER_OUT1_PPQ,TEXT_TRIGGER_OUT2_PPQ,TEXT_TRIGGER_GATE_MODE,TEXT_EMPTY,TEXT_EMPTY,
-			PAR_SCREENSAVER_ON_OFF,  PAR_BAR_RESET_MODE, PAR_PRESCALER_CLOCK_IN, PAR_PRESCALER_CLOCK_OUT1,PAR_PRESCALER_CLOCK_OUT2,	PAR_TRIG_GATE_MODE,	PAR_NONE,PAR_NONE
+			TEXT_SCREENSAVER_ON_OFF, TEXT_BAR_RESET_MODE, TEXT_TRIGGER_IN_PPQ,TEXT_TRIGGER_OUT1_PPQ,TEXT_TRIGGER_OUT2_PPQ,TEXT_TRIGGER_GATE_MODE,TEXT_GROOVE,TEXT_EMPTY,
+			PAR_SCREENSAVER_ON_OFF,  PAR_BAR_RESET_MODE, PAR_PRESCALER_CLOCK_IN, PAR_PRESCALER_CLOCK_OUT1,PAR_PRESCALER_CLOCK_OUT2,	PAR_TRIG_GATE_MODE,	PAR_GROOVE,PAR_NONE
 		},{ // --AS GMENU can expand into all these too
 			TEXT_EMPTY,TEXT_EMPTY,TEXT_EMPTY,TEXT_EMPTY,TEXT_EMPTY,TEXT_EMPTY,TEXT_EMPTY,TEXT_EMPTY,
 			PAR_NONE,PAR_NONE,PAR_NONE,PAR_NONE,PAR_NONE,PAR_NONE,PAR_NONE,PAR_NONE
@@ -151,6 +151,9 @@ static uint8_t preset_readGlobalData()
 		if(!bytesRead)
 			return 0;
 	}
+	//files saved before the groove setting have 0xff padding there
+	if(parameter_values[PAR_GROOVE] > 127)
+		parameter_values[PAR_GROOVE] = 0;
 	return 1;
 #endif
 }
@@ -472,6 +475,94 @@ void preset_queryMainStepDataFromSeq(uint16_t stepNr, uint16_t *mainStepData, ui
 	*length=frontParser_stepData.note;
 };
 
+//----------------------------------------------------
+/** request parameter lock lockNr of a track (pattern*7 + track). returns 0 if the track has no such lock*/
+static uint8_t preset_queryLockFromSeq(uint8_t trackNr, uint16_t lockNr, uint8_t* lock)
+{
+	frontParser_newSeqDataAvailable = 0;
+
+	frontPanel_sendByte(trackNr);
+	frontPanel_sendByte((lockNr>>7)&0x7f);		//upper nibble 7 bit
+	frontPanel_sendByte(lockNr&0x7f);			//lower nibble 7 bit
+
+	//wait until data arrives
+	uint8_t newSeqDataLocal = 0;
+	uint16_t now = time_sysTick;
+	while((newSeqDataLocal==0))
+	{
+		//we have to call the uart parser to handle incoming messages from the sequencer
+		uart_checkAndParse();
+
+		newSeqDataLocal = frontParser_newSeqDataAvailable;
+
+		if(time_sysTick-now >= 31)
+		{
+			//timeout
+			now = time_sysTick;
+			//request lock again
+			frontPanel_sendByte(trackNr);
+			frontPanel_sendByte((lockNr>>7)&0x7f);
+			frontPanel_sendByte(lockNr&0x7f);
+		}
+	}
+
+	//the stepdata struct is used as buffer for the data
+	lock[0] = frontParser_stepData.volume;
+	lock[1] = frontParser_stepData.prob;
+	lock[2] = frontParser_stepData.note;
+	return frontParser_stepData.param1Nr == 0;
+}
+//----------------------------------------------------
+/** send the parameter locks from SD card to the sequencer*/
+static void preset_sendLocksToSeq()
+{
+	UINT bytesRead;
+	uint8_t lock[3];
+	uint8_t track = 0;
+
+	//older files end before the locks
+	f_read((FIL*)&preset_File,(void*)lock,3,&bytesRead);
+	if(bytesRead != 3)
+		return;
+
+	frontParser_midiMsg.status = 0;
+	while( (frontParser_midiMsg.status != SYSEX_START))
+	{
+		frontPanel_sendByte(SYSEX_START);
+		uart_checkAndParse();
+	}
+	_delay_ms(50);
+	frontPanel_sendByte(SYSEX_SEND_LOCK_DATA);
+	frontPanel_sysexMode = SYSEX_SEND_LOCK_DATA;
+
+	while(bytesRead == 3)
+	{
+		if(lock[0] == 0xff)
+		{
+			//end of the track
+			frontPanel_sendByte(0);
+			frontPanel_sendByte(0);
+			frontPanel_sendByte(0);
+			frontPanel_sendByte(0x04);
+			if(++track >= NUM_PATTERN*NUM_TRACKS)
+				break;
+		}
+		else
+		{
+			frontPanel_sendByte(lock[0]	& 0x7f);
+			frontPanel_sendByte(lock[1]	& 0x7f);
+			frontPanel_sendByte(lock[2]	& 0x7f);
+			frontPanel_sendByte((uint8_t)(((lock[1]&0x80)>>7) | ((lock[2]&0x80)>>6)));
+		}
+		//we have to give the cortex some time to cope with all the incoming data
+		_delay_us(200);
+
+		f_read((FIL*)&preset_File,(void*)lock,3,&bytesRead);
+	}
+
+	//end sysex mode
+	frontPanel_sendByte(SYSEX_END);
+}
 //----------------------------------------------------
 static void preset_writePatternData()
 {
@@ -592,6 +683,34 @@ static void preset_writePatternData()
 	frontPanel_sendByte(SYSEX_END);
 	frontParser_midiMsg.status = 0;
 
+	//----- parameter locks ------
+	// appended behind the lengths for the same reason. {step, dest, value} records of
+	// each track in main step data order, a step of 0xff ends the track
+	while( (frontParser_midiMsg.status != SYSEX_START))
+	{
+		frontPanel_sendByte(SYSEX_START);
+		uart_checkAndParse();
+	}
+	_delay_ms(50);
+	frontPanel_sendByte(SYSEX_REQUEST_LOCK_DATA);
+	frontPanel_sysexMode = SYSEX_REQUEST_LOCK_DATA;
+
+	uint8_t lock[3];
+	for(i=0;i<(NUM_PATTERN*NUM_TRACKS);i++)
+	{
+		uint16_t lockNr = 0;
+		while(preset_queryLockFromSeq((uint8_t)i, lockNr++, lock))
+		{
+			f_write((FIL*)&preset_File,(const void*)lock,3,&bytesWritten);
+		}
+		lock[0] = 0xff;
+		f_write((FIL*)&preset_File,(const void*)lock,3,&bytesWritten);
+	}
+
+	//end sysex mode
+	frontPanel_sendByte(SYSEX_END);
+	frontParser_midiMsg.status = 0;
+
 }
 
 
@@ -754,6 +873,16 @@ static uint8_t preset_readPatternData()
 		}
 	}
 
+	// ----------- Parameter locks
+	// they are stored behind the lengths but have to reach the sequencer first,
+	// the lengths complete the transfer of a playing pattern
+	if(success) {
+		const DWORD lenPos = f_tell((FIL*)&preset_File);
+		if(f_lseek((FIL*)&preset_File, lenPos + NUM_PATTERN*NUM_TRACKS) == FR_OK)
+			preset_sendLocksToSeq();
+		f_lseek((FIL*)&preset_File, lenPos);
+	}
+
 	// ----------- Pattern/track lengths
 	// -- AS this might not exist in the saved data file, we still want success
 	if(success) {
@@ -24,6 +24,8 @@ volatile MidiMsg frontParser_midiMsg;
 static uint16_t frontParser_nrpnNr = 0;
 
 uint8_t frontPanel_sysexMode = 0;
+uint8_t frontParser_cpuLevel = 0;
+uint8_t frontParser_poolFull = 0;
 
 volatile uint8_t frontParser_newSeqDataAvailable = 0;
 volatile StepData frontParser_stepData;
@@ -239,6 +241,26 @@ void frontPanel_parseData(uint8_t data)
 					frontParser_stepData.prob = (uint8_t)(mainStepData&0xff);
 					frontParser_stepData.note = frontParser_sysexBuffer[3];
 					
+					//signal that a new data chunk is available
+					frontParser_newSeqDataAvailable = 1;
+					//reset receive counter for next chunk
+					frontParser_rxCnt = 0;
+				}
+			}
+			else if(frontPanel_sysexMode == SYSEX_REQUEST_LOCK_DATA)
+			{
+				if(frontParser_rxCnt<3)
+				{
+					//step, dest and value
+					frontParser_sysexBuffer[frontParser_rxCnt++] = data;
+				} else {
+					//MSBs of dest and value, bit 2 = no more locks on this track
+					//we abuse the stepData struct to store the lock
+					frontParser_stepData.volume = frontParser_sysexBuffer[0];
+					frontParser_stepData.prob = (uint8_t)(frontParser_sysexBuffer[1] | ((data&0x01)<<7));
+					frontParser_stepData.note = (uint8_t)(frontParser_sysexBuffer[2] | ((data&0x02)<<6));
+					frontParser_stepData.param1Nr = data&0x04;
+
 					//signal that a new data chunk is available
 					frontParser_newSeqDataAvailable = 1;
 					//reset receive counter for next chunk
@@ -313,6 +335,21 @@ void frontPanel_parseData(uint8_t data)
 					menu_repaintAll();
 				}
 				
+				else if(frontParser_midiMsg.status == CC_2)
+				{
+					//sound parameters above 127, sent by the cortex when a kit is restored
+					const uint8_t parNr = (uint8_t)(frontParser_midiMsg.data1 + 128);
+					if(parNr < END_OF_SOUND_PARAMETERS)
+					{
+						parameter_values[parNr] = frontParser_midiMsg.data2;
+						menu_repaint();
+					}
+				}
+				else if(frontParser_midiMsg.status == SET_BPM)
+				{
+					parameter_values[PAR_BPM] = (uint8_t)(frontParser_midiMsg.data1 | (frontParser_midiMsg.data2<<7));
+					menu_repaint();
+				}
 				else if(frontParser_midiMsg.status == SEQ_CC)
 				{
 					switch(frontParser_midiMsg.data1)
@@ -425,6 +462,42 @@ void frontPanel_parseData(uint8_t data)
 							// button to act properly
 							buttonHandler_setRunStopState(frontParser_midiMsg.data2);
 							break;
+
+						case SEQ_MIDI_CHAN: {
+							//voice 7 is the global channel, the menu shows channels from 1
+							const uint8_t voice = frontParser_midiMsg.data2 >> 4;
+							const uint8_t channel = (uint8_t)((frontParser_midiMsg.data2 & 0x0f) + 1);
+							if(voice == 7)
+								parameter_values[PAR_MIDI_CHAN_GLOBAL] = channel;
+							else if(voice == 6)
+								parameter_values[PAR_MIDI_CHAN_7] = channel;
+							else
+								parameter_values[PAR_MIDI_CHAN_1+voice] = channel;
+							menu_repaint();
+						}
+							break;
+
+						case SEQ_MIDI_FILT_TX:
+							parameter_values[PAR_MIDI_FILT_TX] = frontParser_midiMsg.data2;
+							menu_repaint();
+							break;
+
+						case SEQ_MIDI_FILT_RX:
+							parameter_values[PAR_MIDI_FILT_RX] = frontParser_midiMsg.data2;
+							menu_repaint();
+							break;
+
+						case SEQ_CPU_LEVEL:
+							frontParser_cpuLevel = frontParser_midiMsg.data2;
+							//shown in the bottom right corner of the menu
+							menu_repaint();
+							break;
+
+						case SEQ_POOL_FULL:
+							frontParser_poolFull = frontParser_midiMsg.data2;
+							//shown as '!' in the bottom right corner of the menu
+							menu_repaint();
+							break;
 						
 						case LED_QUERY_SEQ_TRACK:
 						//this message is only send by the frontpanel, so it doesnt need to handle it
@@ -18,6 +18,10 @@ extern volatile uint8_t frontParser_newSeqDataAvailable;
 //a step instance to buffer the data received from the sequencer
 extern volatile StepData frontParser_stepData;
 extern uint8_t frontPanel_sysexMode;
+//quality level reported by the cpu load governor of the mainboard, 0 = full quality
+extern uint8_t frontParser_cpuLevel;
+//pattern memory of the mainboard is full, step data or locks were not stored
+extern uint8_t frontParser_poolFull;
 
 
 
@@ -137,6 +141,9 @@ extern uint8_t frontPanel_sysexMode;
 #define SEQ_TRIGGER_OUT1_PPQ  0x37
 #define SEQ_TRIGGER_OUT2_PPQ  0x38
 #define SEQ_TRIGGER_GATE_MODE 0x39
+#define SEQ_CPU_LEVEL		  0x3a
+#define SEQ_GROOVE			  0x3c
+#define SEQ_POOL_FULL		  0x3d
 
 //SysEx
 #define SYSEX_REQUEST_STEP_DATA			0x01
@@ -145,6 +152,8 @@ extern uint8_t frontPanel_sysexMode;
 #define SYSEX_SEND_MAIN_STEP_DATA		0x04
 #define SYSEX_REQUEST_PATTERN_DATA		0x05
 #define SYSEX_SEND_PAT_LEN_DATA			0x06
+#define SYSEX_REQUEST_LOCK_DATA			0x07
+#define SYSEX_SEND_LOCK_DATA			0x08
 
 
 /** a struct defining a standard midi message*/
@@ -111,10 +111,12 @@ inline void bufferTool_addGainDithered(Dither* dither, int16_t* buf, const float
 //---------------------------------------------------
 inline void bufferTool_addGainInterpolated(int16_t* buf, const float gain, const float lastGain, const uint8_t size)
 {
+	//blocks can be split at trigger positions, so size may be 1
+	const float step = size>1 ? 1.f/(size-1.f) : 0.f;
 	uint8_t i;
 	for(i=0;i<size;i++)
 	{
-		const float frac = i/(size-1.f);
+		const float frac = i*step;
 		const float currentGain = lastGain + frac*(gain - lastGain);
 		buf[i] = buf[i] * currentGain;
 	}
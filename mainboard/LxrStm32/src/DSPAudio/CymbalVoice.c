@@ -38,6 +38,7 @@
 #include "squareRootLut.h"
 #include "modulationNode.h"
 #include "TriggerOut.h"
+#include "samplePool.h"
 #include "config.h"
 
 INCCMZ CymbalVoice cymbalVoice;
@@ -103,6 +104,11 @@ void Cymbal_trigger( const uint8_t vel, const uint8_t note)
 	//update velocity modulation
 	modNode_updateValue(&velocityModulators[4],vel/127.f);
 
+	//let a still sounding sample ring out in the sample pool
+	samplePool_takeOver(4, &cymbalVoice.osc, &cymbalVoice.oscVolEg, cymbalVoice.egValueOscVol,
+			cymbalVoice.vol * (cymbalVoice.volumeMod ? cymbalVoice.velo : 1.f),
+			&cymbalVoice.filter, cymbalVoice.filterType, &cymbalVoice.distortion);
+
 	float offset = 1;
 	if(cymbalVoice.transGen.waveform==1) //offset mode
 	{
@@ -162,8 +168,8 @@ void Cymbal_calcSyncBlock(int16_t* buf, const uint8_t size)
 		int16_t mod[size];
 		int16_t mod2[size];
 		//calc next mod osc sample
-		calcNextOscSampleBlock(&cymbalVoice.modOsc,mod,size,cymbalVoice.fmModAmount1);
-		calcNextOscSampleBlock(&cymbalVoice.modOsc2,mod2,size,cymbalVoice.fmModAmount2);
+		calcNextModOscSampleBlock(&cymbalVoice.modOsc,mod,size,cymbalVoice.fmModAmount1);
+		calcNextModOscSampleBlock(&cymbalVoice.modOsc2,mod2,size,cymbalVoice.fmModAmount2);
 
 		//combine both mod oscs to 1 modulation signal
 		bufferTool_addBuffersSaturating(mod,mod2,size);
@@ -172,27 +178,15 @@ void Cymbal_calcSyncBlock(int16_t* buf, const uint8_t size)
 		SVF_calcBlockZDF(&cymbalVoice.filter,cymbalVoice.filterType,buf,size);
 
 		//calc transient sample
-		transient_calcBlock(&cymbalVoice.transGen,mod,size);
-
-		uint8_t j;
-		if(cymbalVoice.volumeMod)
+		if(transient_calcBlock(&cymbalVoice.transGen,mod,size))
 		{
-			for(j=0;j<size;j++)
-			{
-				//add filter to buffer
-				buf[j] = (__QADD16(buf[j],mod[j])) ;
-				buf[j] *=  cymbalVoice.velo * cymbalVoice.vol * cymbalVoice.egValueOscVol;
-			}
-		}
-		else
-		{
-			for(j=0;j<size;j++)
-			{
-				//add filter to buffer
-				buf[j] = (__QADD16(buf[j],mod[j])) ;
-				buf[j] *=  cymbalVoice.vol * cymbalVoice.egValueOscVol;
-			}
+			bufferTool_addBuffersSaturating(buf,mod,size);
 		}
+
+		//osc EG, MIDI velocity and the channel volume, which is ramped from the last block and drives the distortion
+		const float egGain = (cymbalVoice.volumeMod ? cymbalVoice.velo : 1.f) * cymbalVoice.egValueOscVol;
+		bufferTool_addGainInterpolated(buf, egGain * cymbalVoice.vol, egGain * cymbalVoice.lastVol, size);
+		cymbalVoice.lastVol = cymbalVoice.vol;
 		calcDistBlock(&cymbalVoice.distortion,buf,size);
 }
 //---------------------------------------------------
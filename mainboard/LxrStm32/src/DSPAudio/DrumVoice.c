@@ -43,6 +43,7 @@
 #include "ParameterArray.h"
 #include "modulationNode.h"
 #include "TriggerOut.h"
+#include "samplePool.h"
 
 
 INCCM static float ampSmoothValue = 0.1f;
@@ -124,6 +125,23 @@ void Drum_trigger(const uint8_t voiceNr, const uint8_t vol, const uint8_t note)
 	//update velocity modulation
 	modNode_updateValue(&velocityModulators[voiceNr],vol/127.f);
 
+	//let a still sounding sample ring out in the sample pool
+	{
+		const float gain = voiceArray[voiceNr].volumeMod ? voiceArray[voiceNr].velo : 1.f;
+#if (USE_FILTER_DRIVE == 0)
+		const Distortion* dist = &voiceArray[voiceNr].distortion;
+#else
+		const Distortion* dist = 0;
+#endif
+#if (AMP_EG_SYNC==0)
+		const float egValue = voiceArray[voiceNr].ampFilterInput;
+#else
+		const float egValue = voiceArray[voiceNr].volEgValueBlock[OUTPUT_DMA_SIZE-1];
+#endif
+		samplePool_takeOver(voiceNr, &voiceArray[voiceNr].osc, &voiceArray[voiceNr].oscVolEg, egValue, gain,
+				&voiceArray[voiceNr].filter, voiceArray[voiceNr].filterType, dist);
+	}
+
 	//only reset phase if envelope is closed
 #ifdef USE_AMP_FILTER
 	if((voiceArray[voiceNr].volEgValueBlock[15]<=0.01f) || (voiceArray[voiceNr].transGen.waveform==1))
@@ -229,7 +247,7 @@ void calcDrumVoiceSyncBlock(const uint8_t voiceNr, int16_t* buf, const uint8_t s
 #endif
 
 	//calc next mod osc sampleBlock
-	calcNextOscSampleBlock(&voiceArray[voiceNr].modOsc,modBuf,size,voiceArray[voiceNr].fmModAmount);
+	calcNextModOscSampleBlock(&voiceArray[voiceNr].modOsc,modBuf,size,voiceArray[voiceNr].fmModAmount);
 
 	if(voiceArray[voiceNr].mixOscs)
 	{
@@ -243,33 +261,35 @@ void calcDrumVoiceSyncBlock(const uint8_t voiceNr, int16_t* buf, const uint8_t s
 		calcNextOscSampleFmBlock(&voiceArray[voiceNr].osc,modBuf,buf,size,1.0f);
 	}
 
-	//calc transient sample
-	transient_calcBlock(&voiceArray[voiceNr].transGen,modBuf,size);
-
-	//Mix with transient buffer
-	bufferTool_addBuffersSaturating(buf,modBuf,size);
+	//calc transient sample and mix it with the osc
+	if(transient_calcBlock(&voiceArray[voiceNr].transGen,modBuf,size))
+	{
+		bufferTool_addBuffersSaturating(buf,modBuf,size);
+	}
 
 	//calc filter block
 	SVF_calcBlockZDF(&voiceArray[voiceNr].filter,voiceArray[voiceNr].filterType,buf,size);
 
+	//MIDI velocity
+	const float velo = voiceArray[voiceNr].volumeMod ? voiceArray[voiceNr].velo : 1.f;
+
 	//attentuate main OSCs by amp EG
 #ifdef USE_AMP_FILTER
 	bufferTool_multiplyWithFloatBufferDithered(&voiceArray[voiceNr].dither, buf,voiceArray[voiceNr].volEgValueBlock,size);
-#else
-	bufferTool_addGainInterpolated(buf,voiceArray[voiceNr].ampFilterInput, voiceArray[voiceNr].lastGain, size);
-#endif
-
-	//MIDI velocity
 	if(voiceArray[voiceNr].volumeMod)
 	{
-		bufferTool_addGain(buf,voiceArray[voiceNr].velo,size);
+		bufferTool_addGain(buf,velo,size);
 	}
+#else
+	//velocity folded into the amp EG ramp
+	bufferTool_addGainInterpolated(buf,voiceArray[voiceNr].ampFilterInput*velo, voiceArray[voiceNr].lastGain*velo, size);
+#endif
+
 	//distortion
 #if (USE_FILTER_DRIVE == 0)
 	calcDistBlock(&voiceArray[voiceNr].distortion,buf,size);
 #endif
-	//channel volume
-	bufferTool_addGain(buf,voiceArray[voiceNr].vol,size);
+	//channel volume is applied with the pan gains in the mixer
 }
 //---------------------------------------------------
 
@@ -39,6 +39,7 @@
 #include "squareRootLut.h"
 #include "modulationNode.h"
 #include "TriggerOut.h"
+#include "samplePool.h"
 
 INCCMZ HiHatVoice hatVoice;
 
@@ -103,6 +104,11 @@ void HiHat_trigger( uint8_t vel, uint8_t isOpen, const uint8_t note)
 	//update velocity modulation
 	modNode_updateValue(&velocityModulators[5],vel/127.f);
 
+	//let a still sounding sample ring out in the sample pool (0.5 = fm osc gain in HiHat_calcSyncBlock)
+	samplePool_takeOver(5, &hatVoice.osc, &hatVoice.oscVolEg, hatVoice.egValueOscVol,
+			0.5f * hatVoice.vol * (hatVoice.volumeMod ? hatVoice.velo : 1.f),
+			&hatVoice.filter, hatVoice.filterType, &hatVoice.distortion);
+
 	float offset = 1;
 	if(hatVoice.transGen.waveform==1) //offset mode
 	{
@@ -167,8 +173,8 @@ void HiHat_calcSyncBlock(int16_t* buf, const uint8_t size)
 	//2 buffers for the mod oscs
 	int16_t mod1[size],mod2[size];
 	//calc next mod osc samples, scaled with mod amount
-	calcNextOscSampleBlock(&hatVoice.modOsc,mod1,size, hatVoice.fmModAmount1);
-	calcNextOscSampleBlock(&hatVoice.modOsc2,mod2,size,  hatVoice.fmModAmount2);
+	calcNextModOscSampleBlock(&hatVoice.modOsc,mod1,size, hatVoice.fmModAmount1);
+	calcNextModOscSampleBlock(&hatVoice.modOsc2,mod2,size,  hatVoice.fmModAmount2);
 
 	//combine both mod oscs to 1 modulation signal
 	bufferTool_addBuffersSaturating(mod1,mod2,size);
@@ -178,28 +184,16 @@ void HiHat_calcSyncBlock(int16_t* buf, const uint8_t size)
 	SVF_calcBlockZDF(&hatVoice.filter,hatVoice.filterType,buf,size);
 
 	//calc transient sample
-	transient_calcBlock(&hatVoice.transGen,mod1,size);
-
-	uint8_t j;
-	if(hatVoice.volumeMod)
-	{
-		for(j=0;j<size;j++)
-		{
-			//add filter to buffer
-			buf[j] = __QADD16(buf[j],mod1[j]);
-			buf[j] *= hatVoice.velo * hatVoice.vol * hatVoice.egValueOscVol;
-		}
-	}
-	else
+	if(transient_calcBlock(&hatVoice.transGen,mod1,size))
 	{
-		for(j=0;j<size;j++)
-		{
-			//add filter to buffer
-			buf[j] = __QADD16(buf[j],mod1[j]);
-			buf[j] *= hatVoice.vol * hatVoice.egValueOscVol;
-		}
+		bufferTool_addBuffersSaturating(buf,mod1,size);
 	}
 
+	//osc EG, MIDI velocity and the channel volume, which is ramped from the last block and drives the distortion
+	const float egGain = (hatVoice.volumeMod ? hatVoice.velo : 1.f) * hatVoice.egValueOscVol;
+	bufferTool_addGainInterpolated(buf, egGain * hatVoice.vol, egGain * hatVoice.lastVol, size);
+	hatVoice.lastVol = hatVoice.vol;
+
 	calcDistBlock(&hatVoice.distortion,buf,size);
 }
 //---------------------------------------------------
@@ -62,6 +62,7 @@ typedef struct HiHatStruct
 	float		fmModAmount2;
 
 	float	 	vol;		// volume of the voice
+	float		lastVol;	// volume of the last block, start of the volume ramp
 	//float		panL;		// [0:1]
 	//float		panR;		// [0:1]
 	uint8_t pan;
@@ -41,6 +41,9 @@
 #include "MidiNoteNumbers.h"
 #include "sequencer.h"
 
+// quality switches, turned off by the load governor when we run out of cpu
+uint8_t osc_interpolate = 1;	// interpolate between table/sample values (only if INTERPOLATE_OSC/INTERPOLATE_FM_OSC)
+uint8_t osc_modHalfRate = 0;	// calculate mod oscs at half the sample rate
 
 //TODO die phaseInc berechnung kann man doch sicher per LUT machen!
 //-----------------------------------------------------------
@@ -86,9 +89,13 @@ void calcSineBlock(OscInfo* osc, int16_t* buf, const uint8_t size ,const float g
 		uint32_t  itg	= index>>20;
 
 		#if INTERPOLATE_OSC
-			oscOut = sine_table[itg++];
-			const float frac = (index&0x7ffff)*0.0000019073486328125f;
-			oscOut += frac*(sine_table[itg] - oscOut);
+			oscOut = sine_table[itg];
+			if(osc_interpolate)
+			{
+				itg++;
+				const float frac = (index&0x7ffff)*0.0000019073486328125f;
+				oscOut += frac*(sine_table[itg] - oscOut);
+			}
 		#else
 			oscOut = sine_table[itg];
 		#endif
@@ -133,9 +140,13 @@ void calcFmSineBlock(OscInfo* osc, int16_t* modBuffer, int16_t* buf, uint8_t siz
 		uint32_t  itg	= index>>20;
 
 	#if INTERPOLATE_FM_OSC
-		oscOut = sine_table[itg++];
-		const float frac	= (index&0x7ffff)*0.0000019073486328125f;
-		oscOut += frac*(sine_table[itg] - oscOut);
+		oscOut = sine_table[itg];
+		if(osc_interpolate)
+		{
+			itg++;
+			const float frac	= (index&0x7ffff)*0.0000019073486328125f;
+			oscOut += frac*(sine_table[itg] - oscOut);
+		}
 	#else
 		oscOut = sine_table[itg];
 	#endif
@@ -178,12 +189,16 @@ void calcFmBlock(OscInfo* osc, const int16_t table[][1024], int16_t* modBuffer,
 		uint32_t  itg	= index>>22;
 
 	#if INTERPOLATE_FM_OSC
-		oscOut = table[osc->tableOffset][itg++];
-		const float frac	= (index&0x003FFFFF)*2.38418579101562e-07f;
-		oscOut += frac*(table[osc->tableOffset][itg] - oscOut);
+		oscOut = table[osc->tableOffset][itg];
+		if(osc_interpolate)
+		{
+			itg++;
+			const float frac	= (index&0x003FFFFF)*2.38418579101562e-07f;
+			oscOut += frac*(table[osc->tableOffset][itg] - oscOut);
+		}
 
 	#else
-		oscOut = table[overtoneIndex][itg];
+		oscOut = table[osc->tableOffset][itg];
 	#endif
 
 		osc->phase = oscPhase + osc->phaseInc;
@@ -207,7 +222,7 @@ int16_t calcFm(OscInfo* osc, OscInfo* modOsc, const int16_t table[][1024])
 	const float frac	= (index&0x003FFFFF)*2.38418579101562e-07f;
 	oscOut += frac*(table[osc->tableOffset][itg] - oscOut);
 #else
-	oscOut = table[overtoneIndex][itg];
+	oscOut = table[osc->tableOffset][itg];
 #endif
 
 	osc->phase = oscPhase + osc->phaseInc;
@@ -374,6 +389,31 @@ void calcNextOscSampleBlock(OscInfo* osc, int16_t* buf, const uint8_t size, cons
 		}
 }
 //-----------------------------------------------------------
+void calcNextModOscSampleBlock(OscInfo* osc, int16_t* buf, const uint8_t size, const float gain)
+{
+	if(!osc_modHalfRate)
+	{
+		calcNextOscSampleBlock(osc,buf,size,gain);
+		return;
+	}
+
+	//calc half the samples with doubled phase increment (rounded up, split blocks can have an odd size)
+	const uint32_t phaseInc = osc->phaseInc;
+	const uint8_t half = (size+1)/2;
+	osc->phaseInc = phaseInc*2;
+	calcNextOscSampleBlock(osc,buf,half,gain);
+	osc->phaseInc = phaseInc;
+
+	//and stretch them to the full block. back to front, so no unread sample is overwritten
+	uint8_t i;
+	for(i=half;i>0;i--)
+	{
+		const int16_t val = buf[i-1];
+		if(2*i-1 < size) buf[2*i-1] = val;
+		buf[2*i-2] = val;
+	}
+}
+//-----------------------------------------------------------
 int16_t calcNextOscSample(OscInfo* osc)
 {
 	switch(osc->waveform)
@@ -421,9 +461,13 @@ void calcWavetableOscBlock(OscInfo* osc, const int16_t table[][1024], int16_t* b
 			uint32_t  itg	= oscPhase>>22;
 		#if INTERPOLATE_OSC
 			//todo use ldm instead of ldr to laod multiple values from memory
-			oscOut = table[osc->tableOffset][itg++];
-			const float frac = (itg&0x003FFFFF)*2.38418579101562e-07f; //2.38... => 1.f/0x3fffff
-			oscOut += frac*(table[osc->tableOffset][itg] - oscOut);
+			oscOut = table[osc->tableOffset][itg];
+			if(osc_interpolate)
+			{
+				itg++;
+				const float frac = (itg&0x003FFFFF)*2.38418579101562e-07f; //2.38... => 1.f/0x3fffff
+				oscOut += frac*(table[osc->tableOffset][itg] - oscOut);
+			}
 		#else
 			oscOut = table[osc->tableOffset][itg];
 		#endif
@@ -469,9 +513,13 @@ void calcSampleOscFmBlock(OscInfo* osc,int16_t* modBuffer, int16_t* buf, uint8_t
 		uint32_t  itg	= index>>17;
 
 	#if INTERPOLATE_FM_OSC
-		oscOut = crashSample[itg++];
-		const float frac	= (index&20000)*0.00000762939453125f;//=> * 1/0x20000
-		oscOut += frac*(crashSample[itg] - oscOut);
+		oscOut = crashSample[itg];
+		if(osc_interpolate)
+		{
+			itg++;
+			const float frac	= (index&20000)*0.00000762939453125f;//=> * 1/0x20000
+			oscOut += frac*(crashSample[itg] - oscOut);
+		}
 	#else
 		oscOut = crashSample[itg];
 	#endif
@@ -526,9 +574,13 @@ void calcUserSampleOscFmBlock(OscInfo* osc,int16_t* modBuffer, int16_t* buf, uin
 		uint32_t  itg	= index>>17;
 
 	#if INTERPOLATE_FM_OSC
-		oscOut = sampleData[itg++];
-		const float frac	= (index&20000)*0.00000762939453125f;//=> * 1/0x20000
-		oscOut += frac*(sampleData[itg] - oscOut);
+		oscOut = sampleData[itg];
+		if(osc_interpolate)
+		{
+			itg++;
+			const float frac	= (index&20000)*0.00000762939453125f;//=> * 1/0x20000
+			oscOut += frac*(sampleData[itg] - oscOut);
+		}
 	#else
 		oscOut = sampleData[itg];
 	#endif
@@ -561,9 +613,13 @@ void calcUserSampleOscBlock(OscInfo* osc, int16_t* buf, const uint8_t size ,cons
 
 	#if INTERPOLATE_OSC
 
-		oscOut = sampleData[itg++];
-		const float frac = (oscPhase&20000)*0.00000762939453125f;//=> * 1/0x20000
-		oscOut += frac*(sampleData[itg] - oscOut);
+		oscOut = sampleData[itg];
+		if(osc_interpolate)
+		{
+			itg++;
+			const float frac = (oscPhase&20000)*0.00000762939453125f;//=> * 1/0x20000
+			oscOut += frac*(sampleData[itg] - oscOut);
+		}
 	#else
 		oscOut = sampleData[itg];
 	#endif
@@ -590,9 +646,13 @@ void calcSampleOscBlock(OscInfo* osc, int16_t* buf, const uint8_t size ,const fl
 
 	#if INTERPOLATE_OSC
 		//todo use ldm instead of ldr to laod multiple values from memory
-		oscOut = crashSample[itg++];
-		const float frac = (oscPhase&20000)*0.00000762939453125f;//=> * 1/0x20000
-		oscOut += frac*(crashSample[itg] - oscOut);
+		oscOut = crashSample[itg];
+		if(osc_interpolate)
+		{
+			itg++;
+			const float frac = (oscPhase&20000)*0.00000762939453125f;//=> * 1/0x20000
+			oscOut += frac*(crashSample[itg] - oscOut);
+		}
 	#else
 		oscOut = crashSample[itg];
 	#endif
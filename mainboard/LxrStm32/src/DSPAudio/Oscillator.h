@@ -80,6 +80,10 @@ typedef struct OscStruct
 } OscInfo;
 //-----------------------------------------------------------
 
+//quality switches used by the load governor
+extern uint8_t osc_interpolate;
+extern uint8_t osc_modHalfRate;
+
 //extern OscInfo osc1;
 //extern OscInfo osc2;
 
@@ -114,6 +118,9 @@ void calcSampleOscFmBlock(OscInfo* osc,int16_t* modBuffer, int16_t* buf, uint8_t
 //-----------------------------------------------------------
 void calcNextOscSampleBlock(OscInfo* osc, int16_t* buf, const uint8_t size ,const float gain);
 //-----------------------------------------------------------
+// same as calcNextOscSampleBlock, but runs at half rate if osc_modHalfRate is set. used for the mod oscs
+void calcNextModOscSampleBlock(OscInfo* osc, int16_t* buf, const uint8_t size ,const float gain);
+//-----------------------------------------------------------
 // calculate an oscillator
 int16_t calcNextOscSample(OscInfo* osc);
  //-----------------------------------------------------------
@@ -40,6 +40,9 @@
 // so libm.a won't link without this int.
 int __errno;
 //------------------------------------------------------------------------------------
+// nonlinear integrators on/off. switched off by the load governor to save cpu
+uint8_t SVF_nonlinear = 1;
+//------------------------------------------------------------------------------------
 
 //------------------------------------------------------------------------------------
 void SVF_setReso(ResonantFilter* filter, float feedback)
@@ -201,9 +204,14 @@ void SVF_calcBlockZDF(ResonantFilter* filter, const uint8_t type, int16_t* buf,
 			double t1 = tanhXdX(a*s[0]);
 			*/
 	#if ENABLE_NONLINEAR_INTEGRATORS
-			const float scale = 0.5f;
-			const float t0 = tanhXdX(scale* (ih - 2*R*filter->s1 - filter->s2 ) );
-			const float t1 = tanhXdX(scale* (filter->s1 ) );
+			float t0 = 1;
+			float t1 = 1;
+			if(SVF_nonlinear)
+			{
+				const float scale = 0.5f;
+				t0 = tanhXdX(scale* (ih - 2*R*filter->s1 - filter->s2 ) );
+				t1 = tanhXdX(scale* (filter->s1 ) );
+			}
 	#else
 			const float t0 = 1;
 			const float t1 = 1;
@@ -222,9 +230,10 @@ void SVF_calcBlockZDF(ResonantFilter* filter, const uint8_t type, int16_t* buf,
 
 			// solve the remaining stages with nonlinear gain
 			 const float xx = t0*(x - y1);
-			 const float y0 = (softClipTwo(s1) + f*xx)*g0;
+			 const float s1Clip = SVF_nonlinear ? softClipTwo(s1) : s1;
+			 const float y0 = (s1Clip + f*xx)*g0;
 
-			filter->s1   = softClipTwo(filter->s1) + 2*f*(xx - t0*2*R*y0);
+			filter->s1   = s1Clip + 2*f*(xx - t0*2*R*y0);
 			filter->s2   = (filter->s2)    + 2*f* t1*y0;
 
 
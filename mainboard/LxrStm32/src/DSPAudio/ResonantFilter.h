@@ -90,6 +90,8 @@ typedef struct ResoFilterStruct
 #endif
 } ResonantFilter;
 //------------------------------------------------------------------------------------
+extern uint8_t SVF_nonlinear;
+//------------------------------------------------------------------------------------
 void SVF_setReso(ResonantFilter* filter, float feedback);
 //------------------------------------------------------------------------------------
 void SVF_init();
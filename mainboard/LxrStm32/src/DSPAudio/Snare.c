@@ -159,8 +159,10 @@ void Snare_calcSyncBlock(int16_t* buf, const uint8_t size)
 	SVF_calcBlockZDF(&snareVoice.filter,snareVoice.filterType,buf,size);
 
 	//calc transient sample
-	transient_calcBlock(&snareVoice.transGen,transBuf,size);
-	bufferTool_addBuffersSaturating(buf,transBuf,size);
+	if(transient_calcBlock(&snareVoice.transGen,transBuf,size))
+	{
+		bufferTool_addBuffersSaturating(buf,transBuf,size);
+	}
 
 	//calc next osc sample
 	calcNextOscSampleBlock(&snareVoice.osc,transBuf,size,(1.f-snareVoice.mix));
@@ -168,27 +170,18 @@ void Snare_calcSyncBlock(int16_t* buf, const uint8_t size)
 	//SVF_calcBlockZDF(&snareVoice.filter,snareVoice.filterType,transBuf,size);
 
 	uint8_t j;
-	if(snareVoice.volumeMod)
-	{
-		for(j=0;j<size;j++)
-		{
-			//add filter to buffer
-			buf[j] *= snareVoice.mix;
-			buf[j] = (__QADD16(buf[j],transBuf[j]));
-			buf[j] *=  snareVoice.velo * snareVoice.vol * snareVoice.egValueOscVol;
-		}
-	}
-	else
+	for(j=0;j<size;j++)
 	{
-		for(j=0;j<size;j++)
-		{
-			//add filter to buffer
-			buf[j] *= snareVoice.mix;
-			buf[j] = (__QADD16(buf[j],transBuf[j]));
-			buf[j] *=  snareVoice.vol * snareVoice.egValueOscVol;
-		}
+		//add filter to buffer
+		buf[j] *= snareVoice.mix;
+		buf[j] = (__QADD16(buf[j],transBuf[j]));
 	}
 
+	//osc EG, MIDI velocity and the channel volume, which is ramped from the last block and drives the distortion
+	const float egGain = (snareVoice.volumeMod ? snareVoice.velo : 1.f) * snareVoice.egValueOscVol;
+	bufferTool_addGainInterpolated(buf, egGain * snareVoice.vol, egGain * snareVoice.lastVol, size);
+	snareVoice.lastVol = snareVoice.vol;
+
 	calcDistBlock(&snareVoice.distortion,buf,size);
 }
 //------------------------------------------------------------------------
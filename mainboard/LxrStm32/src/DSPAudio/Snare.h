@@ -59,6 +59,7 @@ typedef struct SnareStruct
 
 	uint8_t		filterType; // bit 0 = lp, bit 1 = hp, bit 3 = bp on/off
 	float	 	vol;		// volume of the voice
+	float		lastVol;	// volume of the last block, start of the volume ramp
 	//float		panL;		// [0:1]
 	//float		panR;		// [0:1]
 	uint8_t pan;
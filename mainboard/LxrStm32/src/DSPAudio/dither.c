@@ -38,7 +38,6 @@
 
 int16_t dither_process(Dither* dither, float in)
 {
-
 	dither->r2 = dither->r1;                               						//can make HP-TRI dither by
 	dither->r1 = GetRngValue();//rand();                          				//subtracting previous rand()
 
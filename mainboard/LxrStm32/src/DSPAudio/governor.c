@@ -0,0 +1,108 @@
+/*
+ * governor.c
+ *
+ *  Created on: 18.10.2026
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  Copyright 2013 Julian Schmidt
+ *  Julian@sonic-potions.com
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  This file is part of the Sonic Potions LXR drumsynth firmware.
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  Redistribution and use of the LXR code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *       - The code may not be sold, nor may it be used in a commercial product or activity.
+ *
+ *       - Redistributions that are modified from the original source must include the complete
+ *         source code, including the source code for all components used by a binary built
+ *         from the modified sources. However, as a special exception, the source code distributed
+ *         need not include anything that is normally distributed (in either source or binary form)
+ *         with the major components (compiler, kernel, and so on) of the operating system on which
+ *         the executable runs, unless that component itself accompanies the executable.
+ *
+ *       - Redistributions must reproduce the above copyright notice, this list of conditions and the
+ *         following disclaimer in the documentation and/or other materials provided with the distribution.
+ * ------------------------------------------------------------------------------------------------------------------------
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *   WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *   USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ------------------------------------------------------------------------------------------------------------------------
+ */
+
+#include "governor.h"
+#include "Oscillator.h"
+#include "ResonantFilter.h"
+#include "Uart.h"
+#include "MidiMessages.h"
+//------------------------------------------------------------------------
+static uint8_t governor_level = GOVERNOR_LEVEL_FULL;
+static uint8_t governor_overCnt = 0;	// consecutive blocks over GOVERNOR_LOAD_HIGH
+static uint16_t governor_underCnt = 0;	// consecutive blocks under GOVERNOR_LOAD_LOW
+//------------------------------------------------------------------------
+static void governor_applyLevel()
+{
+	osc_interpolate	= governor_level < GOVERNOR_LEVEL_NO_INTERPOLATION;
+	SVF_nonlinear	= governor_level < GOVERNOR_LEVEL_LINEAR_SVF;
+	osc_modHalfRate	= governor_level >= GOVERNOR_LEVEL_HALF_RATE_MOD;
+
+	//report the new level to the front
+	uart_sendFrontpanelByte(FRONT_SEQ_CC);
+	uart_sendFrontpanelByte(FRONT_SEQ_CPU_LEVEL);
+	uart_sendFrontpanelByte(governor_level);
+}
+//------------------------------------------------------------------------
+void governor_init()
+{
+	governor_level = GOVERNOR_LEVEL_FULL;
+	governor_overCnt = 0;
+	governor_underCnt = 0;
+	osc_interpolate	= 1;
+	SVF_nonlinear	= 1;
+	osc_modHalfRate	= 0;
+}
+//------------------------------------------------------------------------
+void governor_update(const uint8_t cpuLoad)
+{
+	if(cpuLoad > GOVERNOR_LOAD_HIGH)
+	{
+		governor_underCnt = 0;
+		if(governor_level < GOVERNOR_MAX_LEVEL)
+		{
+			if(++governor_overCnt >= GOVERNOR_DEGRADE_BLOCKS)
+			{
+				governor_level++;
+				governor_overCnt = 0;
+				governor_applyLevel();
+			}
+		}
+	}
+	else if(cpuLoad < GOVERNOR_LOAD_LOW)
+	{
+		governor_overCnt = 0;
+		if(governor_level > GOVERNOR_LEVEL_FULL)
+		{
+			if(++governor_underCnt >= GOVERNOR_RESTORE_BLOCKS)
+			{
+				governor_level--;
+				governor_underCnt = 0;
+				governor_applyLevel();
+			}
+		}
+	}
+	else
+	{
+		//in the hysteresis band, start counting again
+		governor_overCnt = 0;
+		governor_underCnt = 0;
+	}
+}
+//------------------------------------------------------------------------
+uint8_t governor_getLevel()
+{
+	return governor_level;
+}
+//------------------------------------------------------------------------
@@ -0,0 +1,68 @@
+/*
+ * governor.h
+ *
+ *  Created on: 18.10.2026
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  Copyright 2013 Julian Schmidt
+ *  Julian@sonic-potions.com
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  This file is part of the Sonic Potions LXR drumsynth firmware.
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  Redistribution and use of the LXR code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *       - The code may not be sold, nor may it be used in a commercial product or activity.
+ *
+ *       - Redistributions that are modified from the original source must include the complete
+ *         source code, including the source code for all components used by a binary built
+ *         from the modified sources. However, as a special exception, the source code distributed
+ *         need not include anything that is normally distributed (in either source or binary form)
+ *         with the major components (compiler, kernel, and so on) of the operating system on which
+ *         the executable runs, unless that component itself accompanies the executable.
+ *
+ *       - Redistributions must reproduce the above copyright notice, this list of conditions and the
+ *         following disclaimer in the documentation and/or other materials provided with the distribution.
+ * ------------------------------------------------------------------------------------------------------------------------
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *   WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *   USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ------------------------------------------------------------------------------------------------------------------------
+ */
+
+
+#ifndef GOVERNOR_H_
+#define GOVERNOR_H_
+
+#include "stm32f4xx.h"
+#include "config.h"
+//------------------------------------------------------------------------
+// Watches the cpu load of the audio blocks and trades sound quality for
+// cpu time when we are about to miss the dma deadline.
+// Each level switches off one more quality feature, in this order:
+//------------------------------------------------------------------------
+#define GOVERNOR_LEVEL_FULL				0	// everything on
+#define GOVERNOR_LEVEL_NO_INTERPOLATION	1	// no osc/sample interpolation
+#define GOVERNOR_LEVEL_LINEAR_SVF		2	// filters without nonlinear integrators
+#define GOVERNOR_LEVEL_HALF_RATE_MOD	3	// mod oscs at half the sample rate
+#define GOVERNOR_MAX_LEVEL				GOVERNOR_LEVEL_HALF_RATE_MOD
+
+// cpu load thresholds [%]
+#define GOVERNOR_LOAD_HIGH				90
+#define GOVERNOR_LOAD_LOW				60
+
+// number of consecutive blocks needed for a level change
+#define GOVERNOR_DEGRADE_BLOCKS			4		// ~3ms, react fast to overload
+#define GOVERNOR_RESTORE_BLOCKS			690		// ~0.5s of headroom before the next level is restored
+//------------------------------------------------------------------------
+void governor_init();
+
+/** check the load of the last block and change the quality level if needed. call once per block from the main loop*/
+void governor_update(const uint8_t cpuLoad);
+
+uint8_t governor_getLevel();
+
+#endif /* GOVERNOR_H_ */
@@ -36,43 +36,69 @@
 #include "mixer.h"
 #include "config.h"
 #include "AudioCodecManager.h"
-#include "CymbalVoice.h"
-#include "DrumVoice.h"
-#include "Snare.h"
-#include "HiHat.h"
+#include "voiceTable.h"
+#include "samplePool.h"
 #include "BufferTools.h"
 #include "squareRootLut.h"
 #include "../Hardware/TriggerOut.h"
+#include "sequencer.h"
+#include "ParameterArray.h"
 //-----------------------------------------------------------------------
-INCCMZ uint8_t mixer_audioRouting[6];
+INCCMZ uint8_t mixer_audioRouting[NUM_SYNTH_VOICES];
+//-----------------------------------------------------------------------
+static uint32_t mixer_blockCycles = 0;		/**< cpu cycles the last mixer_calcNextSampleBlock call took*/
+static uint32_t mixer_budgetCycles = 1;		/**< cpu cycles available per audio block*/
+//-----------------------------------------------------------------------
+typedef struct MixerGainStruct
+{
+	float l;		/**< left gain of the stereo routings (volume * pan law)*/
+	float r;		/**< right gain of the stereo routings*/
+	float mono;		/**< gain of the mono routings (volume only)*/
+} MixerGain;
+
+INCCMZ static MixerGain mixer_lastGain[NUM_SYNTH_VOICES];	/**< output gains of the last block, start of the gain ramp*/
 //-----------------------------------------------------------------------
 #if USE_DECIMATOR
-INCCMZ float mixer_decimation_rate[7];		/**<sets the sample rate decimation. 0..1 = full rate*/
-INCCMZ float mixer_decimation_cnt[6];		/**<s'n'h counter for decimator*/
-INCCMZ int16_t mixer_voice_samples[6];		/**< stores the last outputted sample of the 6 voices*/
+INCCMZ float mixer_decimation_rate[NUM_SYNTH_VOICES+1];	/**<sets the sample rate decimation. 0..1 = full rate, last entry scales all voices*/
+INCCMZ float mixer_decimation_cnt[NUM_SYNTH_VOICES];		/**<s'n'h counter for decimator*/
+INCCMZ int16_t mixer_voice_samples[NUM_SYNTH_VOICES];		/**< stores the last outputted sample of each voice*/
 #endif
 //-----------------------------------------------------------------------
 void mixer_init()
 {
+	//enable the DWT cycle counter to measure the render time per block
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT_CYCCNT = 0;
+	DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+	mixer_budgetCycles = SystemCoreClock / (REAL_FS/OUTPUT_DMA_SIZE);
+
+	samplePool_init();
+
 #if USE_DECIMATOR
 	int i;
-	for(i=0;i<6;i++)
+	for(i=0;i<NUM_SYNTH_VOICES;i++)
 	{
 		mixer_decimation_rate[i] 	= 1;
 		mixer_decimation_cnt[i] 	= 0;
 		mixer_voice_samples[i] 		= 0;
 		mixer_audioRouting[i]		= 0;
 	}
-	mixer_decimation_rate[6] 		= 1;
+	mixer_decimation_rate[NUM_SYNTH_VOICES] = 1;
 #endif
 }
 //-----------------------------------------------------------------------
+uint8_t mixer_getCpuLoad()
+{
+	const uint32_t load = (mixer_blockCycles*100) / mixer_budgetCycles;
+	return load > 0xff ? 0xff : load;
+}
+//-----------------------------------------------------------------------
 void mixer_decimateBlock(const uint8_t voiceNr, int16_t* buffer)
 {
 	uint8_t i;
 	for(i=0;i<OUTPUT_DMA_SIZE;i++)
 	{
-		mixer_decimation_cnt[voiceNr] += mixer_decimation_rate[voiceNr]*mixer_decimation_rate[6];
+		mixer_decimation_cnt[voiceNr] += mixer_decimation_rate[voiceNr]*mixer_decimation_rate[NUM_SYNTH_VOICES];
 		if(mixer_decimation_cnt[voiceNr] >= 1.f)
 		{
 			mixer_decimation_cnt[voiceNr] -= 1.f;
@@ -222,63 +248,64 @@ inline void mixer_moveDataToOutput(uint8_t dest, const float panL, const float p
 	}
 }
 //-----------------------------------------------------------------------
-inline void mixer_addDataToOutput(uint8_t dest, const float panL, const float panR,  int16_t* data,int16_t* outL,int16_t* outR,int16_t* outL2, int16_t* outR2)
+inline void mixer_addDataToOutput(uint8_t dest, const MixerGain* start, const MixerGain* end, int16_t* data,int16_t* outL,int16_t* outR,int16_t* outL2, int16_t* outR2)
 {
 	//check if a cable is in the selected out
 	dest = mixer_checkOutJackAvailable(dest);
 
+	//gains are ramped linearly from the last block to this one
+	const float invSize = 1.f/OUTPUT_DMA_SIZE;
+
 	//TODO may be possible tooptimize here using both halfwordsof qadd for stereo mixing
 	uint8_t i;
 	switch(dest)
 	{
 
 	case MIXER_ROUTING_DAC1_STEREO:
-		for(i=0;i<OUTPUT_DMA_SIZE;i++)
-		{
-			*outL2 = __QADD16(*outL2,(int16_t)(data[i] * panL)) & 0xFFFF;
-			outL2 += 2;
-
-			*outR2 = __QADD16(*outR2,(int16_t)(data[i] * panR)) & 0xFFFF;
-			outR2 += 2;
-		}
-		break;
 	case MIXER_ROUTING_DAC2_STEREO:
+	{
+		int16_t* dstL = dest==MIXER_ROUTING_DAC1_STEREO ? outL2 : outL;
+		int16_t* dstR = dest==MIXER_ROUTING_DAC1_STEREO ? outR2 : outR;
+		float gainL = start->l;
+		float gainR = start->r;
+		const float incL = (end->l - start->l)*invSize;
+		const float incR = (end->r - start->r)*invSize;
 		for(i=0;i<OUTPUT_DMA_SIZE;i++)
 		{
-			*outL = __QADD16(*outL,(int16_t)(data[i] * panL)) & 0xFFFF;
-			outL += 2;
+			*dstL = __QADD16(*dstL,(int16_t)(data[i] * gainL)) & 0xFFFF;
+			dstL += 2;
 
-			*outR = __QADD16(*outR,(int16_t)(data[i] * panR)) & 0xFFFF;
-			outR += 2;
+			*dstR = __QADD16(*dstR,(int16_t)(data[i] * gainR)) & 0xFFFF;
+			dstR += 2;
+
+			gainL += incL;
+			gainR += incR;
 		}
+	}
 		break;
+
 	case MIXER_ROUTING_DAC1_L:
-		for(i=0;i<OUTPUT_DMA_SIZE;i++)
-		{
-			*outL2 = __QADD16(*outL2,data[i]) & 0xFFFF;
-			outL2 += 2;
-		}
-		break;
 	case MIXER_ROUTING_DAC1_R:
-		for(i=0;i<OUTPUT_DMA_SIZE;i++)
-		{
-			*outR2 = __QADD16(*outR2,data[i]) & 0xFFFF;
-			outR2 += 2;
-		}
-		break;
 	case MIXER_ROUTING_DAC2_L:
-		for(i=0;i<OUTPUT_DMA_SIZE;i++)
+	case MIXER_ROUTING_DAC2_R:
+	{
+		int16_t* dst;
+		switch(dest)
 		{
-			*outL = __QADD16(*outL,data[i]) & 0xFFFF;
-			outL += 2;
+		case MIXER_ROUTING_DAC1_L: 	dst = outL2; 	break;
+		case MIXER_ROUTING_DAC1_R: 	dst = outR2; 	break;
+		case MIXER_ROUTING_DAC2_L: 	dst = outL; 	break;
+		default: 					dst = outR; 	break;
 		}
-		break;
-	case MIXER_ROUTING_DAC2_R:
+		float gain = start->mono;
+		const float inc = (end->mono - start->mono)*invSize;
 		for(i=0;i<OUTPUT_DMA_SIZE;i++)
 		{
-			*outR = __QADD16(*outR,data[i]) & 0xFFFF;
-			outR += 2;
+			*dst = __QADD16(*dst,(int16_t)(data[i] * gain)) & 0xFFFF;
+			dst += 2;
+			gain += inc;
 		}
+	}
 		break;
 
 	}
@@ -286,34 +313,42 @@ inline void mixer_addDataToOutput(uint8_t dest, const float panL, const float pa
 //-----------------------------------------------------------------------
 void mixer_calcNextSampleBlock(int16_t* output,int16_t* output2)
 {
+	const uint32_t startCycles = DWT_CYCCNT;
+	uint8_t i;
+
+	//adapt sample tail polyphony to the load of the last block
+	samplePool_updateBudget(mixer_getCpuLoad());
+
 	modNode_resetTargets();
 	//re assign velocity modulation
 	modNode_reassignVeloMod();
+	//parameter locks of the steps triggered since the last block
+	seq_applyParamLocks();
+	//the latest value of every parameter changed since the last block
+	paramArray_applyQueued();
 
 	//calc and dispatch LFO
-	lfo_dispatchNextValue(&voiceArray[0].lfo);
-	lfo_dispatchNextValue(&voiceArray[1].lfo);
-	lfo_dispatchNextValue(&voiceArray[2].lfo);
-	lfo_dispatchNextValue(&snareVoice.lfo);
-	lfo_dispatchNextValue(&cymbalVoice.lfo);
-	lfo_dispatchNextValue(&hatVoice.lfo);
+	for(i=0;i<NUM_SYNTH_VOICES;i++)
+	{
+		lfo_dispatchNextValue(voiceTable[i].lfo);
+	}
 
 	//update filter frequencies
-	SVF_recalcFreq(&voiceArray[0].filter);
-	SVF_recalcFreq(&voiceArray[1].filter);
-	SVF_recalcFreq(&voiceArray[2].filter);
-	SVF_recalcFreq(&snareVoice.filter);
-	SVF_recalcFreq(&cymbalVoice.filter);
-	SVF_recalcFreq(&hatVoice.filter);
+	for(i=0;i<NUM_SYNTH_VOICES;i++)
+	{
+		SVF_recalcFreq(voiceTable[i].filter);
+	}
 
 	//--- Calc async -----
-	calcDrumVoiceAsync(0);
-	calcDrumVoiceAsync(1);
-	calcDrumVoiceAsync(2);
-
-	Snare_calcAsync();
-	Cymbal_calcAsync();
-	HiHat_calcAsync();
+	for(i=0;i<NUM_SYNTH_VOICES;i++)
+	{
+		//a voice retriggered inside this block is advanced once, right after its trigger.
+		//the part before the trigger keeps the values of the last block
+		if(voiceTable_getTriggerOffset(i) >= OUTPUT_DMA_SIZE)
+		{
+			voiceTable[i].calcAsync(i);
+		}
+	}
 
 	//calculate trigger io phase
 	trigger_tickPhaseCounter();
@@ -327,52 +362,43 @@ void mixer_calcNextSampleBlock(int16_t* output,int16_t* output2)
 	bufferTool_clearBuffer(output,OUTPUT_DMA_SIZE*2);
 	bufferTool_clearBuffer(output2,OUTPUT_DMA_SIZE*2);
 
-	//calc voice 1
-	calcDrumVoiceSyncBlock(0, sampleData,OUTPUT_DMA_SIZE);
-	//decimate voice
-	mixer_decimateBlock(0,sampleData);
-	//copy to selected dma buffer
-	mixer_addDataToOutput(mixer_audioRouting[0],squareRootLut[127-voiceArray[0].pan] ,squareRootLut[voiceArray[0].pan], sampleData,&output[pos],&output[pos+1],&output2[pos],&output2[pos+1]);
-
-
-	//calc voice 2
-	calcDrumVoiceSyncBlock(1, sampleData,OUTPUT_DMA_SIZE);
-	//decimate voice
-	mixer_decimateBlock(1,sampleData);
-	//copy to selected dma buffer
-	mixer_addDataToOutput(mixer_audioRouting[1],squareRootLut[127-voiceArray[1].pan] ,squareRootLut[voiceArray[1].pan], sampleData,&output[pos],&output[pos+1],&output2[pos],&output2[pos+1]);
-
-	//calc voice 3
-	calcDrumVoiceSyncBlock(2, sampleData,OUTPUT_DMA_SIZE);
-	//decimate voice
-	mixer_decimateBlock(2,sampleData);
-	//copy to selected dma buffer
-	mixer_addDataToOutput(mixer_audioRouting[2],squareRootLut[127-voiceArray[2].pan] ,squareRootLut[voiceArray[2].pan], sampleData,&output[pos],&output[pos+1],&output2[pos],&output2[pos+1]);
-
-	//calc snare
-	Snare_calcSyncBlock(sampleData,OUTPUT_DMA_SIZE);
-	//decimate voice
-	mixer_decimateBlock(3,sampleData);
-	//copy to selected dma buffer
-	mixer_addDataToOutput(mixer_audioRouting[3],squareRootLut[127-snareVoice.pan],
-			squareRootLut[snareVoice.pan], sampleData,&output[pos],&output[pos+1],&output2[pos],&output2[pos+1]);
-	//calc cymbal
-	Cymbal_calcSyncBlock(sampleData,OUTPUT_DMA_SIZE);
-	//decimate voice
-	mixer_decimateBlock(4,sampleData);
-	//copy to selected dma buffer
-	mixer_addDataToOutput(mixer_audioRouting[4],squareRootLut[127-cymbalVoice.pan],
-			squareRootLut[cymbalVoice.pan], sampleData,&output[pos],&output[pos+1],&output2[pos],&output2[pos+1]);
-
-
-
-	//calc HiHat
-	HiHat_calcSyncBlock(sampleData,OUTPUT_DMA_SIZE);
-	//decimate voice
-	mixer_decimateBlock(5,sampleData);
-	//copy to selected dma buffer
-	mixer_addDataToOutput(mixer_audioRouting[5],squareRootLut[127-hatVoice.pan],
-			squareRootLut[hatVoice.pan], sampleData,&output[pos],&output[pos+1],&output2[pos],&output2[pos+1]);
-
+	for(i=0;i<NUM_SYNTH_VOICES;i++)
+	{
+		//calc voice
+		const uint8_t triggerPos = voiceTable_getTriggerOffset(i);
+		if(triggerPos < OUTPUT_DMA_SIZE)
+		{
+			//sample accurate trigger: finish the old note up to the trigger position, then restart the voice there
+			if(triggerPos)
+			{
+				voiceTable[i].calcSyncBlock(i, sampleData,triggerPos);
+			}
+			samplePool_setTriggerOffset(triggerPos);
+			voiceTable_firePendingTrigger(i);
+			samplePool_setTriggerOffset(0);
+			SVF_recalcFreq(voiceTable[i].filter);
+			voiceTable[i].calcAsync(i);
+			voiceTable[i].calcSyncBlock(i, &sampleData[triggerPos],OUTPUT_DMA_SIZE-triggerPos);
+		}
+		else
+		{
+			voiceTable[i].calcSyncBlock(i, sampleData,OUTPUT_DMA_SIZE);
+		}
+		//add sample tails of retriggered notes
+		samplePool_addVoiceTails(i, sampleData,OUTPUT_DMA_SIZE);
+		//decimate voice
+		mixer_decimateBlock(i,sampleData);
+		//channel volume and pan gains, ramped from the values of the last block
+		const uint8_t pan = *voiceTable[i].pan;
+		const float vol = voiceTable[i].mixVol ? *voiceTable[i].mixVol : 1.f;
+		MixerGain gain;
+		gain.l 		= vol*squareRootLut[127-pan];
+		gain.r 		= vol*squareRootLut[pan];
+		gain.mono 	= vol;
+		//copy to selected dma buffer
+		mixer_addDataToOutput(mixer_audioRouting[i],&mixer_lastGain[i],&gain, sampleData,&output[pos],&output[pos+1],&output2[pos],&output2[pos+1]);
+		mixer_lastGain[i] = gain;
+	}
 
+	mixer_blockCycles = DWT_CYCCNT - startCycles;
 }
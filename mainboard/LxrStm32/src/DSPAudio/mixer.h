@@ -38,15 +38,16 @@
 #define MIXER_H_
 
 #include "stm32f4xx.h"
+#include "config.h"
 
 #define USE_SWITCH_ROUTING 1
 #define USE_DECIMATOR 1
 
 #if USE_DECIMATOR
-extern float mixer_decimation_rate[7];		/**<sets the sample rate decimation. 0..1 = full rate*/
+extern float mixer_decimation_rate[NUM_SYNTH_VOICES+1];		/**<sets the sample rate decimation. 0..1 = full rate*/
 #endif
 
-extern uint8_t mixer_audioRouting[6];
+extern uint8_t mixer_audioRouting[NUM_SYNTH_VOICES];
 
 enum
 {
@@ -60,5 +61,7 @@ enum
 
 void mixer_init();
 void mixer_calcNextSampleBlock(int16_t* output,int16_t* output2);
+/** render time of the last audio block in percent of the available block time*/
+uint8_t mixer_getCpuLoad();
 
 #endif /* MIXER_H_ */
@@ -36,13 +36,10 @@
 
 
 #include "modulationNode.h"
-#include "DrumVoice.h"
-#include "CymbalVoice.h"
-#include "HiHat.h"
-#include "Snare.h"
+#include "voiceTable.h"
 #include "sequencer.h"
 
-INCCMZ ModulationNode velocityModulators[6];
+INCCMZ ModulationNode velocityModulators[NUM_SYNTH_VOICES];
 
  //-----------------------------------------------------------------------
 void modNode_init(ModulationNode* vm)
@@ -92,41 +89,32 @@ static void modNode_setOriginalValueChanged(ModulationNode* vm, uint16_t idx)
 void modNode_originalValueChanged(uint16_t idx)
 {
 	uint8_t i;
-	for(i=0;i<6;i++)
+	for(i=0;i<NUM_SYNTH_VOICES;i++)
 	{
 		modNode_setOriginalValueChanged(&velocityModulators[i],idx);
+		modNode_setOriginalValueChanged(&voiceTable[i].lfo->modTarget,idx);
 	}
-
-	modNode_setOriginalValueChanged(&voiceArray[0].lfo.modTarget,idx);
-	modNode_setOriginalValueChanged(&voiceArray[1].lfo.modTarget,idx);
-	modNode_setOriginalValueChanged(&voiceArray[2].lfo.modTarget,idx);
-	modNode_setOriginalValueChanged(&snareVoice.lfo.modTarget,idx);
-	modNode_setOriginalValueChanged(&cymbalVoice.lfo.modTarget,idx);
-	modNode_setOriginalValueChanged(&hatVoice.lfo.modTarget,idx);
 }
 //-----------------------------------------------------------------------
 void modNode_resetTargets()
 {
 	uint8_t i;
-	for(i=0;i<6;i++)
+	for(i=0;i<NUM_SYNTH_VOICES;i++)
 	{
 		paramArray_setParameter(velocityModulators[i].destination,velocityModulators[i].originalValue);
 	}
 
-	paramArray_setParameter(voiceArray[0].lfo.modTarget.destination,voiceArray[0].lfo.modTarget.originalValue);
-	paramArray_setParameter(voiceArray[1].lfo.modTarget.destination,voiceArray[1].lfo.modTarget.originalValue);
-	paramArray_setParameter(voiceArray[2].lfo.modTarget.destination,voiceArray[2].lfo.modTarget.originalValue);
-	paramArray_setParameter(snareVoice.lfo.modTarget.destination,snareVoice.lfo.modTarget.originalValue);
-	paramArray_setParameter(cymbalVoice.lfo.modTarget.destination,cymbalVoice.lfo.modTarget.originalValue);
-	paramArray_setParameter(hatVoice.lfo.modTarget.destination,hatVoice.lfo.modTarget.originalValue);
-
-
+	for(i=0;i<NUM_SYNTH_VOICES;i++)
+	{
+		const ModulationNode* target = &voiceTable[i].lfo->modTarget;
+		paramArray_setParameter(target->destination,target->originalValue);
+	}
 }
 //-----------------------------------------------------------------------
 void modNode_reassignVeloMod()
 {
 	uint8_t i;
-	for(i=0;i<6;i++)
+	for(i=0;i<NUM_SYNTH_VOICES;i++)
 	{
 		modNode_updateValue(&velocityModulators[i], velocityModulators[i].lastVal);
 	}
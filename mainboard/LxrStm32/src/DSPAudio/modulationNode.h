@@ -39,6 +39,7 @@
 
 #include "stm32f4xx.h"
 #include "ParameterArray.h"
+#include "config.h"
 
 typedef struct ModulatorStruct
 {
@@ -52,7 +53,7 @@ typedef struct ModulatorStruct
 } ModulationNode;
 
 //TODO move into corresponding voice
-extern ModulationNode velocityModulators[6];
+extern ModulationNode velocityModulators[NUM_SYNTH_VOICES];
 
 void modNode_init(ModulationNode* vm);
 void modNode_resetTargets();
@@ -0,0 +1,186 @@
+/*
+ * samplePool.c
+ *
+ *  Created on: 18.10.2026
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  Copyright 2013 Julian Schmidt
+ *  Julian@sonic-potions.com
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  This file is part of the Sonic Potions LXR drumsynth firmware.
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  Redistribution and use of the LXR code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *       - The code may not be sold, nor may it be used in a commercial product or activity.
+ *
+ *       - Redistributions that are modified from the original source must include the complete
+ *         source code, including the source code for all components used by a binary built
+ *         from the modified sources. However, as a special exception, the source code distributed
+ *         need not include anything that is normally distributed (in either source or binary form)
+ *         with the major components (compiler, kernel, and so on) of the operating system on which
+ *         the executable runs, unless that component itself accompanies the executable.
+ *
+ *       - Redistributions must reproduce the above copyright notice, this list of conditions and the
+ *         following disclaimer in the documentation and/or other materials provided with the distribution.
+ * ------------------------------------------------------------------------------------------------------------------------
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *   WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *   USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ------------------------------------------------------------------------------------------------------------------------
+ */
+
+#include "samplePool.h"
+#include "BufferTools.h"
+//------------------------------------------------------------------------
+INCCMZ static SamplePoolVoice samplePool_voices[SAMPLE_POOL_SIZE];
+static uint8_t samplePool_numAllowed = SAMPLE_POOL_SIZE;	// slots usable with the current cpu load
+static uint8_t samplePool_numActive = 0;
+static uint8_t samplePool_triggerOffset = 0;	// block position of takeovers, set by the mixer for split blocks
+//------------------------------------------------------------------------
+void samplePool_init()
+{
+	uint8_t i;
+	for(i=0;i<SAMPLE_POOL_SIZE;i++)
+	{
+		samplePool_voices[i].owner = SAMPLE_POOL_FREE;
+	}
+	samplePool_numAllowed = SAMPLE_POOL_SIZE;
+	samplePool_numActive = 0;
+}
+//------------------------------------------------------------------------
+static void samplePool_free(SamplePoolVoice* v)
+{
+	v->owner = SAMPLE_POOL_FREE;
+	samplePool_numActive--;
+}
+//------------------------------------------------------------------------
+// returns the active slot with the lowest current amplitude
+static SamplePoolVoice* samplePool_findQuietest()
+{
+	SamplePoolVoice* quietest = 0;
+	float minAmp = 2.f;
+	uint8_t i;
+	for(i=0;i<SAMPLE_POOL_SIZE;i++)
+	{
+		SamplePoolVoice* v = &samplePool_voices[i];
+		if(v->owner == SAMPLE_POOL_FREE) continue;
+
+		const float amp = v->gain * v->lastEg;
+		if(amp < minAmp)
+		{
+			minAmp = amp;
+			quietest = v;
+		}
+	}
+	return quietest;
+}
+//------------------------------------------------------------------------
+static SamplePoolVoice* samplePool_alloc()
+{
+	if(samplePool_numAllowed == 0) return 0;
+
+	if(samplePool_numActive >= samplePool_numAllowed)
+	{
+		//steal the quietest tail
+		SamplePoolVoice* v = samplePool_findQuietest();
+		if(v) samplePool_free(v);
+	}
+
+	uint8_t i;
+	for(i=0;i<SAMPLE_POOL_SIZE;i++)
+	{
+		if(samplePool_voices[i].owner == SAMPLE_POOL_FREE)
+		{
+			samplePool_numActive++;
+			return &samplePool_voices[i];
+		}
+	}
+	return 0;
+}
+//------------------------------------------------------------------------
+void samplePool_takeOver(const uint8_t voiceNr, const OscInfo* osc, const SlopeEg2* eg, const float egValue, const float gain,
+		const ResonantFilter* filter, const uint8_t filterType, const Distortion* dist)
+{
+	//only sample playback oscs get a tail, synth waveforms are cut as before
+	if(osc->waveform < CRASH) return;
+	if(eg->state == EG_STOPPED || egValue <= 0.f) return;
+
+	SamplePoolVoice* v = samplePool_alloc();
+	if(!v) return;
+
+	v->osc 		= *osc;
+	v->eg 		= *eg;
+	v->gain 	= gain;
+	v->lastEg 	= egValue;
+	v->owner 	= voiceNr;
+	v->offset 	= samplePool_triggerOffset;
+	v->filter 	= *filter;
+	v->filterType = filterType;
+	v->useDistortion = dist != 0;
+	if(dist) v->distortion = *dist;
+}
+//------------------------------------------------------------------------
+void samplePool_setTriggerOffset(const uint8_t offset)
+{
+	samplePool_triggerOffset = offset;
+}
+//------------------------------------------------------------------------
+void samplePool_updateBudget(const uint8_t cpuLoad)
+{
+	if(cpuLoad > SAMPLE_POOL_LOAD_HIGH)
+	{
+		if(samplePool_numAllowed) samplePool_numAllowed--;
+	}
+	else if(cpuLoad < SAMPLE_POOL_LOAD_LOW)
+	{
+		if(samplePool_numAllowed < SAMPLE_POOL_SIZE) samplePool_numAllowed++;
+	}
+
+	//drop tails until we are within the budget again
+	while(samplePool_numActive > samplePool_numAllowed)
+	{
+		SamplePoolVoice* v = samplePool_findQuietest();
+		if(!v) break;
+		samplePool_free(v);
+	}
+}
+//------------------------------------------------------------------------
+void samplePool_addVoiceTails(const uint8_t voiceNr, int16_t* buf, const uint8_t size)
+{
+	if(!samplePool_numActive) return;
+
+	int16_t tailBuf[size];
+	uint8_t i;
+	for(i=0;i<SAMPLE_POOL_SIZE;i++)
+	{
+		SamplePoolVoice* v = &samplePool_voices[i];
+		if(v->owner != voiceNr) continue;
+
+		const float egVal = slopeEg2_calc(&v->eg);
+
+		//a tail taken over in the middle of the block starts at the trigger position
+		const uint8_t offset = v->offset < size ? v->offset : 0;
+		const uint8_t len = size - offset;
+		//same order as the voices: osc, filter, amp eg, distortion
+		calcNextOscSampleBlock(&v->osc,tailBuf,len,v->gain);
+		SVF_calcBlockZDF(&v->filter,v->filterType,tailBuf,len);
+		bufferTool_addGainInterpolated(tailBuf,egVal,v->lastEg,len);
+		if(v->useDistortion)
+		{
+			calcDistBlock(&v->distortion,tailBuf,len);
+		}
+		bufferTool_addBuffersSaturating(&buf[offset],tailBuf,len);
+
+		v->lastEg = egVal;
+		v->offset = 0;
+		if(v->eg.state == EG_STOPPED || egVal <= 0.f)
+		{
+			samplePool_free(v);
+		}
+	}
+}
+//------------------------------------------------------------------------
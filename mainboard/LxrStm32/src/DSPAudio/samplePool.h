@@ -0,0 +1,92 @@
+/*
+ * samplePool.h
+ *
+ *  Created on: 18.10.2026
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  Copyright 2013 Julian Schmidt
+ *  Julian@sonic-potions.com
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  This file is part of the Sonic Potions LXR drumsynth firmware.
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  Redistribution and use of the LXR code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *       - The code may not be sold, nor may it be used in a commercial product or activity.
+ *
+ *       - Redistributions that are modified from the original source must include the complete
+ *         source code, including the source code for all components used by a binary built
+ *         from the modified sources. However, as a special exception, the source code distributed
+ *         need not include anything that is normally distributed (in either source or binary form)
+ *         with the major components (compiler, kernel, and so on) of the operating system on which
+ *         the executable runs, unless that component itself accompanies the executable.
+ *
+ *       - Redistributions must reproduce the above copyright notice, this list of conditions and the
+ *         following disclaimer in the documentation and/or other materials provided with the distribution.
+ * ------------------------------------------------------------------------------------------------------------------------
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *   WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *   USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ------------------------------------------------------------------------------------------------------------------------
+ */
+
+
+#ifndef SAMPLEPOOL_H_
+#define SAMPLEPOOL_H_
+
+#include "stm32f4xx.h"
+#include "config.h"
+#include "Oscillator.h"
+#include "SlopeEg2.h"
+#include "ResonantFilter.h"
+#include "distortion.h"
+//------------------------------------------------------------------------
+// When a voice playing a sample (crash or user sample) is retriggered, its
+// still sounding tail is handed over to a slot from this pool and rings out
+// there, instead of being cut by the phase reset.
+// The tail runs through copies of the voice filter and distortion taken at the
+// retrigger, so it keeps the sound of the note it continues. Filter and drive
+// changes after the retrigger only reach the new note.
+//------------------------------------------------------------------------
+#define SAMPLE_POOL_SIZE		4
+
+// the number of usable slots follows the measured cpu load of the last audio block [%]
+#define SAMPLE_POOL_LOAD_HIGH	85	// above this we give up a slot and steal the quietest tail
+#define SAMPLE_POOL_LOAD_LOW	65	// below this we allow one more slot again
+
+#define SAMPLE_POOL_FREE		0xff
+//------------------------------------------------------------------------
+typedef struct SamplePoolVoiceStruct
+{
+	OscInfo		osc;		// copy of the voice osc at the time of the retrigger
+	SlopeEg2	eg;			// copy of the amp eg, continues the decay
+	ResonantFilter filter;	// copy of the voice filter with its state
+	Distortion	distortion;	// copy of the voice distortion
+	float		gain;		// velocity of the stolen note, times the channel volume for snare, cymbal and hihat
+	float		lastEg;		// eg value of the last block, for gain interpolation
+	uint8_t		owner;		// voice nr the tail is mixed into, SAMPLE_POOL_FREE if unused
+	uint8_t		filterType;
+	uint8_t		useDistortion;
+	uint8_t		offset;		// first sample of the next block the tail is mixed into (tails started by a split block)
+} SamplePoolVoice;
+//------------------------------------------------------------------------
+void samplePool_init();
+
+/** hand the sounding tail of a voice to a free slot. call before the voice osc and eg are retriggered.
+ * dist may be 0 for voices that do not distort their output*/
+void samplePool_takeOver(const uint8_t voiceNr, const OscInfo* osc, const SlopeEg2* eg, const float egValue, const float gain,
+		const ResonantFilter* filter, const uint8_t filterType, const Distortion* dist);
+
+/** sample position in the current block for tails taken over from now on*/
+void samplePool_setTriggerOffset(const uint8_t offset);
+
+/** adapt the number of usable slots to the cpu load of the last block. call once per block*/
+void samplePool_updateBudget(const uint8_t cpuLoad);
+
+/** add all tails owned by voiceNr to the voice output buffer*/
+void samplePool_addVoiceTails(const uint8_t voiceNr, int16_t* buf, const uint8_t size);
+
+#endif /* SAMPLEPOOL_H_ */
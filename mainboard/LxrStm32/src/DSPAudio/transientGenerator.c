@@ -42,7 +42,7 @@ void transient_init(TransientGenerator* transient)
 {
 	transient->pitch 	= 1.f;
 	transient->output 	= 0;
-	transient->phase	= 0;
+	transient->phase	= TRANSIENT_PHASE_END;
 	transient->waveform	= 0;
 	transient->volume	= 1.f;
 };
@@ -61,26 +61,34 @@ void transient_trigger(TransientGenerator* transient)
 	transient->phase	= 0;
 }
 //---------------------------------------------------------------
-void transient_calcBlock(TransientGenerator* transient, int16_t* buf, const uint8_t size)
+uint8_t transient_calcBlock(TransientGenerator* transient, int16_t* buf, const uint8_t size)
 {
-	if(transient->waveform<=1)
+	//snapEg and offset modes and finished transients cost nothing
+	uint32_t phase = transient->phase;
+	if(transient->waveform<=1 || phase>=TRANSIENT_PHASE_END)
 	{
-		memset(buf,0,size*sizeof(int16_t));
-		return; //snapEg and offset
+		return 0;
 	}
 
+	//pitch and volume are floats for the parameter and modulation system, convert them once per block
+	const uint32_t phaseInc	= transient->pitch*(1<<20);
+	const int32_t volume	= transient->volume*256; //Q8
+	const int8_t* table		= transientData[transient->waveform-2];
+
 	uint8_t i;
 	for(i=0;i<size;i++)
 	{
-		uint32_t phase = transient->phase;
-		phase = phase >> 20;
-
-		buf[i] = transient->volume*(transientData[transient->waveform-2][phase]<<8) * (phase < TRANSIENT_SAMPLE_LENGTH);//* transientVolumeTable[phase>>5];
-
-		//if phase is < then table size, we increment it
-		transient->phase += (transient->phase<2311061504u) * (transient->pitch*(1<<20)); //2311061504 => 2204<<20
-
+		if(phase>=TRANSIENT_PHASE_END)
+		{
+			//transient finished within this block
+			memset(&buf[i],0,(size-i)*sizeof(int16_t));
+			break;
+		}
+		buf[i] = __SSAT(table[phase>>20]*volume,16);
+		phase += phaseInc;
 	}
+	transient->phase = phase;
+	return 1;
 }
 //---------------------------------------------------------------
 void transient_calc(TransientGenerator* transient)
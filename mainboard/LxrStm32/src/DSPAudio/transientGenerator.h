@@ -46,6 +46,9 @@
 #include <stdint.h>
 #include "transientTables.h"
 
+// phase (12.20 fixed point) at which the transient sample has been played completely
+#define TRANSIENT_PHASE_END ((uint32_t)TRANSIENT_SAMPLE_LENGTH<<20)
+
 typedef struct TransientGeneratorStruct
 {
 	int16_t 	output;
@@ -64,7 +67,8 @@ void transient_init(TransientGenerator* transient);
 void transient_trigger(TransientGenerator* transient);
 
 void transient_calc(TransientGenerator* transient);
-void transient_calcBlock(TransientGenerator* transient, int16_t* buf, const uint8_t size);
+/** render the transient into buf. returns 0 without touching buf if the transient is silent (finished or not a sample waveform)*/
+uint8_t transient_calcBlock(TransientGenerator* transient, int16_t* buf, const uint8_t size);
 
 void transient_setWaveform(TransientGenerator* transient, const uint8_t waveform);
 #endif /* TRANSIENTGENERATOR_H_ */
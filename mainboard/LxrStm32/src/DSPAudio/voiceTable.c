@@ -0,0 +1,210 @@
+/*
+ * voiceTable.c
+ *
+ *  Created on: 18.10.2026
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  Copyright 2013 Julian Schmidt
+ *  Julian@sonic-potions.com
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  This file is part of the Sonic Potions LXR drumsynth firmware.
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  Redistribution and use of the LXR code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *       - The code may not be sold, nor may it be used in a commercial product or activity.
+ *
+ *       - Redistributions that are modified from the original source must include the complete
+ *         source code, including the source code for all components used by a binary built
+ *         from the modified sources. However, as a special exception, the source code distributed
+ *         need not include anything that is normally distributed (in either source or binary form)
+ *         with the major components (compiler, kernel, and so on) of the operating system on which
+ *         the executable runs, unless that component itself accompanies the executable.
+ *
+ *       - Redistributions must reproduce the above copyright notice, this list of conditions and the
+ *         following disclaimer in the documentation and/or other materials provided with the distribution.
+ * ------------------------------------------------------------------------------------------------------------------------
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *   WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *   USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ------------------------------------------------------------------------------------------------------------------------
+ */
+
+#include "voiceTable.h"
+#include "DrumVoice.h"
+#include "Snare.h"
+#include "CymbalVoice.h"
+#include "HiHat.h"
+//------------------------------------------------------------------------
+// wrappers to give all voices the same call signature
+//------------------------------------------------------------------------
+static void voiceTable_drumTrigger(const uint8_t track, const uint8_t vel, const uint8_t note)
+{
+	Drum_trigger(track, vel, note);
+}
+//------------------------------------------------------------------------
+static void voiceTable_snareTrigger(const uint8_t track, const uint8_t vel, const uint8_t note)
+{
+	UNUSED(track);
+	Snare_trigger(vel, note);
+}
+//------------------------------------------------------------------------
+static void voiceTable_cymbalTrigger(const uint8_t track, const uint8_t vel, const uint8_t note)
+{
+	UNUSED(track);
+	Cymbal_trigger(vel, note);
+}
+//------------------------------------------------------------------------
+static void voiceTable_hatTrigger(const uint8_t track, const uint8_t vel, const uint8_t note)
+{
+	//track 5 = closed, track 6 = open hihat
+	HiHat_trigger(vel, track-5, note);
+}
+//------------------------------------------------------------------------
+static void voiceTable_snareAsync(const uint8_t voiceNr)
+{
+	UNUSED(voiceNr);
+	Snare_calcAsync();
+}
+//------------------------------------------------------------------------
+static void voiceTable_cymbalAsync(const uint8_t voiceNr)
+{
+	UNUSED(voiceNr);
+	Cymbal_calcAsync();
+}
+//------------------------------------------------------------------------
+static void voiceTable_hatAsync(const uint8_t voiceNr)
+{
+	UNUSED(voiceNr);
+	HiHat_calcAsync();
+}
+//------------------------------------------------------------------------
+static void voiceTable_snareSyncBlock(const uint8_t voiceNr, int16_t* buf, const uint8_t size)
+{
+	UNUSED(voiceNr);
+	Snare_calcSyncBlock(buf, size);
+}
+//------------------------------------------------------------------------
+static void voiceTable_cymbalSyncBlock(const uint8_t voiceNr, int16_t* buf, const uint8_t size)
+{
+	UNUSED(voiceNr);
+	Cymbal_calcSyncBlock(buf, size);
+}
+//------------------------------------------------------------------------
+static void voiceTable_hatSyncBlock(const uint8_t voiceNr, int16_t* buf, const uint8_t size)
+{
+	UNUSED(voiceNr);
+	HiHat_calcSyncBlock(buf, size);
+}
+//------------------------------------------------------------------------
+static void voiceTable_snarePan(const uint8_t voiceNr, const uint8_t pan)
+{
+	UNUSED(voiceNr);
+	Snare_setPan(pan);
+}
+//------------------------------------------------------------------------
+static void voiceTable_cymbalPan(const uint8_t voiceNr, const uint8_t pan)
+{
+	UNUSED(voiceNr);
+	Cymbal_setPan(pan);
+}
+//------------------------------------------------------------------------
+static void voiceTable_hatPan(const uint8_t voiceNr, const uint8_t pan)
+{
+	UNUSED(voiceNr);
+	HiHat_setPan(pan);
+}
+//------------------------------------------------------------------------
+#define DRUM_VOICE_DESC(n, initFunc) \
+	{ initFunc, voiceTable_drumTrigger, calcDrumVoiceAsync, calcDrumVoiceSyncBlock, setPan, \
+	  &voiceArray[n].pan, &voiceArray[n].vol, &voiceArray[n].vol, &voiceArray[n].filterType, &voiceArray[n].volumeMod, \
+	  &voiceArray[n].osc, &voiceArray[n].lfo, &voiceArray[n].filter, &voiceArray[n].oscVolEg, \
+	  &voiceArray[n].transGen, &voiceArray[n].distortion }
+
+#define SYNTH_VOICE_DESC(v, prefix, initFunc) \
+	{ initFunc, voiceTable_##prefix##Trigger, voiceTable_##prefix##Async, voiceTable_##prefix##SyncBlock, voiceTable_##prefix##Pan, \
+	  &v.pan, &v.vol, 0, &v.filterType, &v.volumeMod, \
+	  &v.osc, &v.lfo, &v.filter, &v.oscVolEg, \
+	  &v.transGen, &v.distortion }
+
+// initDrumVoice() inits all NUM_VOICES drum voices at once
+const VoiceDesc voiceTable[NUM_SYNTH_VOICES] =
+{
+		DRUM_VOICE_DESC(0, initDrumVoice),
+		DRUM_VOICE_DESC(1, 0),
+		DRUM_VOICE_DESC(2, 0),
+		SYNTH_VOICE_DESC(snareVoice, snare, Snare_init),
+		SYNTH_VOICE_DESC(cymbalVoice, cymbal, Cymbal_init),
+		SYNTH_VOICE_DESC(hatVoice, hat, HiHat_init),
+};
+//------------------------------------------------------------------------
+// sample accurate triggers
+//------------------------------------------------------------------------
+typedef struct PendingTriggerStruct
+{
+	uint8_t offset;		// sample position in the current block, VOICE_TRIGGER_NONE if unused
+	uint8_t track;
+	uint8_t vel;
+	uint8_t note;
+} PendingTrigger;
+
+//no trigger pending before voiceTable_init(), main renders the first block before the voices are set up
+static PendingTrigger voiceTable_pending[NUM_SYNTH_VOICES] = {[0 ... NUM_SYNTH_VOICES-1] = {.offset = VOICE_TRIGGER_NONE}};
+static uint8_t voiceTable_eventOffset = 0;
+//------------------------------------------------------------------------
+void voiceTable_init()
+{
+	uint8_t i;
+	for(i=0;i<NUM_SYNTH_VOICES;i++)
+	{
+		voiceTable_pending[i].offset = VOICE_TRIGGER_NONE;
+		if(voiceTable[i].init)
+		{
+			voiceTable[i].init();
+		}
+	}
+}
+//------------------------------------------------------------------------
+void voiceTable_setEventOffset(const uint8_t offset)
+{
+	voiceTable_eventOffset = offset;
+}
+//------------------------------------------------------------------------
+void voiceTable_trigger(const uint8_t track, const uint8_t vel, const uint8_t note)
+{
+	const uint8_t voiceNr = voiceTable_trackToVoice(track);
+
+	//a voice can only be split once per block, an older pending trigger is played now
+	if(voiceTable_pending[voiceNr].offset != VOICE_TRIGGER_NONE)
+	{
+		voiceTable_firePendingTrigger(voiceNr);
+	}
+
+	if(voiceTable_eventOffset == 0)
+	{
+		voiceTable[voiceNr].trigger(track, vel, note);
+		return;
+	}
+
+	voiceTable_pending[voiceNr].offset 	= voiceTable_eventOffset;
+	voiceTable_pending[voiceNr].track 	= track;
+	voiceTable_pending[voiceNr].vel 	= vel;
+	voiceTable_pending[voiceNr].note 	= note;
+}
+//------------------------------------------------------------------------
+uint8_t voiceTable_getTriggerOffset(const uint8_t voiceNr)
+{
+	return voiceTable_pending[voiceNr].offset;
+}
+//------------------------------------------------------------------------
+void voiceTable_firePendingTrigger(const uint8_t voiceNr)
+{
+	PendingTrigger* t = &voiceTable_pending[voiceNr];
+	if(t->offset == VOICE_TRIGGER_NONE) return;
+	t->offset = VOICE_TRIGGER_NONE;
+	voiceTable[voiceNr].trigger(t->track, t->vel, t->note);
+}
+//------------------------------------------------------------------------
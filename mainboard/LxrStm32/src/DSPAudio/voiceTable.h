@@ -0,0 +1,98 @@
+/*
+ * voiceTable.h
+ *
+ *  Created on: 18.10.2026
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  Copyright 2013 Julian Schmidt
+ *  Julian@sonic-potions.com
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  This file is part of the Sonic Potions LXR drumsynth firmware.
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  Redistribution and use of the LXR code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *       - The code may not be sold, nor may it be used in a commercial product or activity.
+ *
+ *       - Redistributions that are modified from the original source must include the complete
+ *         source code, including the source code for all components used by a binary built
+ *         from the modified sources. However, as a special exception, the source code distributed
+ *         need not include anything that is normally distributed (in either source or binary form)
+ *         with the major components (compiler, kernel, and so on) of the operating system on which
+ *         the executable runs, unless that component itself accompanies the executable.
+ *
+ *       - Redistributions must reproduce the above copyright notice, this list of conditions and the
+ *         following disclaimer in the documentation and/or other materials provided with the distribution.
+ * ------------------------------------------------------------------------------------------------------------------------
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *   WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *   USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ------------------------------------------------------------------------------------------------------------------------
+ */
+
+
+#ifndef VOICETABLE_H_
+#define VOICETABLE_H_
+
+#include "stm32f4xx.h"
+#include "config.h"
+#include "Oscillator.h"
+#include "ResonantFilter.h"
+#include "SlopeEg2.h"
+#include "lfo.h"
+#include "transientGenerator.h"
+#include "distortion.h"
+//------------------------------------------------------------------------
+// describes one synth voice so that mixer, modulation, lfo and parameter code
+// can iterate over all voices instead of addressing each voice struct directly
+typedef struct VoiceDescStruct
+{
+	void (*init)();																	// may be 0 if a previous entry inits this voice too
+	void (*trigger)(const uint8_t track, const uint8_t vel, const uint8_t note);	// track is the sequencer track (0..6)
+	void (*calcAsync)(const uint8_t voiceNr);
+	void (*calcSyncBlock)(const uint8_t voiceNr, int16_t* buf, const uint8_t size);
+	void (*setPan)(const uint8_t voiceNr, const uint8_t pan);
+
+	uint8_t*			pan;
+	float*				vol;
+	float*				mixVol;		// volume applied by the mixer, 0 if the voice applies vol itself before its distortion
+	uint8_t*			filterType;
+	uint8_t*			volumeMod;
+	OscInfo*			osc;
+	Lfo*				lfo;
+	ResonantFilter*		filter;
+	SlopeEg2*			volEg;
+	TransientGenerator*	transGen;
+	Distortion*			distortion;
+} VoiceDesc;
+//------------------------------------------------------------------------
+#define VOICE_TRIGGER_NONE	0xff
+//------------------------------------------------------------------------
+extern const VoiceDesc voiceTable[NUM_SYNTH_VOICES];
+
+/** call the init function of every voice */
+void voiceTable_init();
+
+/** set the sample position in the current block for the following voiceTable_trigger calls.
+ * 0 triggers immediately, otherwise the mixer restarts the voice at that sample while rendering the block*/
+void voiceTable_setEventOffset(const uint8_t offset);
+
+/** trigger the voice of a sequencer track (0..6) at the current event offset*/
+void voiceTable_trigger(const uint8_t track, const uint8_t vel, const uint8_t note);
+
+/** sample position of the pending trigger of a voice, VOICE_TRIGGER_NONE if there is none*/
+uint8_t voiceTable_getTriggerOffset(const uint8_t voiceNr);
+
+/** execute the pending trigger of a voice*/
+void voiceTable_firePendingTrigger(const uint8_t voiceNr);
+
+/** map a sequencer track (0..6) to its voice (0..5). open and closed hihat share the hat voice */
+static inline uint8_t voiceTable_trackToVoice(const uint8_t track)
+{
+	return track < NUM_SYNTH_VOICES ? track : NUM_SYNTH_VOICES-1;
+}
+
+#endif /* VOICETABLE_H_ */
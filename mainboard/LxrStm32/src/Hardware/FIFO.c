@@ -42,13 +42,17 @@ void fifo_init(Fifo* fifo)
 	memset((void*)fifo->data,0,BUFFER_SIZE);
 	fifo->read = 0;
 	fifo->write = 0;
+	fifo->overflowCnt = 0;
 }
 //-------------------------------------------------------------------------
 uint8_t fifo_bufferIn(Fifo* fifo, uint8_t byte)
 {
   uint8_t next = ((fifo->write + 1) & BUFFER_MASK);
   if (fifo->read == next)
+  {
+    fifo->overflowCnt++;
     return 0;
+  }
   fifo->data[fifo->write] = byte;
   fifo->write = next;
   return 1;
@@ -73,13 +77,17 @@ void fifoBig_init(FifoBig* fifo)
 	memset((void*)fifo->data,0,BUFFER_SIZE_BIG);
 	fifo->read = 0;
 	fifo->write = 0;
+	fifo->overflowCnt = 0;
 }
 //-------------------------------------------------------------------------
 uint8_t fifoBig_bufferIn(FifoBig* fifo, uint8_t byte)
 {
   uint8_t next = ((fifo->write + 1) & BUFFER_MASK_BIG);
   if (fifo->read == next)
+  {
+    fifo->overflowCnt++;
     return 0;
+  }
   fifo->data[fifo->write] = byte;
   fifo->write = next;
   return 1;
@@ -46,6 +46,7 @@ typedef struct FifoStruct
 	  volatile uint8_t data[BUFFER_SIZE];
 	  volatile uint8_t read; // zeigt auf das Feld mit dem ltesten Inhalt
 	  volatile uint8_t write; // zeigt immer auf leeres Feld
+	  volatile uint16_t overflowCnt; // bytes dropped because the fifo was full
 }Fifo;
 
 
@@ -59,7 +60,7 @@ void fifo_clear(Fifo* fifo);
 
 
 //--
-#define BUFFER_SIZE_BIG 64 // muss 2^n betragen (8, 16, 32, 64 ...)
+#define BUFFER_SIZE_BIG 256 // muss 2^n betragen (8, 16, 32, 64 ...), max 256 (8 bit index)
 #define BUFFER_MASK_BIG (BUFFER_SIZE_BIG-1) // Klammern auf keinen Fall vergessen
 
 typedef struct FifoStructBig
@@ -67,6 +68,7 @@ typedef struct FifoStructBig
 	volatile  uint8_t data[BUFFER_SIZE_BIG];
 	volatile uint8_t read; // zeigt auf das Feld mit dem ltesten Inhalt
 	volatile uint8_t write; // zeigt immer auf leeres Feld
+	volatile uint16_t overflowCnt; // bytes dropped because the fifo was full
 }FifoBig;
 
 
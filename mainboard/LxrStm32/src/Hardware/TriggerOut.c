@@ -373,8 +373,8 @@ void trigger_tickPhaseCounter()
 		{
 			trigger_phaseWrapCounter++;
 			// trigger a step
-			// -> set time to next step to immediately (trigger next step)
-			seq_setDeltaT(-1);
+			// -> trigger next step immediately
+			seq_forceNextStep();
 		}
 	}
 }
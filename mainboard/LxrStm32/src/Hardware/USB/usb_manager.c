@@ -32,6 +32,7 @@
 
 
 #include "usb_manager.h"
+#include "seqClock.h"
 #include <string.h>
 
 enum {
@@ -40,6 +41,12 @@ enum {
 };
 
 USB_OTG_CORE_HANDLE           USB_OTG_dev;
+
+#ifdef USE_USB_OTG_HS
+#define USB_IRQ OTG_HS_IRQn
+#else
+#define USB_IRQ OTG_FS_IRQn
+#endif
 //-------------------------------------------------------------------------------
 void usb_init()
 {
@@ -89,61 +96,103 @@ void usb_start()
 	            &MIDI_cb,
 	            &USR_cb);
 }
-//-------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
 /*
- * writes a byte to the Usb Tx buffer
- * Will be send out by the usb_flushMidi() call
+ * start sending queued midi events if the endpoint is idle.
+ * the DataIn callback chains the following packets, this only catches events
+ * queued while the device was not configured
  */
-void usb_sendByte(uint8_t byte)
+void usb_flushMidi()
 {
-	*usb_MidiInWrPtr++ = byte;
-	if(usb_MidiInWrPtr >= (usb_MidiInBuff+(TOTAL_MIDI_BUF_SIZE * NUM_SUB_BUFFERS)))
+	NVIC_DisableIRQ(USB_IRQ);
+	usb_midiInKick(&USB_OTG_dev);
+	NVIC_EnableIRQ(USB_IRQ);
+}
+//------------------------------------------------------------------------------
+void usb_sendMidi(MidiMsg msg)
+{
+	if(msg.status >= 0xf8)
 	{
-		usb_MidiInWrPtr = usb_MidiInBuff;
+		usb_sendMidiRealtime(msg.status);
+		return;
 	}
+
+	//USB MIDI msg has to be ALWAYS 4 bytes long
+	//even if it is just a single clock byte
+	uint8_t event[USB_MIDI_IN_EVENT_SIZE];
+
+	//MIDI byte[0] = 4 bits cable number + 4 bits event type code
+	event[0] = msg.status>>4;
+	//then the 3 midi message bytes
+	event[1] = msg.status;
+	event[2] = msg.data1;
+	event[3] = msg.data2;
+
+	NVIC_DisableIRQ(USB_IRQ);
+	usb_midiInQueue(event);
+	usb_midiInKick(&USB_OTG_dev);
+	NVIC_EnableIRQ(USB_IRQ);
 }
 //------------------------------------------------------------------------------
-/*
- * flush FIFO and send out next block of messages stored in the usb_MidiInBuff
- * called periodically by usb_tick()
- * TODO:  maybe there is a better way to call this automatically by the USB driver when it is ready to TX some more data?
- */
-void usb_flushMidi()
+void usb_sendMidiRealtime(uint8_t status)
 {
-	const uint8_t len = usb_MidiInWrPtr - usb_MidiInRdPtr;
-	if((len != 0) && (USB_OTG_dev.dev.device_status != USB_OTG_SUSPENDED))
-	{
-		DCD_EP_Flush (&USB_OTG_dev,MIDI_IN_EP);
-		DCD_EP_Tx (&USB_OTG_dev, MIDI_IN_EP, usb_MidiInRdPtr, len);
+	//the sequencer clock interrupt is the other writer
+	NVIC_DisableIRQ(SEQ_CLOCK_IRQ);
+	NVIC_DisableIRQ(USB_IRQ);
+	usb_midiInQueueRealtime(status);
+	NVIC_EnableIRQ(USB_IRQ);
+	NVIC_EnableIRQ(SEQ_CLOCK_IRQ);
+
+	//the usb interrupt starts the transfer (see OTG_FS_IRQHandler)
+	NVIC_SetPendingIRQ(USB_IRQ);
+}
+//------------------------------------------------------------------------------
+uint16_t usb_sendSysex(const uint8_t* data, const uint16_t len)
+{
+	uint16_t pos = 0;
 
-		usb_MidiInRdPtr += TOTAL_MIDI_BUF_SIZE;
-		if(usb_MidiInRdPtr >= (usb_MidiInBuff+(TOTAL_MIDI_BUF_SIZE * NUM_SUB_BUFFERS)))
-		{
-			usb_MidiInRdPtr = usb_MidiInBuff;
+	NVIC_DisableIRQ(USB_IRQ);
+	while(pos < len && usb_midiInFree())
+	{
+		//3 bytes per event, the event holding the closing F7 tells how many bytes are valid
+		uint8_t event[USB_MIDI_IN_EVENT_SIZE] = {CIN_SYSEX_START, 0, 0, 0};
+		const uint8_t n = (len-pos) < 3 ? (len-pos) : 3;
+		memcpy(&event[1], &data[pos], n);
+		if(data[pos+n-1] == SYSEX_END) {
+			event[0] = CIN_SYSEX_END_1 + n - 1;
 		}
-		usb_MidiInWrPtr=usb_MidiInRdPtr;
+		usb_midiInQueue(event);
+		pos += n;
 	}
+	usb_midiInKick(&USB_OTG_dev);
+	NVIC_EnableIRQ(USB_IRQ);
+
+	return pos;
 }
 //------------------------------------------------------------------------------
-void usb_sendMidi(MidiMsg msg)
+uint8_t usb_getSysex(uint8_t* data)
 {
-	//MIDI byte[0] = 4 bits cable number + 4 bits event type code
-	usb_sendByte(msg.status>>4);
-
-	//then the 3 midi message bytes
-	//USB MIDI msg has to be ALWAYS 4 bytes long
-	//even if it is just a single clock byte
-	usb_sendByte(msg.status);
-	usb_sendByte(msg.data1);
-	usb_sendByte(msg.data2);
+	if(usb_sysexRxRead != usb_sysexRxWrite)
+	{
+		*data = usb_sysexRx[usb_sysexRxRead];
+		usb_sysexRxRead = (usb_sysexRxRead+1) & USB_SYSEX_RX_MASK;
+		return 1;
+	}
+	return 0;
+}
+//------------------------------------------------------------------------------
+uint16_t usb_getMidiInOverflowCnt()
+{
+	return usb_midiInOverflowCnt;
 }
 //-------------------------------------------------------------------------------
-uint8_t usb_getMidi(MidiMsg* msg)
+uint8_t usb_getMidi(MidiMsg* msg, uint32_t* arrival)
 {
 	if(usb_MidiMessagesRead != usb_MidiMessagesWrite)
 	{
 		//we have unprocessed messages in the queue
 		*msg = usb_MidiMessages[usb_MidiMessagesRead];
+		*arrival = usb_MidiArrival[usb_MidiMessagesRead];
 
 		usb_MidiMessagesRead++;
 		usb_MidiMessagesRead &= USB_MIDI_INPUT_BUFFER_MASK;
@@ -46,8 +46,20 @@ void usb_init();
 void usb_stop();
 void usb_start();
 void usb_tick();
+/** queue a message for the host. the usb interrupt sends it as soon as the endpoint is free*/
 void usb_sendMidi(MidiMsg msg);
-uint8_t usb_getMidi(MidiMsg* msg);
+/** fetch the next received message and the playback position its packet arrived at*/
+uint8_t usb_getMidi(MidiMsg* msg, uint32_t* arrival);
+/** send a realtime message in the next usb packet, ahead of the queued messages.
+ * may be called from the sequencer clock interrupt*/
+void usb_sendMidiRealtime(uint8_t status);
+/** queue a sysex frame or the next part of it. frames have to be passed in order and split
+ * at multiples of 3 bytes. returns the number of bytes that fit into the usb buffer*/
+uint16_t usb_sendSysex(const uint8_t* data, const uint16_t len);
+/** fetch the next received sysex byte (F0 to F7). returns 0 if there is none*/
+uint8_t usb_getSysex(uint8_t* data);
 void usb_flushMidi();
+/** number of messages dropped because the host did not fetch them fast enough*/
+uint16_t usb_getMidiInOverflowCnt();
 
 #endif /* USB_MANAGER_H_ */
@@ -31,6 +31,7 @@
  */
 #include "usb_midi_core.h"
 #include "MidiParser.h"
+#include "cs4344_cs5343.h"
 
 #define UNUSED(x) (void)(x)
 
@@ -38,6 +39,7 @@
 
 //buffer for parsed midi messages
 MidiMsg usb_MidiMessages[USB_MIDI_INPUT_BUFFER_SIZE];
+uint32_t usb_MidiArrival[USB_MIDI_INPUT_BUFFER_SIZE];
 uint8_t usb_MidiMessagesRead = 0;
 uint8_t usb_MidiMessagesWrite = 0;
 
@@ -63,9 +65,27 @@ uint8_t  usb_MidiOutBuff [TOTAL_MIDI_BUF_SIZE * NUM_SUB_BUFFERS];
 uint8_t* usb_MidiOutWrPtr = usb_MidiOutBuff;
 uint8_t* usb_MidiOutRdPtr = usb_MidiOutBuff;
 
-uint8_t  usb_MidiInBuff [TOTAL_MIDI_BUF_SIZE * NUM_SUB_BUFFERS];
-uint8_t* usb_MidiInWrPtr = usb_MidiInBuff;
-uint8_t* usb_MidiInRdPtr = usb_MidiInBuff;
+//the packet at usb_midiInRead is on the bus while usb_midiInBusy is set,
+//events are appended to the packet at usb_midiInWrite
+static uint8_t  usb_midiInPackets[USB_MIDI_IN_PACKETS][MIDI_PACKET_SIZE];
+static uint8_t  usb_midiInFill[USB_MIDI_IN_PACKETS];
+static volatile uint8_t usb_midiInRead = 0;
+static volatile uint8_t usb_midiInWrite = 0;
+static volatile uint8_t usb_midiInBusy = 0;
+uint16_t usb_midiInOverflowCnt = 0;
+
+//realtime messages bypass the packet ring, they go out in a packet of their own
+//before the next queued packet
+#define USB_MIDI_IN_BUSY_RING		1
+#define USB_MIDI_IN_BUSY_REALTIME	2
+static uint8_t  usb_midiRealtime[USB_MIDI_RT_SIZE];
+static volatile uint8_t usb_midiRealtimeRead = 0;
+static volatile uint8_t usb_midiRealtimeWrite = 0;
+static uint8_t  usb_midiRealtimePacket[USB_MIDI_RT_SIZE*USB_MIDI_IN_EVENT_SIZE];
+
+uint8_t usb_sysexRx[USB_SYSEX_RX_SIZE];
+volatile uint16_t usb_sysexRxRead = 0;
+volatile uint16_t usb_sysexRxWrite = 0;
 
 static uint8_t usbd_midi_CfgDesc[AUDIO_CONFIG_DESC_SIZE];
 //------------------------------------------------------------------------------------------------
@@ -242,6 +262,12 @@ static uint8_t  usbd_midi_Init (void  *pdev,
   		  	  MIDI_PACKET_SIZE,
   		  	  USB_OTG_EP_BULK);
 
+  //drop what was queued for a previous connection
+  usb_midiInRead = usb_midiInWrite = 0;
+  usb_midiInFill[0] = 0;
+  usb_midiInBusy = 0;
+  usb_midiRealtimeRead = usb_midiRealtimeWrite;
+
   /* Prepare Out endpoint to receive midi data */
   DCD_EP_PrepareRx(pdev,
 		  	  	   MIDI_OUT_EP,
@@ -314,10 +340,118 @@ static uint8_t  usbd_midi_EP0_RxReady (void  *pdev)
   */
 static uint8_t  usbd_midi_DataIn (void *pdev, uint8_t epnum)
 {
-	UNUSED(epnum);
-	UNUSED(pdev);
+	if((epnum & 0x7f) == (MIDI_IN_EP & 0x7f))
+	{
+		//release the sent packet and chain the next one
+		if(usb_midiInBusy == USB_MIDI_IN_BUSY_RING)
+		{
+			usb_midiInFill[usb_midiInRead] = 0;
+			usb_midiInRead = (usb_midiInRead+1) & (USB_MIDI_IN_PACKETS-1);
+		}
+		usb_midiInBusy = 0;
+		usb_midiInKick(pdev);
+	}
 	return USBD_OK;
 }
+//------------------------------------------------------------------------------------------------
+uint8_t usb_midiInQueue(const uint8_t* event)
+{
+	uint8_t wr = usb_midiInWrite;
+	if(usb_midiInFill[wr] >= MIDI_PACKET_SIZE)
+	{
+		//packet full, continue with the next one unless it is still waiting to be sent
+		const uint8_t next = (wr+1) & (USB_MIDI_IN_PACKETS-1);
+		if(next == usb_midiInRead)
+		{
+			usb_midiInOverflowCnt++;
+			return 0;
+		}
+		usb_midiInFill[next] = 0;
+		usb_midiInWrite = wr = next;
+	}
+
+	uint8_t* dst = &usb_midiInPackets[wr][usb_midiInFill[wr]];
+	dst[0] = event[0];
+	dst[1] = event[1];
+	dst[2] = event[2];
+	dst[3] = event[3];
+	usb_midiInFill[wr] += USB_MIDI_IN_EVENT_SIZE;
+	return 1;
+}
+//------------------------------------------------------------------------------------------------
+uint8_t usb_midiInQueueRealtime(const uint8_t status)
+{
+	const uint8_t next = (usb_midiRealtimeWrite+1) & (USB_MIDI_RT_SIZE-1);
+	if(next == usb_midiRealtimeRead)
+	{
+		usb_midiInOverflowCnt++;
+		return 0;
+	}
+	usb_midiRealtime[usb_midiRealtimeWrite] = status;
+	usb_midiRealtimeWrite = next;
+	return 1;
+}
+//------------------------------------------------------------------------------------------------
+uint16_t usb_midiInFree()
+{
+	//space left in the packet being filled plus the packets up to the one being sent
+	const uint8_t wr = usb_midiInWrite;
+	const uint8_t freePackets = (usb_midiInRead - wr - 1) & (USB_MIDI_IN_PACKETS-1);
+	return (MIDI_PACKET_SIZE - usb_midiInFill[wr])/USB_MIDI_IN_EVENT_SIZE
+			+ freePackets * (MIDI_PACKET_SIZE/USB_MIDI_IN_EVENT_SIZE);
+}
+//------------------------------------------------------------------------------------------------
+static void usb_queueSysex(const MidiDataUsb* usbData, const uint8_t length)
+{
+	const uint8_t* bytes = &usbData->status;
+	uint8_t i;
+	for(i=0;i<length;i++)
+	{
+		const uint16_t next = (usb_sysexRxWrite+1) & USB_SYSEX_RX_MASK;
+		if(next == usb_sysexRxRead) return; //full, the frame checksum catches the loss
+		usb_sysexRx[usb_sysexRxWrite] = bytes[i];
+		usb_sysexRxWrite = next;
+	}
+}
+//------------------------------------------------------------------------------------------------
+void usb_midiInKick(void* pdev)
+{
+	if(usb_midiInBusy) return;
+	if(((USB_OTG_CORE_HANDLE*)pdev)->dev.device_status != USB_OTG_CONFIGURED)
+	{
+		//clocks are worthless later on
+		usb_midiRealtimeRead = usb_midiRealtimeWrite;
+		return;
+	}
+
+	if(usb_midiRealtimeRead != usb_midiRealtimeWrite)
+	{
+		uint8_t len = 0;
+		while(usb_midiRealtimeRead != usb_midiRealtimeWrite)
+		{
+			const uint8_t status = usb_midiRealtime[usb_midiRealtimeRead];
+			usb_midiRealtimePacket[len++] = status>>4;
+			usb_midiRealtimePacket[len++] = status;
+			usb_midiRealtimePacket[len++] = 0;
+			usb_midiRealtimePacket[len++] = 0;
+			usb_midiRealtimeRead = (usb_midiRealtimeRead+1) & (USB_MIDI_RT_SIZE-1);
+		}
+		usb_midiInBusy = USB_MIDI_IN_BUSY_REALTIME;
+		DCD_EP_Tx(pdev, MIDI_IN_EP, usb_midiRealtimePacket, len);
+		return;
+	}
+
+	if(usb_midiInRead == usb_midiInWrite)
+	{
+		//nothing closed yet, send the packet that is being filled right away
+		if(usb_midiInFill[usb_midiInWrite] == 0) return;
+		usb_midiInWrite = (usb_midiInWrite+1) & (USB_MIDI_IN_PACKETS-1);
+		usb_midiInFill[usb_midiInWrite] = 0;
+	}
+
+	usb_midiInBusy = USB_MIDI_IN_BUSY_RING;
+	DCD_EP_Tx(pdev, MIDI_IN_EP, usb_midiInPackets[usb_midiInRead], usb_midiInFill[usb_midiInRead]);
+}
 #endif
 //------------------------------------------------------------------------------------------------
 /**
@@ -352,6 +486,8 @@ static uint8_t  usbd_midi_DataOut (void *pdev, uint8_t epnum)
 
     //process buffer
     int i;
+    //all messages of a packet arrived together
+    const uint32_t arrival = codec_getPlaybackPos();
 
 
     MidiDataUsb usbData;
@@ -367,6 +503,7 @@ static uint8_t  usbd_midi_DataOut (void *pdev, uint8_t epnum)
 		usb_MidiOutRdPtr[i] = 0;
 
     	uint8_t length=0;
+    	uint8_t isSysex=0;
 
     	//TODO midi parsing can be improved
     	// we only have cable 0
@@ -392,21 +529,25 @@ static uint8_t  usbd_midi_DataOut (void *pdev, uint8_t epnum)
 				case CIN_SYSEX_START:
 					// SYSEX
 					length = 3;
+					isSysex = 1;
 					break;
 
 				case CIN_SYSEX_END_1:
-					// SYSEX end
+					// SYSEX end or single byte system common
 					length = 1;
+					isSysex = (usbData.status == SYSEX_END);
 					break;
 
 				case CIN_SYSEX_END_2:
 					// SYSEX end
 					length = 2;
+					isSysex = 1;
 					break;
 
 				case CIN_SYSEX_END_3:
 					// SYSEX end
 					length = 3;
+					isSysex = 1;
 					break;
 
 				case CIN_SINGLE_BYTE:
@@ -426,7 +567,11 @@ static uint8_t  usbd_midi_DataOut (void *pdev, uint8_t epnum)
 			//JS: I think it's not guaranteed
 			//But I suppose there are no messages on other cables to be expected
 		}
-    	if(length != 0)
+    	if(isSysex)
+    	{
+    		usb_queueSysex(&usbData, length);
+    	}
+    	else if(length != 0)
     	{
     		usb_MidiMessages[usb_MidiMessagesWrite].status	= usbData.status;
     		usb_MidiMessages[usb_MidiMessagesWrite].data1 	= usbData.data1;
@@ -437,6 +582,7 @@ static uint8_t  usbd_midi_DataOut (void *pdev, uint8_t epnum)
     		// is it possible for there to be more than one sysex message byte received?
     		usb_MidiMessages[usb_MidiMessagesWrite].bits.sysxbyte = 0;
     		usb_MidiMessages[usb_MidiMessagesWrite].bits.source = midiSourceUSB;
+    		usb_MidiArrival[usb_MidiMessagesWrite] = arrival;
 
     		//increment and wrap write pointer
     		usb_MidiMessagesWrite++;
@@ -59,13 +59,39 @@ extern uint8_t  usb_MidiOutBuff [TOTAL_MIDI_BUF_SIZE * 2];
 extern uint8_t* usb_MidiOutWrPtr;
 extern uint8_t* usb_MidiOutRdPtr;
 */
-extern uint8_t  usb_MidiInBuff [TOTAL_MIDI_BUF_SIZE * NUM_SUB_BUFFERS];
-extern uint8_t* usb_MidiInWrPtr;
-extern uint8_t* usb_MidiInRdPtr;
+
+//ring of packets for the MIDI IN endpoint (device to host)
+#define USB_MIDI_IN_PACKETS		8		/**< number of 64 byte packets in the ring, power of 2*/
+#define USB_MIDI_IN_EVENT_SIZE	4		/**< every usb midi event has 4 bytes*/
+#define USB_MIDI_RT_SIZE		16		/**< realtime messages waiting for the next packet, power of 2*/
+
+/** append one 4 byte usb midi event. returns 0 and counts an overflow if the ring is full.
+ * call with the usb interrupt disabled*/
+uint8_t usb_midiInQueue(const uint8_t* event);
+/** queue a realtime message, it is sent in a packet of its own before the queued packets.
+ * call with the usb interrupt and the sequencer clock interrupt disabled*/
+uint8_t usb_midiInQueueRealtime(const uint8_t status);
+/** start the transfer of the next packet if the endpoint is idle.
+ * called from the DataIn callback and with the usb interrupt disabled*/
+void usb_midiInKick(void* pdev);
+/** number of events that still fit into the ring. call with the usb interrupt disabled*/
+uint16_t usb_midiInFree();
+/** number of events dropped because the ring was full*/
+extern uint16_t usb_midiInOverflowCnt;
+
+//sysex bytes received from the host are kept apart from the parsed messages
+//so a whole dump frame fits without flooding the message buffer
+#define USB_SYSEX_RX_SIZE		4096	/**< power of 2, larger than the biggest sysex frame*/
+#define USB_SYSEX_RX_MASK		(USB_SYSEX_RX_SIZE-1)
+
+extern uint8_t usb_sysexRx[USB_SYSEX_RX_SIZE];
+extern volatile uint16_t usb_sysexRxRead;
+extern volatile uint16_t usb_sysexRxWrite;
 
 
 //buffer for parsed midi messages
 extern MidiMsg usb_MidiMessages[USB_MIDI_INPUT_BUFFER_SIZE];
+extern uint32_t usb_MidiArrival[USB_MIDI_INPUT_BUFFER_SIZE];	/**< playback position each message was received at*/
 extern uint8_t usb_MidiMessagesRead;
 extern uint8_t usb_MidiMessagesWrite;
 
@@ -42,6 +42,7 @@ DMA_InitTypeDef DMA_InitStructure2;
 
 uint8_t dmaPtr=0;
 uint8_t dmaPtr2=0;
+static volatile uint32_t codec_playedBlocks = 0;	// number of completed DAC1 dma blocks, the audio sample clock
 //################################ DAC 1 ############################################################
 void DMA1_Stream7_IRQHandler(void)
 {
@@ -52,6 +53,7 @@ void DMA1_Stream7_IRQHandler(void)
   {
 
 	  dmaPtr++;
+	  codec_playedBlocks++;
 
 	  /* Wait the DMA Stream to be effectively disabled */
 	   while (DMA_GetCmdStatus(DMA1_Stream7) != DISABLE)
@@ -98,6 +100,26 @@ void DMA1_Stream7_IRQHandler(void)
 #endif //error flags
 }
 //----------------------------------------------------------------------------------
+uint32_t codec_getPlaybackPos()
+{
+	uint32_t blocks, remaining;
+	//the dma irq may complete a block between both reads
+	do
+	{
+		blocks 		= codec_playedBlocks;
+		remaining 	= DMA_GetCurrDataCounter(AUDIO_I2S_DMA_STREAM);
+	} while(blocks != codec_playedBlocks);
+
+	//remaining counts 16 bit words, 2 per stereo sample
+	return blocks*OUTPUT_DMA_SIZE + OUTPUT_DMA_SIZE - remaining/2;
+}
+//----------------------------------------------------------------------------------
+uint32_t codec_getRenderPos()
+{
+	//the block calculated now is played after the one the dma is currently sending
+	return (codec_playedBlocks+1)*OUTPUT_DMA_SIZE;
+}
+//----------------------------------------------------------------------------------
 void codec_initDma_DAC()
 {
 		NVIC_InitTypeDef NVIC_InitStructure;
@@ -166,4 +166,10 @@ extern volatile int16_t dma_buffer2[OUTPUT_DMA_SIZE*4]; 	// *4 because we need 1
 
 void codec_initCsCodec(uint32_t Addr1, uint32_t Size1,uint32_t Addr2, uint32_t Size2);
 
+/** index of the stereo sample DAC1 is currently sending. counts up continuously at the sample rate*/
+uint32_t codec_getPlaybackPos();
+
+/** sample index of the first sample of the block that is calculated next*/
+uint32_t codec_getRenderPos();
+
 #endif /* CS4344_CS5343_H_ */
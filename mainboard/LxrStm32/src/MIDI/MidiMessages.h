@@ -91,6 +91,7 @@ typedef struct MidiStruct {
 #define MIDI_CONTINUE		0xFB
 #define MIDI_MTC_QFRAME		0xF1	//--AS mtc timecodes
 #define MIDI_SONG_SEL		0xF3	//--AS passthru only
+#define MIDI_SONG_POS		0xF2	// passthru only
 
 //------------------------------------------------------------
 
@@ -482,6 +483,9 @@ enum
 #define FRONT_SEQ_TRIGGER_OUT1_PPQ 		0x37
 #define FRONT_SEQ_TRIGGER_OUT2_PPQ 		0x38
 #define FRONT_SEQ_TRIGGER_GATE_MODE 	0x39
+#define FRONT_SEQ_CPU_LEVEL				0x3a	// quality level of the load governor, 0 = full quality
+#define FRONT_SEQ_GROOVE				0x3c	// shuffle groove template, 0 = built in, others from SD
+#define FRONT_SEQ_POOL_FULL				0x3d	// pattern memory full, PATTERN_FULL_STEPS/PATTERN_FULL_LOCKS bits, 0 = ok
 
 //codec control messages
 #define EQ_ON_OFF						0x01
@@ -506,5 +510,7 @@ enum
 #define SYSEX_RECEIVE_MAIN_STEP_DATA	0x04
 #define SYSEX_REQUEST_PATTERN_DATA		0x05
 #define SYSEX_RECEIVE_PAT_LEN_DATA		0x06
+#define SYSEX_REQUEST_LOCK_DATA			0x07
+#define SYSEX_RECEIVE_LOCK_DATA			0x08
 #define SYSEX_ACTIVE_MODE_NONE			0x7f	/**< a placeholder message indicating that sysex is active but no mode is selected yet*/
 #endif /* MIDIMESSAGES_H_ */
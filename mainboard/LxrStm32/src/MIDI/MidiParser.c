@@ -49,6 +49,7 @@
 #include "modulationNode.h"
 #include "frontPanelParser.h"
 #include "usb_manager.h"
+#include "ParameterArray.h"
 
 static uint16_t midiParser_activeNrpnNumber = 0;
 
@@ -57,6 +58,7 @@ uint8_t midiParser_originalCcValues[0xff];
 // this will be set to some value if we are ignoring all mtc messages until the next 0 message
 static uint8_t midiParser_mtcIgnore=1;
 static uint32_t volatile midiParser_lastMtcReceived=0x0;
+static uint32_t midiParser_arrivalTime = 0;		// playback position the parsed data was received at
 static uint8_t midiParser_mtcIsRunning=0;
 
 static union {
@@ -106,12 +108,6 @@ inline uint16_t calcSlopeEgTime(uint8_t data2)
 	return data2>0?val*val*data2*128:1;
 }
 #endif
-//-----------------------------------------------------------
-static inline float calcPitchModAmount(uint8_t data2)
-{
-	const float val = data2/127.f;
-	return val*val*PITCH_AMOUNT_FACTOR;
-}
 
 //-----------------------------------------------------------
 // vars
@@ -155,7 +151,8 @@ static void midiParser_nrpnHandler(uint16_t value)
 	midiParser_ccHandler(msg2,true);
 }
 //-----------------------------------------------------------
-/** handle all incoming CCs and invoke action*/
+/** handle all incoming CCs and invoke action.
+ * the sound parameters are queued and applied once per audio block through the dispatch table in ParameterArray.c*/
 void midiParser_ccHandler(MidiMsg msg, uint8_t updateOriginalValue)
 {
 	if(msg.status == MIDI_CC)
@@ -175,12 +172,7 @@ void midiParser_ccHandler(MidiMsg msg, uint8_t updateOriginalValue)
 
 		case CC_BANK_CHANGE:
 			// bank change (coarse) selects kit (sound)
-			/*
-			 * already send in parseMidiMessage()
-			uart_sendFrontpanelByte(MIDI_CC);
-			uart_sendFrontpanelByte(CC_BANK_CHANGE);
-			uart_sendFrontpanelByte(msg.data2);
-			*/
+			// already send in parseMidiMessage()
 			break;
 
 		case NRPN_DATA_ENTRY_COARSE:
@@ -198,900 +190,39 @@ void midiParser_ccHandler(MidiMsg msg, uint8_t updateOriginalValue)
 			midiParser_activeNrpnNumber |= (msg.data2<<7);
 			break;
 
-		case VOL_SLOPE1:
-			slopeEg2_setSlope(&voiceArray[0].oscVolEg,msg.data2);
-
-			break;
-		case PITCH_SLOPE1:
-			DecayEg_setSlope(&voiceArray[0].oscPitchEg,msg.data2);
-			break;
-
-		case VOL_SLOPE2:
-			slopeEg2_setSlope(&voiceArray[1].oscVolEg,msg.data2);
-			break;
-		case PITCH_SLOPE2:
-			DecayEg_setSlope(&voiceArray[1].oscPitchEg,msg.data2);
-			break;
-
-		case VOL_SLOPE3:
-			slopeEg2_setSlope(&voiceArray[2].oscVolEg,msg.data2);
-			break;
-		case PITCH_SLOPE3:
-			DecayEg_setSlope(&voiceArray[2].oscPitchEg,msg.data2);
-			break;
-
-		case PITCH_SLOPE4:
-			DecayEg_setSlope(&snareVoice.oscPitchEg,msg.data2);
-			break;
-		case VOL_SLOPE6:
-			slopeEg2_setSlope(&hatVoice.oscVolEg,msg.data2);
-			break;
-
-		case FILTER_FREQ_DRUM1:
-		case FILTER_FREQ_DRUM2:
-		case FILTER_FREQ_DRUM3:
-		{
-			const float f = msg.data2/127.f;
-			//exponential full range freq
-			SVF_directSetFilterValue(&voiceArray[msg.data1-FILTER_FREQ_DRUM1].filter,valueShaperF2F(f,FILTER_SHAPER) );
-		}
-			break;
-		case RESO_DRUM1:
-		case RESO_DRUM2:
-		case RESO_DRUM3:
-			SVF_setReso(&voiceArray[msg.data1-RESO_DRUM1].filter, msg.data2/127.f);
-			break;
-
-		case F_OSC1_COARSE:
-		{
-			//clear upper nibble
-			voiceArray[0].osc.midiFreq &= 0x00ff;
-			//set upper nibble
-			voiceArray[0].osc.midiFreq |= msg.data2 << 8;
-			osc_recalcFreq(&voiceArray[0].osc);
-		}
-			break;
-		case F_OSC2_COARSE:
-		{
-			//clear upper nibble
-			voiceArray[1].osc.midiFreq &= 0x00ff;
-			//set upper nibble
-			voiceArray[1].osc.midiFreq |= msg.data2 << 8;
-			osc_recalcFreq(&voiceArray[1].osc);
-		}
-				break;
-		case F_OSC3_COARSE:
-		{
-			//clear upper nibble
-			voiceArray[2].osc.midiFreq &= 0x00ff;
-			//set upper nibble
-			voiceArray[2].osc.midiFreq |= msg.data2 << 8;
-			osc_recalcFreq(&voiceArray[2].osc);
-		}
-				break;
-		case F_OSC4_COARSE:
-		{
-			//clear upper nibble
-			snareVoice.osc.midiFreq &= 0x00ff;
-			//set upper nibble
-			snareVoice.osc.midiFreq |= msg.data2 << 8;
-			osc_recalcFreq(&snareVoice.osc);
-		}
-				break;
-		case F_OSC5_COARSE:
-		{
-			//clear upper nibble
-			cymbalVoice.osc.midiFreq &= 0x00ff;
-			//set upper nibble
-			cymbalVoice.osc.midiFreq |= msg.data2 << 8;
-			osc_recalcFreq(&cymbalVoice.osc);
-		}
-				break;
-
-		case F_OSC1_FINE:
-		{
-			//clear lower nibble
-			voiceArray[0].osc.midiFreq &= 0xff00;
-			//set lower nibble
-			voiceArray[0].osc.midiFreq |= msg.data2;
-			osc_recalcFreq(&voiceArray[0].osc);
-		}
-			break;
-		case F_OSC2_FINE:
-		{
-			//clear lower nibble
-			voiceArray[1].osc.midiFreq &= 0xff00;
-			//set lower nibble
-			voiceArray[1].osc.midiFreq |= msg.data2;
-			osc_recalcFreq(&voiceArray[1].osc);
-		}
-				break;
-		case F_OSC3_FINE:
-		{
-			//clear lower nibble
-			voiceArray[2].osc.midiFreq &= 0xff00;
-			//set lower nibble
-			voiceArray[2].osc.midiFreq |= msg.data2;
-			osc_recalcFreq(&voiceArray[2].osc);
-		}
-				break;
-		case F_OSC4_FINE:
-		{
-			//clear lower nibble
-			snareVoice.osc.midiFreq &= 0xff00;
-			//set lower nibble
-			snareVoice.osc.midiFreq |= msg.data2;
-			osc_recalcFreq(&snareVoice.osc);
-		}
-				break;
-
-		case F_OSC5_FINE:
-		{
-			//clear lower nibble
-			cymbalVoice.osc.midiFreq &= 0xff00;
-			//set lower nibble
-			cymbalVoice.osc.midiFreq |= msg.data2;
-			osc_recalcFreq(&cymbalVoice.osc);
-		}
-				break;
-
-		case F_OSC6_FINE:
-		{
-			//clear lower nibble
-			hatVoice.osc.midiFreq &= 0xff00;
-			//set lower nibble
-			hatVoice.osc.midiFreq |= msg.data2;
-			osc_recalcFreq(&hatVoice.osc);
-		}
-				break;
-
-		case OSC_WAVE_DRUM1:
-			voiceArray[0].osc.waveform = msg.data2;
-			break;
-
-		case MOD_WAVE_DRUM1:
-			voiceArray[0].modOsc.waveform = msg.data2;
-			break;
-
-		case OSC_WAVE_DRUM2:
-			voiceArray[1].osc.waveform = msg.data2;
-			break;
-
-		case MOD_WAVE_DRUM2:
-			voiceArray[1].modOsc.waveform = msg.data2;
-			break;
-
-		case OSC_WAVE_DRUM3:
-			voiceArray[2].osc.waveform = msg.data2;
-			break;
-
-		case MOD_WAVE_DRUM3:
-			voiceArray[2].modOsc.waveform = msg.data2;
-			break;
-
-		case OSC_WAVE_SNARE:
-			snareVoice.osc.waveform = msg.data2;
-			break;
-
-
-		case OSC1_DIST:
-#if USE_FILTER_DRIVE
-			voiceArray[0].filter.drive = 0.5f + (msg.data2/127.f) *6;
-#else
-			setDistortionShape(&voiceArray[0].distortion,msg.data2);
-#endif
-			break;
-		case OSC2_DIST:
-#if USE_FILTER_DRIVE
-			voiceArray[1].filter.drive = 0.5f + (msg.data2/127.f)*6;
-#else
-			setDistortionShape(&voiceArray[1].distortion,msg.data2);
-#endif
-			break;
-		case OSC3_DIST:
-#if USE_FILTER_DRIVE
-			voiceArray[3].filter.drive = 0.5f + (msg.data2/127.f)*6;
-#else
-			setDistortionShape(&voiceArray[2].distortion,msg.data2);
-#endif
-			break;
-
-		case VELOA1:
-			slopeEg2_setAttack(&voiceArray[0].oscVolEg,msg.data2,AMP_EG_SYNC);
-			break;
-
-		case VELOD1:
-		{
-			slopeEg2_setDecay(&voiceArray[0].oscVolEg,msg.data2,AMP_EG_SYNC);
-		}
-			break;
-
-		case PITCHD1:
-		{
-			DecayEg_setDecay(&voiceArray[0].oscPitchEg,msg.data2);
-		}
-			break;
-
-		case MODAMNT1:
-			voiceArray[0].egPitchModAmount = calcPitchModAmount(msg.data2);
-			break;
-
-		case FMAMNT1:
-			voiceArray[0].fmModAmount = msg.data2/127.f;
-			break;
-
-		case FMDTN1:
-			//clear upper nibble
-			voiceArray[0].modOsc.midiFreq &= 0x00ff;
-			//set upper nibble
-			voiceArray[0].modOsc.midiFreq |= msg.data2 << 8;
-			osc_recalcFreq(&voiceArray[0].modOsc);
-			break;
-
-		case VOL1:
-			voiceArray[0].vol = msg.data2/127.f;
-			break;
-
-		case PAN1:
-			setPan(0,msg.data2);
-			break;
-
-		case VELOA2:
-		{
-			slopeEg2_setAttack(&voiceArray[1].oscVolEg,msg.data2,AMP_EG_SYNC);
-		}
+		default:
+			//applied at the start of the next audio block
+			paramArray_queueValue(paramNr, msg.data2);
 			break;
-
-			case VELOD2:
-			{
-				slopeEg2_setDecay(&voiceArray[1].oscVolEg,msg.data2,AMP_EG_SYNC);
-			}
-				break;
-
-			case PITCHD2:
-			{
-				DecayEg_setDecay(&voiceArray[1].oscPitchEg,msg.data2);
-			}
-				break;
-
-			case MODAMNT2:
-				voiceArray[1].egPitchModAmount = calcPitchModAmount(msg.data2);
-				break;
-
-			case FMAMNT2:
-				voiceArray[1].fmModAmount = msg.data2/127.f;
-				break;
-
-			case FMDTN2:
-				//clear upper nibble
-				voiceArray[1].modOsc.midiFreq &= 0x00ff;
-				//set upper nibble
-				voiceArray[1].modOsc.midiFreq |= msg.data2 << 8;
-				osc_recalcFreq(&voiceArray[1].modOsc);
-				break;
-
-			case VOL2:
-				voiceArray[1].vol = msg.data2/127.f;
-				break;
-
-			case PAN2:
-				setPan(1,msg.data2);
-				break;
-
-
-			case VELOA3:
-			{
-				slopeEg2_setAttack(&voiceArray[2].oscVolEg,msg.data2,AMP_EG_SYNC);
-			}
-				break;
-
-				case VELOD3:
-				{
-					slopeEg2_setDecay(&voiceArray[2].oscVolEg,msg.data2,AMP_EG_SYNC);
-				}
-					break;
-
-				case PITCHD3:
-				{
-					DecayEg_setDecay(&voiceArray[2].oscPitchEg,msg.data2);
-				}
-					break;
-
-				case MODAMNT3:
-					voiceArray[2].egPitchModAmount = calcPitchModAmount(msg.data2);
-					break;
-
-				case FMAMNT3:
-					voiceArray[2].fmModAmount = msg.data2/127.f;
-					break;
-
-				case FMDTN3:
-					//clear upper nibble
-					voiceArray[2].modOsc.midiFreq &= 0x00ff;
-					//set upper nibble
-					voiceArray[2].modOsc.midiFreq |= msg.data2 << 8;
-					osc_recalcFreq(&voiceArray[2].modOsc);
-					break;
-
-				case VOL3:
-					voiceArray[2].vol = msg.data2/127.f;
-					break;
-
-				case PAN3:
-					setPan(2,msg.data2);
-					break;
-
-				//snare
-				case VOL4:
-					snareVoice.vol = msg.data2/127.f;
-					break;
-
-				case PAN4:
-					Snare_setPan(msg.data2);
-
-					break;
-
-				case SNARE_NOISE_F:
-					snareVoice.noiseOsc.freq = msg.data2/127.f*22000;
-					//TODO respond to midi note
-					break;
-				case VELOA4:
-				{
-					slopeEg2_setAttack(&snareVoice.oscVolEg,msg.data2,false);
-				}
-					break;
-				case VELOD4:
-				{
-					slopeEg2_setDecay(&snareVoice.oscVolEg,msg.data2,false);
-				}
-
-					break;
-				case PITCHD4:
-				{
-					DecayEg_setDecay(&snareVoice.oscPitchEg,msg.data2);
-				}
-
-					break;
-				case MODAMNT4:
-					snareVoice.egPitchModAmount = calcPitchModAmount(msg.data2);
-					break;
-				case SNARE_FILTER_F:
-						{
-			#if USE_PEAK
-							peak_setFreq(&snareVoice.filter, msg.data2/127.f*20000.f);
-			#else
-							const float f = msg.data2/127.f;
-							//exponential full range freq
-							SVF_directSetFilterValue(&snareVoice.filter,valueShaperF2F(f,FILTER_SHAPER) );
-			#endif
-						}
-						break;
-
-				case SNARE_RESO:
-	#if USE_PEAK
-					peak_setGain(&snareVoice.filter, msg.data2/127.f);
-	#else
-					SVF_setReso(&snareVoice.filter, msg.data2/127.f);
-	#endif
-					break;
-
-				case SNARE_MIX:
-					snareVoice.mix = msg.data2/127.f;
-					break;
-
-				//snare 2
-				case VOL5:
-					cymbalVoice.vol = msg.data2/127.f;
-				break;
-
-				case PAN5:
-					Cymbal_setPan(msg.data2);
-
-					break;
-
-				case VELOA5:
-				{
-					slopeEg2_setAttack(&cymbalVoice.oscVolEg,msg.data2,false);
-				}
-
-					break;
-				case VELOD5:
-				{
-					slopeEg2_setDecay(&cymbalVoice.oscVolEg,msg.data2,false);
-				}
-					break;
-
-
-				case CYM_WAVE1:
-					cymbalVoice.osc.waveform = msg.data2;
-					break;
-
-				case CYM_WAVE2:
-					cymbalVoice.modOsc.waveform = msg.data2;
-					break;
-
-				case CYM_WAVE3:
-					cymbalVoice.modOsc2.waveform = msg.data2;
-					break;
-
-				case CYM_MOD_OSC_F1:
-					//cymbalVoice.modOsc.freq = MidiNoteFrequencies[msg.data2];
-					//clear upper nibble
-					cymbalVoice.modOsc.midiFreq &= 0x00ff;
-					//set upper nibble
-					cymbalVoice.modOsc.midiFreq |= msg.data2 << 8;
-					osc_recalcFreq(&cymbalVoice.modOsc);
-
-					break;
-				case CYM_MOD_OSC_F2:
-					//clear upper nibble
-					cymbalVoice.modOsc2.midiFreq &= 0x00ff;
-					//set upper nibble
-					cymbalVoice.modOsc2.midiFreq |= msg.data2 << 8;
-					osc_recalcFreq(&cymbalVoice.modOsc2);
-					break;
-				case CYM_MOD_OSC_GAIN1:
-					cymbalVoice.fmModAmount1 = msg.data2/127.f;
-					break;
-				case CYM_MOD_OSC_GAIN2:
-					cymbalVoice.fmModAmount2 = msg.data2/127.f;
-					break;
-
-				case CYM_FIL_FREQ:
-				{
-					const float f = msg.data2/127.f;
-					//exponential full range freq
-					SVF_directSetFilterValue(&cymbalVoice.filter,valueShaperF2F(f,FILTER_SHAPER) );
-				}
-					break;
-
-				case CYM_RESO:
-					SVF_setReso(&cymbalVoice.filter, msg.data2/127.f);
-					break;
-
-				case CYM_REPEAT:
-					cymbalVoice.oscVolEg.repeat = msg.data2;
-					break;
-				case CYM_SLOPE:
-					slopeEg2_setSlope(&cymbalVoice.oscVolEg,msg.data2);
-					break;
-
-				// hat
-				case WAVE1_HH:
-					hatVoice.osc.waveform = msg.data2;
-					break;
-				case WAVE2_HH:
-					hatVoice.modOsc.waveform = msg.data2;
-					break;
-				case WAVE3_HH:
-					hatVoice.modOsc2.waveform = msg.data2;
-					break;
-
-				case VELOD6:
-					hatVoice.decayClosed = slopeEg2_calcDecay(msg.data2);
-					break;
-
-				case VELOD6_OPEN:
-					hatVoice.decayOpen = slopeEg2_calcDecay(msg.data2);
-					break;
-
-				case HAT_FILTER_F:
-				{
-					const float f = msg.data2/127.f;
-					//exponential full range freq
-					SVF_directSetFilterValue(&hatVoice.filter,valueShaperF2F(f,FILTER_SHAPER) );
-				}
-					break;
-
-				case HAT_RESO:
-					SVF_setReso(&hatVoice.filter, msg.data2/127.f);
-					break;
-
-				case VOL6:
-					hatVoice.vol = msg.data2/127.f;
-					break;
-
-				case PAN6:
-					HiHat_setPan(msg.data2);
-					break;
-
-				case F_OSC6_COARSE:
-				{
-					//clear upper nibble
-					hatVoice.osc.midiFreq &= 0x00ff;
-					//set upper nibble
-					hatVoice.osc.midiFreq |= msg.data2 << 8;
-					osc_recalcFreq(&hatVoice.osc);
-				}
-						break;
-
-				case MOD_OSC_F1:
-					//clear upper nibble
-					hatVoice.modOsc.midiFreq &= 0x00ff;
-					//set upper nibble
-					hatVoice.modOsc.midiFreq |= msg.data2 << 8;
-					osc_recalcFreq(&hatVoice.modOsc);
-					break;
-
-				case MOD_OSC_F2:
-					//clear upper nibble
-					hatVoice.modOsc2.midiFreq &= 0x00ff;
-					//set upper nibble
-					hatVoice.modOsc2.midiFreq |= msg.data2 << 8;
-					osc_recalcFreq(&hatVoice.modOsc2);
-					break;
-
-				case MOD_OSC_GAIN1:
-					hatVoice.fmModAmount1 = msg.data2/127.f;
-					break;
-
-				case MOD_OSC_GAIN2:
-					hatVoice.fmModAmount2 = msg.data2/127.f;
-					break;
-
-				case VELOA6:
-					slopeEg2_setAttack(&hatVoice.oscVolEg,msg.data2,false);
-					break;
-
-				case REPEAT1:
-					snareVoice.oscVolEg.repeat = msg.data2;
-					break;
-
-
-				case EG_SNARE1_SLOPE:
-					slopeEg2_setSlope(&snareVoice.oscVolEg,msg.data2);
-					break;
-
-				case SNARE_DISTORTION:
-					setDistortionShape(&snareVoice.distortion,msg.data2);
-					break;
-
-				case CYMBAL_DISTORTION:
-					setDistortionShape(&cymbalVoice.distortion,msg.data2);
-					break;
-
-				case HAT_DISTORTION:
-					setDistortionShape(&hatVoice.distortion,msg.data2);
-					break;
-
-				case FREQ_LFO1:
-				case FREQ_LFO2:
-				case FREQ_LFO3:
-					lfo_setFreq(&voiceArray[msg.data1-FREQ_LFO1].lfo,msg.data2);
-									break;
-				case FREQ_LFO4:
-					lfo_setFreq(&snareVoice.lfo,msg.data2);
-									break;
-				case FREQ_LFO5:
-					lfo_setFreq(&cymbalVoice.lfo,msg.data2);
-									break;
-				case FREQ_LFO6:
-					lfo_setFreq(&hatVoice.lfo,msg.data2);
-					break;
-
-				case AMOUNT_LFO1:
-				case AMOUNT_LFO2:
-				case AMOUNT_LFO3:
-					voiceArray[msg.data1-AMOUNT_LFO1].lfo.modTarget.amount = msg.data2/127.f;
-					break;
-				case AMOUNT_LFO4:
-					snareVoice.lfo.modTarget.amount = msg.data2/127.f;
-					break;
-				case AMOUNT_LFO5:
-					cymbalVoice.lfo.modTarget.amount = msg.data2/127.f;
-					break;
-				case AMOUNT_LFO6:
-					hatVoice.lfo.modTarget.amount = msg.data2/127.f;
-					break;
-
-				case VOICE_DECIMATION1:
-				case VOICE_DECIMATION2:
-				case VOICE_DECIMATION3:
-				case VOICE_DECIMATION4:
-				case VOICE_DECIMATION5:
-				case VOICE_DECIMATION6:
-				case VOICE_DECIMATION_ALL:
-					mixer_decimation_rate[msg.data1-VOICE_DECIMATION1] = valueShaperI2F(msg.data2,-0.7f);
-					break;
-
-				default:
-					break;
 		}
-		modNode_originalValueChanged(paramNr);
 	} //msg.status == MIDI_CC
 
 	else //MIDI_CC2
 	{
 		const uint16_t paramNr = msg.data1+1 + 127;
 
-		if(updateOriginalValue) {
+		//nrpn numbers above the cc2 range have no stored value
+		if(updateOriginalValue && paramNr < sizeof(midiParser_originalCcValues)) {
 			midiParser_originalCcValues[paramNr] = msg.data2;
 		}
-		switch(msg.data1)
-		{
-
-			case CC2_TRANS1_WAVE:
-				transient_setWaveform(&voiceArray[0].transGen, msg.data2);
-				break;
-
-			case CC2_TRANS1_VOL:
-				voiceArray[0].transGen.volume = msg.data2/127.f;
-				break;
-
-			case CC2_TRANS1_FREQ:
-				voiceArray[0].transGen.pitch = 1.f + ((msg.data2/33.9f)-0.75f) ;// range about  0.25 to 4 => 1/4 to 1*4
-				break;
-
-			case CC2_TRANS2_WAVE:
-				transient_setWaveform(&voiceArray[1].transGen, msg.data2);
-				break;
-
-			case CC2_TRANS2_VOL:
-				voiceArray[1].transGen.volume = msg.data2/127.f;
-				break;
-
-			case CC2_TRANS2_FREQ:
-				voiceArray[1].transGen.pitch = 1.f + ((msg.data2/33.9f)-0.75f) ;
-				break;
-
-			case CC2_TRANS3_WAVE:
-				transient_setWaveform(&voiceArray[2].transGen, msg.data2);
-				break;
-
-			case CC2_TRANS3_VOL:
-				voiceArray[2].transGen.volume = msg.data2/127.f;
-				break;
-
-			case CC2_TRANS3_FREQ:
-				voiceArray[2].transGen.pitch = 1.f + ((msg.data2/33.9f)-0.75f) ;
-				break;
-
-			case CC2_TRANS4_WAVE:
-				transient_setWaveform(&snareVoice.transGen, msg.data2);
-				break;
-
-			case CC2_TRANS4_VOL:
-				snareVoice.transGen.volume = msg.data2/127.f;
-				break;
-			case CC2_TRANS4_FREQ:
-				snareVoice.transGen.pitch = 1.f + ((msg.data2/33.9f)-0.75f) ;
-				break;
-
-			case CC2_TRANS5_WAVE:
-				transient_setWaveform(&cymbalVoice.transGen, msg.data2);
-				break;
-
-			case CC2_TRANS5_VOL:
-				cymbalVoice.transGen.volume = msg.data2/127.f;
-				break;
-			case CC2_TRANS5_FREQ:
-				cymbalVoice.transGen.pitch = 1.f + ((msg.data2/33.9f)-0.75f) ;
-				break;
-
-			case CC2_TRANS6_WAVE:
-				transient_setWaveform(&hatVoice.transGen, msg.data2);
-				break;
-
-			case CC2_TRANS6_VOL:
-				hatVoice.transGen.volume = msg.data2/127.f;
-				break;
-			case CC2_TRANS6_FREQ:
-				hatVoice.transGen.pitch = 1.f + ((msg.data2/33.9f)-0.75f) ;
-				break;
-
-			case CC2_FILTER_TYPE_1:
-			case CC2_FILTER_TYPE_2:
-			case CC2_FILTER_TYPE_3:
-				voiceArray[msg.data1-CC2_FILTER_TYPE_1].filterType = msg.data2+1;
-				//SVF_reset(&voiceArray[msg.data1-CC2_FILTER_TYPE_1].filter);
-				break;
-			case CC2_FILTER_TYPE_4:
-				snareVoice.filterType = msg.data2 + 1; // +1 because 0 is filter off which results in silence
-				//SVF_reset(&snareVoice.filter);
-				break;
-			case CC2_FILTER_TYPE_5:
-				//cymbal filter
-				cymbalVoice.filterType = msg.data2+1;
-				//SVF_reset(&cymbalVoice.filter);
-				break;
-			case CC2_FILTER_TYPE_6:
-				//Hihat filter
-				hatVoice.filterType = msg.data2+1;
-				//SVF_reset(&hatVoice.filter);
-				break;
-
-			case CC2_FILTER_DRIVE_1:
-			case CC2_FILTER_DRIVE_2:
-			case CC2_FILTER_DRIVE_3:
-#if UNIT_GAIN_DRIVE
-				voiceArray[msg.data1-CC2_FILTER_DRIVE_1].filter.drive = (msg.data2/127.f);
-#else
-				SVF_setDrive(&voiceArray[msg.data1-CC2_FILTER_DRIVE_1].filter,msg.data2);
-#endif
-				break;
-			case CC2_FILTER_DRIVE_4:
-#if UNIT_GAIN_DRIVE
-				snareVoice.filter.drive = (msg.data2/127.f);
-#else
-				SVF_setDrive(&snareVoice.filter, msg.data2);
-#endif
-
-				break;
-			case CC2_FILTER_DRIVE_5:
-#if UNIT_GAIN_DRIVE
-				cymbalVoice.filter.drive = (msg.data2/127.f);
-#else
-				SVF_setDrive(&cymbalVoice.filter, msg.data2);
-#endif
-
-				break;
-			case CC2_FILTER_DRIVE_6:
-#if UNIT_GAIN_DRIVE
-				hatVoice.filter.drive = (msg.data2/127.f);
-#else
-				SVF_setDrive(&hatVoice.filter, msg.data2);
-#endif
-
-				break;
-
-			case CC2_MIX_MOD_1:
-			case CC2_MIX_MOD_2:
-			case CC2_MIX_MOD_3:
-				voiceArray[msg.data1-CC2_MIX_MOD_1].mixOscs = msg.data2;
-				break;
-
-			case CC2_VOLUME_MOD_ON_OFF1:
-			case CC2_VOLUME_MOD_ON_OFF2:
-			case CC2_VOLUME_MOD_ON_OFF3:
-				voiceArray[msg.data1-CC2_VOLUME_MOD_ON_OFF1].volumeMod = msg.data2;
-				break;
-			case CC2_VOLUME_MOD_ON_OFF4:
-				snareVoice.volumeMod = msg.data2;
-				break;
-			case CC2_VOLUME_MOD_ON_OFF5:
-				cymbalVoice.volumeMod = msg.data2;
-				break;
-			case CC2_VOLUME_MOD_ON_OFF6:
-				hatVoice.volumeMod = msg.data2;
-				break;
-
-			case CC2_VELO_MOD_AMT_1:
-			case CC2_VELO_MOD_AMT_2:
-			case CC2_VELO_MOD_AMT_3:
-			case CC2_VELO_MOD_AMT_4:
-			case CC2_VELO_MOD_AMT_5:
-			case CC2_VELO_MOD_AMT_6:
-				velocityModulators[msg.data1-CC2_VELO_MOD_AMT_1].amount = msg.data2/127.f;
-				break;
-
-			case CC2_WAVE_LFO1:
-			case CC2_WAVE_LFO2:
-			case CC2_WAVE_LFO3:
-				voiceArray[msg.data1-CC2_WAVE_LFO1].lfo.waveform = msg.data2;
-				break;
-			case CC2_WAVE_LFO4:
-				snareVoice.lfo.waveform = msg.data2;
-				break;
-			case CC2_WAVE_LFO5:
-				cymbalVoice.lfo.waveform = msg.data2;
-				break;
-			case CC2_WAVE_LFO6:
-				hatVoice.lfo.waveform = msg.data2;
-				break;
-
-			case CC2_RETRIGGER_LFO1:
-			case CC2_RETRIGGER_LFO2:
-			case CC2_RETRIGGER_LFO3:
-				voiceArray[msg.data1-CC2_RETRIGGER_LFO1].lfo.retrigger = msg.data2;
-				break;
-			case CC2_RETRIGGER_LFO4:
-				snareVoice.lfo.retrigger = msg.data2;
-				break;
-			case CC2_RETRIGGER_LFO5:
-				cymbalVoice.lfo.retrigger = msg.data2;
-				break;
-			case CC2_RETRIGGER_LFO6:
-				hatVoice.lfo.retrigger = msg.data2;
-				break;
-
-			case CC2_SYNC_LFO1:
-			case CC2_SYNC_LFO2:
-			case CC2_SYNC_LFO3:
-				lfo_setSync(&voiceArray[msg.data1-CC2_SYNC_LFO1].lfo, msg.data2);
-				break;
-			case CC2_SYNC_LFO4:
-				lfo_setSync(&snareVoice.lfo, msg.data2);
-				break;
-			case CC2_SYNC_LFO5:
-				lfo_setSync(&cymbalVoice.lfo, msg.data2);
-				break;
-			case CC2_SYNC_LFO6:
-				lfo_setSync(&hatVoice.lfo, msg.data2);
-				break;
-
-			case CC2_VOICE_LFO1:
-			case CC2_VOICE_LFO2:
-			case CC2_VOICE_LFO3:
-			case CC2_VOICE_LFO4:
-			case CC2_VOICE_LFO5:
-			case CC2_VOICE_LFO6:
-				break;
-
-			case CC2_TARGET_LFO1:
-			case CC2_TARGET_LFO2:
-			case CC2_TARGET_LFO3:
-			case CC2_TARGET_LFO4:
-			case CC2_TARGET_LFO5:
-			case CC2_TARGET_LFO6:
-				break;
 
-
-
-			case CC2_OFFSET_LFO1:
-			case CC2_OFFSET_LFO2:
-			case CC2_OFFSET_LFO3:
-				voiceArray[msg.data1-CC2_OFFSET_LFO1].lfo.phaseOffset = msg.data2/127.f * 0xffffffff;
-				break;
-			case CC2_OFFSET_LFO4:
-				snareVoice.lfo.phaseOffset = msg.data2/127.f * 0xffffffff;
-				break;
-			case CC2_OFFSET_LFO5:
-				cymbalVoice.lfo.phaseOffset = msg.data2/127.f * 0xffffffff;
-				break;
-			case CC2_OFFSET_LFO6:
-				hatVoice.lfo.phaseOffset = msg.data2/127.f * 0xffffffff;
-				break;
-
-			case CC2_AUDIO_OUT1:
-			case CC2_AUDIO_OUT2:
-			case CC2_AUDIO_OUT3:
-			case CC2_AUDIO_OUT4:
-			case CC2_AUDIO_OUT5:
-			case CC2_AUDIO_OUT6:
-				mixer_audioRouting[msg.data1-CC2_AUDIO_OUT1] = msg.data2;
-				break;
-
-			//--AS
-			case CC2_MIDI_NOTE1:
-			case CC2_MIDI_NOTE2:
-			case CC2_MIDI_NOTE3:
-			case CC2_MIDI_NOTE4:
-			case CC2_MIDI_NOTE5:
-			case CC2_MIDI_NOTE6:
-			case CC2_MIDI_NOTE7:
-				//--AS set the note override for the voice. 0 means use the note value, anything else means
-				// that the note will always play with that note
-				midi_NoteOverride[msg.data1-CC2_MIDI_NOTE1] = msg.data2;
-				break;
-
-			case CC2_MUTE_1:
-			case CC2_MUTE_2:
-			case CC2_MUTE_3:
-			case CC2_MUTE_4:
-			case CC2_MUTE_5:
-			case CC2_MUTE_6:
-			case CC2_MUTE_7:
-			{
-				const uint8_t voiceNr = msg.data1 - CC2_MUTE_1;
-				if(msg.data2 == 0)
-				{
-					seq_setMute(voiceNr,0);
-				}
-				else
-				{
-					seq_setMute(voiceNr,1);
-				}
-
-			}
-				break;
-
-			default:
-				break;
+		if(msg.data1 >= CC2_MUTE_1 && msg.data1 <= CC2_MUTE_7)
+		{
+			//mute buttons are no sound parameters, they can be controlled by external NRPN messages
+			seq_setMute(msg.data1 - CC2_MUTE_1, msg.data2 != 0);
+		}
+		else
+		{
+			paramArray_queueValue(paramNr, msg.data2);
 		}
-		modNode_originalValueChanged(paramNr);
 	}
 }
 
+//-----------------------------------------------------------
+void midiParser_setArrivalTime(uint32_t samplePos)
+{
+	midiParser_arrivalTime = samplePos;
+}
 //-----------------------------------------------------------
 // this will check whether mtc is running, and if so will
 // check to see whether we need to stop the sequencer due to
@@ -1144,7 +275,8 @@ static void midiParser_noteOn(uint8_t voice, uint8_t note, uint8_t vel, uint8_t
 			return; // note does not match. Do nothing
 	}
 
-	voiceControl_noteOn(voice,note,vel);
+	//played with a constant latency from its arrival, independent of the main loop load
+	voiceControl_noteOnAt(voice,note,vel,midiParser_arrivalTime);
 
 	//Recording Mode - record the note to sequencer and echo to channel of that voice
 	// (we'd want to hear what's being recorded)
@@ -1152,7 +284,7 @@ static void midiParser_noteOn(uint8_t voice, uint8_t note, uint8_t vel, uint8_t
 		const uint8_t chan=midi_MidiChannels[voice];
 
 		// record note if rec is on
-		seq_addNote(voice,vel, note);
+		seq_addNoteAt(voice,vel, note, midiParser_arrivalTime);
 
 		//if a note is on for that channel send note-off first
 		seq_midiNoteOff(chan);
@@ -1209,7 +341,7 @@ void midiParser_parseMidiMessage(MidiMsg msg)
 		switch(msg.status) {
 		case MIDI_CLOCK:
 			if((midiParser_txRxFilter & 0x02) && seq_getExtSync())
-				seq_sync();
+				seq_sync(midiParser_arrivalTime);
 			break;
 
 		case MIDI_START:
@@ -1311,7 +443,7 @@ void midiParser_parseMidiMessage(MidiMsg msg)
 		} else if(msgonly==PROG_CHANGE) {
 			// --AS respond to prog change and change patterns. This responds only when global channel matches the PC message's channel.
 			if((midiParser_txRxFilter & 0x08) && (chanonly == midi_MidiChannels[7]))
-				seq_setNextPattern(msg.data1 & 0x07);
+				seq_setNextBankPattern(msg.data1);
 
 		} else if(msgonly==MIDI_CC){
 			// respond to CC message. This responds only when global channel matches the cc message's channel
@@ -1319,10 +451,14 @@ void midiParser_parseMidiMessage(MidiMsg msg)
 				//record automation if record is turned on
 				seq_recordAutomation(frontParser_activeTrack, msg.data1, msg.data2);
 
+				//the cc handler and the front tell cc and cc2 apart by the status, drop the channel
+				MidiMsg cc = msg;
+				cc.status = MIDI_CC;
+
 				//handle midi data
-				midiParser_ccHandler(msg,1);
+				midiParser_ccHandler(cc,1);
 				//we received a midi cc message forward it to the front panel
-				uart_sendFrontpanelByte(msg.status);
+				uart_sendFrontpanelByte(cc.status);
 				uart_sendFrontpanelByte(msg.data1);
 				uart_sendFrontpanelByte(msg.data2);
 			}
@@ -1372,20 +508,34 @@ void midiParser_handleStatusByte(unsigned char data)
 // parseMidiMessage when it's complete
 void midiParser_parseUartData(unsigned char data)
 {
+	if(data>=MIDI_CLOCK) {
+		// realtime messages may appear between any two bytes, even inside sysex.
+		// handle them on their own so the message in progress and running status survive
+		MidiMsg realtime;
+		realtime.status = data;
+		realtime.data1 = 0;
+		realtime.data2 = 0;
+		realtime.bits.sysxbyte = 0;
+		realtime.bits.length = 0;
+		realtime.bits.source = midiSourceMIDI;
+		midiParser_parseMidiMessage(realtime);
+		return;
+	}
 
 	if(data&0x80) { // High bit is set -  its either a status or a system message.
 		// regardless of current state, we blindly start a new message without questioning it
 		midiMsg_tmp.bits.sysxbyte=0;
-		if( (data&0xf0) == 0xf0) { // system message
-			midiMsg_tmp.status = data;
+		if( (data&0xf0) == 0xf0) { // system common message
 			switch(data) {
 			case SYSEX_START: // get into sysex receive mode. any more bytes received until this status changes are considered
 							  // to be sysex data. we still need to parse this sysex start, in case we are routing it
+				midiMsg_tmp.status = data;
 				parserState = SYSEX_DATA;
 				midiMsg_tmp.bits.length=0;
 				goto parseMsg; // we will still parse it in case we are doing a passthru
 			case SYSEX_END:	  // get out of sysex mode
 				if(parserState==SYSEX_DATA) {
+					midiMsg_tmp.status = data;
 					parserState=MIDI_STATUS;
 					midiMsg_tmp.bits.length=0;
 					goto parseMsg; // we will still parse it in case we are doing a passthru
@@ -1396,13 +546,21 @@ void midiParser_parseUartData(unsigned char data)
 			// 1 byte payload messages
 			case MIDI_SONG_SEL:		// passthru only
 			case MIDI_MTC_QFRAME: 	// mtc chunk
+				midiMsg_tmp.status = data;
 				parserState = MIDI_DATA1; 	// we expect the nugget of mtc frame info
 				midiMsg_tmp.bits.length=1;// we expect 1 data byte
 				break;
+			// 2 byte payload messages
+			case MIDI_SONG_POS:		// passthru only
+				midiMsg_tmp.status = data;
+				parserState = MIDI_DATA1;
+				midiMsg_tmp.bits.length=2;
+				break;
 
 			// 0 byte payload messages (we will assume that any system message
 			// other than those above has 0 byte payload)
 			default:
+				midiMsg_tmp.status = data;
 				midiMsg_tmp.bits.length=0;
 				goto parseMsg;
 			}
@@ -1458,6 +616,10 @@ parseMsg:
 	midiMsg_tmp.bits.source=midiSourceMIDI;
 	midiParser_parseMidiMessage(midiMsg_tmp);
 
+	// system common messages cancel running status, data bytes after them are ignored
+	if(parserState == MIDI_STATUS && (midiMsg_tmp.status & 0xF0) == 0xF0)
+		midiMsg_tmp.bits.length=0;
+
 }
 
 // 0 - Off - nothing to nothing
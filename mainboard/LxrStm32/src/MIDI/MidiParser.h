@@ -44,8 +44,13 @@
 
 
 void midiParser_parseUartData(unsigned char data);
+/** start a channel message with status byte data, running status continues from it*/
+void midiParser_handleStatusByte(unsigned char data);
 void midiParser_ccHandler(MidiMsg msg, uint8_t updateOriginalValue);
 void midiParser_parseMidiMessage(MidiMsg msg);
+/** playback position (codec_getPlaybackPos) at which the data parsed next was received.
+ * live notes and note recording are timed from it*/
+void midiParser_setArrivalTime(uint32_t samplePos);
 float midiParser_calcDetune(uint8_t value);
 // check mtc status, might stop the sequencer
 void midiParser_checkMtc();
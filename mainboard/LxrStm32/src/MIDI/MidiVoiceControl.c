@@ -35,31 +35,36 @@
 
 
 #include "MidiVoiceControl.h"
-#include "DrumVoice.h"
-#include "Snare.h"
-#include "HiHat.h"
+#include "voiceTable.h"
 #include "MidiMessages.h"
-#include "CymbalVoice.h"
 #include "sequencer.h"
 #include "TriggerOut.h"
 #include "Uart.h"
+#include "seqClock.h"
 //#include "LCD_driver.h"
 
 static uint8_t active_voices=0;	// which voices are currently playing a note
+
+// live notes wait here until the block they have to be played in is calculated
+#define LIVE_NOTE_QUEUE_SIZE	16	// power of 2
+typedef struct LiveNoteStruct
+{
+	uint32_t	pos;		// playback position to start at
+	uint8_t		voice;
+	uint8_t		note;
+	uint8_t		vel;
+} LiveNote;
+
+static LiveNote voiceControl_liveNotes[LIVE_NOTE_QUEUE_SIZE];
+static uint8_t voiceControl_liveRead = 0;
+static uint8_t voiceControl_liveWrite = 0;
 //----------------------------------------------------------------
 // this fn assumes a valid voice is sent
 void voiceControl_noteOn(uint8_t voice, uint8_t note, uint8_t vel)
 {
 	active_voices |= (1<<voice);
 
-	if(voice < 3)
-		Drum_trigger(voice, vel, note);
-	else if(voice < 4)
-		Snare_trigger(vel, note);
-	else if(voice < 5)
-		Cymbal_trigger(vel, note);
-	else
-		HiHat_trigger(vel,voice-5,note);
+	voiceTable_trigger(voice, vel, note);
 	
 	//Send trigger out signal	
 	if(trigger_isGateModeOn())
@@ -76,6 +81,42 @@ void voiceControl_noteOn(uint8_t voice, uint8_t note, uint8_t vel)
 	uart_sendFrontpanelByte(0);
 }
 //----------------------------------------------------------------
+void voiceControl_noteOnAt(uint8_t voice, uint8_t note, uint8_t vel, uint32_t samplePos)
+{
+	const uint8_t next = (voiceControl_liveWrite+1) & (LIVE_NOTE_QUEUE_SIZE-1);
+	if(next == voiceControl_liveRead)
+	{
+		voiceControl_noteOn(voice, note, vel);
+		return;
+	}
+
+	//same latency as the sequencer clock pulses
+	LiveNote* n = &voiceControl_liveNotes[voiceControl_liveWrite];
+	n->pos 		= samplePos + SEQ_CLOCK_LATENCY;
+	n->voice 	= voice;
+	n->note 	= note;
+	n->vel 		= vel;
+	voiceControl_liveWrite = next;
+}
+//----------------------------------------------------------------
+void voiceControl_processLiveNotes(const uint32_t blockPos)
+{
+	while(voiceControl_liveRead != voiceControl_liveWrite)
+	{
+		const LiveNote* n = &voiceControl_liveNotes[voiceControl_liveRead];
+
+		//not in this block yet
+		if((int32_t)(n->pos - (blockPos+OUTPUT_DMA_SIZE)) >= 0) break;
+
+		//late notes (main loop stalled) are played at the block start
+		const int32_t offset = n->pos - blockPos;
+		voiceTable_setEventOffset(offset > 0 ? offset : 0);
+		voiceControl_noteOn(n->voice, n->note, n->vel);
+		voiceControl_liveRead = (voiceControl_liveRead+1) & (LIVE_NOTE_QUEUE_SIZE-1);
+	}
+	voiceTable_setEventOffset(0);
+}
+//----------------------------------------------------------------
 void voiceControl_noteOff(uint8_t voice)
 {
 	uint8_t midiChan; // which midi channel to send a note on
@@ -59,6 +59,10 @@ uint8_t voiceStatus[NUM_VOICES];
 //---------------------------------------------------
 //------------- Functions ---------------------------
 void voiceControl_noteOn(uint8_t voice, uint8_t note, uint8_t vel);
+/** play a note SEQ_CLOCK_LATENCY samples after samplePos (playback position it was received at)*/
+void voiceControl_noteOnAt(uint8_t voice, uint8_t note, uint8_t vel, uint32_t samplePos);
+/** trigger the queued notes that fall into the audio block starting at blockPos. call right before the block is calculated*/
+void voiceControl_processLiveNotes(const uint32_t blockPos);
 void voiceControl_noteOff(uint8_t voice);//0xff == all voices
 uint8_t voiceControl_isVoicePlaying(uint8_t voice);
 
@@ -34,7 +34,6 @@
  */
 
 
-
 #include "ParameterArray.h"
 #include "DrumVoice.h"
 #include "CymbalVoice.h"
@@ -42,9 +41,395 @@
 #include "HiHat.h"
 #include "Snare.h"
 #include "mixer.h"
+#include "voiceTable.h"
+#include "modulationNode.h"
+#include "valueShaper.h"
+#include "config.h"
 
 
  Parameter parameterArray[END_OF_SOUND_PARAMETERS];
+
+//latest not yet applied controller value of each parameter and one dirty bit per parameter
+static uint8_t paramArray_queuedValue[END_OF_SOUND_PARAMETERS];
+static uint32_t paramArray_dirty[(END_OF_SOUND_PARAMETERS+31)/32];
+//####################################################################
+// converters from 7 bit controller values to the synth parameters
+//####################################################################
+static void paramConv_uint8(void* target, uint8_t value)
+{
+	*(uint8_t*)target = value;
+}
+//---------------------------------------------------------------------
+static void paramConv_norm(void* target, uint8_t value)
+{
+	*(float*)target = value/127.f;
+}
+//---------------------------------------------------------------------
+static void paramConv_filterType(void* target, uint8_t value)
+{
+	// +1 because 0 is filter off which results in silence
+	*(uint8_t*)target = value + 1;
+}
+//---------------------------------------------------------------------
+static void paramConv_oscCoarse(void* target, uint8_t value)
+{
+	OscInfo* osc = (OscInfo*)target;
+	//upper byte of the note offset
+	osc->midiFreq &= 0x00ff;
+	osc->midiFreq |= value << 8;
+	osc_recalcFreq(osc);
+}
+//---------------------------------------------------------------------
+static void paramConv_oscFine(void* target, uint8_t value)
+{
+	OscInfo* osc = (OscInfo*)target;
+	//lower byte of the note offset
+	osc->midiFreq &= 0xff00;
+	osc->midiFreq |= value;
+	osc_recalcFreq(osc);
+}
+//---------------------------------------------------------------------
+static void paramConv_noiseFreq(void* target, uint8_t value)
+{
+	((OscInfo*)target)->freq = value/127.f*22000;
+}
+//---------------------------------------------------------------------
+static void paramConv_filterFreq(void* target, uint8_t value)
+{
+	//exponential full range freq
+	SVF_directSetFilterValue((ResonantFilter*)target, valueShaperF2F(value/127.f, FILTER_SHAPER));
+}
+//---------------------------------------------------------------------
+static void paramConv_reso(void* target, uint8_t value)
+{
+	SVF_setReso((ResonantFilter*)target, value/127.f);
+}
+//---------------------------------------------------------------------
+static void paramConv_snareFilterFreq(void* target, uint8_t value)
+{
+#if USE_PEAK
+	peak_setFreq(target, value/127.f*20000.f);
+#else
+	paramConv_filterFreq(target, value);
+#endif
+}
+//---------------------------------------------------------------------
+static void paramConv_snareReso(void* target, uint8_t value)
+{
+#if USE_PEAK
+	peak_setGain(target, value/127.f);
+#else
+	paramConv_reso(target, value);
+#endif
+}
+//---------------------------------------------------------------------
+static void paramConv_filterDrive(void* target, uint8_t value)
+{
+#if UNIT_GAIN_DRIVE
+	((ResonantFilter*)target)->drive = value/127.f;
+#else
+	SVF_setDrive((ResonantFilter*)target, value);
+#endif
+}
+//---------------------------------------------------------------------
+/** the drum voices drive either their filter or their distortion*/
+static void paramConv_drumDrive(void* target, uint8_t value)
+{
+#if USE_FILTER_DRIVE
+	((DrumVoice*)target)->filter.drive = 0.5f + (value/127.f)*6;
+#else
+	setDistortionShape(&((DrumVoice*)target)->distortion, value);
+#endif
+}
+//---------------------------------------------------------------------
+static void paramConv_distortion(void* target, uint8_t value)
+{
+	setDistortionShape((Distortion*)target, value);
+}
+//---------------------------------------------------------------------
+static void paramConv_ampAttackSync(void* target, uint8_t value)
+{
+	slopeEg2_setAttack((SlopeEg2*)target, value, AMP_EG_SYNC);
+}
+//---------------------------------------------------------------------
+static void paramConv_ampDecaySync(void* target, uint8_t value)
+{
+	slopeEg2_setDecay((SlopeEg2*)target, value, AMP_EG_SYNC);
+}
+//---------------------------------------------------------------------
+static void paramConv_ampAttack(void* target, uint8_t value)
+{
+	slopeEg2_setAttack((SlopeEg2*)target, value, false);
+}
+//---------------------------------------------------------------------
+static void paramConv_ampDecay(void* target, uint8_t value)
+{
+	slopeEg2_setDecay((SlopeEg2*)target, value, false);
+}
+//---------------------------------------------------------------------
+static void paramConv_ampDecayTime(void* target, uint8_t value)
+{
+	*(float*)target = slopeEg2_calcDecay(value);
+}
+//---------------------------------------------------------------------
+static void paramConv_ampSlope(void* target, uint8_t value)
+{
+	slopeEg2_setSlope((SlopeEg2*)target, value);
+}
+//---------------------------------------------------------------------
+static void paramConv_pitchDecay(void* target, uint8_t value)
+{
+	DecayEg_setDecay((DecayEg*)target, value);
+}
+//---------------------------------------------------------------------
+static void paramConv_pitchSlope(void* target, uint8_t value)
+{
+	DecayEg_setSlope((DecayEg*)target, value);
+}
+//---------------------------------------------------------------------
+static void paramConv_pitchModAmount(void* target, uint8_t value)
+{
+	const float val = value/127.f;
+	*(float*)target = val*val*PITCH_AMOUNT_FACTOR;
+}
+//---------------------------------------------------------------------
+static void paramConv_drumPan(void* target, uint8_t value)
+{
+	setPan((DrumVoice*)target - voiceArray, value);
+}
+//---------------------------------------------------------------------
+static void paramConv_snarePan(void* target, uint8_t value)
+{
+	UNUSED(target);
+	Snare_setPan(value);
+}
+//---------------------------------------------------------------------
+static void paramConv_cymbalPan(void* target, uint8_t value)
+{
+	UNUSED(target);
+	Cymbal_setPan(value);
+}
+//---------------------------------------------------------------------
+static void paramConv_hatPan(void* target, uint8_t value)
+{
+	UNUSED(target);
+	HiHat_setPan(value);
+}
+//---------------------------------------------------------------------
+static void paramConv_decimation(void* target, uint8_t value)
+{
+	*(float*)target = valueShaperI2F(value, -0.7f);
+}
+//---------------------------------------------------------------------
+static void paramConv_lfoFreq(void* target, uint8_t value)
+{
+	lfo_setFreq((Lfo*)target, value);
+}
+//---------------------------------------------------------------------
+static void paramConv_lfoSync(void* target, uint8_t value)
+{
+	lfo_setSync((Lfo*)target, value);
+}
+//---------------------------------------------------------------------
+static void paramConv_lfoOffset(void* target, uint8_t value)
+{
+	*(uint32_t*)target = value/127.f * 0xffffffff;
+}
+//---------------------------------------------------------------------
+static void paramConv_transWave(void* target, uint8_t value)
+{
+	transient_setWaveform((TransientGenerator*)target, value);
+}
+//---------------------------------------------------------------------
+static void paramConv_transFreq(void* target, uint8_t value)
+{
+	// range about  0.25 to 4 => 1/4 to 1*4
+	*(float*)target = 1.f + ((value/33.9f)-0.75f);
+}
+//####################################################################
+// one entry per parameter number. the front panel sends its values as midi CCs,
+// so front panel, midi, nrpn and automation all end up here
+//####################################################################
+//the same member of all 6 voices
+#define PAR_VOICES(par, member, conv) \
+	[(par)+0] = {&voiceArray[0].member, conv}, \
+	[(par)+1] = {&voiceArray[1].member, conv}, \
+	[(par)+2] = {&voiceArray[2].member, conv}, \
+	[(par)+3] = {&snareVoice.member, 	conv}, \
+	[(par)+4] = {&cymbalVoice.member, 	conv}, \
+	[(par)+5] = {&hatVoice.member, 		conv}
+
+#define PAR_DRUMS(par, member, conv) \
+	[(par)+0] = {&voiceArray[0].member, conv}, \
+	[(par)+1] = {&voiceArray[1].member, conv}, \
+	[(par)+2] = {&voiceArray[2].member, conv}
+
+#define PAR_ARRAY6(par, array, conv) \
+	[(par)+0] = {&(array)[0], conv}, \
+	[(par)+1] = {&(array)[1], conv}, \
+	[(par)+2] = {&(array)[2], conv}, \
+	[(par)+3] = {&(array)[3], conv}, \
+	[(par)+4] = {&(array)[4], conv}, \
+	[(par)+5] = {&(array)[5], conv}
+
+const ParamDispatch paramArray_dispatch[END_OF_SOUND_PARAMETERS] =
+{
+	PAR_DRUMS(PAR_OSC_WAVE_DRUM1, 	osc.waveform, 			paramConv_uint8),
+	[PAR_OSC_WAVE_SNARE] 		= {&snareVoice.osc.waveform, 		paramConv_uint8},
+	[PAR_WAVE1_CYM] 			= {&cymbalVoice.osc.waveform, 		paramConv_uint8},
+	[PAR_WAVE1_HH] 				= {&hatVoice.osc.waveform, 			paramConv_uint8},
+
+	[PAR_COARSE1] 				= {&voiceArray[0].osc, 				paramConv_oscCoarse},
+	[PAR_FINE1] 				= {&voiceArray[0].osc, 				paramConv_oscFine},
+	[PAR_COARSE2] 				= {&voiceArray[1].osc, 				paramConv_oscCoarse},
+	[PAR_FINE2] 				= {&voiceArray[1].osc, 				paramConv_oscFine},
+	[PAR_COARSE3] 				= {&voiceArray[2].osc, 				paramConv_oscCoarse},
+	[PAR_FINE3] 				= {&voiceArray[2].osc, 				paramConv_oscFine},
+	[PAR_COARSE4] 				= {&snareVoice.osc, 				paramConv_oscCoarse},
+	[PAR_FINE4] 				= {&snareVoice.osc, 				paramConv_oscFine},
+	[PAR_COARSE5] 				= {&cymbalVoice.osc, 				paramConv_oscCoarse},
+	[PAR_FINE5] 				= {&cymbalVoice.osc, 				paramConv_oscFine},
+	[PAR_COARSE6] 				= {&hatVoice.osc, 					paramConv_oscCoarse},
+	[PAR_FINE6] 				= {&hatVoice.osc, 					paramConv_oscFine},
+
+	PAR_DRUMS(PAR_MOD_WAVE_DRUM1, 	modOsc.waveform, 		paramConv_uint8),
+	[PAR_WAVE2_CYM] 			= {&cymbalVoice.modOsc.waveform, 	paramConv_uint8},
+	[PAR_WAVE3_CYM] 			= {&cymbalVoice.modOsc2.waveform, 	paramConv_uint8},
+	[PAR_WAVE2_HH] 				= {&hatVoice.modOsc.waveform, 		paramConv_uint8},
+	[PAR_WAVE3_HH] 				= {&hatVoice.modOsc2.waveform, 		paramConv_uint8},
+
+	[PAR_NOISE_FREQ1] 			= {&snareVoice.noiseOsc, 			paramConv_noiseFreq},
+	[PAR_MIX1] 					= {&snareVoice.mix, 				paramConv_norm},
+
+	[PAR_MOD_OSC_F1_CYM] 		= {&cymbalVoice.modOsc, 			paramConv_oscCoarse},
+	[PAR_MOD_OSC_F2_CYM] 		= {&cymbalVoice.modOsc2, 			paramConv_oscCoarse},
+	[PAR_MOD_OSC_GAIN1_CYM] 	= {&cymbalVoice.fmModAmount1, 		paramConv_norm},
+	[PAR_MOD_OSC_GAIN2_CYM] 	= {&cymbalVoice.fmModAmount2, 		paramConv_norm},
+	[PAR_MOD_OSC_F1] 			= {&hatVoice.modOsc, 				paramConv_oscCoarse},
+	[PAR_MOD_OSC_F2] 			= {&hatVoice.modOsc2, 				paramConv_oscCoarse},
+	[PAR_MOD_OSC_GAIN1] 		= {&hatVoice.fmModAmount1, 			paramConv_norm},
+	[PAR_MOD_OSC_GAIN2] 		= {&hatVoice.fmModAmount2, 			paramConv_norm},
+
+	PAR_DRUMS(PAR_FILTER_FREQ_1, 	filter, 				paramConv_filterFreq),
+	[PAR_FILTER_FREQ_4] 		= {&snareVoice.filter, 				paramConv_snareFilterFreq},
+	[PAR_FILTER_FREQ_5] 		= {&cymbalVoice.filter, 			paramConv_filterFreq},
+	[PAR_FILTER_FREQ_6] 		= {&hatVoice.filter, 				paramConv_filterFreq},
+	PAR_DRUMS(PAR_RESO_1, 			filter, 				paramConv_reso),
+	[PAR_RESO_4] 				= {&snareVoice.filter, 				paramConv_snareReso},
+	[PAR_RESO_5] 				= {&cymbalVoice.filter, 			paramConv_reso},
+	[PAR_RESO_6] 				= {&hatVoice.filter, 				paramConv_reso},
+
+	[PAR_VELOA1] 				= {&voiceArray[0].oscVolEg, 		paramConv_ampAttackSync},
+	[PAR_VELOD1] 				= {&voiceArray[0].oscVolEg, 		paramConv_ampDecaySync},
+	[PAR_VELOA2] 				= {&voiceArray[1].oscVolEg, 		paramConv_ampAttackSync},
+	[PAR_VELOD2] 				= {&voiceArray[1].oscVolEg, 		paramConv_ampDecaySync},
+	[PAR_VELOA3] 				= {&voiceArray[2].oscVolEg, 		paramConv_ampAttackSync},
+	[PAR_VELOD3] 				= {&voiceArray[2].oscVolEg, 		paramConv_ampDecaySync},
+	[PAR_VELOA4] 				= {&snareVoice.oscVolEg, 			paramConv_ampAttack},
+	[PAR_VELOD4] 				= {&snareVoice.oscVolEg, 			paramConv_ampDecay},
+	[PAR_VELOA5] 				= {&cymbalVoice.oscVolEg, 			paramConv_ampAttack},
+	[PAR_VELOD5] 				= {&cymbalVoice.oscVolEg, 			paramConv_ampDecay},
+	[PAR_VELOA6] 				= {&hatVoice.oscVolEg, 				paramConv_ampAttack},
+	[PAR_VELOD6_CLOSED] 		= {&hatVoice.decayClosed, 			paramConv_ampDecayTime},
+	[PAR_VELOD6_OPEN] 			= {&hatVoice.decayOpen, 			paramConv_ampDecayTime},
+
+	PAR_VOICES(PAR_VOL_SLOPE1, 		oscVolEg, 				paramConv_ampSlope),
+	[PAR_REPEAT4] 				= {&snareVoice.oscVolEg.repeat, 	paramConv_uint8},
+	[PAR_REPEAT5] 				= {&cymbalVoice.oscVolEg.repeat, 	paramConv_uint8},
+
+	PAR_DRUMS(PAR_MOD_EG1, 			oscPitchEg, 			paramConv_pitchDecay),
+	[PAR_MOD_EG4] 				= {&snareVoice.oscPitchEg, 			paramConv_pitchDecay},
+	PAR_DRUMS(PAR_MODAMNT1, 		egPitchModAmount, 		paramConv_pitchModAmount),
+	[PAR_MODAMNT4] 				= {&snareVoice.egPitchModAmount, 	paramConv_pitchModAmount},
+	PAR_DRUMS(PAR_PITCH_SLOPE1, 	oscPitchEg, 			paramConv_pitchSlope),
+	[PAR_PITCH_SLOPE4] 			= {&snareVoice.oscPitchEg, 			paramConv_pitchSlope},
+
+	[PAR_FMAMNT1] 				= {&voiceArray[0].fmModAmount, 		paramConv_norm},
+	[PAR_FM_FREQ1] 				= {&voiceArray[0].modOsc, 			paramConv_oscCoarse},
+	[PAR_FMAMNT2] 				= {&voiceArray[1].fmModAmount, 		paramConv_norm},
+	[PAR_FM_FREQ2] 				= {&voiceArray[1].modOsc, 			paramConv_oscCoarse},
+	[PAR_FMAMNT3] 				= {&voiceArray[2].fmModAmount, 		paramConv_norm},
+	[PAR_FM_FREQ3] 				= {&voiceArray[2].modOsc, 			paramConv_oscCoarse},
+
+	PAR_VOICES(PAR_VOL1, 			vol, 					paramConv_norm),
+
+	[PAR_PAN1] 					= {&voiceArray[0], 					paramConv_drumPan},
+	[PAR_PAN2] 					= {&voiceArray[1], 					paramConv_drumPan},
+	[PAR_PAN3] 					= {&voiceArray[2], 					paramConv_drumPan},
+	[PAR_PAN4] 					= {&snareVoice, 					paramConv_snarePan},
+	[PAR_PAN5] 					= {&cymbalVoice, 					paramConv_cymbalPan},
+	[PAR_PAN6] 					= {&hatVoice, 						paramConv_hatPan},
+
+	[PAR_DRIVE1] 				= {&voiceArray[0], 					paramConv_drumDrive},
+	[PAR_DRIVE2] 				= {&voiceArray[1], 					paramConv_drumDrive},
+	[PAR_DRIVE3] 				= {&voiceArray[2], 					paramConv_drumDrive},
+	[PAR_SNARE_DISTORTION] 		= {&snareVoice.distortion, 			paramConv_distortion},
+	[PAR_CYMBAL_DISTORTION] 	= {&cymbalVoice.distortion, 		paramConv_distortion},
+	[PAR_HAT_DISTORTION] 		= {&hatVoice.distortion, 			paramConv_distortion},
+
+	PAR_ARRAY6(PAR_VOICE_DECIMATION1, mixer_decimation_rate, paramConv_decimation),
+	[PAR_VOICE_DECIMATION_ALL] 	= {&mixer_decimation_rate[NUM_SYNTH_VOICES], paramConv_decimation},
+
+	PAR_VOICES(PAR_FREQ_LFO1, 		lfo, 					paramConv_lfoFreq),
+	PAR_VOICES(PAR_AMOUNT_LFO1, 	lfo.modTarget.amount, 	paramConv_norm),
+
+	//parameters above 127, sent as MIDI_CC2
+	PAR_VOICES(PAR_FILTER_DRIVE_1, 	filter, 				paramConv_filterDrive),
+	PAR_DRUMS(PAR_MIX_MOD_1, 		mixOscs, 				paramConv_uint8),
+	PAR_VOICES(PAR_VOLUME_MOD_ON_OFF1, volumeMod, 			paramConv_uint8),
+	[PAR_VELO_MOD_AMT_1] 		= {&velocityModulators[0].amount, 	paramConv_norm},
+	[PAR_VELO_MOD_AMT_2] 		= {&velocityModulators[1].amount, 	paramConv_norm},
+	[PAR_VELO_MOD_AMT_3] 		= {&velocityModulators[2].amount, 	paramConv_norm},
+	[PAR_VELO_MOD_AMT_4] 		= {&velocityModulators[3].amount, 	paramConv_norm},
+	[PAR_VELO_MOD_AMT_5] 		= {&velocityModulators[4].amount, 	paramConv_norm},
+	[PAR_VELO_MOD_AMT_6] 		= {&velocityModulators[5].amount, 	paramConv_norm},
+	PAR_VOICES(PAR_WAVE_LFO1, 		lfo.waveform, 			paramConv_uint8),
+	PAR_VOICES(PAR_RETRIGGER_LFO1, 	lfo.retrigger, 			paramConv_uint8),
+	PAR_VOICES(PAR_SYNC_LFO1, 		lfo, 					paramConv_lfoSync),
+	PAR_VOICES(PAR_OFFSET_LFO1, 	lfo.phaseOffset, 		paramConv_lfoOffset),
+	PAR_VOICES(PAR_FILTER_TYPE_1, 	filterType, 			paramConv_filterType),
+	PAR_VOICES(PAR_TRANS1_VOL, 		transGen.volume, 		paramConv_norm),
+	PAR_VOICES(PAR_TRANS1_WAVE, 	transGen, 				paramConv_transWave),
+	PAR_VOICES(PAR_TRANS1_FREQ, 	transGen.pitch, 		paramConv_transFreq),
+	PAR_ARRAY6(PAR_AUDIO_OUT1, 		mixer_audioRouting, 	paramConv_uint8),
+	PAR_ARRAY6(PAR_MIDI_NOTE1, 		midi_NoteOverride, 		paramConv_uint8),
+	[PAR_MIDI_NOTE7] 			= {&midi_NoteOverride[6], 			paramConv_uint8},
+};
+//---------------------------------------------------------------------
+void paramArray_dispatchValue(uint16_t idx, uint8_t value)
+{
+	if(idx>=END_OF_SOUND_PARAMETERS || paramArray_dispatch[idx].set==0) return;
+	paramArray_dispatch[idx].set(paramArray_dispatch[idx].target, value);
+}
+//---------------------------------------------------------------------
+void paramArray_queueValue(uint16_t idx, uint8_t value)
+{
+	if(idx>=END_OF_SOUND_PARAMETERS || paramArray_dispatch[idx].set==0) return;
+	paramArray_queuedValue[idx] = value;
+	paramArray_dirty[idx>>5] |= 1UL<<(idx&31);
+}
+//---------------------------------------------------------------------
+void paramArray_applyQueued()
+{
+	uint8_t i;
+	for(i=0;i<(END_OF_SOUND_PARAMETERS+31)/32;i++)
+	{
+		uint32_t dirty = paramArray_dirty[i];
+		if(!dirty) continue;
+		paramArray_dirty[i] = 0;
+
+		while(dirty)
+		{
+			//lowest set bit first
+			const uint8_t bit = 31-__CLZ(dirty & -dirty);
+			const uint16_t idx = i*32 + bit;
+			dirty &= dirty-1;
+
+			paramArray_dispatchValue(idx, paramArray_queuedValue[idx]);
+			modNode_originalValueChanged(idx);
+		}
+	}
+}
 //the parameter numbers from the AVR/Frontpanel
 //####################################################################
 void paramArray_setParameter(uint16_t idx, ptrValue newValue)
@@ -81,61 +466,106 @@ void paramArray_setParameter(uint16_t idx, ptrValue newValue)
 //---------------------------------------------------------------------
 void parameterArray_init()
 {
+	//parameters every voice has
+	uint8_t i;
+	for(i=0;i<NUM_SYNTH_VOICES;i++)
+	{
+		const VoiceDesc* v = &voiceTable[i];
 
-	parameterArray[PAR_OSC_WAVE_DRUM1].ptr 	= &voiceArray[0].osc.waveform;
-	parameterArray[PAR_OSC_WAVE_DRUM1].type = TYPE_UINT8;
+		parameterArray[PAR_COARSE1+2*i].ptr 		= &v->osc->modNodeValue;
+		parameterArray[PAR_COARSE1+2*i].type 		= TYPE_SPECIAL_F;
 
-	parameterArray[PAR_OSC_WAVE_DRUM2].ptr 	= &voiceArray[1].osc.waveform;
-	parameterArray[PAR_OSC_WAVE_DRUM2].type = TYPE_UINT8;
+		parameterArray[PAR_FINE1+2*i].ptr 			= &v->osc->modNodeValue;
+		parameterArray[PAR_FINE1+2*i].type 			= TYPE_SPECIAL_F;
 
-	parameterArray[PAR_OSC_WAVE_DRUM3].ptr 	= &voiceArray[2].osc.waveform;
-	parameterArray[PAR_OSC_WAVE_DRUM3].type = TYPE_UINT8;
+		parameterArray[PAR_FILTER_FREQ_1+i].ptr 	= &v->filter->f;
+		parameterArray[PAR_FILTER_FREQ_1+i].type 	= TYPE_FLT;//TYPE_SPECIAL_FILTER_F;
 
-	parameterArray[PAR_OSC_WAVE_SNARE].ptr 	= &snareVoice.osc.waveform;;
-	parameterArray[PAR_OSC_WAVE_SNARE].type = TYPE_UINT8;
+		parameterArray[PAR_RESO_1+i].ptr 			= &v->filter->q;
+		parameterArray[PAR_RESO_1+i].type 			= TYPE_FLT;
 
-	parameterArray[PAR_WAVE1_CYM].ptr 		= &cymbalVoice.osc.waveform;
-	parameterArray[PAR_WAVE1_CYM].type 		= TYPE_UINT8;
+		parameterArray[PAR_VOL_SLOPE1+i].ptr 		= &v->volEg->slope;
+		parameterArray[PAR_VOL_SLOPE1+i].type 		= TYPE_FLT;
 
-	parameterArray[PAR_WAVE1_HH].ptr 		=  &hatVoice.osc.waveform;
-	parameterArray[PAR_WAVE1_HH].type 		= TYPE_UINT8;
+		parameterArray[PAR_VOL1+i].ptr 				= v->vol;
+		parameterArray[PAR_VOL1+i].type				= TYPE_FLT;
+
+		//the nrpn parameters sit between pan 3 and pan 4
+		const uint16_t panIdx = i<3 ? PAR_PAN1+i : PAR_PAN4+(i-3);
+		parameterArray[panIdx].ptr 					= v->pan;
+		parameterArray[panIdx].type 				= TYPE_UINT8;
+
+		//PAR_DRIVE1..3 are followed by snare, cymbal and hat distortion
+		parameterArray[PAR_DRIVE1+i].ptr 			= &v->distortion->shape;
+		parameterArray[PAR_DRIVE1+i].type 			= TYPE_FLT;
+
+		parameterArray[PAR_VOICE_DECIMATION1+i].ptr = &mixer_decimation_rate[i];
+		parameterArray[PAR_VOICE_DECIMATION1+i].type = TYPE_FLT;
 
+		parameterArray[PAR_FREQ_LFO1+i].ptr 		= &v->lfo->modNodeValue;
+		parameterArray[PAR_FREQ_LFO1+i].type 		= TYPE_SPECIAL_F;//TYPE_FLT;
 
-	parameterArray[PAR_COARSE1].ptr 		= &voiceArray[0].osc.modNodeValue;
-	parameterArray[PAR_COARSE1].type 		= TYPE_SPECIAL_F;
+		parameterArray[PAR_AMOUNT_LFO1+i].ptr 		= &v->lfo->modTarget.amount;
+		parameterArray[PAR_AMOUNT_LFO1+i].type 		= TYPE_FLT;
 
-	parameterArray[PAR_FINE1].ptr 			= &voiceArray[0].osc.modNodeValue;
-	parameterArray[PAR_FINE1].type 			= TYPE_SPECIAL_F;
+		parameterArray[PAR_FILTER_DRIVE_1+i].ptr 	= &v->filter->drive;
+		parameterArray[PAR_FILTER_DRIVE_1+i].type 	= TYPE_FLT;
 
-	parameterArray[PAR_COARSE2].ptr 		= &voiceArray[1].osc.modNodeValue;
-	parameterArray[PAR_COARSE2].type 		= TYPE_SPECIAL_F;
+		parameterArray[PAR_VOLUME_MOD_ON_OFF1+i].ptr = v->volumeMod;
+		parameterArray[PAR_VOLUME_MOD_ON_OFF1+i].type = TYPE_UINT8;
 
-	parameterArray[PAR_FINE2].ptr 			= &voiceArray[1].osc.modNodeValue;
-	parameterArray[PAR_FINE2].type 			= TYPE_SPECIAL_F;
+		parameterArray[PAR_VELO_MOD_AMT_1+i].ptr 	= &velocityModulators[i].amount;
+		parameterArray[PAR_VELO_MOD_AMT_1+i].type 	= TYPE_FLT;
 
-	parameterArray[PAR_COARSE3].ptr 		= &voiceArray[2].osc.modNodeValue;
-	parameterArray[PAR_COARSE3].type 		= TYPE_SPECIAL_F;
+		parameterArray[PAR_VEL_DEST_1+i].ptr 		= &velocityModulators[i].destination;
+		parameterArray[PAR_VEL_DEST_1+i].type 		= TYPE_UINT8;
 
-	parameterArray[PAR_FINE3].ptr 			= &voiceArray[2].osc.modNodeValue;
-	parameterArray[PAR_FINE3].type 			= TYPE_SPECIAL_F;
+		parameterArray[PAR_WAVE_LFO1+i].ptr 		= &v->lfo->waveform;
+		parameterArray[PAR_WAVE_LFO1+i].type 		= TYPE_UINT8;
 
-	parameterArray[PAR_COARSE4].ptr 		= &snareVoice.osc.modNodeValue;
-	parameterArray[PAR_COARSE4].type 		= TYPE_SPECIAL_F;
+		parameterArray[PAR_RETRIGGER_LFO1+i].ptr 	= &v->lfo->retrigger;
+		parameterArray[PAR_RETRIGGER_LFO1+i].type 	= TYPE_UINT8;
 
-	parameterArray[PAR_FINE4].ptr 			= &snareVoice.osc.modNodeValue;
-	parameterArray[PAR_FINE4].type 			= TYPE_SPECIAL_F;
+		parameterArray[PAR_SYNC_LFO1+i].ptr 		= &v->lfo->sync;
+		parameterArray[PAR_SYNC_LFO1+i].type 		= TYPE_UINT8;
 
-	parameterArray[PAR_COARSE5].ptr 		= &cymbalVoice.osc.modNodeValue;
-	parameterArray[PAR_COARSE5].type 		= TYPE_SPECIAL_F;
+		parameterArray[PAR_OFFSET_LFO1+i].ptr 		= &v->lfo->phaseOffset;
+		parameterArray[PAR_OFFSET_LFO1+i].type 		= TYPE_UINT32;
 
-	parameterArray[PAR_FINE5].ptr 			= &cymbalVoice.osc.modNodeValue;
-	parameterArray[PAR_FINE5].type		 	= TYPE_SPECIAL_F;
+		parameterArray[PAR_FILTER_TYPE_1+i].ptr 	= v->filterType;
+		parameterArray[PAR_FILTER_TYPE_1+i].type 	= TYPE_UINT8;
 
-	parameterArray[PAR_COARSE6].ptr 		= &hatVoice.osc.modNodeValue;
-	parameterArray[PAR_COARSE6].type 		= TYPE_SPECIAL_F;
+		parameterArray[PAR_TRANS1_VOL+i].ptr 		= &v->transGen->volume;
+		parameterArray[PAR_TRANS1_VOL+i].type 		= TYPE_FLT;
 
-	parameterArray[PAR_FINE6].ptr 			= &hatVoice.osc.modNodeValue;
-	parameterArray[PAR_FINE6].type 			= TYPE_SPECIAL_F;
+		parameterArray[PAR_TRANS1_WAVE+i].ptr 		= &v->transGen->waveform;
+		parameterArray[PAR_TRANS1_WAVE+i].type 		= TYPE_UINT8;
+
+		parameterArray[PAR_TRANS1_FREQ+i].ptr 		= &v->transGen->pitch;
+		parameterArray[PAR_TRANS1_FREQ+i].type 		= TYPE_FLT;
+
+		parameterArray[PAR_AUDIO_OUT1+i].ptr 		= &mixer_audioRouting[i];
+		parameterArray[PAR_AUDIO_OUT1+i].type 		= TYPE_UINT8;
+	}
+
+	//voice specific parameters
+	parameterArray[PAR_OSC_WAVE_DRUM1].ptr 	= &voiceArray[0].osc.waveform;
+	parameterArray[PAR_OSC_WAVE_DRUM1].type = TYPE_UINT8;
+
+	parameterArray[PAR_OSC_WAVE_DRUM2].ptr 	= &voiceArray[1].osc.waveform;
+	parameterArray[PAR_OSC_WAVE_DRUM2].type = TYPE_UINT8;
+
+	parameterArray[PAR_OSC_WAVE_DRUM3].ptr 	= &voiceArray[2].osc.waveform;
+	parameterArray[PAR_OSC_WAVE_DRUM3].type = TYPE_UINT8;
+
+	parameterArray[PAR_OSC_WAVE_SNARE].ptr 	= &snareVoice.osc.waveform;;
+	parameterArray[PAR_OSC_WAVE_SNARE].type = TYPE_UINT8;
+
+	parameterArray[PAR_WAVE1_CYM].ptr 		= &cymbalVoice.osc.waveform;
+	parameterArray[PAR_WAVE1_CYM].type 		= TYPE_UINT8;
+
+	parameterArray[PAR_WAVE1_HH].ptr 		=  &hatVoice.osc.waveform;
+	parameterArray[PAR_WAVE1_HH].type 		= TYPE_UINT8;
 
 
 	parameterArray[PAR_MOD_WAVE_DRUM1].ptr 	= &voiceArray[0].modOsc.waveform;
@@ -148,7 +578,6 @@ void parameterArray_init()
 	parameterArray[PAR_MOD_WAVE_DRUM3].type = TYPE_UINT8;
 
 
-
 	parameterArray[PAR_WAVE2_CYM].ptr 		= &cymbalVoice.modOsc.waveform;
 	parameterArray[PAR_WAVE2_CYM].type 		= TYPE_UINT8;
 
@@ -190,43 +619,6 @@ void parameterArray_init()
 	parameterArray[PAR_MOD_OSC_GAIN2].ptr 	= &hatVoice.fmModAmount2;
 	parameterArray[PAR_MOD_OSC_GAIN2].type 	= TYPE_FLT;
 
-	parameterArray[PAR_FILTER_FREQ_1].ptr 	= &voiceArray[0].filter.f;
-	parameterArray[PAR_FILTER_FREQ_1].type 	= TYPE_FLT;//TYPE_SPECIAL_FILTER_F;
-
-	parameterArray[PAR_FILTER_FREQ_2].ptr 	= &voiceArray[1].filter.f;
-	parameterArray[PAR_FILTER_FREQ_2].type 	= TYPE_FLT;//TYPE_SPECIAL_FILTER_F;
-
-	parameterArray[PAR_FILTER_FREQ_3].ptr 	= &voiceArray[2].filter.f;
-	parameterArray[PAR_FILTER_FREQ_3].type 	= TYPE_FLT;//TYPE_SPECIAL_FILTER_F;
-
-	parameterArray[PAR_FILTER_FREQ_4].ptr 	= &snareVoice.filter.f;
-	parameterArray[PAR_FILTER_FREQ_4].type 	= TYPE_FLT;//TYPE_SPECIAL_FILTER_F;
-
-	parameterArray[PAR_FILTER_FREQ_5].ptr 	= &cymbalVoice.filter.f;
-	parameterArray[PAR_FILTER_FREQ_5].type 	= TYPE_FLT;//TYPE_SPECIAL_FILTER_F;
-
-	parameterArray[PAR_FILTER_FREQ_6].ptr 	= &hatVoice.filter.f;
-	parameterArray[PAR_FILTER_FREQ_6].type 	= TYPE_FLT;//TYPE_SPECIAL_FILTER_F;
-
-	parameterArray[PAR_RESO_1].ptr 			= &voiceArray[0].filter.q;
-	parameterArray[PAR_RESO_1].type 		= TYPE_FLT;
-
-	parameterArray[PAR_RESO_2].ptr 			= &voiceArray[1].filter.q;
-	parameterArray[PAR_RESO_2].type 		= TYPE_FLT;
-
-	parameterArray[PAR_RESO_3].ptr 			= &voiceArray[2].filter.q;
-	parameterArray[PAR_RESO_3].type 		= TYPE_FLT;
-
-	parameterArray[PAR_RESO_4].ptr 			= &snareVoice.filter.q;
-	parameterArray[PAR_RESO_4].type 		= TYPE_FLT;
-
-
-	parameterArray[PAR_RESO_5].ptr 			= &cymbalVoice.filter.q;
-	parameterArray[PAR_RESO_5].type 		= TYPE_FLT;
-
-	parameterArray[PAR_RESO_6].ptr 			= &hatVoice.filter.q;
-	parameterArray[PAR_RESO_6].type 		= TYPE_FLT;
-
 	parameterArray[PAR_VELOA1].ptr 			= &voiceArray[0].oscVolEg.attack;
 	parameterArray[PAR_VELOA1].type 		= TYPE_FLT;
 
@@ -266,24 +658,6 @@ void parameterArray_init()
 	parameterArray[PAR_VELOD6_OPEN].ptr 	= &hatVoice.decayOpen;
 	parameterArray[PAR_VELOD6_OPEN].type 	= TYPE_FLT;
 
-	parameterArray[PAR_VOL_SLOPE1].ptr 		= &voiceArray[0].oscVolEg.slope;
-	parameterArray[PAR_VOL_SLOPE1].type 	= TYPE_FLT;
-
-	parameterArray[PAR_VOL_SLOPE2].ptr 		= &voiceArray[1].oscVolEg.slope;
-	parameterArray[PAR_VOL_SLOPE2].type 	= TYPE_FLT;
-
-	parameterArray[PAR_VOL_SLOPE3].ptr 		= &voiceArray[2].oscVolEg.slope;
-	parameterArray[PAR_VOL_SLOPE3].type 	= TYPE_FLT;
-
-	parameterArray[PAR_VOL_SLOPE4].ptr 		= &snareVoice.oscVolEg.slope;
-	parameterArray[PAR_VOL_SLOPE4].type 	= TYPE_FLT;
-
-	parameterArray[PAR_VOL_SLOPE5].ptr 		= &cymbalVoice.oscVolEg.slope;
-	parameterArray[PAR_VOL_SLOPE5].type 	= TYPE_FLT;
-
-	parameterArray[PAR_VOL_SLOPE6].ptr 		= &hatVoice.oscVolEg.slope;
-	parameterArray[PAR_VOL_SLOPE6].type 	= TYPE_FLT;
-
 	parameterArray[PAR_REPEAT4].ptr 		= &snareVoice.oscVolEg.repeat;
 	parameterArray[PAR_REPEAT4].type 		= TYPE_UINT8;
 
@@ -341,114 +715,13 @@ void parameterArray_init()
 	parameterArray[PAR_FM_FREQ3].ptr 		= &voiceArray[2].modOsc.modNodeValue;
 	parameterArray[PAR_FM_FREQ3].type 		= TYPE_SPECIAL_F;//TYPE_UINT32;
 
-
-	parameterArray[PAR_VOL1].ptr 			= &voiceArray[0].vol;
-	parameterArray[PAR_VOL1].type			= TYPE_FLT;
-	parameterArray[PAR_VOL2].ptr 			= &voiceArray[1].vol;
-	parameterArray[PAR_VOL2].type			= TYPE_FLT;
-	parameterArray[PAR_VOL3].ptr 			= &voiceArray[2].vol;
-	parameterArray[PAR_VOL3].type			= TYPE_FLT;
-	parameterArray[PAR_VOL4].ptr 			= &snareVoice.vol;
-	parameterArray[PAR_VOL4].type 			= TYPE_FLT;
-	parameterArray[PAR_VOL5].ptr 			= &cymbalVoice.vol;
-	parameterArray[PAR_VOL5].type 			= TYPE_FLT;
-	parameterArray[PAR_VOL6].ptr 			= &hatVoice.vol;
-	parameterArray[PAR_VOL6].type 			= TYPE_FLT;
-
-	parameterArray[PAR_PAN1].ptr 			= &voiceArray[0].pan;
-	parameterArray[PAR_PAN1].type 			= TYPE_UINT8;
-	parameterArray[PAR_PAN2].ptr 			= &voiceArray[1].pan;
-	parameterArray[PAR_PAN2].type 			= TYPE_UINT8;
-	parameterArray[PAR_PAN3].ptr 			= &voiceArray[2].pan;
-	parameterArray[PAR_PAN3].type 			= TYPE_UINT8;
-	parameterArray[PAR_PAN4].ptr 			= &snareVoice.pan;
-	parameterArray[PAR_PAN4].type 			= TYPE_UINT8;
-	parameterArray[PAR_PAN5].ptr 			= &cymbalVoice.pan;
-	parameterArray[PAR_PAN5].type 			= TYPE_UINT8;
-	parameterArray[PAR_PAN6].ptr 			= &hatVoice.pan;
-	parameterArray[PAR_PAN6].type 			= TYPE_UINT8;
-
-	parameterArray[PAR_DRIVE1].ptr 			= &voiceArray[0].distortion.shape;
-	parameterArray[PAR_DRIVE1].type 		= TYPE_FLT;
-
-	parameterArray[PAR_DRIVE2].ptr 			= &voiceArray[1].distortion.shape;
-	parameterArray[PAR_DRIVE2].type 		= TYPE_FLT;
-
-	parameterArray[PAR_DRIVE3].ptr 			= &voiceArray[2].distortion.shape;
-	parameterArray[PAR_DRIVE3].type 		= TYPE_FLT;
-
-	parameterArray[PAR_SNARE_DISTORTION].ptr 	= &snareVoice.distortion.shape;
-	parameterArray[PAR_SNARE_DISTORTION].type 	= TYPE_FLT;
-
-	parameterArray[PAR_CYMBAL_DISTORTION].ptr 	= &cymbalVoice.distortion.shape;
-	parameterArray[PAR_CYMBAL_DISTORTION].type 	= TYPE_FLT;
-
-	parameterArray[PAR_HAT_DISTORTION].ptr 		= &hatVoice.distortion.shape;
-	parameterArray[PAR_HAT_DISTORTION].type 	= TYPE_FLT;
-
-	parameterArray[PAR_VOICE_DECIMATION1].ptr 	= &mixer_decimation_rate[0];
-	parameterArray[PAR_VOICE_DECIMATION1].type 	= TYPE_FLT;
-	parameterArray[PAR_VOICE_DECIMATION2].ptr 	= &mixer_decimation_rate[1];
-	parameterArray[PAR_VOICE_DECIMATION2].type 	= TYPE_FLT;
-	parameterArray[PAR_VOICE_DECIMATION3].ptr 	= &mixer_decimation_rate[2];
-	parameterArray[PAR_VOICE_DECIMATION3].type 	= TYPE_FLT;
-	parameterArray[PAR_VOICE_DECIMATION4].ptr 	= &mixer_decimation_rate[3];
-	parameterArray[PAR_VOICE_DECIMATION4].type 	= TYPE_FLT;
-	parameterArray[PAR_VOICE_DECIMATION5].ptr 	= &mixer_decimation_rate[4];
-	parameterArray[PAR_VOICE_DECIMATION5].type 	= TYPE_FLT;
-	parameterArray[PAR_VOICE_DECIMATION6].ptr 	= &mixer_decimation_rate[5];
-	parameterArray[PAR_VOICE_DECIMATION6].type 	= TYPE_FLT;
-	parameterArray[PAR_VOICE_DECIMATION_ALL].ptr= &mixer_decimation_rate[6];
+	parameterArray[PAR_VOICE_DECIMATION_ALL].ptr= &mixer_decimation_rate[NUM_SYNTH_VOICES];
 	parameterArray[PAR_VOICE_DECIMATION_ALL].type 	= TYPE_FLT;
-
-	parameterArray[PAR_FREQ_LFO1].ptr 		= &voiceArray[0].lfo.modNodeValue;
-	parameterArray[PAR_FREQ_LFO1].type 		= TYPE_SPECIAL_F;//TYPE_FLT;
-	parameterArray[PAR_FREQ_LFO2].ptr 		= &voiceArray[1].lfo.modNodeValue;
-	parameterArray[PAR_FREQ_LFO2].type 		= TYPE_SPECIAL_F;//TYPE_FLT;
-	parameterArray[PAR_FREQ_LFO3].ptr 		= &voiceArray[2].lfo.modNodeValue;
-	parameterArray[PAR_FREQ_LFO3].type 		= TYPE_SPECIAL_F;//TYPE_FLT;
-	parameterArray[PAR_FREQ_LFO4].ptr 		= &snareVoice.lfo.modNodeValue;
-	parameterArray[PAR_FREQ_LFO4].type 		= TYPE_SPECIAL_F;//TYPE_FLT;
-	parameterArray[PAR_FREQ_LFO5].ptr 		= &cymbalVoice.lfo.modNodeValue;
-	parameterArray[PAR_FREQ_LFO5].type 		= TYPE_SPECIAL_F;//TYPE_FLT;
-	parameterArray[PAR_FREQ_LFO6].ptr 		= &hatVoice.lfo.modNodeValue;
-	parameterArray[PAR_FREQ_LFO6].type 		= TYPE_SPECIAL_F;//TYPE_FLT;
-
-	parameterArray[PAR_AMOUNT_LFO1].ptr 	= &voiceArray[0].lfo.modTarget.amount;
-	parameterArray[PAR_AMOUNT_LFO1].type 	= TYPE_FLT;
-	parameterArray[PAR_AMOUNT_LFO2].ptr 	= &voiceArray[1].lfo.modTarget.amount;
-	parameterArray[PAR_AMOUNT_LFO2].type 	= TYPE_FLT;
-	parameterArray[PAR_AMOUNT_LFO3].ptr 	= &voiceArray[2].lfo.modTarget.amount;
-	parameterArray[PAR_AMOUNT_LFO3].type 	= TYPE_FLT;
-	parameterArray[PAR_AMOUNT_LFO4].ptr 	= &snareVoice.lfo.modTarget.amount;
-	parameterArray[PAR_AMOUNT_LFO4].type 	= TYPE_FLT;
-	parameterArray[PAR_AMOUNT_LFO5].ptr 	= &cymbalVoice.lfo.modTarget.amount;
-	parameterArray[PAR_AMOUNT_LFO5].type 	= TYPE_FLT;
-	parameterArray[PAR_AMOUNT_LFO6].ptr 	= &hatVoice.lfo.modTarget.amount;
-	parameterArray[PAR_AMOUNT_LFO6].type 	= TYPE_FLT;
 	//######################################
 	//######## END OF MIDI DATASIZE ########
 	//######## PARAM NR 127 REACHED ########
 	//######################################
 
-	parameterArray[PAR_FILTER_DRIVE_1].ptr 	= &voiceArray[0].filter.drive;
-	parameterArray[PAR_FILTER_DRIVE_1].type = TYPE_FLT;
-
-	parameterArray[PAR_FILTER_DRIVE_2].ptr 	= &voiceArray[1].filter.drive;
-	parameterArray[PAR_FILTER_DRIVE_2].type = TYPE_FLT;
-
-	parameterArray[PAR_FILTER_DRIVE_3].ptr 	= &voiceArray[2].filter.drive;
-	parameterArray[PAR_FILTER_DRIVE_3].type = TYPE_FLT;
-
-	parameterArray[PAR_FILTER_DRIVE_4].ptr 	= &snareVoice.filter.drive;
-	parameterArray[PAR_FILTER_DRIVE_4].type = TYPE_FLT;
-
-	parameterArray[PAR_FILTER_DRIVE_5].ptr 	= &cymbalVoice.filter.drive;
-	parameterArray[PAR_FILTER_DRIVE_5].type = TYPE_FLT;
-
-	parameterArray[PAR_FILTER_DRIVE_6].ptr 	= &hatVoice.filter.drive;
-	parameterArray[PAR_FILTER_DRIVE_6].type = TYPE_FLT;
-
 	parameterArray[PAR_MIX_MOD_1].ptr 		= &voiceArray[0].mixOscs;
 	parameterArray[PAR_MIX_MOD_1].type 		= TYPE_UINT8;
 
@@ -458,75 +731,6 @@ void parameterArray_init()
 	parameterArray[PAR_MIX_MOD_3].ptr 		= &voiceArray[2].mixOscs;
 	parameterArray[PAR_MIX_MOD_3].type 		= TYPE_UINT8;
 
-
-
-	parameterArray[PAR_VOLUME_MOD_ON_OFF1].ptr 			= &voiceArray[0].volumeMod;
-	parameterArray[PAR_VOLUME_MOD_ON_OFF1].type 		= TYPE_UINT8;
-
-	parameterArray[PAR_VOLUME_MOD_ON_OFF2].ptr 			= &voiceArray[1].volumeMod;
-	parameterArray[PAR_VOLUME_MOD_ON_OFF2].type		 	= TYPE_UINT8;
-
-	parameterArray[PAR_VOLUME_MOD_ON_OFF3].ptr 			= &voiceArray[2].volumeMod;
-	parameterArray[PAR_VOLUME_MOD_ON_OFF3].type 		= TYPE_UINT8;
-
-	parameterArray[PAR_VOLUME_MOD_ON_OFF4].ptr 			= &snareVoice.volumeMod;;
-	parameterArray[PAR_VOLUME_MOD_ON_OFF4].type 		= TYPE_UINT8;
-
-	parameterArray[PAR_VOLUME_MOD_ON_OFF5].ptr 			= &cymbalVoice.volumeMod;
-	parameterArray[PAR_VOLUME_MOD_ON_OFF5].type 		= TYPE_UINT8;
-
-	parameterArray[PAR_VOLUME_MOD_ON_OFF6].ptr 			= &hatVoice.volumeMod;
-	parameterArray[PAR_VOLUME_MOD_ON_OFF6].type 		= TYPE_UINT8;
-
-	parameterArray[PAR_VELO_MOD_AMT_1].ptr 	= &velocityModulators[0].amount;
-	parameterArray[PAR_VELO_MOD_AMT_1].type = TYPE_FLT;
-
-	parameterArray[PAR_VELO_MOD_AMT_2].ptr 	= &velocityModulators[1].amount;
-	parameterArray[PAR_VELO_MOD_AMT_2].type = TYPE_FLT;
-
-	parameterArray[PAR_VELO_MOD_AMT_3].ptr 	= &velocityModulators[2].amount;
-	parameterArray[PAR_VELO_MOD_AMT_3].type = TYPE_FLT;
-
-	parameterArray[PAR_VELO_MOD_AMT_4].ptr 	= &velocityModulators[3].amount;
-	parameterArray[PAR_VELO_MOD_AMT_4].type = TYPE_FLT;
-
-	parameterArray[PAR_VELO_MOD_AMT_5].ptr 	= &velocityModulators[4].amount;
-	parameterArray[PAR_VELO_MOD_AMT_5].type = TYPE_FLT;
-
-	parameterArray[PAR_VELO_MOD_AMT_6].ptr 	= &velocityModulators[5].amount;
-	parameterArray[PAR_VELO_MOD_AMT_6].type = TYPE_FLT;
-
-	parameterArray[PAR_VEL_DEST_1].ptr 		= &velocityModulators[0].destination;
-	parameterArray[PAR_VEL_DEST_1].type 	= TYPE_UINT8;
-
-	parameterArray[PAR_VEL_DEST_2].ptr 		= &velocityModulators[1].destination;
-	parameterArray[PAR_VEL_DEST_2].type 	= TYPE_UINT8;
-
-	parameterArray[PAR_VEL_DEST_3].ptr 		= &velocityModulators[2].destination;
-	parameterArray[PAR_VEL_DEST_3].type 	= TYPE_UINT8;
-
-	parameterArray[PAR_VEL_DEST_4].ptr 		= &velocityModulators[3].destination;
-	parameterArray[PAR_VEL_DEST_4].type 	= TYPE_UINT8;
-
-	parameterArray[PAR_VEL_DEST_5].ptr 		= &velocityModulators[4].destination;
-	parameterArray[PAR_VEL_DEST_5].type 	= TYPE_UINT8;
-
-	parameterArray[PAR_VEL_DEST_6].ptr 		= &velocityModulators[5].destination;
-	parameterArray[PAR_VEL_DEST_6].type 	= TYPE_UINT8;
-
-	parameterArray[PAR_WAVE_LFO1].ptr 		= &voiceArray[0].lfo.waveform;
-	parameterArray[PAR_WAVE_LFO1].type = TYPE_UINT8;
-	parameterArray[PAR_WAVE_LFO2].ptr 		= &voiceArray[1].lfo.waveform;
-	parameterArray[PAR_WAVE_LFO2].type = TYPE_UINT8;
-	parameterArray[PAR_WAVE_LFO3].ptr 		= &voiceArray[2].lfo.waveform;
-	parameterArray[PAR_WAVE_LFO3].type = TYPE_UINT8;
-	parameterArray[PAR_WAVE_LFO4].ptr 		= &snareVoice.lfo.waveform;
-	parameterArray[PAR_WAVE_LFO4].type = TYPE_UINT8;
-	parameterArray[PAR_WAVE_LFO5].ptr 		= &cymbalVoice.lfo.waveform;
-	parameterArray[PAR_WAVE_LFO5].type = TYPE_UINT8;
-	parameterArray[PAR_WAVE_LFO6].ptr 		= &hatVoice.lfo.waveform;
-	parameterArray[PAR_WAVE_LFO6].type = TYPE_UINT8;
-
 	/*
 	PAR_VOICE_LFO1,
 	PAR_VOICE_LFO2,
@@ -543,113 +747,6 @@ void parameterArray_init()
 	PAR_TARGET_LFO6,
 	*/
 
-	parameterArray[PAR_RETRIGGER_LFO1].ptr 	= &voiceArray[0].lfo.retrigger;
-	parameterArray[PAR_RETRIGGER_LFO1].type = TYPE_UINT8;
-	parameterArray[PAR_RETRIGGER_LFO2].ptr 	= &voiceArray[1].lfo.retrigger;
-	parameterArray[PAR_RETRIGGER_LFO2].type = TYPE_UINT8;
-	parameterArray[PAR_RETRIGGER_LFO3].ptr 	= &voiceArray[2].lfo.retrigger;
-	parameterArray[PAR_RETRIGGER_LFO3].type = TYPE_UINT8;
-	parameterArray[PAR_RETRIGGER_LFO4].ptr 	= &snareVoice.lfo.retrigger;
-	parameterArray[PAR_RETRIGGER_LFO4].type = TYPE_UINT8;
-	parameterArray[PAR_RETRIGGER_LFO5].ptr 	= &cymbalVoice.lfo.retrigger;
-	parameterArray[PAR_RETRIGGER_LFO5].type = TYPE_UINT8;
-	parameterArray[PAR_RETRIGGER_LFO6].ptr 	= &hatVoice.lfo.retrigger;
-	parameterArray[PAR_RETRIGGER_LFO6].type = TYPE_UINT8;
-
-	parameterArray[PAR_SYNC_LFO1].ptr 		= &voiceArray[0].lfo.sync;
-	parameterArray[PAR_SYNC_LFO1].type		= TYPE_UINT8;
-	parameterArray[PAR_SYNC_LFO2].ptr 		= &voiceArray[1].lfo.sync;
-	parameterArray[PAR_SYNC_LFO2].type 		= TYPE_UINT8;
-	parameterArray[PAR_SYNC_LFO3].ptr 		= &voiceArray[2].lfo.sync;
-	parameterArray[PAR_SYNC_LFO3].type 		= TYPE_UINT8;
-	parameterArray[PAR_SYNC_LFO4].ptr 		= &snareVoice.lfo.sync;
-	parameterArray[PAR_SYNC_LFO4].type 		= TYPE_UINT8;
-	parameterArray[PAR_SYNC_LFO5].ptr 		= &cymbalVoice.lfo.sync;
-	parameterArray[PAR_SYNC_LFO5].type 		= TYPE_UINT8;
-	parameterArray[PAR_SYNC_LFO6].ptr 		= &hatVoice.lfo.sync;
-	parameterArray[PAR_SYNC_LFO6].type 		= TYPE_UINT8;
-
-	parameterArray[PAR_OFFSET_LFO1].ptr 	= &voiceArray[0].lfo.phaseOffset;
-	parameterArray[PAR_OFFSET_LFO1].type 	= TYPE_UINT32;
-	parameterArray[PAR_OFFSET_LFO2].ptr 	= &voiceArray[1].lfo.phaseOffset;
-	parameterArray[PAR_OFFSET_LFO2].type 	= TYPE_UINT32;
-	parameterArray[PAR_OFFSET_LFO3].ptr 	= &voiceArray[2].lfo.phaseOffset;
-	parameterArray[PAR_OFFSET_LFO3].type 	= TYPE_UINT32;
-	parameterArray[PAR_OFFSET_LFO4].ptr 	= &snareVoice.lfo.phaseOffset;
-	parameterArray[PAR_OFFSET_LFO4].type 	= TYPE_UINT32;
-	parameterArray[PAR_OFFSET_LFO5].ptr 	= &cymbalVoice.lfo.phaseOffset;
-	parameterArray[PAR_OFFSET_LFO5].type 	= TYPE_UINT32;
-	parameterArray[PAR_OFFSET_LFO6].ptr 	= &hatVoice.lfo.phaseOffset;
-	parameterArray[PAR_OFFSET_LFO6].type 	= TYPE_UINT32;
-
-	parameterArray[PAR_FILTER_TYPE_1].ptr 	= &voiceArray[0].filterType;
-	parameterArray[PAR_FILTER_TYPE_1].type 	= TYPE_UINT8;
-	parameterArray[PAR_FILTER_TYPE_2].ptr 	= &voiceArray[1].filterType;
-	parameterArray[PAR_FILTER_TYPE_2].type 	= TYPE_UINT8;
-	parameterArray[PAR_FILTER_TYPE_3].ptr 	= &voiceArray[2].filterType;
-	parameterArray[PAR_FILTER_TYPE_3].type 	= TYPE_UINT8;
-	parameterArray[PAR_FILTER_TYPE_4].ptr 	= &snareVoice.filterType;
-	parameterArray[PAR_FILTER_TYPE_4].type 	= TYPE_UINT8;
-	parameterArray[PAR_FILTER_TYPE_5].ptr 	= &cymbalVoice.filterType;;
-	parameterArray[PAR_FILTER_TYPE_5].type 	= TYPE_UINT8;
-	parameterArray[PAR_FILTER_TYPE_6].ptr 	= &hatVoice.filterType;;
-	parameterArray[PAR_FILTER_TYPE_6].type 	= TYPE_UINT8;
-
-	parameterArray[PAR_TRANS1_VOL].ptr 		= &voiceArray[0].transGen.volume;
-	parameterArray[PAR_TRANS1_VOL].type 	= TYPE_FLT;
-	parameterArray[PAR_TRANS2_VOL].ptr 		= &voiceArray[1].transGen.volume;;
-	parameterArray[PAR_TRANS2_VOL].type 	= TYPE_FLT;
-	parameterArray[PAR_TRANS3_VOL].ptr 		= &voiceArray[2].transGen.volume;;
-	parameterArray[PAR_TRANS3_VOL].type 	= TYPE_FLT;
-	parameterArray[PAR_TRANS4_VOL].ptr 		= &snareVoice.transGen.volume;
-	parameterArray[PAR_TRANS4_VOL].type 	= TYPE_FLT;
-	parameterArray[PAR_TRANS5_VOL].ptr 		= &cymbalVoice.transGen.volume;
-	parameterArray[PAR_TRANS5_VOL].type 	= TYPE_FLT;
-	parameterArray[PAR_TRANS6_VOL].ptr 		= &hatVoice.transGen.volume;
-	parameterArray[PAR_TRANS6_VOL].type 	= TYPE_FLT;
-
-
-
-	parameterArray[PAR_TRANS1_WAVE].ptr 	= &voiceArray[0].transGen.waveform;
-	parameterArray[PAR_TRANS1_WAVE].type 	= TYPE_UINT8;
-	parameterArray[PAR_TRANS2_WAVE].ptr 	= &voiceArray[1].transGen.waveform;;
-	parameterArray[PAR_TRANS2_WAVE].type 	= TYPE_UINT8;
-	parameterArray[PAR_TRANS3_WAVE].ptr 	= &voiceArray[2].transGen.waveform;;
-	parameterArray[PAR_TRANS3_WAVE].type 	= TYPE_UINT8;
-	parameterArray[PAR_TRANS4_WAVE].ptr 	= &snareVoice.transGen.waveform;
-	parameterArray[PAR_TRANS4_WAVE].type 	= TYPE_UINT8;
-	parameterArray[PAR_TRANS5_WAVE].ptr 	= &cymbalVoice.transGen.waveform;
-	parameterArray[PAR_TRANS5_WAVE].type 	= TYPE_UINT8;
-	parameterArray[PAR_TRANS6_WAVE].ptr 	= &hatVoice.transGen.waveform;
-	parameterArray[PAR_TRANS6_WAVE].type 	= TYPE_UINT8;
-
-
-	parameterArray[PAR_TRANS1_FREQ].ptr 	= &voiceArray[0].transGen.pitch;
-	parameterArray[PAR_TRANS1_FREQ].type 	= TYPE_FLT;
-	parameterArray[PAR_TRANS2_FREQ].ptr 	= &voiceArray[1].transGen.pitch;
-	parameterArray[PAR_TRANS2_FREQ].type 	= TYPE_FLT;
-	parameterArray[PAR_TRANS3_FREQ].ptr 	= &voiceArray[2].transGen.pitch;;
-	parameterArray[PAR_TRANS3_FREQ].type 	= TYPE_FLT;
-	parameterArray[PAR_TRANS4_FREQ].ptr 	= &snareVoice.transGen.pitch;
-	parameterArray[PAR_TRANS4_FREQ].type 	= TYPE_FLT;
-	parameterArray[PAR_TRANS5_FREQ].ptr 	= &cymbalVoice.transGen.pitch;
-	parameterArray[PAR_TRANS5_FREQ].type 	= TYPE_FLT;
-	parameterArray[PAR_TRANS6_FREQ].ptr 	= &hatVoice.transGen.pitch;
-	parameterArray[PAR_TRANS6_FREQ].type 	= TYPE_FLT;
-
-	parameterArray[PAR_AUDIO_OUT1].ptr 		= &mixer_audioRouting[0];
-	parameterArray[PAR_AUDIO_OUT1].type 	= TYPE_UINT8;
-	parameterArray[PAR_AUDIO_OUT2].ptr 		= &mixer_audioRouting[1];
-	parameterArray[PAR_AUDIO_OUT2].type		= TYPE_UINT8;
-	parameterArray[PAR_AUDIO_OUT3].ptr 		= &mixer_audioRouting[2];
-	parameterArray[PAR_AUDIO_OUT3].type 	= TYPE_UINT8;
-	parameterArray[PAR_AUDIO_OUT4].ptr 		= &mixer_audioRouting[3];
-	parameterArray[PAR_AUDIO_OUT4].type 	= TYPE_UINT8;
-	parameterArray[PAR_AUDIO_OUT5].ptr 		= &mixer_audioRouting[4];
-	parameterArray[PAR_AUDIO_OUT5].type 	= TYPE_UINT8;
-	parameterArray[PAR_AUDIO_OUT6].ptr 		= &mixer_audioRouting[5];
-	parameterArray[PAR_AUDIO_OUT6].type 	= TYPE_UINT8;
-
 	parameterArray[PAR_MIDI_NOTE1].ptr 		= &midi_NoteOverride[0];
 	parameterArray[PAR_MIDI_NOTE1].type 	= TYPE_UINT8;
 	parameterArray[PAR_MIDI_NOTE2].ptr 		= &midi_NoteOverride[1];
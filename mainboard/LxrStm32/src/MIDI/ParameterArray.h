@@ -397,8 +397,26 @@ typedef struct ParameterStruct
 
 } Parameter;
 
+/** converts a 7 bit controller value and applies it to the target*/
+typedef void (*ParamConverter)(void* target, uint8_t value);
+
+typedef struct ParamDispatchStruct
+{
+	void* 			target;
+	ParamConverter 	set;
+} ParamDispatch;
+
 extern Parameter parameterArray[END_OF_SOUND_PARAMETERS];
+/** how a 7 bit value from midi, the front panel or the automation is applied, indexed by parameter number*/
+extern const ParamDispatch paramArray_dispatch[END_OF_SOUND_PARAMETERS];
 void paramArray_setParameter(uint16_t idx, ptrValue newValue);
+/** apply a 7 bit value to parameter idx. parameters without a converter are ignored*/
+void paramArray_dispatchValue(uint16_t idx, uint8_t value);
+/** store a 7 bit value for parameter idx. it is applied with the next paramArray_applyQueued call,
+ * a newer value for the same parameter replaces the queued one*/
+void paramArray_queueValue(uint16_t idx, uint8_t value);
+/** apply all queued parameter values. called once per audio block*/
+void paramArray_applyQueued();
 void parameterArray_init();
 
 #endif /* PARAMETERARRAY_H_ */
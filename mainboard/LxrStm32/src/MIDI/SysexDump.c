@@ -0,0 +1,562 @@
+/*
+ * SysexDump.c
+ *
+ *  Created on: 18.10.2026
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  Copyright 2013 Julian Schmidt
+ *  Julian@sonic-potions.com
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  This file is part of the Sonic Potions LXR drumsynth firmware.
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  Redistribution and use of the LXR code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *       - The code may not be sold, nor may it be used in a commercial product or activity.
+ *
+ *       - Redistributions that are modified from the original source must include the complete
+ *         source code, including the source code for all components used by a binary built
+ *         from the modified sources. However, as a special exception, the source code distributed
+ *         need not include anything that is normally distributed (in either source or binary form)
+ *         with the major components (compiler, kernel, and so on) of the operating system on which
+ *         the executable runs, unless that component itself accompanies the executable.
+ *
+ *       - Redistributions must reproduce the above copyright notice, this list of conditions and the
+ *         following disclaimer in the documentation and/or other materials provided with the distribution.
+ * ------------------------------------------------------------------------------------------------------------------------
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *   WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *   USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ------------------------------------------------------------------------------------------------------------------------
+ */
+
+#include "SysexDump.h"
+#include "MidiParser.h"
+#include "ParameterArray.h"
+#include "sequencer.h"
+#include "usb_manager.h"
+#include "Uart.h"
+#include "frontPanelParser.h"
+#include "config.h"
+#include <string.h>
+
+enum
+{
+	RX_IDLE,		/**< waiting for F0*/
+	RX_ID,
+	RX_DEVICE,
+	RX_CMD,
+	RX_PAYLOAD,
+	RX_FORWARD,		/**< frame of another device, routed until F7*/
+	RX_SKIP,		/**< bad frame, wait for F7*/
+};
+
+// record order of a dump
+#define DUMP_KIT			0
+#define DUMP_GLOBALS		1
+#define DUMP_PATTERNS		2
+#define DUMP_TRACKS			(DUMP_PATTERNS + NUM_PATTERN)
+#define DUMP_END			(DUMP_TRACKS + NUM_PATTERN*NUM_TRACKS)
+#define DUMP_IDLE			0xff
+
+#define KIT_SIZE			(END_OF_SOUND_PARAMETERS < 0xff ? END_OF_SOUND_PARAMETERS : 0xff)
+#define FRAME_SIZE			(LXR_SYSEX_HEADER_SIZE + ((LXR_SYSEX_MAX_RECORD+6)/7)*8 + 2)
+
+//packed payload of a received frame, unpacked in place. while a dump is running
+//nothing is received and the records are built here
+INCCMZ static uint8_t sysexDump_buffer[FRAME_SIZE];
+INCCMZ static uint8_t sysexDump_txFrame[FRAME_SIZE];
+static uint16_t sysexDump_txLen = 0;
+static uint16_t sysexDump_txPos = 0;
+
+static uint8_t sysexDump_rxState = RX_IDLE;
+static uint8_t sysexDump_rxCmd;
+static uint16_t sysexDump_rxLen;
+
+static uint8_t sysexDump_record = DUMP_IDLE;	/**< next record of a running dump*/
+static uint16_t sysexDump_recordCnt;
+
+static uint8_t sysexDump_lockDest[0xff];
+static uint8_t sysexDump_lockValue[0xff];
+
+// restored values are sent to the front as its tx fifo has room, a kit does not fit at once.
+// the globals are sent in this order
+#define FRONT_GLOBAL_BPM	0
+#define FRONT_GLOBAL_CHAN	1
+#define FRONT_GLOBAL_TX		(FRONT_GLOBAL_CHAN + sizeof(midi_MidiChannels))
+#define FRONT_GLOBAL_RX		(FRONT_GLOBAL_TX + 1)
+#define FRONT_GLOBAL_END	(FRONT_GLOBAL_RX + 1)
+
+static uint16_t sysexDump_frontKitPos = 0;		/**< next kit parameter for the front*/
+static uint16_t sysexDump_frontKitEnd = 0;
+static uint8_t sysexDump_frontGlobal = FRONT_GLOBAL_END;
+//------------------------------------------------------------------------------
+static uint16_t sysexDump_put16(uint8_t* dst, uint16_t pos, const uint16_t value)
+{
+	dst[pos++] = value & 0xff;
+	dst[pos++] = value >> 8;
+	return pos;
+}
+//------------------------------------------------------------------------------
+static uint16_t sysexDump_get16(const uint8_t* src)
+{
+	return src[0] | (src[1]<<8);
+}
+//------------------------------------------------------------------------------
+static void sysexDump_queueFrame(const uint8_t cmd, const uint8_t* payload, const uint16_t len)
+{
+	uint8_t* const f = sysexDump_txFrame;
+	f[0] = SYSEX_START;
+	f[1] = LXR_SYSEX_ID;
+	f[2] = LXR_SYSEX_DEVICE;
+	f[3] = cmd;
+
+	const uint16_t n = lxrSysex_pack(payload, len, &f[LXR_SYSEX_HEADER_SIZE]);
+	uint8_t chk = cmd;
+	uint16_t i;
+	for(i=0;i<n;i++) {
+		chk ^= f[LXR_SYSEX_HEADER_SIZE+i];
+	}
+	f[LXR_SYSEX_HEADER_SIZE+n] = chk;
+	f[LXR_SYSEX_HEADER_SIZE+n+1] = SYSEX_END;
+
+	sysexDump_txLen = LXR_SYSEX_HEADER_SIZE+n+2;
+	sysexDump_txPos = 0;
+}
+//------------------------------------------------------------------------------
+static void sysexDump_ack(const uint8_t status)
+{
+	sysexDump_queueFrame(LXR_SYSEX_ACK, &status, 1);
+}
+//------------------------------------------------------------------------------
+static uint16_t sysexDump_buildTrack(uint8_t* rec, const uint8_t patNr, const uint8_t track)
+{
+	const Pattern* p = seq_patterns[patNr];
+	uint16_t pos = 0;
+	uint8_t i;
+
+	rec[pos++] = LXR_RECORD_TRACK;
+	rec[pos++] = patNr;
+	rec[pos++] = track;
+	rec[pos++] = p->seq_patternLengthRotate[track].value;
+	pos = sysexDump_put16(rec, pos, p->seq_mainSteps[track]);
+	for(i=0;i<NUM_STEPS/32;i++) {
+		pos = sysexDump_put16(rec, pos, p->seq_activeSteps[track][i] & 0xffff);
+		pos = sysexDump_put16(rec, pos, p->seq_activeSteps[track][i] >> 16);
+	}
+
+	//step data of the main steps that have a block
+	uint16_t mask = 0;
+	const uint16_t maskPos = pos;
+	pos += 2;
+	for(i=0;i<NUM_STEPS/8;i++)
+	{
+		if(p->seq_stepBlocks[track][i] == PATTERN_NO_BLOCK) continue;
+		mask |= 1<<i;
+		uint8_t j;
+		for(j=0;j<8;j++) {
+			memcpy(&rec[pos], pattern_getStep(p, track, i*8+j), sizeof(Step));
+			pos += sizeof(Step);
+		}
+	}
+	sysexDump_put16(rec, maskPos, mask);
+
+	//parameter locks, the pool can never hold more than fits into a record
+	uint16_t lockCnt = 0;
+	const uint16_t lockPos = pos;
+	pos += 2;
+	for(i=0;i<NUM_STEPS;i++)
+	{
+		const uint8_t n = pattern_getLocks(p, track, i, sysexDump_lockDest, sysexDump_lockValue, 0xff);
+		uint8_t j;
+		for(j=0;j<n && pos+3 <= LXR_SYSEX_MAX_RECORD;j++) {
+			rec[pos++] = i;
+			rec[pos++] = sysexDump_lockDest[j];
+			rec[pos++] = sysexDump_lockValue[j];
+			lockCnt++;
+		}
+	}
+	sysexDump_put16(rec, lockPos, lockCnt);
+
+	return pos;
+}
+//------------------------------------------------------------------------------
+static uint16_t sysexDump_buildRecord(uint8_t* rec, const uint8_t record)
+{
+	if(record == DUMP_KIT)
+	{
+		rec[0] = LXR_RECORD_KIT;
+		memcpy(&rec[1], midiParser_originalCcValues, KIT_SIZE);
+		return KIT_SIZE+1;
+	}
+	if(record == DUMP_GLOBALS)
+	{
+		rec[0] = LXR_RECORD_GLOBALS;
+		sysexDump_put16(rec, 1, seq_getBpm());
+		memcpy(&rec[3], midi_MidiChannels, sizeof(midi_MidiChannels));
+		rec[3+sizeof(midi_MidiChannels)] = midiParser_txRxFilter;
+		return 4+sizeof(midi_MidiChannels);
+	}
+	if(record < DUMP_TRACKS)
+	{
+		const uint8_t patNr = record - DUMP_PATTERNS;
+		rec[0] = LXR_RECORD_PATTERN;
+		rec[1] = patNr;
+		rec[2] = seq_patterns[patNr]->seq_patternSettings.changeBar;
+		rec[3] = seq_patterns[patNr]->seq_patternSettings.nextPattern;
+		return 4;
+	}
+	const uint8_t trackIdx = record - DUMP_TRACKS;
+	return sysexDump_buildTrack(rec, trackIdx / NUM_TRACKS, trackIdx % NUM_TRACKS);
+}
+//------------------------------------------------------------------------------
+static void sysexDump_sendFront(const uint8_t status, const uint8_t data1, const uint8_t data2)
+{
+	uart_sendFrontpanelByte(status);
+	uart_sendFrontpanelByte(data1);
+	uart_sendFrontpanelByte(data2);
+}
+//------------------------------------------------------------------------------
+static void sysexDump_sendFrontGlobal(const uint8_t global)
+{
+	if(global == FRONT_GLOBAL_BPM)
+	{
+		const uint16_t bpm = seq_getBpm();
+		sysexDump_sendFront(FRONT_SET_BPM, bpm & 0x7f, (bpm >> 7) & 0x7f);
+	}
+	else if(global < FRONT_GLOBAL_TX)
+	{
+		const uint8_t voice = global - FRONT_GLOBAL_CHAN;
+		sysexDump_sendFront(FRONT_SEQ_CC, FRONT_SEQ_MIDI_CHAN, (voice << 4) | (midi_MidiChannels[voice] & 0x0f));
+	}
+	else if(global == FRONT_GLOBAL_TX)
+	{
+		sysexDump_sendFront(FRONT_SEQ_CC, FRONT_SEQ_MIDI_TX_FILTER, midiParser_txRxFilter >> 4);
+	}
+	else
+	{
+		sysexDump_sendFront(FRONT_SEQ_CC, FRONT_SEQ_MIDI_RX_FILTER, midiParser_txRxFilter & 0x0f);
+	}
+}
+//------------------------------------------------------------------------------
+/** send pending restored values to the front, like midi CCs are forwarded by the midi parser*/
+static void sysexDump_updateFront()
+{
+	while(!frontParser_sysexActive && uart_getFrontTxFree() >= 3)
+	{
+		if(sysexDump_frontKitPos < sysexDump_frontKitEnd)
+		{
+			const uint16_t i = sysexDump_frontKitPos++;
+			if(i < 128)
+			{
+				//the nrpn controls are no front parameters
+				if(i == NRPN_DATA_ENTRY_COARSE || i == NRPN_FINE || i == NRPN_COARSE) continue;
+				sysexDump_sendFront(MIDI_CC, i, midiParser_originalCcValues[i]);
+			}
+			else
+			{
+				sysexDump_sendFront(FRONT_CC_2, i-128, midiParser_originalCcValues[i]);
+			}
+		}
+		else if(sysexDump_frontGlobal < FRONT_GLOBAL_END)
+		{
+			sysexDump_sendFrontGlobal(sysexDump_frontGlobal++);
+		}
+		else
+		{
+			return;
+		}
+	}
+}
+//------------------------------------------------------------------------------
+static uint8_t sysexDump_restoreKit(const uint8_t* rec, const uint16_t len)
+{
+	//replay the values like the front panel does, so modulation targets follow
+	const uint16_t n = len-1 < KIT_SIZE ? len-1 : KIT_SIZE;
+	uint16_t i;
+	for(i=1;i<n;i++)
+	{
+		MidiMsg msg;
+		if(i < 128)
+		{
+			if(i == NRPN_DATA_ENTRY_COARSE || i == NRPN_FINE || i == NRPN_COARSE)
+			{
+				//nrpn controls, only keep the value
+				midiParser_originalCcValues[i] = rec[1+i] & 0x7f;
+				continue;
+			}
+			msg.status = MIDI_CC;
+			msg.data1 = i;
+		}
+		else
+		{
+			msg.status = MIDI_CC2;
+			msg.data1 = i-128;
+		}
+		msg.data2 = rec[1+i] & 0x7f;
+		midiParser_ccHandler(msg, 1);
+	}
+	sysexDump_frontKitPos = 1;
+	sysexDump_frontKitEnd = n;
+	return LXR_SYSEX_OK;
+}
+//------------------------------------------------------------------------------
+static uint8_t sysexDump_restoreTrack(const uint8_t* rec, const uint16_t len)
+{
+	//type, pattern, track, length/rotate, main steps, active steps, block mask
+	const uint16_t headerSize = 6 + NUM_STEPS/8 + 2;
+	if(len < headerSize + 2 || rec[1] >= NUM_PATTERN || rec[2] >= NUM_TRACKS) return LXR_SYSEX_ERR_RECORD;
+
+	Pattern* p = seq_patterns[rec[1]];
+	const uint8_t track = rec[2];
+	uint8_t status = LXR_SYSEX_OK;
+	uint8_t i;
+
+	//check the whole record before the track is touched
+	const uint16_t mask = sysexDump_get16(&rec[headerSize-2]);
+	uint16_t pos = headerSize;
+	for(i=0;i<NUM_STEPS/8;i++) {
+		if(mask & (1<<i)) pos += 8*sizeof(Step);
+	}
+	if(pos + 2 > len) return LXR_SYSEX_ERR_RECORD;
+
+	const uint16_t lockPos = pos + 2;
+	const uint16_t lockCnt = sysexDump_get16(&rec[pos]);
+	if(lockPos + (uint32_t)lockCnt*3 > len) return LXR_SYSEX_ERR_RECORD;
+	uint16_t l;
+	for(l=0;l<lockCnt;l++) {
+		if(rec[lockPos+l*3] >= NUM_STEPS) return LXR_SYSEX_ERR_RECORD;
+	}
+
+	pattern_resetSteps(p, track);
+	p->seq_patternLengthRotate[track].value = rec[3];
+	p->seq_mainSteps[track] = sysexDump_get16(&rec[4]);
+
+	pos = headerSize;
+	for(i=0;i<NUM_STEPS/8;i++)
+	{
+		if(!(mask & (1<<i))) continue;
+		uint8_t j;
+		for(j=0;j<8;j++)
+		{
+			Step* dst = pattern_editStep(p, track, i*8+j);
+			if(dst) {
+				memcpy(dst, &rec[pos], sizeof(Step));
+				dst->volume &= STEP_VOLUME_MASK;
+			} else {
+				status = LXR_SYSEX_ERR_POOL;
+			}
+			pos += sizeof(Step);
+		}
+	}
+
+	//editing steps does not touch the active flags, set them afterwards
+	for(i=0;i<NUM_STEPS/32;i++) {
+		p->seq_activeSteps[track][i] = sysexDump_get16(&rec[6+i*4]) | ((uint32_t)sysexDump_get16(&rec[8+i*4]) << 16);
+	}
+
+	for(l=0,pos=lockPos;l<lockCnt;l++,pos+=3)
+	{
+		if(!pattern_setLock(p, track, rec[pos], rec[pos+1], rec[pos+2])) {
+			status = LXR_SYSEX_ERR_POOL;
+		}
+	}
+	return status;
+}
+//------------------------------------------------------------------------------
+static uint8_t sysexDump_restoreRecord(const uint8_t* rec, const uint16_t len)
+{
+	if(len == 0) return LXR_SYSEX_ERR_RECORD;
+
+	switch(rec[0])
+	{
+	case LXR_RECORD_KIT:
+		return sysexDump_restoreKit(rec, len);
+
+	case LXR_RECORD_GLOBALS:
+		if(len < 4+sizeof(midi_MidiChannels)) return LXR_SYSEX_ERR_RECORD;
+		if(sysexDump_get16(&rec[1])) {
+			seq_setBpm(sysexDump_get16(&rec[1]));
+		}
+		memcpy(midi_MidiChannels, &rec[3], sizeof(midi_MidiChannels));
+		midiParser_setFilter(1, rec[3+sizeof(midi_MidiChannels)] >> 4);
+		midiParser_setFilter(0, rec[3+sizeof(midi_MidiChannels)]);
+		sysexDump_frontGlobal = FRONT_GLOBAL_BPM;
+		return LXR_SYSEX_OK;
+
+	case LXR_RECORD_PATTERN:
+		if(len < 4 || rec[1] >= NUM_PATTERN) return LXR_SYSEX_ERR_RECORD;
+		seq_patterns[rec[1]]->seq_patternSettings.changeBar = rec[2];
+		seq_patterns[rec[1]]->seq_patternSettings.nextPattern = rec[3];
+		return LXR_SYSEX_OK;
+
+	case LXR_RECORD_TRACK:
+	{
+		const uint8_t status = sysexDump_restoreTrack(rec, len);
+		seq_flushLookahead();
+		return status;
+	}
+
+	default:
+		return LXR_SYSEX_ERR_RECORD;
+	}
+}
+//------------------------------------------------------------------------------
+static void sysexDump_handleFrame()
+{
+	//the last payload byte is the checksum
+	if(sysexDump_rxLen == 0) return;
+	const uint16_t len = sysexDump_rxLen-1;
+	uint8_t chk = sysexDump_rxCmd;
+	uint16_t i;
+	for(i=0;i<len;i++) {
+		chk ^= sysexDump_buffer[i];
+	}
+	if(chk != sysexDump_buffer[len])
+	{
+		sysexDump_ack(LXR_SYSEX_ERR_CHECKSUM);
+		return;
+	}
+
+	switch(sysexDump_rxCmd)
+	{
+	case LXR_SYSEX_DUMP_REQUEST:
+		sysexDump_record = DUMP_KIT;
+		sysexDump_recordCnt = 0;
+		break;
+
+	case LXR_SYSEX_RECORD:
+	{
+		const uint16_t n = lxrSysex_unpack(sysexDump_buffer, len, sysexDump_buffer);
+		sysexDump_ack(sysexDump_restoreRecord(sysexDump_buffer, n));
+	}
+		break;
+
+	case LXR_SYSEX_END:
+		sysexDump_ack(LXR_SYSEX_OK);
+		break;
+
+	default:
+		break;
+	}
+}
+//------------------------------------------------------------------------------
+static void sysexDump_forward(const uint8_t data)
+{
+	MidiMsg msg;
+	msg.status = data;
+	msg.data1 = msg.data2 = 0;
+	msg.bits.length = 0;
+	msg.bits.sysxbyte = 1;
+	msg.bits.source = midiSourceUSB;
+	midiParser_parseMidiMessage(msg);
+}
+//------------------------------------------------------------------------------
+void sysexDump_parseByte(uint8_t data)
+{
+	if(data == SYSEX_START)
+	{
+		if(sysexDump_rxState == RX_FORWARD) {
+			sysexDump_forward(SYSEX_END);
+		}
+		sysexDump_rxState = RX_ID;
+		return;
+	}
+
+	switch(sysexDump_rxState)
+	{
+	case RX_IDLE:
+		break;
+
+	case RX_ID:
+	case RX_DEVICE:
+	{
+		const uint8_t expected = sysexDump_rxState == RX_ID ? LXR_SYSEX_ID : LXR_SYSEX_DEVICE;
+		if(data == expected)
+		{
+			sysexDump_rxState++;
+			break;
+		}
+		//not ours, pass on what was swallowed so far
+		sysexDump_forward(SYSEX_START);
+		if(sysexDump_rxState == RX_DEVICE) {
+			sysexDump_forward(LXR_SYSEX_ID);
+		}
+		sysexDump_forward(data);
+		sysexDump_rxState = data == SYSEX_END ? RX_IDLE : RX_FORWARD;
+	}
+		break;
+
+	case RX_CMD:
+		sysexDump_rxCmd = data;
+		sysexDump_rxLen = 0;
+		sysexDump_rxState = data < 0x80 ? RX_PAYLOAD : RX_IDLE;
+		break;
+
+	case RX_PAYLOAD:
+		if(data == SYSEX_END)
+		{
+			sysexDump_rxState = RX_IDLE;
+			sysexDump_handleFrame();
+		}
+		else if(data & 0x80 || sysexDump_rxLen >= sizeof(sysexDump_buffer))
+		{
+			sysexDump_ack(LXR_SYSEX_ERR_RECORD);
+			sysexDump_rxState = RX_SKIP;
+		}
+		else
+		{
+			sysexDump_buffer[sysexDump_rxLen++] = data;
+		}
+		break;
+
+	case RX_FORWARD:
+		sysexDump_forward(data);
+		if(data == SYSEX_END) sysexDump_rxState = RX_IDLE;
+		break;
+
+	case RX_SKIP:
+	default:
+		if(data == SYSEX_END) sysexDump_rxState = RX_IDLE;
+		break;
+	}
+}
+//------------------------------------------------------------------------------
+void sysexDump_tick()
+{
+	sysexDump_updateFront();
+
+	//finish the frame on the way first, the usb buffer takes what fits
+	if(sysexDump_txPos < sysexDump_txLen)
+	{
+		sysexDump_txPos += usb_sendSysex(&sysexDump_txFrame[sysexDump_txPos], sysexDump_txLen - sysexDump_txPos);
+		return;
+	}
+
+	if(sysexDump_record != DUMP_IDLE)
+	{
+		if(sysexDump_record == DUMP_END)
+		{
+			uint8_t cnt[2];
+			sysexDump_put16(cnt, 0, sysexDump_recordCnt);
+			sysexDump_queueFrame(LXR_SYSEX_END, cnt, 2);
+			sysexDump_record = DUMP_IDLE;
+		}
+		else
+		{
+			const uint16_t len = sysexDump_buildRecord(sysexDump_buffer, sysexDump_record++);
+			sysexDump_queueFrame(LXR_SYSEX_RECORD, sysexDump_buffer, len);
+			sysexDump_recordCnt++;
+		}
+		return;
+	}
+
+	//parse until a frame needs an answer
+	uint8_t data;
+	while(sysexDump_txPos >= sysexDump_txLen && sysexDump_record == DUMP_IDLE && usb_getSysex(&data)) {
+		sysexDump_parseByte(data);
+	}
+}
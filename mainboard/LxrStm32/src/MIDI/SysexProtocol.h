@@ -0,0 +1,124 @@
+/*
+ * SysexProtocol.h
+ *
+ *  Created on: 18.10.2026
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  Copyright 2013 Julian Schmidt
+ *  Julian@sonic-potions.com
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  This file is part of the Sonic Potions LXR drumsynth firmware.
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  Redistribution and use of the LXR code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *       - The code may not be sold, nor may it be used in a commercial product or activity.
+ *
+ *       - Redistributions that are modified from the original source must include the complete
+ *         source code, including the source code for all components used by a binary built
+ *         from the modified sources. However, as a special exception, the source code distributed
+ *         need not include anything that is normally distributed (in either source or binary form)
+ *         with the major components (compiler, kernel, and so on) of the operating system on which
+ *         the executable runs, unless that component itself accompanies the executable.
+ *
+ *       - Redistributions must reproduce the above copyright notice, this list of conditions and the
+ *         following disclaimer in the documentation and/or other materials provided with the distribution.
+ * ------------------------------------------------------------------------------------------------------------------------
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *   WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *   USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ------------------------------------------------------------------------------------------------------------------------
+ */
+
+
+#ifndef SYSEXPROTOCOL_H_
+#define SYSEXPROTOCOL_H_
+
+// Sysex protocol to dump and restore the patterns, kit and globals over usb midi.
+// Shared by the firmware and the host tool in tools/LxrSysex, so it only depends on stdint.h
+//
+// frame: F0 <id> <device> <cmd> <packed payload> <checksum> F7
+// the payload is 8 bit data packed into 7 bit groups: one byte with the msbs of the
+// following (up to) 7 bytes, bit n holds the msb of byte n.
+// the checksum is the xor of cmd and all packed payload bytes.
+//
+// dump:    host sends LXR_SYSEX_DUMP_REQUEST, the device answers with one LXR_SYSEX_RECORD
+//          frame per record and a final LXR_SYSEX_END frame with the record count (2 bytes, lsb first)
+// restore: host sends the recorded LXR_SYSEX_RECORD frames and LXR_SYSEX_END, the device
+//          answers every frame with LXR_SYSEX_ACK. the host waits for the ack before the next frame
+
+#include <stdint.h>
+
+#define LXR_SYSEX_ID				0x7D	/**< manufacturer id for non commercial use*/
+#define LXR_SYSEX_DEVICE			0x4C	/**< 'L'*/
+
+#define LXR_SYSEX_DUMP_REQUEST		0x01
+#define LXR_SYSEX_RECORD			0x02
+#define LXR_SYSEX_END				0x03
+#define LXR_SYSEX_ACK				0x04
+
+// ack status
+#define LXR_SYSEX_OK				0x00
+#define LXR_SYSEX_ERR_CHECKSUM		0x01
+#define LXR_SYSEX_ERR_RECORD		0x02	/**< unknown record or bad length*/
+#define LXR_SYSEX_ERR_POOL			0x03	/**< step data or lock pool full, the record was applied partially*/
+
+// records, the first payload byte is the record type
+#define LXR_RECORD_KIT				0x01	/**< the 7 bit value of every sound parameter, indexed like midiParser_originalCcValues*/
+#define LXR_RECORD_GLOBALS			0x02	/**< bpm (2 bytes, lsb first), 8 midi channels, tx/rx filter*/
+#define LXR_RECORD_PATTERN			0x03	/**< pattern nr, change bar, next pattern*/
+#define LXR_RECORD_TRACK			0x04	/**< see below*/
+
+// track record:
+// pattern nr, track nr, length/rotate, main steps (2), active steps (16, lsb first),
+// mask of main steps with step data (2), 56 bytes of step data for every set bit (8 steps * 7 bytes),
+// lock count (2) followed by step, dest, value per lock
+
+#define LXR_SYSEX_HEADER_SIZE		4		/**< F0, id, device, cmd*/
+#define LXR_SYSEX_MAX_RECORD		2560	/**< unpacked size of the largest record*/
+
+//------------------------------------------------------------------------------
+/** packed size of len payload bytes*/
+static inline uint16_t lxrSysex_packedSize(const uint16_t len)
+{
+	return len + (len+6)/7;
+}
+//------------------------------------------------------------------------------
+/** pack len bytes from src into 7 bit bytes. returns the packed size*/
+static inline uint16_t lxrSysex_pack(const uint8_t* src, const uint16_t len, uint8_t* dst)
+{
+	uint16_t i, out = 0;
+	for(i=0;i<len;i+=7)
+	{
+		uint8_t j, msbs = 0;
+		const uint16_t msbPos = out++;
+		for(j=0;j<7 && i+j<len;j++)
+		{
+			msbs |= (src[i+j]>>7) << j;
+			dst[out++] = src[i+j] & 0x7f;
+		}
+		dst[msbPos] = msbs;
+	}
+	return out;
+}
+//------------------------------------------------------------------------------
+/** unpack len 7 bit bytes from src. returns the unpacked size*/
+static inline uint16_t lxrSysex_unpack(const uint8_t* src, const uint16_t len, uint8_t* dst)
+{
+	uint16_t i, out = 0;
+	for(i=0;i<len;i+=8)
+	{
+		uint8_t j;
+		const uint8_t msbs = src[i];
+		for(j=1;j<8 && i+j<len;j++)
+		{
+			dst[out++] = src[i+j] | (((msbs>>(j-1))&1) << 7);
+		}
+	}
+	return out;
+}
+
+#endif /* SYSEXPROTOCOL_H_ */
@@ -38,6 +38,8 @@
 #include "FIFO.h"
 #include "frontPanelParser.h"
 #include "config.h"
+#include "cs4344_cs5343.h"
+#include "seqClock.h"
 
  /* USART2 MIDI configured as follow:
 	 - BaudRate = 31250 baud
@@ -48,123 +50,561 @@
 	 - Receive and transmit enabled
 */
 //-----------------------------------------------------------------------------
-//we need a TX and RX FIFO for every uart
+// Both uarts receive with a circular DMA into a ring buffer that the parsers
+// read directly. The main loop polls the DMA write position, so no interrupt
+// is needed per byte. The half and full transfer interrupts (2 per lap) only
+// count the laps so a reader that falls more than a ring behind is detected.
+// Transmit data is queued in a FIFO and sent by DMA, one contiguous chunk of
+// the FIFO per transfer.
+//-----------------------------------------------------------------------------
+typedef struct UartDmaRxStruct
+{
+	volatile uint8_t*	buffer;
+	uint16_t			size;			// power of 2
+	DMA_Stream_TypeDef*	stream;
+	volatile uint32_t	halves;			// half buffers completed by the dma
+	uint32_t			tail;			// bytes read so far
+	uint16_t			overflowCnt;	// bytes overwritten before they were read
+} UartDmaRx;
+
+typedef struct UartDmaTxStruct
+{
+	Fifo*				fifo;
+	DMA_Stream_TypeDef*	stream;
+	IRQn_Type			irq;
+	volatile uint8_t	len;			// bytes of the running transfer, 0 = idle
+} UartDmaTx;
+
+// USART2 midi: rx DMA1 stream 5, tx DMA1 stream 6, channel 4
+// USART3 front: rx DMA1 stream 1, tx DMA1 stream 3 channel 4 or stream 4 channel 7 (the other one is used by SPI2)
+#if USE_DAC2
+#define UART_FRONT_TX_STREAM		DMA1_Stream3
+#define UART_FRONT_TX_CHANNEL		DMA_Channel_4
+#define UART_FRONT_TX_IRQ			DMA1_Stream3_IRQn
+#define UART_FRONT_TX_IRQHANDLER	DMA1_Stream3_IRQHandler
+#define UART_FRONT_TX_IT_TC			DMA_IT_TCIF3
+#define UART_FRONT_TX_FLAGS			(DMA_FLAG_TCIF3 | DMA_FLAG_HTIF3 | DMA_FLAG_TEIF3 | DMA_FLAG_DMEIF3 | DMA_FLAG_FEIF3)
+#else
+#define UART_FRONT_TX_STREAM		DMA1_Stream4
+#define UART_FRONT_TX_CHANNEL		DMA_Channel_7
+#define UART_FRONT_TX_IRQ			DMA1_Stream4_IRQn
+#define UART_FRONT_TX_IRQHANDLER	DMA1_Stream4_IRQHandler
+#define UART_FRONT_TX_IT_TC			DMA_IT_TCIF4
+#define UART_FRONT_TX_FLAGS			(DMA_FLAG_TCIF4 | DMA_FLAG_HTIF4 | DMA_FLAG_TEIF4 | DMA_FLAG_DMEIF4 | DMA_FLAG_FEIF4)
+#endif
 
-static Fifo fifo_midiTx;
-static Fifo fifo_midiRx;
+static volatile uint8_t uart_midiRxBuffer[UART_MIDI_RX_SIZE];
+static volatile uint8_t uart_frontRxBuffer[UART_FRONT_RX_SIZE];	//we use a bigger buffer here because we have lots of data coming in for the preset
 
+static Fifo fifo_midiTx;
 static Fifo fifo_frontTx;
-static FifoBig fifo_frontRx; //we use a bigger fifo here because we have lots of data coming in for the preset
-						//todo test if necessary!
+
+static UartDmaRx uart_midiRx 	= {uart_midiRxBuffer, 	UART_MIDI_RX_SIZE, 	DMA1_Stream5, 0, 0, 0};
+static UartDmaRx uart_frontRx 	= {uart_frontRxBuffer, 	UART_FRONT_RX_SIZE, DMA1_Stream1, 0, 0, 0};
+static UartDmaTx uart_midiTx 	= {&fifo_midiTx, 	DMA1_Stream6, 			DMA1_Stream6_IRQn, 	0};
+static UartDmaTx uart_frontTx 	= {&fifo_frontTx, 	UART_FRONT_TX_STREAM, 	UART_FRONT_TX_IRQ, 	0};
+
+static uint32_t uart_rxBudgetCycles = 1;	//max. cpu cycles per main loop iteration spent parsing one rx buffer
+
+// Arrival time of received midi bytes. The dma gives no per byte interrupt, so the
+// idle line interrupt stamps the end of every burst with the audio playback position.
+// A byte n positions before the end of a burst arrived n byte times earlier, bytes of a
+// burst that is still running are stamped relative to the poll time the same way.
+#define UART_MIDI_BYTE_SAMPLES	((uint32_t)(REAL_FS*10/31250))	// 10 bits per byte at 31250 baud
+
+static volatile uint32_t uart_midiIdleHead = 0;		// dma byte count at the last idle line
+static volatile uint32_t uart_midiIdleTime = 0;		// playback position at the last idle line
+
+// The midi out scheduler. Messages wait in a queue and are handed to the tx dma one at
+// a time, so realtime bytes overtake queued messages and channel messages can omit a status
+// byte that equals the last one sent (running status).
+// Shortly before a midi clock is due no message is started, so the clock finds the line idle.
+// Sysex and raw data bytes are packed into the last queued sysex start or data entry, up to 3
+// bytes per entry.
+#define UART_MIDI_QUEUE_SIZE	64	// power of 2
+#define UART_MIDI_RT_SIZE		16	// power of 2
+#define UART_MIDI_CLOCK_GUARD	(5*UART_MIDI_BYTE_SAMPLES)	// longest message plus 2 bytes still in the usart
+
+static MidiMsg uart_midiQueue[UART_MIDI_QUEUE_SIZE];
+static volatile uint8_t uart_midiQueueRead = 0;
+static volatile uint8_t uart_midiQueueWrite = 0;
+static uint8_t uart_midiRealtime[UART_MIDI_RT_SIZE];
+static volatile uint8_t uart_midiRealtimeRead = 0;
+static volatile uint8_t uart_midiRealtimeWrite = 0;
+static uint8_t uart_midiRunningStatus = 0;	//0 = none
+// messages dropped because the queue was full, one counter per writer context
+static volatile uint16_t uart_midiQueueDropCnt = 0;
+static volatile uint16_t uart_midiRealtimeDropCnt = 0;
 //-----------------------------------------------------------------------------
-void uart_clearFrontFifo()
+/** total number of bytes the dma has written to the ring*/
+static uint32_t uart_dmaRxHead(const UartDmaRx* rx)
 {
-	fifo_clear(&fifo_frontTx);
-	fifoBig_clear(&fifo_frontRx);
+	const uint16_t half = rx->size/2;
+	uint32_t halves;
+	uint16_t pos;
+
+	//retry if a half transfer interrupt ran in between
+	do {
+		halves = rx->halves;
+		pos = rx->size - DMA_GetCurrDataCounter(rx->stream);
+	} while(halves != rx->halves);
+
+	//bytes in the running half. the mask also covers the wrap to 0 right before the interrupt runs
+	return halves*half + ((pos - (halves&1)*half) & (rx->size-1));
+}
+//-----------------------------------------------------------------------------
+/** number of unread bytes, drops the ones already overwritten by the dma*/
+static uint32_t uart_dmaRxAvailable(UartDmaRx* rx)
+{
+	const uint32_t head = uart_dmaRxHead(rx);
+	uint32_t avail = head - rx->tail;
 
+	if(avail > (uint32_t)rx->size - 1u)
+	{
+		//keep the newest half, the older data is broken anyway
+		rx->overflowCnt += avail - rx->size/2;
+		rx->tail = head - rx->size/2;
+		avail = rx->size/2;
+	}
+	return avail;
 }
 //-----------------------------------------------------------------------------
-//the midi interrupt handler
-void USART2_IRQHandler(void)
+static inline uint8_t uart_dmaRxRead(UartDmaRx* rx)
+{
+	return rx->buffer[(rx->tail++) & (rx->size-1)];
+}
+//-----------------------------------------------------------------------------
+static void uart_dmaRxIrq(UartDmaRx* rx, uint32_t itHalf, uint32_t itFull)
 {
-	uint8_t data;
-	//if Receive interrupt (rx not empty)
-	if (USART_GetITStatus(USART2, USART_IT_RXNE) != RESET)
+	if(DMA_GetITStatus(rx->stream, itHalf) != RESET)
 	{
-		data=(uint8_t)USART_ReceiveData(USART2);
-
-		//put the received data in the RX midi buffer
-		fifo_bufferIn(&fifo_midiRx,data);
+		DMA_ClearITPendingBit(rx->stream, itHalf);
+		rx->halves++;
 	}
-
-	if (USART_GetITStatus(USART2, USART_IT_TXE) != RESET)
+	if(DMA_GetITStatus(rx->stream, itFull) != RESET)
 	{
-			if (fifo_bufferOut(&fifo_midiTx,&data) == SUCCESS)//if there is data in the output buffer to send
-			{
-				USART_SendData(USART2, data);
-			}
-			else//if buffer empty
-			{
-				//disable Transmit Data Register empty interrupt
-				USART_ITConfig(USART2, USART_IT_TXE, DISABLE);
-			}
+		DMA_ClearITPendingBit(rx->stream, itFull);
+		rx->halves++;
 	}
+}
+//-----------------------------------------------------------------------------
+/** start the transfer of the next chunk in the tx fifo if the dma is idle.
+ * called from the main loop and from the transfer complete interrupt. the main loop
+ * only starts a transfer while none is running, so no transfer complete interrupt can interfere*/
+static void uart_dmaTxStart(UartDmaTx* tx, uint32_t flags)
+{
+	if(tx->len) return;
+
+	Fifo* const fifo = tx->fifo;
+	const uint8_t read = fifo->read;
+	const uint8_t write = fifo->write;
+	if(read == write) return;
+
+	//contiguous part up to the end of the fifo memory
+	const uint8_t len = (write > read) ? (write - read) : (BUFFER_SIZE - read);
+	tx->len = len;
 
+	DMA_ClearFlag(tx->stream, flags);
+	DMA_MemoryTargetConfig(tx->stream, (uint32_t)&fifo->data[read], DMA_Memory_0);
+	DMA_SetCurrDataCounter(tx->stream, len);
+	DMA_Cmd(tx->stream, ENABLE);
 }
 //-----------------------------------------------------------------------------
-//the front panel interrupt handler
-void USART3_IRQHandler(void)
+/** returns 1 if a transfer was completed*/
+static uint8_t uart_dmaTxIrq(UartDmaTx* tx, uint32_t itComplete, uint32_t flags)
 {
-	uint8_t data;
-	//if Receive interrupt (rx not empty)
-	if (USART_GetITStatus(USART3, USART_IT_RXNE) != RESET)
+	if(DMA_GetITStatus(tx->stream, itComplete) != RESET)
 	{
-		data=(uint8_t)USART_ReceiveData(USART3);
+		DMA_ClearITPendingBit(tx->stream, itComplete);
 
-		//put the received data in the RX midi buffer
-		fifoBig_bufferIn(&fifo_frontRx,data);
+		//release the sent chunk and continue with the rest of the fifo
+		tx->fifo->read = (tx->fifo->read + tx->len) & BUFFER_MASK;
+		tx->len = 0;
+		uart_dmaTxStart(tx, flags);
+		return 1;
 	}
+	return 0;
+}
+//-----------------------------------------------------------------------------
+/** drop all queued bytes that are not part of the running transfer*/
+static void uart_dmaTxClear(UartDmaTx* tx)
+{
+	NVIC_DisableIRQ(tx->irq);
+	tx->fifo->write = (tx->fifo->read + tx->len) & BUFFER_MASK;
+	NVIC_EnableIRQ(tx->irq);
+}
+//-----------------------------------------------------------------------------
+static void uart_initDmaRx(UartDmaRx* rx, USART_TypeDef* usart, uint32_t channel, IRQn_Type irq)
+{
+	DMA_InitTypeDef DMA_InitStructure;
+	NVIC_InitTypeDef NVIC_InitStructure;
 
-	if (USART_GetITStatus(USART3, USART_IT_TXE) != RESET)
+	RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA1, ENABLE);
+
+	DMA_Cmd(rx->stream, DISABLE);
+	DMA_DeInit(rx->stream);
+	DMA_InitStructure.DMA_Channel 				= channel;
+	DMA_InitStructure.DMA_PeripheralBaseAddr 	= (uint32_t)&usart->DR;
+	DMA_InitStructure.DMA_Memory0BaseAddr 		= (uint32_t)rx->buffer;
+	DMA_InitStructure.DMA_DIR 					= DMA_DIR_PeripheralToMemory;
+	DMA_InitStructure.DMA_BufferSize 			= rx->size;
+	DMA_InitStructure.DMA_PeripheralInc 		= DMA_PeripheralInc_Disable;
+	DMA_InitStructure.DMA_MemoryInc 			= DMA_MemoryInc_Enable;
+	DMA_InitStructure.DMA_PeripheralDataSize 	= DMA_PeripheralDataSize_Byte;
+	DMA_InitStructure.DMA_MemoryDataSize 		= DMA_MemoryDataSize_Byte;
+	DMA_InitStructure.DMA_Mode 					= DMA_Mode_Circular;
+	DMA_InitStructure.DMA_Priority 				= DMA_Priority_Low;
+	DMA_InitStructure.DMA_FIFOMode 				= DMA_FIFOMode_Disable;
+	DMA_InitStructure.DMA_FIFOThreshold 		= DMA_FIFOThreshold_Full;
+	DMA_InitStructure.DMA_MemoryBurst 			= DMA_MemoryBurst_Single;
+	DMA_InitStructure.DMA_PeripheralBurst 		= DMA_PeripheralBurst_Single;
+	DMA_Init(rx->stream, &DMA_InitStructure);
+
+	rx->halves = 0;
+	rx->tail = 0;
+	rx->overflowCnt = 0;
+
+	//lowest priority, the lap counter only has to run once per half buffer
+	NVIC_InitStructure.NVIC_IRQChannel 						= irq;
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority 	= 0x0F;
+	NVIC_InitStructure.NVIC_IRQChannelSubPriority 			= 0x0F;
+	NVIC_InitStructure.NVIC_IRQChannelCmd 					= ENABLE;
+	NVIC_Init(&NVIC_InitStructure);
+
+	DMA_ITConfig(rx->stream, DMA_IT_HT | DMA_IT_TC, ENABLE);
+	USART_DMACmd(usart, USART_DMAReq_Rx, ENABLE);
+	DMA_Cmd(rx->stream, ENABLE);
+}
+//-----------------------------------------------------------------------------
+static void uart_initDmaTx(UartDmaTx* tx, USART_TypeDef* usart, uint32_t channel)
+{
+	DMA_InitTypeDef DMA_InitStructure;
+	NVIC_InitTypeDef NVIC_InitStructure;
+
+	RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA1, ENABLE);
+
+	DMA_Cmd(tx->stream, DISABLE);
+	DMA_DeInit(tx->stream);
+	DMA_InitStructure.DMA_Channel 				= channel;
+	DMA_InitStructure.DMA_PeripheralBaseAddr 	= (uint32_t)&usart->DR;
+	DMA_InitStructure.DMA_Memory0BaseAddr 		= (uint32_t)tx->fifo->data;	// set per transfer
+	DMA_InitStructure.DMA_DIR 					= DMA_DIR_MemoryToPeripheral;
+	DMA_InitStructure.DMA_BufferSize 			= 1;						// set per transfer
+	DMA_InitStructure.DMA_PeripheralInc 		= DMA_PeripheralInc_Disable;
+	DMA_InitStructure.DMA_MemoryInc 			= DMA_MemoryInc_Enable;
+	DMA_InitStructure.DMA_PeripheralDataSize 	= DMA_PeripheralDataSize_Byte;
+	DMA_InitStructure.DMA_MemoryDataSize 		= DMA_MemoryDataSize_Byte;
+	DMA_InitStructure.DMA_Mode 					= DMA_Mode_Normal;
+	DMA_InitStructure.DMA_Priority 				= DMA_Priority_Low;
+	DMA_InitStructure.DMA_FIFOMode 				= DMA_FIFOMode_Disable;
+	DMA_InitStructure.DMA_FIFOThreshold 		= DMA_FIFOThreshold_Full;
+	DMA_InitStructure.DMA_MemoryBurst 			= DMA_MemoryBurst_Single;
+	DMA_InitStructure.DMA_PeripheralBurst 		= DMA_PeripheralBurst_Single;
+	DMA_Init(tx->stream, &DMA_InitStructure);
+
+	tx->len = 0;
+
+	NVIC_InitStructure.NVIC_IRQChannel 						= tx->irq;
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority 	= 0x0F;
+	NVIC_InitStructure.NVIC_IRQChannelSubPriority 			= 0x0F;
+	NVIC_InitStructure.NVIC_IRQChannelCmd 					= ENABLE;
+	NVIC_Init(&NVIC_InitStructure);
+
+	DMA_ITConfig(tx->stream, DMA_IT_TC, ENABLE);
+	USART_DMACmd(usart, USART_DMAReq_Tx, ENABLE);
+}
+//-----------------------------------------------------------------------------
+#define UART_MIDI_TX_FLAGS (DMA_FLAG_TCIF6 | DMA_FLAG_HTIF6 | DMA_FLAG_TEIF6 | DMA_FLAG_DMEIF6 | DMA_FLAG_FEIF6)
+/** move the next message into the tx fifo once the previous one is sent completely.
+ * runs in the tx interrupt or with the tx interrupt disabled*/
+static void uart_midiSchedule()
+{
+	if(uart_midiTx.len || fifo_midiTx.read != fifo_midiTx.write) return;
+
+	if(uart_midiRealtimeRead != uart_midiRealtimeWrite)
 	{
-			if (fifo_bufferOut(&fifo_frontTx,&data) == SUCCESS)//if there is data in the output buffer to send
-			{
-				USART_SendData(USART3, data);
-			}
-			else//if buffer empty
-			{
-				//disable Transmit Data Register empty interrupt
-				USART_ITConfig(USART3, USART_IT_TXE, DISABLE);
+		//realtime messages first, they do not change the running status
+		fifo_bufferIn(&fifo_midiTx, uart_midiRealtime[uart_midiRealtimeRead]);
+		uart_midiRealtimeRead = (uart_midiRealtimeRead+1) & (UART_MIDI_RT_SIZE-1);
+	}
+	else if(uart_midiQueueRead != uart_midiQueueWrite)
+	{
+		//the clock interrupt restarts the transfer when it sends the clock
+		if(seqClock_midiClockDue(UART_MIDI_CLOCK_GUARD)) return;
+
+		const MidiMsg* msg = &uart_midiQueue[uart_midiQueueRead];
+
+		if(msg->status >= 0xf0) {
+			//system common and sysex start/end cancel the running status
+			uart_midiRunningStatus = 0;
+			fifo_bufferIn(&fifo_midiTx, msg->status);
+		} else if(msg->status >= 0x80) {
+			//channel message, single status bytes (length 0) are always sent
+			if(msg->status != uart_midiRunningStatus || msg->bits.length == 0) {
+				fifo_bufferIn(&fifo_midiTx, msg->status);
 			}
+			uart_midiRunningStatus = msg->status;
+		} else {
+			//sysex or raw data bytes, the rest is packed into data1/2
+			fifo_bufferIn(&fifo_midiTx, msg->status);
+		}
+
+		if(msg->bits.length) {
+			fifo_bufferIn(&fifo_midiTx, msg->data1);
+			if(msg->bits.length > 1)
+				fifo_bufferIn(&fifo_midiTx, msg->data2);
+		}
+		uart_midiQueueRead = (uart_midiQueueRead+1) & (UART_MIDI_QUEUE_SIZE-1);
+	}
+	else
+	{
+		return;
+	}
+	uart_dmaTxStart(&uart_midiTx, UART_MIDI_TX_FLAGS);
+}
+//-----------------------------------------------------------------------------
+#if MIDI_OUT_DROP_REDUNDANT_CC
+/** update a CC with the same number that is still waiting in the queue.
+ * stops at the first message that must stay ordered with the CC.
+ * returns 1 if msg was merged*/
+static uint8_t uart_midiMergeCc(MidiMsg msg)
+{
+	//(n)rpn and data entry CCs only make sense as a sequence
+	if(msg.data1 == 6 || msg.data1 == 38 || (msg.data1 >= 96 && msg.data1 <= 101)) return 0;
+
+	uint8_t i = uart_midiQueueWrite;
+	while(i != uart_midiQueueRead)
+	{
+		i = (i-1) & (UART_MIDI_QUEUE_SIZE-1);
+		MidiMsg* queued = &uart_midiQueue[i];
+
+		if(queued->status == msg.status && queued->data1 == msg.data1 && queued->bits.length == 2) {
+			queued->data2 = msg.data2;
+			return 1;
+		}
+		//other CCs may be passed, anything else on the same channel, system or sysex data may not
+		if(queued->status < 0x80 || queued->status >= 0xf0) return 0;
+		if((queued->status & 0x0f) == (msg.status & 0x0f) && (queued->status & 0xf0) != MIDI_CC) return 0;
+	}
+	return 0;
+}
+#endif
+//-----------------------------------------------------------------------------
+/** append a sysex or raw data byte to the last queued sysex start or data entry.
+ * returns 1 if it fit*/
+static uint8_t uart_midiPackData(uint8_t data)
+{
+	if(uart_midiQueueWrite == uart_midiQueueRead) return 0;
+
+	MidiMsg* last = &uart_midiQueue[(uart_midiQueueWrite-1) & (UART_MIDI_QUEUE_SIZE-1)];
+	if(last->status != SYSEX_START && last->status >= 0x80) return 0;
+
+	switch(last->bits.length)
+	{
+	case 0:
+		last->data1 = data;
+		break;
+	case 1:
+		last->data2 = data;
+		break;
+	default:
+		return 0;
+	}
+	last->bits.length++;
+	return 1;
+}
+//-----------------------------------------------------------------------------
+void uart_clearFrontFifo()
+{
+	uart_dmaTxClear(&uart_frontTx);
+	uart_frontRx.tail = uart_dmaRxHead(&uart_frontRx);
+}
+//-----------------------------------------------------------------------------
+//midi rx
+void DMA1_Stream5_IRQHandler(void)
+{
+	uart_dmaRxIrq(&uart_midiRx, DMA_IT_HTIF5, DMA_IT_TCIF5);
+}
+//-----------------------------------------------------------------------------
+//midi rx idle line, stamps the end of a burst
+void USART2_IRQHandler(void)
+{
+	if(USART_GetITStatus(USART2, USART_IT_IDLE) != RESET)
+	{
+		//the flag is cleared by reading SR, then DR. the dma has fetched the data already
+		(void)USART2->DR;
+		uart_midiIdleTime = codec_getPlaybackPos();
+		uart_midiIdleHead = uart_dmaRxHead(&uart_midiRx);
+	}
+}
+//-----------------------------------------------------------------------------
+//midi tx
+void DMA1_Stream6_IRQHandler(void)
+{
+	uart_dmaTxIrq(&uart_midiTx, DMA_IT_TCIF6, UART_MIDI_TX_FLAGS);
+	//also pended by uart_sendMidiRealtime and uart_flushMidi
+	uart_midiSchedule();
+}
+//-----------------------------------------------------------------------------
+//front panel rx
+void DMA1_Stream1_IRQHandler(void)
+{
+	uart_dmaRxIrq(&uart_frontRx, DMA_IT_HTIF1, DMA_IT_TCIF1);
+}
+//-----------------------------------------------------------------------------
+//front panel tx
+void UART_FRONT_TX_IRQHANDLER(void)
+{
+	uart_dmaTxIrq(&uart_frontTx, UART_FRONT_TX_IT_TC, UART_FRONT_TX_FLAGS);
+}
+//-----------------------------------------------------------------------------
+static void uart_initRxBudget()
+{
+	uart_rxBudgetCycles = (SystemCoreClock/1000000) * UART_RX_BUDGET_US;
+}
+//-----------------------------------------------------------------------------
+/** playback position at which byte number idx was received completely*/
+static uint32_t uart_midiArrival(const uint32_t idx, const uint32_t head, const uint32_t now,
+		const uint32_t idleHead, const uint32_t idleTime)
+{
+	//the idle interrupt fires one byte time after the last byte of a burst
+	if((int32_t)(idx - idleHead) < 0) {
+		return idleTime - (idleHead - idx)*UART_MIDI_BYTE_SAMPLES;
 	}
 
+	//burst still running or its idle interrupt is not through yet
+	const uint32_t t = now - (head - 1 - idx)*UART_MIDI_BYTE_SAMPLES;
+	return (int32_t)(t - idleTime) > 0 ? t : idleTime;
 }
 //-----------------------------------------------------------------------------
 void uart_processMidi()
 {
-	uint8_t data;
-	if(fifo_bufferOut(&fifo_midiRx,&data))
+	const uint32_t start = DWT_CYCCNT;
+	uint32_t avail;
+
+	//drain the ring, but leave time for the audio calculation
+	while((avail = uart_dmaRxAvailable(&uart_midiRx)) != 0)
 	{
-		midiParser_parseUartData(data);
+		//consistent snapshot of the idle stamp, then the poll time for the bytes after it
+		NVIC_DisableIRQ(USART2_IRQn);
+		const uint32_t idleHead = uart_midiIdleHead;
+		const uint32_t idleTime = uart_midiIdleTime;
+		NVIC_EnableIRQ(USART2_IRQn);
+		const uint32_t now = codec_getPlaybackPos();
+		const uint32_t head = uart_midiRx.tail + avail;
+
+		while(avail--)
+		{
+			midiParser_setArrivalTime(uart_midiArrival(uart_midiRx.tail, head, now, idleHead, idleTime));
+			midiParser_parseUartData(uart_dmaRxRead(&uart_midiRx));
+			if(DWT_CYCCNT - start > uart_rxBudgetCycles) return;
+		}
 	}
 }
 
+//-----------------------------------------------------------------------------
 void uart_sendMidi(MidiMsg msg)
 {
-	uart_sendMidiByte(msg.status);
-	if(msg.bits.length) {
-		uart_sendMidiByte(msg.data1);
-		if(msg.bits.length > 1)
-			uart_sendMidiByte(msg.data2);
+	//the tx interrupt reads the queues
+	NVIC_DisableIRQ(DMA1_Stream6_IRQn);
+
+	if(msg.status >= 0xf8)
+	{
+		uart_sendMidiRealtime(msg.status);
+	}
+#if MIDI_OUT_DROP_REDUNDANT_CC
+	else if((msg.status & 0xf0) == MIDI_CC && msg.bits.length == 2 && uart_midiMergeCc(msg))
+	{
+		//an older value was still waiting
+	}
+#endif
+	else if(msg.status < 0x80 && msg.bits.length == 0 && uart_midiPackData(msg.status))
+	{
+		//sent with the previous sysex bytes
+	}
+	else
+	{
+		const uint8_t next = (uart_midiQueueWrite+1) & (UART_MIDI_QUEUE_SIZE-1);
+		if(next != uart_midiQueueRead) {
+			uart_midiQueue[uart_midiQueueWrite] = msg;
+			uart_midiQueueWrite = next;
+		} else {
+			uart_midiQueueDropCnt++;
+		}
 	}
 
+	uart_midiSchedule();
+	NVIC_EnableIRQ(DMA1_Stream6_IRQn);
 }
 //-----------------------------------------------------------------------------
-void uart_sendMidiByte(uint8_t data)
+void uart_sendMidiRealtime(uint8_t status)
 {
-	//put data in the output fifo
-	fifo_bufferIn(&fifo_midiTx,data);
+	//the sequencer clock interrupt is the other writer
+	NVIC_DisableIRQ(SEQ_CLOCK_IRQ);
+	const uint8_t next = (uart_midiRealtimeWrite+1) & (UART_MIDI_RT_SIZE-1);
+	if(next != uart_midiRealtimeRead) {
+		uart_midiRealtime[uart_midiRealtimeWrite] = status;
+		uart_midiRealtimeWrite = next;
+	} else {
+		uart_midiRealtimeDropCnt++;
+	}
+	NVIC_EnableIRQ(SEQ_CLOCK_IRQ);
 
-	//enable Transmit Data Register empty interrupt
-	USART_ITConfig(USART2, USART_IT_TXE, ENABLE);
+	//the tx interrupt sends it as soon as the byte on the line is out
+	NVIC_SetPendingIRQ(DMA1_Stream6_IRQn);
+}
+//-----------------------------------------------------------------------------
+void uart_flushMidi()
+{
+	NVIC_SetPendingIRQ(DMA1_Stream6_IRQn);
+}
+//-----------------------------------------------------------------------------
+void uart_sendMidiByte(uint8_t data)
+{
+	MidiMsg msg;
+	msg.status = data;
+	msg.data1 = 0;
+	msg.data2 = 0;
+	msg.bits.source = midiSourceMIDI;
+	msg.bits.sysxbyte = 0;
+	msg.bits.length = 0;
+	uart_sendMidi(msg);
 };
 //-----------------------------------------------------------------------------
 void uart_processFront()
 {
-#if UART_DEBUG_ECHO_MODE
-	uint8_t data;
-	if(fifoBig_bufferOut(&fifo_frontRx,&data))
+	const uint32_t start = DWT_CYCCNT;
+	uint32_t avail;
+
+	while((avail = uart_dmaRxAvailable(&uart_frontRx)) != 0)
 	{
-		//echo back received data
-		uart_sendFrontpanelByte(data);
-	}
+		while(avail--)
+		{
+			const uint8_t data = uart_dmaRxRead(&uart_frontRx);
+#if UART_DEBUG_ECHO_MODE
+			//echo back received data
+			uart_sendFrontpanelByte(data);
 #else
-	uint8_t data;
-	if(fifoBig_bufferOut(&fifo_frontRx,&data))
-	{
-		frontParser_parseUartData(data);
-	}
+			frontParser_parseUartData(data);
 #endif
+			if(DWT_CYCCNT - start > uart_rxBudgetCycles) return;
+		}
+	}
+}
+//-----------------------------------------------------------------------------
+uint16_t uart_getMidiRxOverflowCnt()
+{
+	return uart_midiRx.overflowCnt;
+}
+//-----------------------------------------------------------------------------
+uint16_t uart_getFrontRxOverflowCnt()
+{
+	return uart_frontRx.overflowCnt;
+}
+//-----------------------------------------------------------------------------
+uint16_t uart_getMidiTxDropCnt()
+{
+	return uart_midiQueueDropCnt + uart_midiRealtimeDropCnt;
 }
 //-----------------------------------------------------------------------------
 void uart_sendFrontpanelByte(uint8_t data)
@@ -175,18 +615,21 @@ void uart_sendFrontpanelByte(uint8_t data)
 		//put data in the output fifo
 		fifo_bufferIn(&fifo_frontTx,data);
 
-		//enable Transmit Data Register empty interrupt
-		USART_ITConfig(USART3, USART_IT_TXE, ENABLE);
+		uart_dmaTxStart(&uart_frontTx, UART_FRONT_TX_FLAGS);
 	}
 };
 //-----------------------------------------------------------------------------
+uint8_t uart_getFrontTxFree()
+{
+	return (fifo_frontTx.read - fifo_frontTx.write - 1) & BUFFER_MASK;
+}
+//-----------------------------------------------------------------------------
 void uart_sendFrontpanelSysExByte(uint8_t data)
 {
 	//put data in the output fifo
 	fifo_bufferIn(&fifo_frontTx,data);
 
-	//enable Transmit Data Register empty interrupt
-	USART_ITConfig(USART3, USART_IT_TXE, ENABLE);
+	uart_dmaTxStart(&uart_frontTx, UART_FRONT_TX_FLAGS);
 }
 //-----------------------------------------------------------------------------
 void initMidiUart()
@@ -194,7 +637,11 @@ void initMidiUart()
 
 	//init the fifo
 	fifo_init(&fifo_midiTx);
-	fifo_init(&fifo_midiRx);
+	uart_midiQueueRead = uart_midiQueueWrite = 0;
+	uart_midiRealtimeRead = uart_midiRealtimeWrite = 0;
+	uart_midiRunningStatus = 0;
+	uart_midiQueueDropCnt = uart_midiRealtimeDropCnt = 0;
+	uart_initRxBudget();
 	/*
 	 * UART2, APB1
 	 *
@@ -245,23 +692,18 @@ void initMidiUart()
 	//Enable USART2
 	USART_Cmd(USART2, ENABLE);
 
-	//Enable inmterrupt
-	//configure NVIC
+	//rx and tx through dma, the uart itself only interrupts on an idle line to timestamp the received data
+	uart_initDmaRx(&uart_midiRx, USART2, DMA_Channel_4, DMA1_Stream5_IRQn);
+	uart_initDmaTx(&uart_midiTx, USART2, DMA_Channel_4);
+
+	//the stamp is taken when the interrupt runs, it does not need to preempt the audio dma
 	NVIC_InitTypeDef NVIC_InitStructure;
-	//select NVIC channel to configure
-	NVIC_InitStructure.NVIC_IRQChannel = USART2_IRQn;
-	//set priority to lowest
-	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0x0F;
-	//set subpriority to lowest
-	NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0x0F;
-	//enable IRQ channel
-	NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
-	//update NVIC registers
+	NVIC_InitStructure.NVIC_IRQChannel 						= USART2_IRQn;
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority 	= 0x01;
+	NVIC_InitStructure.NVIC_IRQChannelSubPriority 			= 0x00;
+	NVIC_InitStructure.NVIC_IRQChannelCmd 					= ENABLE;
 	NVIC_Init(&NVIC_InitStructure);
-	//disable Transmit Data Register empty interrupt
-	USART_ITConfig(USART2, USART_IT_TXE, DISABLE);
-	//enable Receive Data register not empty interrupt
-	USART_ITConfig(USART2, USART_IT_RXNE, ENABLE);
+	USART_ITConfig(USART2, USART_IT_IDLE, ENABLE);
 }
 //-------------------------------------------------------------------------------------------
 
@@ -269,7 +711,7 @@ void initFrontpanelUart()
 {
 	//fifo init
 	fifo_init(&fifo_frontTx);
-	fifoBig_init(&fifo_frontRx);
+	uart_initRxBudget();
 	/*
 	 * UART3, APB1
 	 * (PB10 TX, PB11 RX)
@@ -324,21 +766,7 @@ void initFrontpanelUart()
 	//Enable USART3
 	USART_Cmd(USART3, ENABLE);
 
-	//Enable inmterrupt
-	//configure NVIC
-	NVIC_InitTypeDef NVIC_InitStructure;
-	//select NVIC channel to configure
-	NVIC_InitStructure.NVIC_IRQChannel = USART3_IRQn;
-	//set priority to lowest
-	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0x0F;
-	//set subpriority to lowest
-	NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0x0F;
-	//enable IRQ channel
-	NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
-	//update NVIC registers
-	NVIC_Init(&NVIC_InitStructure);
-	//disable Transmit Data Register empty interrupt
-	USART_ITConfig(USART3, USART_IT_TXE, DISABLE);
-	//enable Receive Data register not empty interrupt
-	USART_ITConfig(USART3, USART_IT_RXNE, ENABLE);
+	//rx and tx through dma, the uart itself raises no interrupts
+	uart_initDmaRx(&uart_frontRx, USART3, DMA_Channel_4, DMA1_Stream1_IRQn);
+	uart_initDmaTx(&uart_frontTx, USART3, UART_FRONT_TX_CHANNEL);
 }
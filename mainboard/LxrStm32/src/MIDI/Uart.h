@@ -38,22 +38,45 @@
 #define ACK 1
 #define NACK -1
 
+//time a main loop iteration may spend parsing the bytes of one rx buffer [us]
+#define UART_RX_BUDGET_US	100
+
+//dma rx ring sizes, power of 2
+#define UART_MIDI_RX_SIZE	128
+#define UART_FRONT_RX_SIZE	512
+
 void initMidiUart();
 
+/** queue a message for the midi out port. realtime messages are sent before all other
+ * queued messages, channel messages use running status, consecutive sysex data bytes share
+ * queue entries*/
 void uart_sendMidi(MidiMsg msg);
-
+/** queue a realtime byte, it is sent before all queued messages.
+ * may be called from the sequencer clock interrupt*/
+void uart_sendMidiRealtime(uint8_t status);
+/** restart sending queued messages, e.g. after the midi clock output was switched off*/
+void uart_flushMidi();
+/** queue a single byte for the midi out port*/
 void uart_sendMidiByte(uint8_t data);
-//check if there is some received data in the Rx buffer and send it to the midi parser
+//send the received data in the Rx dma ring to the midi parser until it is empty or the time budget is spent
 void uart_processMidi();
 
 void initFrontpanelUart();
-//check if there is data in the front panel Rx buffer and send it to the front panel parser
+//send the data in the front panel Rx dma ring to the front panel parser until it is empty or the time budget is spent
 void uart_processFront();
 //sends a byte to the frontpanel
 void uart_sendFrontpanelByte(uint8_t data);
 //send sysex data to the frontpanel
 //unlike the sendFrontPanelByte function, this function is allowed to send data whilke sysex mode is active
 void uart_sendFrontpanelSysExByte(uint8_t data);
+//number of bytes that still fit into the front panel tx fifo
+uint8_t uart_getFrontTxFree();
 
 void uart_clearFrontFifo();
+
+//number of received bytes overwritten in the rx ring before they were parsed
+uint16_t uart_getMidiRxOverflowCnt();
+uint16_t uart_getFrontRxOverflowCnt();
+//number of midi out messages dropped because the message or realtime queue was full
+uint16_t uart_getMidiTxDropCnt();
 #endif /* MIDIUART_H_ */
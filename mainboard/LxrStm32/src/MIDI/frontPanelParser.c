@@ -51,6 +51,7 @@
 #include "Snare.h"
 #include "SomGenerator.h"
 #include "TriggerOut.h"
+#include "groove.h"
 
 static void frontParser_handleMidiMessage();
 static void frontParser_handleSysexData(unsigned char data);
@@ -182,8 +183,10 @@ static void frontParser_handleSysexData(unsigned char data)
 	case SYSEX_REQUEST_PATTERN_DATA:
 		//1 byte = pattern nr
 		//send back next and repeat
-		uart_sendFrontpanelSysExByte(seq_patternSet.seq_patternSettings[data].nextPattern);
-		uart_sendFrontpanelSysExByte(seq_patternSet.seq_patternSettings[data].changeBar);
+		if(data >= NUM_PATTERN)
+			break; //malformed request
+		uart_sendFrontpanelSysExByte(seq_patterns[data]->seq_patternSettings.nextPattern);
+		uart_sendFrontpanelSysExByte(seq_patterns[data]->seq_patternSettings.changeBar);
 		break;
 
 	case SYSEX_REQUEST_MAIN_STEP_DATA:
@@ -203,7 +206,8 @@ static void frontParser_handleSysexData(unsigned char data)
 			frontParser_rxCnt = 0;
 			//we have received a complete 2 nibble step nr
 			//send data back to front
-			seq_sendMainStepInfoToFront(frontParser_twoByteData);
+			if(frontParser_twoByteData < NUM_TRACKS*NUM_PATTERN)
+				seq_sendMainStepInfoToFront(frontParser_twoByteData);
 		}
 		break;
 
@@ -225,12 +229,64 @@ static void frontParser_handleSysexData(unsigned char data)
 			frontParser_rxCnt = 0;
 			//we have received a complete 2 nibble step nr
 			//send data back to front
-			seq_sendStepInfoToFront(frontParser_twoByteData);
+			if(frontParser_twoByteData < NUM_STEPS*NUM_TRACKS*NUM_PATTERN)
+				seq_sendStepInfoToFront(frontParser_twoByteData);
 		}
 
 		break;
 
+	case SYSEX_REQUEST_LOCK_DATA:
+		//we expect a 3 byte message: track nr (pattern*7 + track) and the 2 nibble lock nr
+		if(frontParser_rxCnt<2)
+		{
+			frontParser_sysexBuffer[frontParser_rxCnt++] = data;
+		}
+		else
+		{
+			frontParser_rxCnt = 0;
+			frontParser_twoByteData = (frontParser_sysexBuffer[1]<<7) | (data&0x7f);
+			if(frontParser_sysexBuffer[0] < NUM_TRACKS*NUM_PATTERN)
+				seq_sendLockInfoToFront(frontParser_sysexBuffer[0], frontParser_twoByteData);
+		}
+		break;
+
+	case SYSEX_RECEIVE_LOCK_DATA:
+		// 4 byte records: step, dest, value, MSBs (bit0 dest, bit1 value).
+		// bit2 of the last byte ends the locks of the current track, tracks are sent in main step data order
+		if(frontParser_sysexSeqStepNr >= NUM_TRACKS*NUM_PATTERN)
+			break; //more data than tracks, drop it
+		if(frontParser_rxCnt<3)
+		{
+			frontParser_sysexBuffer[frontParser_rxCnt++] = data;
+		}
+		else
+		{
+			frontParser_rxCnt = 0;
+			if(data & 0x04)
+			{
+				frontParser_sysexSeqStepNr++;
+				break;
+			}
+
+			const uint8_t currentPattern	= frontParser_sysexSeqStepNr / 7;
+			const uint8_t currentTrack  	= frontParser_sysexSeqStepNr - currentPattern*7;
+
+			//the playing pattern is loaded into the spare slot
+			Pattern* pattern = seq_patterns[currentPattern];
+			if( (currentPattern == seq_activePattern) && seq_isRunning() )
+			{
+				pattern = seq_tmpPattern;
+			}
+			//the step data transfer released the old locks, a full pool is reported by seq_tick
+			pattern_setLock(pattern, currentTrack, frontParser_sysexBuffer[0],
+					frontParser_sysexBuffer[1] | ((data&0x01)<<7),
+					frontParser_sysexBuffer[2] | ((data&0x02)<<6));
+		}
+		break;
+
 	case SYSEX_RECEIVE_MAIN_STEP_DATA:
+		if(frontParser_sysexSeqStepNr >= NUM_TRACKS*NUM_PATTERN)
+			break; //more data than patterns, drop it
 		if(frontParser_rxCnt<2)
 		{
 			frontParser_sysexBuffer[frontParser_rxCnt++] = data;
@@ -245,15 +301,13 @@ static void frontParser_handleSysexData(unsigned char data)
 
 			uint16_t mainStepData = frontParser_sysexBuffer[0] | frontParser_sysexBuffer[1]<<7 | frontParser_sysexBuffer[2]<<14;
 
-			//first load into inactive track
-			PatternSet* patternSet = &seq_patternSet;
-
+			//the playing pattern is loaded into the spare slot
+			Pattern* pattern = seq_patterns[currentPattern];
 			if( (currentPattern == seq_activePattern) && seq_isRunning() )
 			{
-				seq_tmpPattern.seq_mainSteps[currentTrack] = mainStepData;
-			} else {
-				patternSet->seq_mainSteps[currentPattern][currentTrack] = mainStepData;
+				pattern = seq_tmpPattern;
 			}
+			pattern->seq_mainSteps[currentTrack] = mainStepData;
 
 
 			//inc the step counter
@@ -269,20 +323,19 @@ static void frontParser_handleSysexData(unsigned char data)
 		break;
 	case SYSEX_RECEIVE_PAT_LEN_DATA:
 		// --AS same as above but we are receiving length data for each pattern
+		if(frontParser_sysexSeqStepNr < NUM_TRACKS*NUM_PATTERN)
 		{
 			//calculate the step pattern and track indices
 			const uint8_t currentPattern	= frontParser_sysexSeqStepNr / 7;
 			const uint8_t currentTrack  	= frontParser_sysexSeqStepNr - currentPattern*7;
 
-			//first load into inactive track
-			PatternSet* patternSet = &seq_patternSet;
-
+			//the playing pattern is loaded into the spare slot
+			Pattern* pattern = seq_patterns[currentPattern];
 			if( (currentPattern == seq_activePattern) && seq_isRunning() )
 			{
-				seq_tmpPattern.seq_patternLengthRotate[currentTrack].length = data;
-			} else {
-				patternSet->seq_patternLengthRotate[currentPattern][currentTrack].length = data;
+				pattern = seq_tmpPattern;
 			}
+			pattern->seq_patternLengthRotate[currentTrack].length = data;
 
 
 			//inc the step counter
@@ -292,6 +345,7 @@ static void frontParser_handleSysexData(unsigned char data)
 			// signal new pattern after receiving all the data
 			if( seq_isRunning() && (frontParser_sysexSeqStepNr == NUM_TRACKS*NUM_PATTERN)) {
 				seq_newPatternAvailable = 1;
+				seq_flushLookahead();
 			}
 		}
 		break;
@@ -300,6 +354,8 @@ static void frontParser_handleSysexData(unsigned char data)
 	case SYSEX_RECEIVE_STEP_DATA:
 		// we expect a bunch of 8 byte sysex message containing new step data for the sequencer
 		// beginning with step 0 up to NUMBER_STEPS*NUM_TRACKS*NUM_PATTERN = 128*7*8 = 7168 steps
+		if(frontParser_sysexSeqStepNr >= NUM_STEPS*NUM_TRACKS*NUM_PATTERN)
+			break; //more data than steps, drop it
 		if(frontParser_rxCnt<7)
 		{
 			frontParser_sysexBuffer[frontParser_rxCnt++] = data;
@@ -320,28 +376,27 @@ static void frontParser_handleSysexData(unsigned char data)
 			const uint8_t currentPattern 	= absPat - currentTrack*8;
 			const uint8_t currentStep		= frontParser_sysexSeqStepNr - absPat*128;
 
-			PatternSet* patternSet = &seq_patternSet;
-
-			//do not overwrite playing pattern
+			//do not overwrite playing pattern, it is loaded into the spare slot
+			Pattern* pattern = seq_patterns[currentPattern];
 			if( (currentPattern == seq_activePattern)   && seq_isRunning())
 			{
-				seq_tmpPattern.seq_subStepPattern[currentTrack][currentStep].volume 	= frontParser_sysexBuffer[0];
-				seq_tmpPattern.seq_subStepPattern[currentTrack][currentStep].prob 	= frontParser_sysexBuffer[1];
-				seq_tmpPattern.seq_subStepPattern[currentTrack][currentStep].note 	= frontParser_sysexBuffer[2];
-				seq_tmpPattern.seq_subStepPattern[currentTrack][currentStep].param1Nr = frontParser_sysexBuffer[3];
-				seq_tmpPattern.seq_subStepPattern[currentTrack][currentStep].param1Val 	= frontParser_sysexBuffer[4];
-				seq_tmpPattern.seq_subStepPattern[currentTrack][currentStep].param2Nr 	= frontParser_sysexBuffer[5];
-				seq_tmpPattern.seq_subStepPattern[currentTrack][currentStep].param2Val 	= frontParser_sysexBuffer[6];
-			} else {
-
-				patternSet->seq_subStepPattern[currentPattern][currentTrack][currentStep].volume 	= frontParser_sysexBuffer[0];
-				patternSet->seq_subStepPattern[currentPattern][currentTrack][currentStep].prob 	= frontParser_sysexBuffer[1];
-				patternSet->seq_subStepPattern[currentPattern][currentTrack][currentStep].note 	= frontParser_sysexBuffer[2];
-				patternSet->seq_subStepPattern[currentPattern][currentTrack][currentStep].param1Nr = frontParser_sysexBuffer[3];
-				patternSet->seq_subStepPattern[currentPattern][currentTrack][currentStep].param1Val 	= frontParser_sysexBuffer[4];
-				patternSet->seq_subStepPattern[currentPattern][currentTrack][currentStep].param2Nr 	= frontParser_sysexBuffer[5];
-				patternSet->seq_subStepPattern[currentPattern][currentTrack][currentStep].param2Val 	= frontParser_sysexBuffer[6];
+				pattern = seq_tmpPattern;
+			}
+			//a new track starts, release the pool memory of the old data
+			if(currentStep == 0)
+			{
+				pattern_resetSteps(pattern, currentTrack);
 			}
+			Step step;
+			step.volume 	= frontParser_sysexBuffer[0];
+			step.prob 		= frontParser_sysexBuffer[1];
+			step.note 		= frontParser_sysexBuffer[2];
+			step.param1Nr 	= frontParser_sysexBuffer[3];
+			step.param1Val 	= frontParser_sysexBuffer[4];
+			step.param2Nr 	= frontParser_sysexBuffer[5];
+			step.param2Val 	= frontParser_sysexBuffer[6];
+			pattern_writeStep(pattern, currentTrack, currentStep, &step);
+
 			//signal that a new data chunk is available
 			//frontParser_newSeqDataAvailable = 1;
 			//reset receive counter for next chunk
@@ -457,9 +512,9 @@ static void frontParser_handleMidiMessage()
 			uint8_t val = (hi<<7)|lo;
 			if(val && val < 128 )
 				val++;
-			seq_patternSet.seq_subStepPattern[frontParser_shownPattern]
-			                                 [frontParser_activeTrack]
-			                                 [seq_selectedStep].param1Nr = val;
+			Step* step = pattern_editStep(seq_patterns[frontParser_shownPattern], frontParser_activeTrack, seq_selectedStep);
+			if(step)
+				step->param1Nr = val;
 		}
 		break;
 	case FRONT_SET_P2_DEST: { // frontParser_midiMsg.status
@@ -469,22 +524,26 @@ static void frontParser_handleMidiMessage()
 			uint8_t val = (hi<<7)|lo;
 			if(val && val < 128 )
 				val++;
-			seq_patternSet.seq_subStepPattern[frontParser_shownPattern]
-			                                 [frontParser_activeTrack]
-			                                 [seq_selectedStep].param2Nr = val;
+			Step* step = pattern_editStep(seq_patterns[frontParser_shownPattern], frontParser_activeTrack, seq_selectedStep);
+			if(step)
+				step->param2Nr = val;
 		}
 		break;
 	case FRONT_SET_P1_VAL: { // frontParser_midiMsg.status
 			uint8_t stepNr = frontParser_midiMsg.data1;
 			uint8_t value = frontParser_midiMsg.data2;
-			seq_patternSet.seq_subStepPattern[frontParser_shownPattern][frontParser_activeTrack][stepNr].param1Val = value;
+			Step* step = pattern_editStep(seq_patterns[frontParser_shownPattern], frontParser_activeTrack, stepNr);
+			if(step)
+				step->param1Val = value;
 
 		}
 		break;
 	case FRONT_SET_P2_VAL: { // frontParser_midiMsg.status
 			uint8_t stepNr = frontParser_midiMsg.data1;
 			uint8_t value = frontParser_midiMsg.data2;
-			seq_patternSet.seq_subStepPattern[frontParser_shownPattern][frontParser_activeTrack][stepNr].param2Val = value;
+			Step* step = pattern_editStep(seq_patterns[frontParser_shownPattern], frontParser_activeTrack, stepNr);
+			if(step)
+				step->param2Val = value;
 		}
 		break;
 
@@ -609,19 +668,21 @@ static void frontParser_handleSeqCC()
 		/* send back bar change and next pattern params from requested pattern*/
 		uart_sendFrontpanelByte(FRONT_SEQ_CC);
 		uart_sendFrontpanelByte(FRONT_SEQ_SET_PAT_BEAT);
-		uart_sendFrontpanelByte(seq_patternSet.seq_patternSettings[frontParser_shownPattern].changeBar);
+		uart_sendFrontpanelByte(seq_patterns[frontParser_shownPattern]->seq_patternSettings.changeBar);
 
 		uart_sendFrontpanelByte(FRONT_SEQ_CC);
 		uart_sendFrontpanelByte(FRONT_SEQ_SET_PAT_NEXT);
-		uart_sendFrontpanelByte(seq_patternSet.seq_patternSettings[frontParser_shownPattern].nextPattern);
+		uart_sendFrontpanelByte(seq_patterns[frontParser_shownPattern]->seq_patternSettings.nextPattern);
 
 
 		break;
 	case FRONT_SEQ_SET_PAT_BEAT:
-		seq_patternSet.seq_patternSettings[frontParser_shownPattern].changeBar = frontParser_midiMsg.data2;
+		seq_patterns[frontParser_shownPattern]->seq_patternSettings.changeBar = frontParser_midiMsg.data2;
+		seq_flushLookahead();
 		break;
 	case FRONT_SEQ_SET_PAT_NEXT:
-		seq_patternSet.seq_patternSettings[frontParser_shownPattern].nextPattern = frontParser_midiMsg.data2;
+		seq_patterns[frontParser_shownPattern]->seq_patternSettings.nextPattern = frontParser_midiMsg.data2;
+		seq_flushLookahead();
 		break;
 
 	case FRONT_SEQ_REC_ON_OFF:
@@ -633,17 +694,30 @@ static void frontParser_handleSeqCC()
 		break;
 
 	case FRONT_SEQ_NOTE:
-		seq_patternSet.seq_subStepPattern[frontParser_shownPattern][frontParser_activeTrack][frontParser_activeStep].note = frontParser_midiMsg.data2;
+		{
+			Step* step = pattern_editStep(seq_patterns[frontParser_shownPattern], frontParser_activeTrack, frontParser_activeStep);
+			if(step)
+				step->note = frontParser_midiMsg.data2;
+			seq_flushLookahead();
+		}
 		break;
 
 	case FRONT_SEQ_VOLUME:
-		seq_patternSet.seq_subStepPattern[frontParser_shownPattern][frontParser_activeTrack][frontParser_activeStep].volume &= ~(0x7f);
-		seq_patternSet.seq_subStepPattern[frontParser_shownPattern][frontParser_activeTrack][frontParser_activeStep].volume |= (frontParser_midiMsg.data2&0x7f);
+		{
+			Step* step = pattern_editStep(seq_patterns[frontParser_shownPattern], frontParser_activeTrack, frontParser_activeStep);
+			if(step)
+				step->volume = frontParser_midiMsg.data2&STEP_VOLUME_MASK;
+			seq_flushLookahead();
+		}
 		break;
 
 	case FRONT_SEQ_PROB:
-
-		seq_patternSet.seq_subStepPattern[frontParser_shownPattern][frontParser_activeTrack][frontParser_activeStep].prob = frontParser_midiMsg.data2;
+		{
+			Step* step = pattern_editStep(seq_patterns[frontParser_shownPattern], frontParser_activeTrack, frontParser_activeStep);
+			if(step)
+				step->prob = frontParser_midiMsg.data2;
+			seq_flushLookahead();
+		}
 		break;
 
 	case FRONT_SEQ_EUKLID_LENGTH:
@@ -660,8 +734,8 @@ static void frontParser_handleSeqCC()
 			steps += 1;
 			uint8_t pattern = frontParser_midiMsg.data2 & 0x7;
 
-			euklid_setSteps(frontParser_activeTrack,steps,pattern);
-			frontParser_updateTrackLeds(frontParser_activeTrack, pattern);
+			if(euklid_setSteps(frontParser_activeTrack,steps,pattern))
+				frontParser_updateTrackLeds(frontParser_activeTrack, pattern);
 		}
 		break;
 
@@ -671,8 +745,8 @@ static void frontParser_handleSeqCC()
 			//rotation += 1;
 			uint8_t pattern = frontParser_midiMsg.data2 & 0x7;
 
-			euklid_setRotation(frontParser_activeTrack,rotation,pattern);
-			frontParser_updateTrackLeds(frontParser_activeTrack, pattern);
+			if(euklid_setRotation(frontParser_activeTrack,rotation,pattern))
+				frontParser_updateTrackLeds(frontParser_activeTrack, pattern);
 		}
 		break;
 
@@ -694,7 +768,7 @@ static void frontParser_handleSeqCC()
 		break;
 
 	case FRONT_SEQ_FLUX:
-		som_setFlux(frontParser_midiMsg.data2/127.f);
+		som_setFlux(frontParser_midiMsg.data2);
 		break;
 
 	case FRONT_SEQ_SOM_FREQ:
@@ -792,25 +866,25 @@ static void frontParser_handleSeqCC()
 	case FRONT_SEQ_REQUEST_STEP_PARAMS:{
 
 
+		const Step* step = pattern_getStep(seq_patterns[frontParser_shownPattern], frontParser_activeTrack, frontParser_midiMsg.data2);
+
 		/* send back probability, volume and note nr*/
 		uart_sendFrontpanelByte(FRONT_SEQ_CC);
 		uart_sendFrontpanelByte(FRONT_SEQ_VOLUME);
-		uart_sendFrontpanelByte(seq_patternSet.seq_subStepPattern[frontParser_shownPattern][frontParser_activeTrack][frontParser_midiMsg.data2].volume&STEP_VOLUME_MASK);
+		uart_sendFrontpanelByte(step->volume);
 
 		uart_sendFrontpanelByte(FRONT_SEQ_CC);
 		uart_sendFrontpanelByte(FRONT_SEQ_NOTE);
-		uart_sendFrontpanelByte(seq_patternSet.seq_subStepPattern[frontParser_shownPattern][frontParser_activeTrack][frontParser_midiMsg.data2].note);
+		uart_sendFrontpanelByte(step->note);
 
 		uart_sendFrontpanelByte(FRONT_SEQ_CC);
 		uart_sendFrontpanelByte(FRONT_SEQ_PROB);
-		uart_sendFrontpanelByte(seq_patternSet.seq_subStepPattern[frontParser_shownPattern][frontParser_activeTrack][frontParser_midiMsg.data2].prob);
+		uart_sendFrontpanelByte(step->prob);
 
 		//send back automation params
 		// --AS **AUTOM subtract one for differing offsets when parameter is < 128
 		uint8_t hi,lo;
-		uint8_t dest = seq_patternSet.seq_subStepPattern[frontParser_shownPattern]
-														[frontParser_activeTrack]
-														[frontParser_midiMsg.data2].param1Nr;
+		uint8_t dest = step->param1Nr;
 		if(dest < 128 && dest)
 			dest--;
 		hi = dest>>7;
@@ -819,18 +893,14 @@ static void frontParser_handleSeqCC()
 		uart_sendFrontpanelByte(hi);
 		uart_sendFrontpanelByte(lo);
 
-		uint8_t val = seq_patternSet.seq_subStepPattern[frontParser_shownPattern]
-													   [frontParser_activeTrack]
-													   [frontParser_midiMsg.data2].param1Val;
+		uint8_t val = step->param1Val;
 		hi = val>>7;
 		lo = val&0x7f;
 		uart_sendFrontpanelByte(FRONT_SET_P1_VAL);
 		uart_sendFrontpanelByte(hi);
 		uart_sendFrontpanelByte(lo);
 		// --AS **AUTOM subtract one for differing offsets
-		dest = seq_patternSet.seq_subStepPattern[frontParser_shownPattern]
-												[frontParser_activeTrack]
-												[frontParser_midiMsg.data2].param2Nr;
+		dest = step->param2Nr;
 		if(dest < 128 && dest)
 			dest--;
 		hi = dest>>7;
@@ -839,9 +909,7 @@ static void frontParser_handleSeqCC()
 		uart_sendFrontpanelByte(hi);
 		uart_sendFrontpanelByte(lo);
 
-		val = seq_patternSet.seq_subStepPattern[frontParser_shownPattern]
-											   [frontParser_activeTrack]
-											   [frontParser_midiMsg.data2].param2Val;
+		val = step->param2Val;
 		hi = val>>7;
 		lo = val&0x7f;
 		uart_sendFrontpanelByte(FRONT_SET_P2_VAL);
@@ -973,6 +1041,10 @@ static void frontParser_handleSeqCC()
 		trigger_setGatemode(frontParser_midiMsg.data2);
 		break;
 
+	case FRONT_SEQ_GROOVE:
+		groove_select(frontParser_midiMsg.data2);
+		break;
+
 	default:
 		break;
 	}
@@ -44,8 +44,9 @@ uint8_t euklid_getLength(uint8_t trackNr);
 uint8_t euklid_getSteps(uint8_t trackNr);
 uint8_t euklid_getRotation(uint8_t trackNr);
 void euklid_setLength(uint8_t trackNr, uint8_t value);
-void euklid_setSteps(uint8_t trackNr, uint8_t value, uint8_t patternNr);
-void euklid_setRotation(uint8_t trackNr, uint8_t value, uint8_t patternNr);
+/** the setters regenerate the track pattern and return 1 if it changed */
+uint8_t euklid_setSteps(uint8_t trackNr, uint8_t value, uint8_t patternNr);
+uint8_t euklid_setRotation(uint8_t trackNr, uint8_t value, uint8_t patternNr);
 void euklid_rotatePattern(uint8_t length, uint8_t amount);
 void euklid_transferPattern(uint8_t trackNr, uint8_t patternNr);
 #endif /* EUKLIDGENERATOR_H_ */
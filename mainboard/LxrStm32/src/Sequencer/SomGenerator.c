@@ -37,16 +37,80 @@
 #include "SomGenerator.h"
 #include "SomData.h"
 #include "sequencer.h"
-#include "math.h"
 
 SomGenerator somGenerator;
 
+#define SOM_CENTER		63		/**< raw x/y value of the map center*/
+#define SOM_ONE			256		/**< fixed point 1.0 for the x/y weights*/
+//-----------------------------------------------
+/** xorshift32, cheap enough to run for every track on a step edge*/
+static uint32_t som_rand()
+{
+	uint32_t r = somGenerator.rngState;
+	r ^= r << 13;
+	r ^= r >> 17;
+	r ^= r << 5;
+	somGenerator.rngState = r;
+	return r;
+}
+//-----------------------------------------------
+/** distance of a raw position value from the map center as 0..SOM_ONE*/
+static uint32_t som_calcWeight(uint8_t pos)
+{
+	uint32_t dist = pos<SOM_CENTER ? SOM_CENTER-pos : pos-SOM_CENTER;
+	uint32_t w = (dist*SOM_ONE)/SOM_CENTER;
+	if(w>SOM_ONE) w = SOM_ONE;
+	return w;
+}
+//-----------------------------------------------
+/** recalculate the interpolated map for the current x/y position.
+ *  picks the 4 nodes of the quadrant, precalculates their bilinear weights
+ *  and evaluates all 16 main steps of the 7 tracks
+ */
+static void som_updateMap()
+{
+	const uint8_t x = somGenerator.x;
+	const uint8_t y = somGenerator.y;
+	uint8_t node1,node2,node3,node4;
+
+	if(x < SOM_CENTER)
+	{
+		if(y > SOM_CENTER)	{ node1 = 4; node2 = 3; node3 = 7; node4 = 6; }
+		else				{ node1 = 1; node2 = 0; node3 = 4; node4 = 3; }
+	} else {
+		if(y >= SOM_CENTER)	{ node1 = 4; node2 = 5; node3 = 7; node4 = 8; }
+		else				{ node1 = 1; node2 = 2; node3 = 4; node4 = 5; }
+	}
+
+	//weights in 16.16 fixed point, they always sum up to 1
+	const uint32_t wx = som_calcWeight(x);
+	const uint32_t wy = som_calcWeight(y);
+	const uint32_t w1 = wx*wy;
+	const uint32_t w2 = (SOM_ONE-wx)*wy;
+	const uint32_t w3 = wx*(SOM_ONE-wy);
+	const uint32_t w4 = (SOM_ONE-wx)*(SOM_ONE-wy);
+
+	const uint8_t* n1 = som_nodes[node1];
+	const uint8_t* n2 = som_nodes[node2];
+	const uint8_t* n3 = som_nodes[node3];
+	const uint8_t* n4 = som_nodes[node4];
+
+	int i,step;
+	for(step=0;step<SOM_NUM_STEPS;step++)
+	{
+		for(i=0;i<7;i++)
+		{
+			const uint16_t idx = i*128 + step*8;
+			somGenerator.values[step][i] = (w1*n1[idx] + w2*n2[idx] + w3*n3[idx] + w4*n4[idx]) >> 16;
+		}
+	}
+}
 //-----------------------------------------------
 void som_init()
 {
 
-	somGenerator.x = 0;
-	somGenerator.y = 0;
+	somGenerator.x = SOM_CENTER;
+	somGenerator.y = SOM_CENTER;
 
 	somGenerator.frequency[0] = 0x7f;
 	somGenerator.frequency[1] = 0x7f;
@@ -56,39 +120,12 @@ void som_init()
 	somGenerator.frequency[5] = 0x7f;
 	somGenerator.frequency[6] = 0x7f;
 
-	somGenerator.flux = 0.1;
-}
-//-----------------------------------------------
-void som_interpolate(uint8_t stepNr, uint8_t* values, uint8_t node1, uint8_t node2, uint8_t node3, uint8_t node4)
-{
-
-	float x = fabsf(somGenerator.x );//* rnd);
-	float y = fabsf(somGenerator.y );//* rnd);
-
-	if(x<-1)x=-1;
-	else if(x>1)x=1;
-
-	if(y<-1)y=-1;
-	else if(y>1)y=1;
-
-
-
-
-	int i;
-	for(i=0;i<7;i++)
-	{
-		const uint8_t a = x*(som_nodes[node1][i*128 + stepNr]-som_nodes[node2][i*128 + stepNr]) + som_nodes[node2][i*128 + stepNr];
-		const uint8_t b = x*(som_nodes[node3][i*128 + stepNr]-som_nodes[node4][i*128 + stepNr]) + som_nodes[node4][i*128 + stepNr];
-		values[i] = y*(a-b)+b;
-
-		uint8_t rnd = GetRngValue()/(float)0xffffffff * somGenerator.flux * 254 ;
-		if(values[i] <= 254-rnd)
-		{
-			values[i] += rnd;
-		}
-	}
+	somGenerator.flux = 25;
 
+	//xorshift must never be seeded with 0
+	somGenerator.rngState = GetRngValue() | 1;
 
+	som_updateMap();
 }
 //-----------------------------------------------
 void som_tick(uint8_t stepNr, uint8_t mutedTracks)
@@ -96,45 +133,25 @@ void som_tick(uint8_t stepNr, uint8_t mutedTracks)
 
 	if(stepNr%8 != 0)return;
 
-		uint8_t values[7];
-
-		uint8_t area = 0;
-		if (somGenerator.x < 0 && somGenerator.y < 0) area = 1;
-		else if (somGenerator.x < 0 && somGenerator.y > 0) area = 2;
-		else if (somGenerator.x >= 0 && somGenerator.y >= 0) area = 3;
-		else if (somGenerator.x >= 0 && somGenerator.y <= 0) area = 4;
-
-		switch(area)
-		{
-		default:
-
-		case 1:
-			som_interpolate(stepNr,values,1,0,4,3);
-			break;
-
-		case 2:
-			som_interpolate(stepNr,values,4,3,7,6);
-			break;
-
-		case 3:
-			som_interpolate(stepNr,values,4,5,7,8);
-			break;
-
-		case 4:
-			som_interpolate(stepNr,values,1,2,4,5);
-			break;
-
-		}
+		const uint8_t* values = somGenerator.values[stepNr/8];
 
 		int i;
 		for(i=0;i<7;i++)
 		{
-			if( somGenerator.frequency[i] < values[i])
+			uint8_t value = values[i];
+
+			const uint8_t rnd = ((som_rand()>>24) * somGenerator.flux) >> 8;
+			if(value <= 254-rnd)
+			{
+				value += rnd;
+			}
+
+			if( somGenerator.frequency[i] < value)
 			{
 				if(!(mutedTracks & (1<<i) ) )
 				{
 					//trigger note
-					uint8_t vol = 64+ (values[i] >> 2);
+					uint8_t vol = 64+ (value >> 2);
 					seq_triggerVoice(i,vol,SEQ_DEFAULT_NOTE);
 				}
 
@@ -146,17 +163,21 @@ void som_tick(uint8_t stepNr, uint8_t mutedTracks)
 //-----------------------------------------------
 void som_setX(uint8_t x)
 {
-	somGenerator.x = (x/63.f)-1;
+	if(somGenerator.x == x) return;
+	somGenerator.x = x;
+	som_updateMap();
 }
 //-----------------------------------------------
 void som_setY(uint8_t y)
 {
-	somGenerator.y = (y/63.f)-1;
+	if(somGenerator.y == y) return;
+	somGenerator.y = y;
+	som_updateMap();
 }
 //-----------------------------------------------
-void som_setFlux(float flux)
+void som_setFlux(uint8_t flux)
 {
-	somGenerator.flux = flux;
+	somGenerator.flux = flux*2;
 }
 //-----------------------------------------------
 void som_setFreq(uint8_t freq, uint8_t voice)
@@ -41,17 +41,23 @@
 #include "random.h"
 
 
+#define SOM_NUM_STEPS	16		/**< the map is evaluated on every main step*/
+
 typedef struct SomGeneratorStruct
 {
-	//position
-	float x;
-	float y;
+	//position, raw 0-127 with the map center at 63
+	uint8_t x;
+	uint8_t y;
 
 	//voice frequency
 	uint8_t frequency[7];
 
-	float flux;
+	//scale of the random offset 0-254
+	uint8_t flux;
+	uint32_t rngState;
 
+	//interpolated map values for the current position
+	uint8_t values[SOM_NUM_STEPS][7];
 
 }SomGenerator;
 
@@ -60,7 +66,7 @@ void som_tick(uint8_t stepNr, uint8_t mutedTracks);
 
 void som_setX(uint8_t x);
 void som_setY(uint8_t y);
-void som_setFlux(float flux);
+void som_setFlux(uint8_t flux);
 void som_setFreq(uint8_t freq, uint8_t voice);
 
 extern SomGenerator somGenerator;
@@ -36,56 +36,149 @@
 
 
 #include "clockSync.h"
+#include "seqClock.h"
+#include "cs4344_cs5343.h"
 
-static float sync_window[WINDOW_SIZE];
-float sync_timeLast = 0;
-uint8_t sync_writePos = 0;
-uint8_t sync_armed = 0;
+//------------------------------------------------------------------------
+// The internal 96 ppq clock is phase locked to the incoming 24 ppq midi clock.
+// On every midi clock the position of the internal clock is compared to the
+// expected position (4 pulses per clock). Clocks are stamped with the time the
+// byte arrived, not the time the main loop parses it. A PI controller slews the pulse
+// length: the proportional part corrects the phase, the integral part tracks
+// the fractional tempo. Clocks with a large phase error are ignored, a run of
+// them or a stalled clock unlocks the loop and the sequencer is hard realigned
+// on the next sync clock.
+//------------------------------------------------------------------------
+static float sync_pulseLength = 0;		/**< tracked tempo, internal pulse length [samples]*/
+static uint32_t sync_lastClockPos = 0;	/**< arrival sample position of the last midi clock*/
+static uint32_t sync_clocks = 0;		/**< midi clocks since the internal clock was aligned*/
+static uint8_t sync_locked = 0;
+static uint8_t sync_outliers = 0;
+static uint8_t sync_tempoJumps = 0;
 
 uint8_t sync_clockCnt = 0;
 //---------------------------------------------------------
-uint16_t sync_calcBpm(float timePerPulse)
+static uint16_t sync_calcBpm(float pulseLength)
 {
-	// 1 Minute has 60 * 1000 [ms]
-	//we have 24 pulses per quarter
-	//120 bpm = 120 quarters per minute
-
-	float quarterDuration = 24 * (timePerPulse/4);
-	float bpm = (60 * 1000) / quarterDuration;
+	const float bpm = REAL_FS*60.f / (pulseLength*SEQ_CLOCK_PPQ);
+	return bpm>1 ? (uint16_t)(bpm+0.5f) : 1;
+}
+//---------------------------------------------------------
+/** follow the measured clock interval directly. used while the sequencer is stopped
+ *  and to catch up with tempo jumps that are too large for the loop*/
+static void sync_trackInterval(float measured)
+{
+	if(sync_pulseLength == 0)
+	{
+		sync_pulseLength = measured;
+		return;
+	}
 
-	return bpm>0?bpm:1;
+	const float ratio = measured/sync_pulseLength;
+	if(ratio > (1+SYNC_MAX_SLEW) || ratio < (1-SYNC_MAX_SLEW))
+	{
+		//single late or early clocks are jitter, consecutive ones a tempo change
+		if(++sync_tempoJumps >= SYNC_MAX_OUTLIERS)
+		{
+			sync_tempoJumps = 0;
+			sync_pulseLength = measured;
+		}
+		return;
+	}
+	sync_tempoJumps = 0;
+	sync_pulseLength += (measured-sync_pulseLength)*SYNC_INTERVAL_GAIN;
 }
 //---------------------------------------------------------
-//called by midi clock
-void sync_tick()
+static void sync_updateBpm()
+{
+	const uint16_t bpm = sync_calcBpm(sync_pulseLength);
+	if(bpm != seq_getBpm())
+	{
+		seq_setSyncedBpm(bpm);
+	}
+}
+//---------------------------------------------------------
+static void sync_align()
+{
+	seq_resetDeltaAndTick();
+	seqClock_setPulseLength(sync_pulseLength);
+	sync_clocks = 0;
+	sync_outliers = 0;
+	sync_locked = 1;
+}
+//---------------------------------------------------------
+static void sync_updatePll(float measured, uint32_t arrival)
 {
-	float time = systick_ticks - sync_timeLast;
-	sync_timeLast = systick_ticks;
+	sync_clocks++;
 
-	sync_window[sync_writePos++] = time;
-	sync_writePos &= WINDOW_MASK;
+	float frac;
+	const uint32_t pulses = seqClock_getPosition(&frac);
+	//the internal clock kept running while the clock byte waited to be parsed
+	const float late = (int32_t)(codec_getPlaybackPos() - arrival) / seqClock_getPulseLength();
+	//positive error => the internal clock is behind
+	const float err = (int32_t)(sync_clocks*SYNC_PULSES_PER_CLOCK - pulses) - frac + late;
 
-	//calc average time in [ms] between midi clock pulses
-	int i;
-	float avg=0;
-	for(i=0;i<WINDOW_SIZE;i++)
+	if(err > SYNC_MAX_PHASE_ERR || err < -SYNC_MAX_PHASE_ERR)
 	{
-		avg += sync_window[i];
+		if(++sync_outliers >= SYNC_MAX_OUTLIERS)
+		{
+			sync_locked = 0;
+		}
+		//a tempo jump shows up as a run of outliers, follow it for the realignment
+		sync_trackInterval(measured);
+		return;
 	}
-	avg /= WINDOW_SIZE;
+	sync_outliers = 0;
+
+	//integral part: tempo
+	sync_pulseLength -= sync_pulseLength*err*SYNC_FREQ_GAIN;
 
-	seq_setBpm(sync_calcBpm(avg));
+	//proportional part: phase, limited so the tempo never jumps audibly
+	float slew = err*SYNC_PHASE_GAIN;
+	if(slew > SYNC_MAX_SLEW) slew = SYNC_MAX_SLEW;
+	else if(slew < -SYNC_MAX_SLEW) slew = -SYNC_MAX_SLEW;
+
+	seqClock_setPulseLength(sync_pulseLength*(1.f-slew));
+}
+//---------------------------------------------------------
+//called by midi clock
+void sync_tick(uint32_t arrival)
+{
+	const uint32_t interval = arrival - sync_lastClockPos;
+	sync_lastClockPos = arrival;
 
 	sync_clockCnt++;
+	if(sync_clockCnt >= 4) sync_clockCnt = 1;
+
+	const float measured = interval/(float)SYNC_PULSES_PER_CLOCK;
 
-	if(seq_isRunning())
+	if(!seq_isRunning() || !sync_locked)
 	{
-		//now handle sequencer transport (4 steps every 3 clocks)
-		if(sync_clockCnt == 1 || sync_clockCnt >= 4) {
-			sync_clockCnt = 1;
-			seq_resetDeltaAndTick();
+		sync_trackInterval(measured);
+		sync_updateBpm();
+
+		//(re)align the step grid on the sync clock (4 steps every 3 clocks)
+		if(seq_isRunning() && sync_clockCnt == 1)
+		{
+			sync_align();
 		}
+		return;
+	}
+
+	sync_updatePll(measured, arrival);
+	sync_updateBpm();
+}
+//---------------------------------------------------------
+uint8_t sync_isLocked()
+{
+	if(!sync_locked) return 0;
+
+	//external clock stalled
+	if((int32_t)(codec_getPlaybackPos() - sync_lastClockPos) > SYNC_TIMEOUT_CLOCKS*SYNC_PULSES_PER_CLOCK*sync_pulseLength)
+	{
+		sync_locked = 0;
 	}
+	return sync_locked;
 }
 //---------------------------------------------------------
 void sync_midiStartStop(uint8_t isStart)
@@ -93,9 +186,11 @@ void sync_midiStartStop(uint8_t isStart)
 	if(isStart) {
 		// this message does NOT mean start immediately! it just 'arms' the seq to start at the next MIDI_CLOCK received
 		sync_clockCnt = 0;
+		sync_locked = 0;
 		seq_setRunning(1);
-		sync_timeLast = systick_ticks;
+		sync_lastClockPos = codec_getPlaybackPos();
 	} else {
+		sync_locked = 0;
 		seq_setRunning(0);
 	}
 }
@@ -45,8 +45,14 @@
 #include "config.h"
 #include "sequencer.h"
 
-#define WINDOW_SIZE 8
-#define WINDOW_MASK 0x07
+#define SYNC_PULSES_PER_CLOCK	4		// 96 ppq internal clock / 24 ppq midi clock
+#define SYNC_PHASE_GAIN			0.1f	// slew per pulse of phase error
+#define SYNC_FREQ_GAIN			0.005f	// tempo correction per pulse of phase error
+#define SYNC_MAX_SLEW			0.1f	// max. deviation of the pulse length from the tracked tempo
+#define SYNC_INTERVAL_GAIN		0.25f	// smoothing of the measured interval while stopped
+#define SYNC_MAX_PHASE_ERR		2.f		// [pulses] clocks off by more than half a clock are outliers
+#define SYNC_MAX_OUTLIERS		4		// consecutive outliers until the loop unlocks
+#define SYNC_TIMEOUT_CLOCKS		3		// missing clocks until the sequencer holds
 
 
 /*
@@ -57,9 +63,11 @@
  for every 3 midi clocks we have to advance 4 steps
  */
 
-//called by midi clock
-void sync_tick();
+//called by midi clock. arrival is the playback position the clock byte was received at
+void sync_tick(uint32_t arrival);
 void sync_midiStartStop(uint8_t isStart);
+/** the internal clock is locked to a running external clock*/
+uint8_t sync_isLocked();
 uint8_t sync_getClockCnt();
 
 #endif /* CLOCKSYNC_H_ */
@@ -0,0 +1,138 @@
+/*
+ * groove.c
+ *
+ *  Created on: 18.10.2026
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  Copyright 2013 Julian Schmidt
+ *  Julian@sonic-potions.com
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  This file is part of the Sonic Potions LXR drumsynth firmware.
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  Redistribution and use of the LXR code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *       - The code may not be sold, nor may it be used in a commercial product or activity.
+ *
+ *       - Redistributions that are modified from the original source must include the complete
+ *         source code, including the source code for all components used by a binary built
+ *         from the modified sources. However, as a special exception, the source code distributed
+ *         need not include anything that is normally distributed (in either source or binary form)
+ *         with the major components (compiler, kernel, and so on) of the operating system on which
+ *         the executable runs, unless that component itself accompanies the executable.
+ *
+ *       - Redistributions must reproduce the above copyright notice, this list of conditions and the
+ *         following disclaimer in the documentation and/or other materials provided with the distribution.
+ * ------------------------------------------------------------------------------------------------------------------------
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *   WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *   USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ------------------------------------------------------------------------------------------------------------------------
+ */
+
+
+#include "groove.h"
+#if USE_SD_CARD
+#include "ff.h"
+#endif
+
+#define GROOVE_HEADER_SIZE	8
+
+// the classic lxr shuffle: every 2nd 16th note of a half beat (16 steps) is shifted full.
+// 16 pulses * (n/8)^2 up to step 8, 16 pulses * (1-((n-8)/8)^2) after it, exact in delay units
+static const uint16_t groove_builtin[16] =
+{
+		0, 4, 16, 36, 64, 100, 144, 196, 256, 252, 240, 220, 192, 156, 112, 60
+};
+
+static uint16_t groove_template[GROOVE_MAX_STEPS];
+static uint8_t groove_length;
+static float groove_amount = 0;
+static float groove_delay[GROOVE_MAX_STEPS];	/**< scaled template [pulses]*/
+//------------------------------------------------------------------------
+static void groove_update()
+{
+	uint8_t i;
+	const float scale = groove_amount / GROOVE_DELAY_UNIT;
+	for(i=0;i<groove_length;i++)
+	{
+		groove_delay[i] = groove_template[i] * scale;
+	}
+}
+//------------------------------------------------------------------------
+static void groove_loadBuiltin()
+{
+	uint8_t i;
+	groove_length = sizeof(groove_builtin);
+	for(i=0;i<groove_length;i++)
+	{
+		groove_template[i] = groove_builtin[i];
+	}
+}
+//------------------------------------------------------------------------
+void groove_init()
+{
+	groove_loadBuiltin();
+	groove_update();
+}
+//------------------------------------------------------------------------
+void groove_setAmount(float amount)
+{
+	groove_amount = amount;
+	groove_update();
+}
+//------------------------------------------------------------------------
+uint8_t groove_select(uint8_t grooveNr)
+{
+	if(grooveNr == GROOVE_BUILTIN)
+	{
+		groove_loadBuiltin();
+		groove_update();
+		return 1;
+	}
+
+#if USE_SD_CARD
+	FIL file;
+	UINT bytesRead;
+	uint8_t header[GROOVE_HEADER_SIZE];
+	uint8_t data[GROOVE_MAX_STEPS];
+	char filename[] = "/grooves/GROOVE00.GRV";
+
+	if(grooveNr >= 100) return 0;
+	filename[15] = '0' + grooveNr/10;
+	filename[16] = '0' + grooveNr%10;
+
+	if(f_open(&file, filename, FA_OPEN_EXISTING | FA_READ) != FR_OK)
+		return 0;
+
+	uint8_t ok = f_read(&file, header, GROOVE_HEADER_SIZE, &bytesRead) == FR_OK && bytesRead == GROOVE_HEADER_SIZE
+			&& header[0] == 'L' && header[1] == 'X' && header[2] == 'R' && header[3] == 'G'
+			&& header[4] > 0 && header[4] <= GROOVE_MAX_STEPS;
+
+	ok = ok && f_read(&file, data, header[4], &bytesRead) == FR_OK && bytesRead == header[4];
+	f_close(&file);
+
+	if(!ok) return 0;
+
+	//swap in only complete templates
+	uint8_t i;
+	for(i=0;i<header[4];i++)
+	{
+		groove_template[i] = data[i];
+	}
+	groove_length = header[4];
+	groove_update();
+	return 1;
+#else
+	return 0;
+#endif
+}
+//------------------------------------------------------------------------
+float groove_getDelay(uint8_t masterStep)
+{
+	return groove_delay[masterStep % groove_length];
+}
+//------------------------------------------------------------------------
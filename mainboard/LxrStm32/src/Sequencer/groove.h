@@ -0,0 +1,70 @@
+/*
+ * groove.h
+ *
+ *  Created on: 18.10.2026
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  Copyright 2013 Julian Schmidt
+ *  Julian@sonic-potions.com
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  This file is part of the Sonic Potions LXR drumsynth firmware.
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  Redistribution and use of the LXR code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *       - The code may not be sold, nor may it be used in a commercial product or activity.
+ *
+ *       - Redistributions that are modified from the original source must include the complete
+ *         source code, including the source code for all components used by a binary built
+ *         from the modified sources. However, as a special exception, the source code distributed
+ *         need not include anything that is normally distributed (in either source or binary form)
+ *         with the major components (compiler, kernel, and so on) of the operating system on which
+ *         the executable runs, unless that component itself accompanies the executable.
+ *
+ *       - Redistributions must reproduce the above copyright notice, this list of conditions and the
+ *         following disclaimer in the documentation and/or other materials provided with the distribution.
+ * ------------------------------------------------------------------------------------------------------------------------
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *   WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *   USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ------------------------------------------------------------------------------------------------------------------------
+ */
+
+
+#ifndef GROOVE_H_
+#define GROOVE_H_
+
+#include "stm32f4xx.h"
+#include "config.h"
+//------------------------------------------------------------------------
+// Groove templates for the shuffle.
+// A template holds a delay for every sequencer step of a groove cycle
+// (up to 2 beats). The delay is applied to the pulse timestamps of the
+// sequencer clock, so the swing is sample accurate and identical for the
+// internal clock and external sync at any tempo. The shuffle amount scales
+// the template.
+//
+// template 0 is the built in shuffle curve, others are loaded from
+// /grooves/GROOVEnn.GRV:
+// header	: 'L','X','R','G', uint8 length (steps, 1-64), 3 reserved bytes
+// delays	: length * uint8 delay in 1/16 pulses of the 96 ppq clock
+//------------------------------------------------------------------------
+#define GROOVE_MAX_STEPS		64		/**< 2 beats of 32 steps*/
+#define GROOVE_DELAY_UNIT		16		/**< delay units per clock pulse*/
+#define GROOVE_BUILTIN			0		/**< template nr of the built in shuffle*/
+//------------------------------------------------------------------------
+void groove_init();
+//------------------------------------------------------------------------
+/** shuffle amount 0-1, scales the template*/
+void groove_setAmount(float amount);
+//------------------------------------------------------------------------
+/** select a template. returns 0 if the file could not be loaded, the previous template stays active then*/
+uint8_t groove_select(uint8_t grooveNr);
+//------------------------------------------------------------------------
+/** delay of a step [clock pulses]*/
+float groove_getDelay(uint8_t masterStep);
+
+#endif /* GROOVE_H_ */
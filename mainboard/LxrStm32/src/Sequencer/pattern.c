@@ -0,0 +1,332 @@
+/*
+ * pattern.c
+ *
+ *  Created on: 18.10.2026
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  Copyright 2013 Julian Schmidt
+ *  Julian@sonic-potions.com
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  This file is part of the Sonic Potions LXR drumsynth firmware.
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  Redistribution and use of the LXR code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *       - The code may not be sold, nor may it be used in a commercial product or activity.
+ *
+ *       - Redistributions that are modified from the original source must include the complete
+ *         source code, including the source code for all components used by a binary built
+ *         from the modified sources. However, as a special exception, the source code distributed
+ *         need not include anything that is normally distributed (in either source or binary form)
+ *         with the major components (compiler, kernel, and so on) of the operating system on which
+ *         the executable runs, unless that component itself accompanies the executable.
+ *
+ *       - Redistributions must reproduce the above copyright notice, this list of conditions and the
+ *         following disclaimer in the documentation and/or other materials provided with the distribution.
+ * ------------------------------------------------------------------------------------------------------------------------
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *   WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *   USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ------------------------------------------------------------------------------------------------------------------------
+ */
+
+
+#include "pattern.h"
+#include "MidiMessages.h"
+#include <string.h>
+
+typedef union StepBlockUnion
+{
+	Step 		steps[8];
+	uint16_t 	nextFree;	/**< free list link while the block is unused*/
+} StepBlock;
+
+static StepBlock pattern_stepPool[PATTERN_STEP_BLOCKS];
+static uint16_t pattern_freeList = PATTERN_NO_BLOCK;	/**< released blocks*/
+static uint16_t pattern_poolUsed = 0;					/**< blocks taken from the pool so far*/
+
+typedef struct ParamLockStruct
+{
+	uint8_t		step;		/**< sub step 0-127*/
+	uint8_t		dest;		/**< parameter nr, same numbering as Step.param1Nr*/
+	uint8_t		value;
+	uint16_t	next;		/**< next lock of the track or the free list, pool index +1*/
+} ParamLock;
+
+static ParamLock pattern_lockPool[PATTERN_LOCK_POOL];
+static uint16_t pattern_lockFreeList = PATTERN_NO_LOCK;
+static uint16_t pattern_lockPoolUsed = 0;
+
+uint8_t pattern_poolFull = 0;
+
+static const Step pattern_defaultStep =
+{
+		100,				// volume
+		127,				// prob
+		SEQ_DEFAULT_NOTE,	// note
+		NO_AUTOMATION,		// param1Nr
+		0,					// param1Val
+		NO_AUTOMATION,		// param2Nr
+		0					// param2Val
+};
+//------------------------------------------------------------------------
+static uint16_t pattern_allocBlock()
+{
+	uint16_t block;
+	if(pattern_freeList != PATTERN_NO_BLOCK)
+	{
+		block = pattern_freeList;
+		pattern_freeList = pattern_stepPool[block-1].nextFree;
+	}
+	else if(pattern_poolUsed < PATTERN_STEP_BLOCKS)
+	{
+		block = ++pattern_poolUsed;
+	}
+	else
+	{
+		pattern_poolFull |= PATTERN_FULL_STEPS;
+		return PATTERN_NO_BLOCK;
+	}
+
+	uint8_t i;
+	for(i=0;i<8;i++) {
+		pattern_stepPool[block-1].steps[i] = pattern_defaultStep;
+	}
+	return block;
+}
+//------------------------------------------------------------------------
+static void pattern_freeBlock(uint16_t* block)
+{
+	if(*block == PATTERN_NO_BLOCK) return;
+
+	pattern_stepPool[*block-1].nextFree = pattern_freeList;
+	pattern_freeList = *block;
+	*block = PATTERN_NO_BLOCK;
+	pattern_poolFull &= ~PATTERN_FULL_STEPS;
+}
+//------------------------------------------------------------------------
+static uint16_t pattern_allocLock()
+{
+	uint16_t lock;
+	if(pattern_lockFreeList != PATTERN_NO_LOCK)
+	{
+		lock = pattern_lockFreeList;
+		pattern_lockFreeList = pattern_lockPool[lock-1].next;
+	}
+	else if(pattern_lockPoolUsed < PATTERN_LOCK_POOL)
+	{
+		lock = ++pattern_lockPoolUsed;
+	}
+	else
+	{
+		pattern_poolFull |= PATTERN_FULL_LOCKS;
+		return PATTERN_NO_LOCK;
+	}
+	pattern_lockPool[lock-1].next = PATTERN_NO_LOCK;
+	return lock;
+}
+//------------------------------------------------------------------------
+/** release all locks from *link to the end of the list that are on a step < endStep*/
+static void pattern_freeLocks(uint16_t* link, const uint8_t endStep)
+{
+	while(*link != PATTERN_NO_LOCK && pattern_lockPool[*link-1].step < endStep)
+	{
+		const uint16_t lock = *link;
+		*link = pattern_lockPool[lock-1].next;
+		pattern_lockPool[lock-1].next = pattern_lockFreeList;
+		pattern_lockFreeList = lock;
+		pattern_poolFull &= ~PATTERN_FULL_LOCKS;
+	}
+}
+//------------------------------------------------------------------------
+/** link pointing to the first lock of the track on a step >= step*/
+static uint16_t* pattern_findLock(Pattern* p, const uint8_t track, const uint8_t step)
+{
+	uint16_t* link = &p->seq_paramLocks[track];
+	while(*link != PATTERN_NO_LOCK && pattern_lockPool[*link-1].step < step) {
+		link = &pattern_lockPool[*link-1].next;
+	}
+	return link;
+}
+//------------------------------------------------------------------------
+void pattern_setStepActive(Pattern* p, const uint8_t track, const uint8_t step, const uint8_t isActive)
+{
+	const uint32_t bit = 1UL<<(step&31);
+	if(isActive)
+		p->seq_activeSteps[track][step>>5] |= bit;
+	else
+		p->seq_activeSteps[track][step>>5] &= ~bit;
+}
+//------------------------------------------------------------------------
+const Step* pattern_getStep(const Pattern* p, const uint8_t track, const uint8_t step)
+{
+	const uint16_t block = p->seq_stepBlocks[track][step>>3];
+	if(block == PATTERN_NO_BLOCK)
+		return &pattern_defaultStep;
+	return &pattern_stepPool[block-1].steps[step&7];
+}
+//------------------------------------------------------------------------
+Step* pattern_editStep(Pattern* p, const uint8_t track, const uint8_t step)
+{
+	uint16_t* const block = &p->seq_stepBlocks[track][step>>3];
+	if(*block == PATTERN_NO_BLOCK)
+	{
+		*block = pattern_allocBlock();
+		if(*block == PATTERN_NO_BLOCK)
+			return 0;
+	}
+	return &pattern_stepPool[*block-1].steps[step&7];
+}
+//------------------------------------------------------------------------
+void pattern_writeStep(Pattern* p, const uint8_t track, const uint8_t step, const Step* data)
+{
+	Step tmp = *data;
+	tmp.volume &= STEP_VOLUME_MASK;
+
+	pattern_setStepActive(p, track, step, data->volume & STEP_ACTIVE_MASK);
+
+	//default steps only need memory if the block exists anyway
+	if(p->seq_stepBlocks[track][step>>3] == PATTERN_NO_BLOCK &&
+			memcmp(&tmp, &pattern_defaultStep, sizeof(Step)) == 0)
+		return;
+
+	//pool full, the step plays with the default data. reported through pattern_poolFull
+	Step* const dst = pattern_editStep(p, track, step);
+	if(dst)
+		*dst = tmp;
+}
+//------------------------------------------------------------------------
+void pattern_resetSteps(Pattern* p, const uint8_t track)
+{
+	uint8_t i;
+	for(i=0;i<NUM_STEPS/8;i++) {
+		pattern_freeBlock(&p->seq_stepBlocks[track][i]);
+	}
+	memset(p->seq_activeSteps[track], 0, sizeof(p->seq_activeSteps[track]));
+	pattern_freeLocks(&p->seq_paramLocks[track], 0xff);
+}
+//------------------------------------------------------------------------
+void pattern_resetMainStep(Pattern* p, const uint8_t track, const uint8_t mainStep)
+{
+	pattern_freeBlock(&p->seq_stepBlocks[track][mainStep]);
+	//8 bits of the 32 bit word
+	p->seq_activeSteps[track][mainStep>>2] &= ~(0xffUL << ((mainStep&3)*8));
+	pattern_freeLocks(pattern_findLock(p, track, mainStep*8), mainStep*8+8);
+}
+//------------------------------------------------------------------------
+void pattern_clear(Pattern* p)
+{
+	uint8_t i;
+	for(i=0;i<NUM_TRACKS;i++) {
+		pattern_resetSteps(p, i);
+	}
+}
+//------------------------------------------------------------------------
+void pattern_copyTrack(Pattern* dst, const uint8_t dstTrack, const Pattern* src, const uint8_t srcTrack)
+{
+	uint8_t i;
+	if(dst == src && dstTrack == srcTrack) return;
+
+	for(i=0;i<NUM_STEPS/8;i++)
+	{
+		uint16_t* const dstBlock = &dst->seq_stepBlocks[dstTrack][i];
+		const uint16_t srcBlock = src->seq_stepBlocks[srcTrack][i];
+
+		if(srcBlock == PATTERN_NO_BLOCK) {
+			pattern_freeBlock(dstBlock);
+			continue;
+		}
+		if(*dstBlock == PATTERN_NO_BLOCK) {
+			*dstBlock = pattern_allocBlock();
+			//pool full, the main step keeps the default data. reported through pattern_poolFull
+			if(*dstBlock == PATTERN_NO_BLOCK) continue;
+		}
+		memcpy(pattern_stepPool[*dstBlock-1].steps, pattern_stepPool[srcBlock-1].steps, sizeof(Step)*8);
+	}
+
+	memcpy(dst->seq_activeSteps[dstTrack], src->seq_activeSteps[srcTrack], sizeof(dst->seq_activeSteps[dstTrack]));
+	dst->seq_mainSteps[dstTrack] = src->seq_mainSteps[srcTrack];
+	dst->seq_patternLengthRotate[dstTrack].value = src->seq_patternLengthRotate[srcTrack].value;
+
+	//rebuild the lock list, stops early if the pool runs out
+	uint16_t* link = &dst->seq_paramLocks[dstTrack];
+	pattern_freeLocks(link, 0xff);
+	uint16_t srcLock = src->seq_paramLocks[srcTrack];
+	while(srcLock != PATTERN_NO_LOCK)
+	{
+		const uint16_t lock = pattern_allocLock();
+		if(lock == PATTERN_NO_LOCK) break;
+
+		pattern_lockPool[lock-1] = pattern_lockPool[srcLock-1];
+		pattern_lockPool[lock-1].next = PATTERN_NO_LOCK;
+		*link = lock;
+		link = &pattern_lockPool[lock-1].next;
+		srcLock = pattern_lockPool[srcLock-1].next;
+	}
+}
+//------------------------------------------------------------------------
+uint8_t pattern_setLock(Pattern* p, const uint8_t track, const uint8_t step, const uint8_t dest, const uint8_t value)
+{
+	uint16_t* link = pattern_findLock(p, track, step);
+
+	//replace the lock if dest is already locked on this step
+	while(*link != PATTERN_NO_LOCK && pattern_lockPool[*link-1].step == step)
+	{
+		if(pattern_lockPool[*link-1].dest == dest) {
+			pattern_lockPool[*link-1].value = value;
+			return 1;
+		}
+		link = &pattern_lockPool[*link-1].next;
+	}
+
+	const uint16_t lock = pattern_allocLock();
+	if(lock == PATTERN_NO_LOCK)
+		return 0;
+
+	pattern_lockPool[lock-1].step	= step;
+	pattern_lockPool[lock-1].dest	= dest;
+	pattern_lockPool[lock-1].value	= value;
+	pattern_lockPool[lock-1].next	= *link;
+	*link = lock;
+	return 1;
+}
+//------------------------------------------------------------------------
+void pattern_clearLocks(Pattern* p, const uint8_t track, const uint8_t step)
+{
+	pattern_freeLocks(pattern_findLock(p, track, step), step+1);
+}
+//------------------------------------------------------------------------
+uint8_t pattern_getLocks(const Pattern* p, const uint8_t track, const uint8_t step, uint8_t* dest, uint8_t* value, const uint8_t max)
+{
+	uint8_t num = 0;
+	uint16_t lock = p->seq_paramLocks[track];
+
+	while(lock != PATTERN_NO_LOCK && pattern_lockPool[lock-1].step <= step)
+	{
+		if(pattern_lockPool[lock-1].step == step && num < max) {
+			dest[num]	= pattern_lockPool[lock-1].dest;
+			value[num]	= pattern_lockPool[lock-1].value;
+			num++;
+		}
+		lock = pattern_lockPool[lock-1].next;
+	}
+	return num;
+}
+//------------------------------------------------------------------------
+uint8_t pattern_getLockAt(const Pattern* p, const uint8_t track, uint16_t n, uint8_t* step, uint8_t* dest, uint8_t* value)
+{
+	uint16_t lock = p->seq_paramLocks[track];
+	while(lock != PATTERN_NO_LOCK && n--) {
+		lock = pattern_lockPool[lock-1].next;
+	}
+	if(lock == PATTERN_NO_LOCK)
+		return 0;
+
+	*step	= pattern_lockPool[lock-1].step;
+	*dest	= pattern_lockPool[lock-1].dest;
+	*value	= pattern_lockPool[lock-1].value;
+	return 1;
+}
@@ -0,0 +1,170 @@
+/*
+ * pattern.h
+ *
+ *  Created on: 18.10.2026
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  Copyright 2013 Julian Schmidt
+ *  Julian@sonic-potions.com
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  This file is part of the Sonic Potions LXR drumsynth firmware.
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  Redistribution and use of the LXR code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *       - The code may not be sold, nor may it be used in a commercial product or activity.
+ *
+ *       - Redistributions that are modified from the original source must include the complete
+ *         source code, including the source code for all components used by a binary built
+ *         from the modified sources. However, as a special exception, the source code distributed
+ *         need not include anything that is normally distributed (in either source or binary form)
+ *         with the major components (compiler, kernel, and so on) of the operating system on which
+ *         the executable runs, unless that component itself accompanies the executable.
+ *
+ *       - Redistributions must reproduce the above copyright notice, this list of conditions and the
+ *         following disclaimer in the documentation and/or other materials provided with the distribution.
+ * ------------------------------------------------------------------------------------------------------------------------
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *   WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *   USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ------------------------------------------------------------------------------------------------------------------------
+ */
+
+
+#ifndef PATTERN_H_
+#define PATTERN_H_
+
+#include "stm32f4xx.h"
+
+ /**<
+  * we have 6 voices
+  * 3 drums
+  * 1 snare/claps
+  * 1 cymbal/snare
+  * 1 hiHat
+  * track 7 is the open hh... it triggers the highhat voice but with longer decay. it chokes the closed hihat*/
+#define NUM_TRACKS 7
+#define NUM_PATTERN 8			/**< patterns of a bank, the front panel and the SD files address 8 patterns*/
+#define NUM_PATTERN_BANKS 4		/**< banks resident in RAM, selected together with the pattern by midi program changes*/
+#define NUM_STEPS 128
+
+#define SEQ_DEFAULT_NOTE 63
+
+#define STEP_ACTIVE_MASK 0x80
+#define STEP_VOLUME_MASK 0x7f
+
+//------------------------------------------------------------------------
+// Compact pattern storage.
+// The active flag of every sub step is kept in a bitset. The remaining step
+// data is stored in blocks of 8 steps (one main step) that are allocated from
+// a shared pool only when a step differs from the default step.
+// A track that only uses active/inactive steps needs no pool memory at all.
+//------------------------------------------------------------------------
+#define PATTERN_STEP_BLOCKS		640		/**< pool size shared by all resident patterns. a pattern with data on every main step needs 112 blocks, a full pool is reported through pattern_poolFull*/
+#define PATTERN_NO_BLOCK		0		/**< block index of main steps without step data (zeroed RAM)*/
+
+/** pattern_poolFull bits, set when step data or a lock could not be stored*/
+#define PATTERN_FULL_STEPS		0x01
+#define PATTERN_FULL_LOCKS		0x02
+
+//------------------------------------------------------------------------
+// Parameter locks.
+// Besides the 2 automation slots of a step any number of parameters can be
+// locked per step. The locks live in a second shared pool as a list per
+// track, sorted by step, so they only need memory where they are used.
+//------------------------------------------------------------------------
+#define PATTERN_LOCK_POOL		512		/**< number of locks shared by all patterns*/
+#define PATTERN_NO_LOCK			0		/**< end of a lock list (zeroed RAM)*/
+
+typedef struct StepStruct
+{
+	uint8_t 	volume;		// 0-127 volume -> 0x7f. the active flag is stored in Pattern.seq_activeSteps
+	uint8_t  	prob;		//step probability (--AS todo we have one free bit here)
+	uint8_t		note;		//midi note value 0-127 -> 0x7f, --AS todo upper bit is now free for other usages
+
+	//parameter automation
+	uint8_t 	param1Nr;
+	uint8_t 	param1Val;
+
+	uint8_t 	param2Nr;
+	uint8_t 	param2Val;
+
+}Step;
+
+typedef struct PatternSettingsStruct
+{
+	uint8_t 	changeBar;		// change on every Nth bar to the next pattern
+	uint8_t  	nextPattern;	// [0:9] (0-7) are the 8 patterns, (8) is random previous, (9) is random all
+}PatternSetting;
+
+// --AS **PATROT
+typedef union {
+	uint8_t value;
+	struct {
+		unsigned length:4;	// length (0 = default 16 steps)
+		unsigned rotate:4;	// 0 means not rotated, 15 is max
+	};
+} LengthRotate;
+
+/** one pattern. the sequencer addresses patterns through seq_patterns[] so a pattern
+ * loaded in the background can be activated by swapping a pointer*/
+typedef struct PatternStruct
+{
+	uint32_t seq_activeSteps[NUM_TRACKS][NUM_STEPS/32];	/**< one bit per sub step*/
+	uint16_t seq_stepBlocks[NUM_TRACKS][NUM_STEPS/8];	/**< step data of each main step, pool index +1*/
+	uint16_t seq_mainSteps[NUM_TRACKS];
+	uint16_t seq_paramLocks[NUM_TRACKS];				/**< first lock of each track, pool index +1*/
+	PatternSetting seq_patternSettings;
+	LengthRotate seq_patternLengthRotate[NUM_TRACKS];
+}Pattern;
+
+/** PATTERN_FULL_xxx bits, cleared again when pool memory is released*/
+extern uint8_t pattern_poolFull;
+
+//------------------------------------------------------------------------
+static inline uint8_t pattern_isStepActive(const Pattern* p, const uint8_t track, const uint8_t step)
+{
+	return (p->seq_activeSteps[track][step>>5] >> (step&31)) & 1;
+}
+//------------------------------------------------------------------------
+void pattern_setStepActive(Pattern* p, const uint8_t track, const uint8_t step, const uint8_t isActive);
+//------------------------------------------------------------------------
+/** read only step data. steps without data return the default step*/
+const Step* pattern_getStep(const Pattern* p, const uint8_t track, const uint8_t step);
+//------------------------------------------------------------------------
+/** writable step data. allocates the main step block if needed, returns 0 if the pool is full*/
+Step* pattern_editStep(Pattern* p, const uint8_t track, const uint8_t step);
+//------------------------------------------------------------------------
+/** store a whole step. default steps do not allocate pool memory.
+ * the active flag is taken from the upper bit of data->volume*/
+void pattern_writeStep(Pattern* p, const uint8_t track, const uint8_t step, const Step* data);
+//------------------------------------------------------------------------
+/** reset all steps of a track to the default step and release its pool memory*/
+void pattern_resetSteps(Pattern* p, const uint8_t track);
+//------------------------------------------------------------------------
+/** reset all steps of a main step block to the default step and release its pool memory*/
+void pattern_resetMainStep(Pattern* p, const uint8_t track, const uint8_t mainStep);
+//------------------------------------------------------------------------
+/** reset all steps of all tracks and release the pool memory of the pattern*/
+void pattern_clear(Pattern* p);
+//------------------------------------------------------------------------
+/** copy the steps, parameter locks, main steps and length/rotation of a track*/
+void pattern_copyTrack(Pattern* dst, const uint8_t dstTrack, const Pattern* src, const uint8_t srcTrack);
+//------------------------------------------------------------------------
+/** lock parameter dest to value on a step. an existing lock of dest on that step is replaced.
+ * returns 0 if the lock pool is full*/
+uint8_t pattern_setLock(Pattern* p, const uint8_t track, const uint8_t step, const uint8_t dest, const uint8_t value);
+//------------------------------------------------------------------------
+/** remove all parameter locks of a step*/
+void pattern_clearLocks(Pattern* p, const uint8_t track, const uint8_t step);
+//------------------------------------------------------------------------
+/** copy up to max locks of a step to dest/value. returns the number of locks copied*/
+uint8_t pattern_getLocks(const Pattern* p, const uint8_t track, const uint8_t step, uint8_t* dest, uint8_t* value, const uint8_t max);
+//------------------------------------------------------------------------
+/** lock number n of a track in step order. returns 0 if the track has less locks*/
+uint8_t pattern_getLockAt(const Pattern* p, const uint8_t track, uint16_t n, uint8_t* step, uint8_t* dest, uint8_t* value);
+
+#endif /* PATTERN_H_ */
@@ -0,0 +1,273 @@
+/*
+ * seqClock.c
+ *
+ *  Created on: 18.10.2026
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  Copyright 2013 Julian Schmidt
+ *  Julian@sonic-potions.com
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  This file is part of the Sonic Potions LXR drumsynth firmware.
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  Redistribution and use of the LXR code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *       - The code may not be sold, nor may it be used in a commercial product or activity.
+ *
+ *       - Redistributions that are modified from the original source must include the complete
+ *         source code, including the source code for all components used by a binary built
+ *         from the modified sources. However, as a special exception, the source code distributed
+ *         need not include anything that is normally distributed (in either source or binary form)
+ *         with the major components (compiler, kernel, and so on) of the operating system on which
+ *         the executable runs, unless that component itself accompanies the executable.
+ *
+ *       - Redistributions must reproduce the above copyright notice, this list of conditions and the
+ *         following disclaimer in the documentation and/or other materials provided with the distribution.
+ * ------------------------------------------------------------------------------------------------------------------------
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *   WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *   USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ------------------------------------------------------------------------------------------------------------------------
+ */
+
+#include "seqClock.h"
+#include "cs4344_cs5343.h"
+#include "MidiMessages.h"
+#include "Uart.h"
+#include "usb_manager.h"
+//------------------------------------------------------------------------
+// ticks per pulse = timerClk*60 / (bpm*96) = timerClk*5 / (bpm*8)
+static uint32_t seqClock_ticksNum = 0;			// timerClk*5
+static uint32_t seqClock_ticksDen = 1;			// bpm*8
+static uint32_t seqClock_period;				// integer part of ticks per pulse
+static uint32_t seqClock_remainder;				// fractional part, in 1/seqClock_ticksDen ticks
+static uint32_t seqClock_phase;					// accumulated fractional part
+static float seqClock_ticksPerSample;			// timerClk/REAL_FS
+static float seqClock_pulseLength;				// [samples]
+
+static volatile uint32_t seqClock_pulseCnt;		// timer pulses since the last restart
+static volatile uint32_t seqClock_curPeriod;		// length of the running timer period [ticks]
+
+static volatile uint32_t seqClock_fifo[SEQ_CLOCK_FIFO_SIZE];	// sample timestamps of pending pulses
+static volatile uint8_t seqClock_readPos = 0;
+static volatile uint8_t seqClock_writePos = 0;
+static volatile uint16_t seqClock_overflowCnt = 0;
+
+static volatile uint8_t seqClock_midiClockOut = 0;	// send midi clock
+static volatile uint8_t seqClock_midiPrescaler = 0;	// pulses since the last midi clock
+
+//------------------------------------------------------------------------
+static uint32_t seqClock_nextPeriod()
+{
+	seqClock_phase += seqClock_remainder;
+	if(seqClock_phase >= seqClock_ticksDen)
+	{
+		seqClock_phase -= seqClock_ticksDen;
+		return seqClock_period + 1;
+	}
+	return seqClock_period;
+}
+//------------------------------------------------------------------------
+static void seqClock_pushPulse()
+{
+	const uint8_t next = (seqClock_writePos+1) & SEQ_CLOCK_FIFO_MASK;
+	if(next == seqClock_readPos)
+	{
+		seqClock_overflowCnt++;
+		return;
+	}
+	seqClock_fifo[seqClock_writePos] = codec_getPlaybackPos();
+	seqClock_writePos = next;
+}
+//------------------------------------------------------------------------
+// midi clock goes out right when the pulse fires, ahead of all queued midi data
+static void seqClock_midiPulse()
+{
+	if(seqClock_midiPrescaler == 0 && seqClock_midiClockOut)
+	{
+		uart_sendMidiRealtime(MIDI_CLOCK);
+		usb_sendMidiRealtime(MIDI_CLOCK);
+	}
+	if(++seqClock_midiPrescaler >= SEQ_CLOCK_MIDI_PRESCALER)
+	{
+		seqClock_midiPrescaler = 0;
+	}
+}
+//------------------------------------------------------------------------
+void TIM5_IRQHandler()
+{
+	if(TIM_GetITStatus(TIM5, TIM_IT_Update) != RESET)
+	{
+		TIM_ClearITPendingBit(TIM5, TIM_IT_Update);
+		//the preloaded period is running now
+		seqClock_curPeriod = TIM5->ARR + 1;
+		seqClock_pulseCnt++;
+		seqClock_pushPulse();
+		seqClock_midiPulse();
+		//ARR is preloaded, the value written now is used for the pulse after the next
+		TIM5->ARR = seqClock_nextPeriod() - 1;
+	}
+}
+//------------------------------------------------------------------------
+void seqClock_init(const uint16_t bpm)
+{
+	RCC_ClocksTypeDef clocks;
+	RCC_GetClocksFreq(&clocks);
+	//timer clock is 2*PCLK1 if the APB1 prescaler is > 1
+	const uint32_t timerClk = (clocks.HCLK_Frequency == clocks.PCLK1_Frequency) ? clocks.PCLK1_Frequency : 2*clocks.PCLK1_Frequency;
+	seqClock_ticksNum = timerClk*5;
+	seqClock_ticksPerSample = timerClk/REAL_FS;
+
+	RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM5, ENABLE);
+
+	seqClock_setBpm(bpm);
+	seqClock_phase = 0;
+
+	TIM_TimeBaseInitTypeDef TIM_TimeBase_InitStructure;
+	TIM_TimeBase_InitStructure.TIM_ClockDivision 	= TIM_CKD_DIV1;
+	TIM_TimeBase_InitStructure.TIM_CounterMode 		= TIM_CounterMode_Up;
+	seqClock_curPeriod = seqClock_nextPeriod();
+	TIM_TimeBase_InitStructure.TIM_Period 			= seqClock_curPeriod - 1;
+	TIM_TimeBase_InitStructure.TIM_Prescaler 		= 0;
+	TIM_TimeBase_InitStructure.TIM_RepetitionCounter = 0;
+	TIM_TimeBaseInit(TIM5, &TIM_TimeBase_InitStructure);
+	TIM_ARRPreloadConfig(TIM5, ENABLE);
+	//the 2nd period goes to the preload register
+	TIM5->ARR = seqClock_nextPeriod() - 1;
+
+	//same preemption priority as the audio dma, so it never interrupts the dma block counter update
+	NVIC_InitTypeDef NVIC_InitStructure;
+	NVIC_InitStructure.NVIC_IRQChannel = SEQ_CLOCK_IRQ;
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0x00;
+	NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0x01;
+	NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+	NVIC_Init(&NVIC_InitStructure);
+
+	TIM_ClearITPendingBit(TIM5, TIM_IT_Update);
+	TIM_ITConfig(TIM5, TIM_IT_Update, ENABLE);
+	TIM_Cmd(TIM5, ENABLE);
+}
+//------------------------------------------------------------------------
+void seqClock_setBpm(uint16_t bpm)
+{
+	if(bpm==0) bpm = 1;
+	const uint32_t den = bpm*8;
+	seqClock_pulseLength = REAL_FS*60.f / (bpm*SEQ_CLOCK_PPQ);
+
+	TIM_ITConfig(TIM5, TIM_IT_Update, DISABLE);
+	seqClock_ticksDen 	= den;
+	seqClock_period 	= seqClock_ticksNum / den;
+	seqClock_remainder 	= seqClock_ticksNum % den;
+	if(seqClock_phase >= den) seqClock_phase = 0;
+	TIM_ITConfig(TIM5, TIM_IT_Update, ENABLE);
+}
+//------------------------------------------------------------------------
+void seqClock_setPulseLength(float samples)
+{
+	//fractional part of the period in 1/256 ticks
+	const uint32_t ticks = samples*seqClock_ticksPerSample*256.f;
+	if(ticks < 256) return;
+
+	TIM_ITConfig(TIM5, TIM_IT_Update, DISABLE);
+	seqClock_pulseLength	= samples;
+	seqClock_ticksDen 		= 256;
+	seqClock_period 		= ticks >> 8;
+	seqClock_remainder 		= ticks & 0xff;
+	if(seqClock_phase >= 256) seqClock_phase = 0;
+	TIM_ITConfig(TIM5, TIM_IT_Update, ENABLE);
+}
+//------------------------------------------------------------------------
+void seqClock_restart(const uint8_t emitPulse)
+{
+	TIM_ITConfig(TIM5, TIM_IT_Update, DISABLE);
+
+	seqClock_readPos = seqClock_writePos;
+	seqClock_phase = 0;
+
+	//load the next 2 periods and start counting from zero
+	const uint32_t first = seqClock_nextPeriod();
+	TIM5->ARR = first - 1;
+	TIM_GenerateEvent(TIM5, TIM_EventSource_Update);	//transfers ARR and clears the counter
+	TIM_ClearITPendingBit(TIM5, TIM_IT_Update);
+	TIM5->ARR = seqClock_nextPeriod() - 1;
+	seqClock_curPeriod = first;
+	seqClock_pulseCnt = 0;
+	seqClock_midiPrescaler = 0;
+
+	if(emitPulse)
+	{
+		seqClock_pushPulse();
+		seqClock_midiPulse();
+	}
+
+	TIM_ITConfig(TIM5, TIM_IT_Update, ENABLE);
+}
+//------------------------------------------------------------------------
+uint8_t seqClock_peekPulse(uint32_t* timestamp)
+{
+	if(seqClock_readPos == seqClock_writePos) return 0;
+	*timestamp = seqClock_fifo[seqClock_readPos];
+	return 1;
+}
+//------------------------------------------------------------------------
+void seqClock_dropPulse()
+{
+	if(seqClock_readPos == seqClock_writePos) return;
+	seqClock_readPos = (seqClock_readPos+1) & SEQ_CLOCK_FIFO_MASK;
+}
+//------------------------------------------------------------------------
+float seqClock_getPulseLength()
+{
+	return seqClock_pulseLength;
+}
+//------------------------------------------------------------------------
+uint32_t seqClock_getPosition(float* frac)
+{
+	TIM_ITConfig(TIM5, TIM_IT_Update, DISABLE);
+
+	uint32_t pulses = seqClock_pulseCnt;
+	uint32_t period = seqClock_curPeriod;
+	uint32_t cnt = TIM5->CNT;
+
+	//the counter wrapped but the isr did not run yet (the it status reads RESET while the it is disabled)
+	if(TIM_GetFlagStatus(TIM5, TIM_FLAG_Update) != RESET)
+	{
+		pulses++;
+		period = TIM5->ARR + 1;
+		cnt = TIM5->CNT;
+	}
+
+	TIM_ITConfig(TIM5, TIM_IT_Update, ENABLE);
+
+	*frac = cnt/(float)period;
+	return pulses;
+}
+//------------------------------------------------------------------------
+void seqClock_setMidiClockOut(const uint8_t isOn)
+{
+	seqClock_midiClockOut = isOn;
+}
+//------------------------------------------------------------------------
+uint8_t seqClock_getMidiClockOut()
+{
+	return seqClock_midiClockOut;
+}
+//------------------------------------------------------------------------
+uint8_t seqClock_midiClockDue(const uint32_t samples)
+{
+	//the next pulse is no midi clock. a pulse is always longer than the guard times used
+	if(!seqClock_midiClockOut || seqClock_midiPrescaler != 0) return 0;
+
+	const uint32_t cnt = TIM5->CNT;
+	const uint32_t period = seqClock_curPeriod;
+	return cnt >= period || (period - cnt) <= samples*seqClock_ticksPerSample;
+}
+//------------------------------------------------------------------------
+uint16_t seqClock_getOverflowCnt()
+{
+	return seqClock_overflowCnt;
+}
+//------------------------------------------------------------------------
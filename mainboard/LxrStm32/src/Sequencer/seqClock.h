@@ -0,0 +1,102 @@
+/*
+ * seqClock.h
+ *
+ *  Created on: 18.10.2026
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  Copyright 2013 Julian Schmidt
+ *  Julian@sonic-potions.com
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  This file is part of the Sonic Potions LXR drumsynth firmware.
+ * ------------------------------------------------------------------------------------------------------------------------
+ *  Redistribution and use of the LXR code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *       - The code may not be sold, nor may it be used in a commercial product or activity.
+ *
+ *       - Redistributions that are modified from the original source must include the complete
+ *         source code, including the source code for all components used by a binary built
+ *         from the modified sources. However, as a special exception, the source code distributed
+ *         need not include anything that is normally distributed (in either source or binary form)
+ *         with the major components (compiler, kernel, and so on) of the operating system on which
+ *         the executable runs, unless that component itself accompanies the executable.
+ *
+ *       - Redistributions must reproduce the above copyright notice, this list of conditions and the
+ *         following disclaimer in the documentation and/or other materials provided with the distribution.
+ * ------------------------------------------------------------------------------------------------------------------------
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *   INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *   SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *   WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *   USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ------------------------------------------------------------------------------------------------------------------------
+ */
+
+
+#ifndef SEQCLOCK_H_
+#define SEQCLOCK_H_
+
+#include "stm32f4xx.h"
+#include "config.h"
+//------------------------------------------------------------------------
+// 96 ppq sequencer clock, generated by the 32 bit timer TIM5.
+// The period of each pulse is calculated with an integer accumulator
+// (ticks per minute / pulses per minute), so the average tempo is exact
+// for every bpm. Every pulse is stamped with the audio sample that was
+// playing when it fired; the sequencer plays the pulse SEQ_CLOCK_LATENCY
+// samples later at exactly that position in the rendered audio.
+// The midi clock output is sent directly from the pulse interrupt, so it
+// does not depend on when the main loop renders the pulses.
+//------------------------------------------------------------------------
+#define SEQ_CLOCK_PPQ			96
+
+// pulse to audio delay [samples]. a pulse can fire right after a block was
+// calculated, the next block still to be calculated starts 2 blocks later
+#define SEQ_CLOCK_LATENCY		(2*OUTPUT_DMA_SIZE)
+
+// pulses wait here until they are played, shuffle delays them up to 16 pulses
+#define SEQ_CLOCK_FIFO_SIZE		32
+#define SEQ_CLOCK_FIFO_MASK		(SEQ_CLOCK_FIFO_SIZE-1)
+
+// midi clock runs at 24 ppq
+#define SEQ_CLOCK_MIDI_PRESCALER	(SEQ_CLOCK_PPQ/24)
+
+// the pulse interrupt. code writing to queues the interrupt also writes to masks it
+#define SEQ_CLOCK_IRQ			TIM5_IRQn
+//------------------------------------------------------------------------
+void seqClock_init(const uint16_t bpm);
+
+void seqClock_setBpm(uint16_t bpm);
+
+/** set a fractional pulse length [samples], used by the external clock sync to slew the tempo*/
+void seqClock_setPulseLength(float samples);
+
+/** restart the pulse phase now, pending pulses are dropped. if emitPulse is set, a pulse is emitted immediately*/
+void seqClock_restart(const uint8_t emitPulse);
+
+/** get the timestamp of the oldest pending pulse without removing it. returns 0 if there is none*/
+uint8_t seqClock_peekPulse(uint32_t* timestamp);
+
+/** remove the oldest pending pulse*/
+void seqClock_dropPulse();
+
+/** length of one pulse [samples], for converting musical offsets (shuffle) to sample offsets*/
+float seqClock_getPulseLength();
+
+/** pulses since the last restart, frac gets the elapsed part of the running pulse (0-1)*/
+uint32_t seqClock_getPosition(float* frac);
+
+/** send a midi clock on every 4th pulse. the clock is sent from the pulse interrupt, the first one
+ * with the pulse emitted by seqClock_restart*/
+void seqClock_setMidiClockOut(const uint8_t isOn);
+
+uint8_t seqClock_getMidiClockOut();
+
+/** returns 1 if a midi clock will be sent within the next samples, used to keep the midi out line free for it*/
+uint8_t seqClock_midiClockDue(const uint32_t samples);
+
+/** number of pulses lost because the fifo was full*/
+uint16_t seqClock_getOverflowCnt();
+
+#endif /* SEQCLOCK_H_ */
@@ -47,16 +47,19 @@
 #include "frontPanelParser.h"
 #include "sequencer.h"
 #include <string.h>
+#include <math.h>
 #include "usb_manager.h"
 #include "clockSync.h"
 #include "MidiParser.h"
 #include "automationNode.h"
 #include "SomGenerator.h"
 #include "TriggerOut.h"
+#include "seqClock.h"
+#include "voiceTable.h"
+#include "groove.h"
 
 
 #define SEQ_PRESCALER_MASK 	0x03
-#define MIDI_PRESCALER_MASK	0x04
 static uint8_t seq_prescaleCounter = 0;
 
 uint8_t seq_masterStepCnt=0;				/** keeps track of the played steps between 0 and 127 independent from the track counters*/
@@ -68,10 +71,15 @@ static int8_t 	seq_stepIndex[NUM_TRACKS];	/**< we have 16 steps consisting of 8
 
 static uint16_t seq_tempo = 120;			/**< seq speed in bpm*/
 
-static uint32_t	seq_lastTick = 0;			/**< stores the time the last step change occured*/
-static float	seq_deltaT;					/**< time in [ms] until the next step
- 	 	 	 	 	 	 	 	 	 	 	 1000ms = 1 sec
- 	 	 	 	 	 	 	 	 	 	 	 1 min = 60 sec*/
+static uint32_t	seq_lastPulsePos = 0;		/**< sample position the last clock pulse was played at*/
+static uint32_t	seq_lastStepPos = 0;		/**< sample position the last step was played at*/
+
+#define SEQ_FORCED_STEP_HOLD	32000		/**< [0.25ms] internal clock pulses are ignored this long after an externally triggered step*/
+static volatile uint8_t seq_forceStepFlag = 0;	/**< set by external triggers, the next seq_tick plays a step*/
+static uint8_t	seq_forcedStepActive = 0;	/**< external triggers are driving the steps*/
+static uint32_t	seq_forcedStepTime = 0;		/**< systick of the last externally triggered step*/
+
+static uint8_t	seq_reportedPoolFull = 0;	/**< pattern_poolFull state the front knows about*/
 uint8_t seq_activeAutomTrack=0;
 
 uint8_t seq_delayedSyncStepFlag = 0;		//normally sync steps will only be advanced by external midi clocks in ext. sync mode
@@ -81,7 +89,6 @@ uint8_t seq_isSyncExternal = 0;
 uint8_t seq_lastMasterStep[NUM_TRACKS];		//keeps track of the last triggered master sync step of each track
 
 
-float seq_shuffle = 0;
 
 static uint8_t seq_SomModeActive = 0;
 
@@ -108,6 +115,45 @@ uint8_t seq_barCounter;						/**< counts the absolute position in bars since the
 
 static uint8_t seq_loadPendigFlag = 0;
 
+//---- step lookahead ----
+// steps are resolved (step position, pattern switch, probability) ahead of time in the main loop,
+// the clock edge only plays the precomputed events. the live state (seq_stepIndex, seq_activePattern...)
+// always describes the last played step, the cursor the last resolved one.
+#define SEQ_LOOKAHEAD_STEPS		4		/**< resolved steps ahead of the clock, power of 2*/
+#define SEQ_LOOKAHEAD_MASK		(SEQ_LOOKAHEAD_STEPS-1)
+
+#define SEQ_EVENT_PATTERN_CHANGE	0x01	/**< a new pattern starts with this step*/
+
+typedef struct SeqCursorStruct
+{
+	int8_t	stepIndex[NUM_TRACKS];
+	uint8_t	barCounter;
+	uint8_t	activePattern;
+	uint8_t	pendingPattern;
+	uint8_t	loadPending;
+} SeqCursor;
+
+typedef struct SeqStepEventStruct
+{
+	int8_t	stepIndex[NUM_TRACKS];		/**< track positions after this step*/
+	uint8_t	vol[NUM_TRACKS];
+	uint8_t	note[NUM_TRACKS];
+	uint8_t	trigMask;					/**< each bit represents a track that plays on this step*/
+	uint8_t	flags;
+	uint8_t	masterStepPos;
+	int8_t	clockTickPos;
+	uint8_t	barCounter;
+	uint8_t	pattern;
+	uint8_t	pendingPattern;
+	uint8_t	loadPending;
+} SeqStepEvent;
+
+static SeqCursor seq_cursor;
+static SeqStepEvent seq_laQueue[SEQ_LOOKAHEAD_STEPS];
+static uint8_t seq_laRead = 0;
+static uint8_t seq_laWrite = 0;
+static volatile uint8_t seq_laFlushFlag = 1;	/**< restart the lookahead from the live state*/
+
 // --AS Allow it to be configured whether it keeps track of bar position in the song for
 // the purpose of pattern changes
 uint8_t seq_resetBarOnPatternChange=0;
@@ -116,82 +162,107 @@ uint8_t seq_resetBarOnPatternChange=0;
 static uint8_t midi_chan_notes[16];		    /**< what note is playing on each channel */
 static uint16_t midi_notes_on=0;		    /**< which channels have a note currently playing */
 
-const float seq_shuffleTable[16] =
-{
-		0.f,
-		0.015625f,
-		0.0625f,
-		0.140625f,
-		0.25f,
-		0.390625f,
-		0.5625f,
-		0.765625f,
-		1.f,
-		0.984375f,
-		0.9375f,
-		0.859375f,
-		0.75f,
-		0.609375f,
-		0.4375f,
-		0.234375f,
-};
-
-float seq_lastShuffle = 0;
-
-PatternSet seq_patternSet;
-
-TempPattern seq_tmpPattern;
+static Pattern seq_patternSlots[NUM_PATTERN_BANKS*NUM_PATTERN+1];	/**< pattern storage of all banks, one more slot for background loading*/
+static Pattern* seq_bankPatterns[NUM_PATTERN_BANKS][NUM_PATTERN];	/**< patterns of the inactive banks*/
+Pattern* seq_patterns[NUM_PATTERN];									/**< patterns of the active bank*/
+Pattern* seq_tmpPattern = &seq_patternSlots[NUM_PATTERN_BANKS*NUM_PATTERN];
+static uint8_t seq_activeBank = 0;
+static uint8_t seq_pendingBank = 0;		/**< bank of the next pattern, switched together with the pattern*/
 
 uint8_t seq_newPatternAvailable = 0; //indicate that a new pattern has loaded in the background and we should switch
 
 //for the automation tracks each track needs 2 modNodes
 static AutomationNode seq_automationNodes[NUM_TRACKS][2];
 
+//parameter locks of the last triggered step, applied at the start of the next audio block
+static AutomationNode seq_lockNodes[NUM_TRACKS][SEQ_MAX_STEP_LOCKS];
+static uint8_t seq_pendingLockDest[NUM_TRACKS][SEQ_MAX_STEP_LOCKS];
+static uint8_t seq_pendingLockValue[NUM_TRACKS][SEQ_MAX_STEP_LOCKS];
+static uint8_t seq_pendingLockNum[NUM_TRACKS];
+static uint8_t seq_pendingLockMask = 0;			/**< tracks with new locks waiting for the next block*/
+
 static void seq_sendMidi(MidiMsg msg);
 static void seq_sendRealtime(const uint8_t status);
 static void seq_sendProgChg(const uint8_t ptn);
 static void seq_eraseStepAndSubSteps(const uint8_t voice, const uint8_t mainStep);
 static void seq_activateTmpPattern();
+static void seq_activateBank(const uint8_t bank);
 static void seq_nextStep();
 static uint8_t seq_isNextStepSyncStep();
 static uint8_t seq_intIsStepActive(uint8_t voice, uint8_t stepNr, uint8_t patternNr);
 static uint8_t seq_intIsMainStepActive(uint8_t voice, uint8_t mainStepNr, uint8_t pattern);
-static void seq_resetNote(Step *step);
 static void seq_setStepIndexToStart();
+static void seq_calcStepIndexStart(const uint8_t pattern, int8_t* stepIndex);
+static void seq_fillLookahead();
 //------------------------------------------------------------------------------
 void seq_init()
 {
-	int i;
+	int i,j;
 
 	for(i=0;i<NUM_TRACKS;i++) {
 		autoNode_init(&seq_automationNodes[i][0]);
 		autoNode_init(&seq_automationNodes[i][1]);
+		for(j=0;j<SEQ_MAX_STEP_LOCKS;j++) {
+			autoNode_init(&seq_lockNodes[i][j]);
+		}
 	}
 
 	memset(seq_stepIndex,0,NUM_TRACKS);
 	memset(seq_lastMasterStep,0,NUM_TRACKS);
 
+	for(j=0;j<NUM_PATTERN_BANKS;j++) {
+		for(i=0;i<NUM_PATTERN;i++) {
+			seq_bankPatterns[j][i] = &seq_patternSlots[j*NUM_PATTERN+i];
+		}
+	}
+
+	seqClock_init(seq_tempo);
+	groove_init();
 
-	for(i=0;i<NUM_PATTERN;i++)
+
+	//clear the patterns of all banks, bank 0 is active in the end
+	for(j=NUM_PATTERN_BANKS-1;j>=0;j--)
 	{
-		seq_patternSet.seq_patternSettings[i].changeBar 	= 0;	//default setting: zero repeats (play once then change)
-		seq_patternSet.seq_patternSettings[i].nextPattern 	= i;	//default setting: repeat same pattern
-		seq_clearPattern(i); // will clear all tracks in the pattern
+		memcpy(seq_patterns,seq_bankPatterns[j],sizeof(seq_patterns));
+		for(i=0;i<NUM_PATTERN;i++)
+		{
+			seq_patterns[i]->seq_patternSettings.changeBar 	= 0;	//default setting: zero repeats (play once then change)
+			seq_patterns[i]->seq_patternSettings.nextPattern 	= i;	//default setting: repeat same pattern
+			seq_clearPattern(i); // will clear all tracks in the pattern
+		}
 	}
+	seq_activeBank = seq_pendingBank = 0;
 
 }
 //------------------------------------------------------------------------------
 static void seq_activateTmpPattern()
 {
-	memcpy(&seq_patternSet.seq_subStepPattern[seq_activePattern],&seq_tmpPattern.seq_subStepPattern,sizeof(Step)*NUM_TRACKS*NUM_STEPS);
-	memcpy(&seq_patternSet.seq_mainSteps[seq_activePattern],&seq_tmpPattern.seq_mainSteps,sizeof(uint16_t)*NUM_TRACKS);
-	memcpy(&seq_patternSet.seq_patternSettings[seq_activePattern],&seq_tmpPattern.seq_patternSettings,sizeof(PatternSetting));
-	memcpy(&seq_patternSet.seq_patternLengthRotate[seq_activePattern],&seq_tmpPattern.seq_patternLengthRotate,sizeof(LengthRotate)*NUM_TRACKS);
+	Pattern* const playing = seq_patterns[seq_activePattern];
+
+	//settings and rotation are not part of the transfer, keep the current ones
+	seq_tmpPattern->seq_patternSettings = playing->seq_patternSettings;
+	uint8_t i;
+	for(i=0;i<NUM_TRACKS;i++) {
+		seq_tmpPattern->seq_patternLengthRotate[i].rotate = playing->seq_patternLengthRotate[i].rotate;
+	}
+
+	seq_patterns[seq_activePattern] = seq_tmpPattern;
+	seq_tmpPattern = playing;
+	//the old data is not needed anymore, give its pool memory back to the other patterns
+	pattern_clear(seq_tmpPattern);
+}
+//------------------------------------------------------------------------------
+// make the patterns of another bank the ones the sequencer and the front address
+static void seq_activateBank(const uint8_t bank)
+{
+	memcpy(seq_bankPatterns[seq_activeBank],seq_patterns,sizeof(seq_patterns));
+	memcpy(seq_patterns,seq_bankPatterns[bank],sizeof(seq_patterns));
+	seq_activeBank = bank;
 }
 //------------------------------------------------------------------------------
 void seq_setShuffle(float shuffle)
 {
-	seq_shuffle = shuffle;
+	groove_setAmount(shuffle);
 }
 //------------------------------------------------------------------------------
 void seq_setTrackLength(uint8_t trackNr, uint8_t length)
@@ -200,7 +271,8 @@ void seq_setTrackLength(uint8_t trackNr, uint8_t length)
 	if(length == 16)
 		length=0;
 	// --AS **PATROT this was changed from setting length on seq_activePattern to shown (or edited) pattern
-	seq_patternSet.seq_patternLengthRotate[frontParser_shownPattern][trackNr].length=length;
+	seq_patterns[frontParser_shownPattern]->seq_patternLengthRotate[trackNr].length=length;
+	seq_flushLookahead();
 
 }
 
@@ -208,7 +280,7 @@ void seq_setTrackLength(uint8_t trackNr, uint8_t length)
 uint8_t seq_getTrackLength(uint8_t trackNr)
 {
 	// --AS **PATROT this was changed from getting seq_activePattern to shown (or edited) pattern
-	uint8_t r=seq_patternSet.seq_patternLengthRotate[frontParser_shownPattern][trackNr].length;
+	uint8_t r=seq_patterns[frontParser_shownPattern]->seq_patternLengthRotate[trackNr].length;
 	if(r==0)
 		return 16;
 	return r;
@@ -219,7 +291,7 @@ void seq_setTrackRotation(uint8_t trackNr, const uint8_t newRot)
 {
 	// frontParser_shownPattern contains the pattern that is shown (being edited) on the front at the time this is called
 	// seq_activePattern is the pattern that is now playing
-	LengthRotate *lr=&seq_patternSet.seq_patternLengthRotate[frontParser_shownPattern][trackNr];
+	LengthRotate *lr=&seq_patterns[frontParser_shownPattern]->seq_patternLengthRotate[trackNr];
 
 	if(newRot == lr->rotate)
 		return;
@@ -246,47 +318,33 @@ void seq_setTrackRotation(uint8_t trackNr, const uint8_t newRot)
 
 	//set new rotation value
 	lr->rotate=newRot;
+	seq_flushLookahead();
 
 }
 //------------------------------------------------------------------------------
 // **PATROT
 uint8_t seq_getTrackRotation(uint8_t trackNr)
 {
-	return seq_patternSet.seq_patternLengthRotate[frontParser_shownPattern][trackNr].rotate;
+	return seq_patterns[frontParser_shownPattern]->seq_patternLengthRotate[trackNr].rotate;
 }
 //------------------------------------------------------------------------------
-static void seq_calcDeltaT(uint16_t bpm)
-{
-	//--- calc deltaT ----
-	// f�r 4/4tel takt -> 1 beat = 4 main steps = 4*8 = 32 sub steps
-	// 120 bpm 4/4tel = 120 * 1 beat / 60sec = 120 * 32 in 60 sec;
-	seq_deltaT 	= (1000*60)/bpm; 	//bei 12 = 500ms = time for one beat
-	seq_deltaT /= 96.f; //we run the internal clock at 96ppq -> seq clock 32 ppq == prescaler 3, midi clock 24 ppq == prescale 4
-	seq_deltaT *= 4;
-	//32.f;					// time for one beat / number of steps per beat
-
-	//--- calc shuffle ---
-	if(seq_shuffle != 0)
-	{
-		//every 2nd and 4th 16th note in a beat is shifted full
-		//=> step 8 and step 24
-		//every 2nd 16th note in half a beat
-		//every beat has 32 steps => half = 16
-		uint8_t stepInHalfBeat = seq_masterStepCnt&0xf;
-		const float shuffleFactor = seq_shuffleTable[stepInHalfBeat] * seq_shuffle;
-		const float originalDeltaT = seq_deltaT;
-
-		seq_deltaT += shuffleFactor * originalDeltaT * 16.f;
-		seq_deltaT -= seq_lastShuffle * originalDeltaT * 16.f;
-
-		seq_lastShuffle = shuffleFactor;
-	}
+// delay of the current step caused by the shuffle [samples]
+static float seq_getShuffleDelay()
+{
+	return groove_getDelay(seq_masterStepCnt) * seqClock_getPulseLength();
 }
 //------------------------------------------------------------------------------
 void seq_setBpm(uint16_t bpm)
 {
 	seq_tempo 	= bpm;
-	//seq_calcDeltaT(bpm);
+	seqClock_setBpm(bpm);
+	lfo_recalcSync();
+}
+//------------------------------------------------------------------------------
+void seq_setSyncedBpm(uint16_t bpm)
+{
+	//the clock itself is slewed by the sync pll, only the displayed tempo and lfo sync follow
+	seq_tempo 	= bpm;
 	lfo_recalcSync();
 }
 //------------------------------------------------------------------------------
@@ -295,15 +353,27 @@ uint16_t seq_getBpm()
 	return seq_tempo;
 }
 //------------------------------------------------------------------------------
-void seq_sync()
+void seq_sync(uint32_t arrival)
 {
-	sync_tick();
+	sync_tick(arrival);
 }
 //------------------------------------------------------------------------------
 void seq_setNextPattern(const uint8_t patNr)
 {
 	seq_pendingPattern = patNr;
 	seq_loadPendigFlag = 1;
+	seq_flushLookahead();
+}
+//------------------------------------------------------------------------------
+void seq_setNextBankPattern(const uint8_t nr)
+{
+	seq_pendingBank = (nr/NUM_PATTERN) % NUM_PATTERN_BANKS;
+	//a running sequencer switches the bank with the next pattern change
+	if(!seq_running && seq_pendingBank != seq_activeBank)
+	{
+		seq_activateBank(seq_pendingBank);
+	}
+	seq_setNextPattern(nr % NUM_PATTERN);
 }
 //------------------------------------------------------------------------------
 static void seq_sendMidi(MidiMsg msg)
@@ -318,7 +388,7 @@ static void seq_sendMidi(MidiMsg msg)
 
 
 //------------------------------------------------------------------------------
-static void seq_parseAutomationNodes(uint8_t track, Step* stepData)
+static void seq_parseAutomationNodes(uint8_t track, const Step* stepData)
 {
 	//set new destination
 	autoNode_setDestination(&seq_automationNodes[track][0], stepData->param1Nr);
@@ -328,6 +398,41 @@ static void seq_parseAutomationNodes(uint8_t track, Step* stepData)
 	autoNode_updateValue(&seq_automationNodes[track][1], stepData->param2Val);
 }
 //------------------------------------------------------------------------------
+static void seq_queueParamLocks(uint8_t track)
+{
+	const uint8_t num = pattern_getLocks(seq_patterns[seq_activePattern], track, seq_stepIndex[track],
+			seq_pendingLockDest[track], seq_pendingLockValue[track], SEQ_MAX_STEP_LOCKS);
+
+	//nothing to do if neither this nor the last step had locks
+	if(num == 0 && seq_pendingLockNum[track] == 0) return;
+
+	seq_pendingLockNum[track] = num;
+	seq_pendingLockMask |= (1<<track);
+}
+//------------------------------------------------------------------------------
+void seq_applyParamLocks()
+{
+	if(!seq_pendingLockMask) return;
+
+	uint8_t i,j;
+	for(i=0;i<NUM_TRACKS;i++)
+	{
+		if(!(seq_pendingLockMask & (1<<i))) continue;
+
+		//the nodes restore the values of the previous locks when their destination changes
+		for(j=0;j<SEQ_MAX_STEP_LOCKS;j++)
+		{
+			if(j < seq_pendingLockNum[i]) {
+				autoNode_setDestination(&seq_lockNodes[i][j], seq_pendingLockDest[i][j]);
+				autoNode_updateValue(&seq_lockNodes[i][j], seq_pendingLockValue[i][j]);
+			} else {
+				autoNode_setDestination(&seq_lockNodes[i][j], NO_AUTOMATION);
+			}
+		}
+	}
+	seq_pendingLockMask = 0;
+}
+//------------------------------------------------------------------------------
 void seq_triggerVoice(uint8_t voiceNr, uint8_t vol, uint8_t note)
 {
 	uint8_t midiChan; // which midi channel to send a note on
@@ -335,7 +440,9 @@ void seq_triggerVoice(uint8_t voiceNr, uint8_t vol, uint8_t note)
 
 	if(voiceNr > 6) return;
 
-	seq_parseAutomationNodes(voiceNr, &seq_patternSet.seq_subStepPattern[seq_activePattern][voiceNr][seq_stepIndex[voiceNr]]);
+	const Step * const step = pattern_getStep(seq_patterns[seq_activePattern], voiceNr, seq_stepIndex[voiceNr]);
+	seq_parseAutomationNodes(voiceNr, step);
+	seq_queueParamLocks(voiceNr);
 
 	//turn the trigger off before sending the next one
 	if(voiceNr>=5)
@@ -363,108 +470,249 @@ void seq_triggerVoice(uint8_t voiceNr, uint8_t vol, uint8_t note)
 		midiNote = midi_NoteOverride[voiceNr];
 
 	//send the new note to midi/usb out
-	seq_sendMidiNoteOn(midiChan, midiNote,
-			seq_patternSet.seq_subStepPattern[seq_activePattern][voiceNr][seq_stepIndex[voiceNr]].volume&STEP_VOLUME_MASK);
+	seq_sendMidiNoteOn(midiChan, midiNote, step->volume);
 }
 //------------------------------------------------------------------------------
-static uint8_t seq_determineNextPattern()
+static uint8_t seq_determineNextPattern(const uint8_t pattern, const uint8_t barCounter)
 {
-	const PatternSetting * const p=&seq_patternSet.seq_patternSettings[seq_activePattern];
-	if(seq_barCounter % (p->changeBar+1) == 0)
+	const PatternSetting * const p=&seq_patterns[pattern]->seq_patternSettings;
+	if(barCounter % (p->changeBar+1) == 0)
 		return p->nextPattern;
 	else
-		return seq_activePattern;
+		return pattern;
 }
-
-static void seq_nextStep()
+//------------------------------------------------------------------------------
+// check which tracks play on the step described by ev (main step, sub step and probability)
+static void seq_resolveTriggers(SeqStepEvent* ev)
 {
+	uint8_t i;
+	ev->trigMask = 0;
+	for(i=0;i<NUM_TRACKS;i++)
+	{
+		const int8_t stepIdx = ev->stepIndex[i];
 
-	if(!seq_running)
-		return;
+		//if main step (associated with current substep) and sub-step are active
+		if(!seq_intIsMainStepActive(i,stepIdx/8,ev->pattern)) continue;
+		if(!seq_intIsStepActive(i,stepIdx,ev->pattern)) continue;
 
-	seq_masterStepCnt++;
+		const Step * const step = pattern_getStep(seq_patterns[ev->pattern], i, stepIdx);
 
-	//---- calc master step position. max value is 127. also take in regard the pattern length -----
-	// track 0 determines the master step position
+		//PROBABILITY
+		//every 8th step a new random value is generated
+		//thus every sub step block has only one random value to compare against
+		//allows randomisation of rolls by chance
+		if((stepIdx & 0x07) == 0x00) //every 8th step
+		{
+			seq_rndValue[i] = GetRngValue()&0x7f;
+		}
+
+		if(seq_rndValue[i] <= step->prob)
+		{
+			ev->trigMask |= (1<<i);
+			ev->vol[i] 	= step->volume;
+			ev->note[i] = step->note;
+		}
+	}
+}
+//------------------------------------------------------------------------------
+// advance the lookahead cursor by one step and store the result in ev
+static void seq_resolveStep(SeqStepEvent* ev)
+{
+	SeqCursor * const c = &seq_cursor;
 	uint8_t masterStepPos;
 	uint8_t seqlen;
-	//if( (((seq_stepIndex[0]+1) &0x7f) == 0) ||
-	//    (((seq_patternSet.seq_subStepPattern[seq_activePattern][0][seq_stepIndex[0]+1]).note & PATTERN_END_MASK)>=PATTERN_END_MASK) )
+	uint8_t i;
+
+	ev->flags = 0;
 
-	seqlen=seq_patternSet.seq_patternLengthRotate[seq_activePattern][0].length;
+	//---- calc master step position. max value is 127. also take in regard the pattern length -----
+	// track 0 determines the master step position
+	seqlen=seq_patterns[c->activePattern]->seq_patternLengthRotate[0].length;
 	if(!seqlen)
 		seqlen=16;
 
-	if( (((seq_stepIndex[0]+1) & 0x7f) == 0) || ((seq_stepIndex[0]+1) / 8 == seqlen))
-			//(((seq_patternSet.seq_subStepPattern[seq_activePattern][0][seq_stepIndex[0]+1]).note & PATTERN_END)) )
+	if( (((c->stepIndex[0]+1) & 0x7f) == 0) || ((c->stepIndex[0]+1) / 8 == seqlen))
 	{
 		masterStepPos = 0;
 		//a bar has passed
-		seq_barCounter++;
+		c->barCounter++;
 	}
 	else
 	{
-		masterStepPos = seq_stepIndex[0]+1;
+		masterStepPos = c->stepIndex[0]+1;
 	}
 
 	//-------- check if the master track has ended and check if a pattern switch is necessary --------
 	if(masterStepPos == 0)
 	{
-		if(seq_activePattern == seq_pendingPattern)
+		if(c->activePattern == c->pendingPattern)
 		{
 			//check pattern settings if we have to auto change patterns
-			seq_pendingPattern = seq_determineNextPattern();
-			if(seq_pendingPattern >= SEQ_NEXT_RANDOM)
+			c->pendingPattern = seq_determineNextPattern(c->activePattern, c->barCounter);
+			if(c->pendingPattern >= SEQ_NEXT_RANDOM)
 			{
-				uint8_t limit = seq_pendingPattern - SEQ_NEXT_RANDOM +2;
+				uint8_t limit = c->pendingPattern - SEQ_NEXT_RANDOM +2;
 				uint8_t rnd = GetRngValue() % limit;
-				seq_pendingPattern = rnd;
+				c->pendingPattern = rnd;
 			}
 		}
 
 		// a new pattern is about to start
 		// set pendingPattern active
-		if((seq_activePattern != seq_pendingPattern) || seq_loadPendigFlag)
+		if((c->activePattern != c->pendingPattern) || c->loadPending)
 		{
 			//--AS if this setting is active and the user has manually changed patterns,
 			// reset the bar counter. uncommenting the below will cause it to only reset
 			// when a manual pattern change is invoked. to me the whole auto pattern change modulo stuff
 			// above is a bit broken.
-			if(/*seq_loadPendigFlag &&*/ seq_resetBarOnPatternChange)
-				seq_barCounter=0;
+			if(/*c->loadPending &&*/ seq_resetBarOnPatternChange)
+				c->barCounter=0;
 			// --AS TODO we need to also reset barCounter to 0 when the end of a repetition set of a pattern plays
 			// EVEN IF the pattern is set to play itself again, this will facilitate having the bits that play
 			// certain steps only on certain intervals of bar counter
 
-			seq_loadPendigFlag = 0;
-			//first check if 2 new pattern is available
-			if(seq_newPatternAvailable)
-			{
-				seq_newPatternAvailable = 0;
-				seq_activateTmpPattern();
-			}
-
-			seq_activePattern = seq_pendingPattern;
+			c->loadPending = 0;
+			c->activePattern = c->pendingPattern;
 
 			//reset pattern position to pattern rotate starting position for the active pattern --AS **PATROT
-			seq_setStepIndexToStart();
+			seq_calcStepIndexStart(c->activePattern, c->stepIndex);
 
-			//send the ack message to tell the front that a new pattern starts playing
-			uart_sendFrontpanelByte(FRONT_SEQ_CC);
-			uart_sendFrontpanelByte(FRONT_SEQ_CHANGE_PAT);
-			uart_sendFrontpanelByte(seq_activePattern);
+			ev->flags |= SEQ_EVENT_PATTERN_CHANGE;
+		}
+	}
 
-			// --AS send a pattern change message to midi/usb out
-			seq_sendProgChg(seq_activePattern);
+	ev->masterStepPos 	= masterStepPos;
+	ev->clockTickPos 	= c->stepIndex[0]+1;
 
+	for(i=0;i<NUM_TRACKS;i++)
+	{
+		//increment the step index
+		c->stepIndex[i]++;
+		//check if track end is reached
 
-			// --AS all notes off here since we are switching patterns
-			voiceControl_noteOff(0xFF);
+		// --AS **PATROT we now use this for length
+		seqlen=seq_patterns[c->activePattern]->seq_patternLengthRotate[i].length;
+		if(!seqlen)
+			seqlen=16;
+
+		if((c->stepIndex[i] / 8) == seqlen || (c->stepIndex[i] & 0x7f) == 0)
+		{
+			//if end is reached reset track to step 0
+			c->stepIndex[i] = 0;
 		}
+		ev->stepIndex[i] = c->stepIndex[i];
+	}
+
+	ev->barCounter 		= c->barCounter;
+	ev->pattern 		= c->activePattern;
+	ev->pendingPattern 	= c->pendingPattern;
+	ev->loadPending 	= c->loadPending;
+
+	seq_resolveTriggers(ev);
+}
+//------------------------------------------------------------------------------
+void seq_flushLookahead()
+{
+	seq_laFlushFlag = 1;
+}
+//------------------------------------------------------------------------------
+// resolve steps until SEQ_LOOKAHEAD_STEPS are queued.
+// after a flush the cursor restarts at the last played step
+static void seq_fillLookahead()
+{
+	if(seq_laFlushFlag)
+	{
+		seq_laFlushFlag = 0;
+		memcpy(seq_cursor.stepIndex,seq_stepIndex,NUM_TRACKS);
+		seq_cursor.barCounter 		= seq_barCounter;
+		seq_cursor.activePattern 	= seq_activePattern;
+		seq_cursor.pendingPattern 	= seq_pendingPattern;
+		seq_cursor.loadPending 		= seq_loadPendigFlag;
+		seq_laRead = seq_laWrite = 0;
+	}
+
+	if(!seq_running)
+		return;
+
+	while((uint8_t)(seq_laWrite-seq_laRead) < SEQ_LOOKAHEAD_STEPS)
+	{
+		seq_resolveStep(&seq_laQueue[seq_laWrite & SEQ_LOOKAHEAD_MASK]);
+		seq_laWrite++;
+	}
+}
+//------------------------------------------------------------------------------
+// play the next precomputed step
+static void seq_nextStep()
+{
+
+	if(!seq_running)
+		return;
+
+	//normally seq_tick keeps the queue filled
+	if(seq_laFlushFlag || seq_laRead == seq_laWrite)
+	{
+		seq_fillLookahead();
+	}
+	SeqStepEvent * const ev = &seq_laQueue[seq_laRead & SEQ_LOOKAHEAD_MASK];
+	seq_laRead++;
+	seq_lastStepPos = seq_lastPulsePos;
+
+	seq_masterStepCnt++;
+
+	seq_barCounter 		= ev->barCounter;
+	seq_pendingPattern 	= ev->pendingPattern;
+	seq_loadPendigFlag 	= ev->loadPending;
+
+	//-------- a new pattern starts with this step --------
+	if(ev->flags & SEQ_EVENT_PATTERN_CHANGE)
+	{
+		//first check if 2 new pattern is available
+		const uint8_t tmpLoaded = seq_newPatternAvailable;
+		if(tmpLoaded)
+		{
+			seq_newPatternAvailable = 0;
+			seq_activateTmpPattern();
+		}
+
+		//the bank changes together with the pattern
+		const uint8_t bankChanged = seq_pendingBank != seq_activeBank;
+		if(bankChanged)
+		{
+			seq_activateBank(seq_pendingBank);
+		}
+
+		seq_activePattern = ev->pattern;
+
+		//reset pattern position to pattern rotate starting position for the active pattern --AS **PATROT
+		seq_setStepIndexToStart();
+
+		if(tmpLoaded || bankChanged)
+		{
+			//the step was resolved from the old pattern data
+			uint8_t i;
+			for(i=0;i<NUM_TRACKS;i++) {
+				ev->stepIndex[i] = seq_stepIndex[i]+1;
+			}
+			ev->clockTickPos = seq_stepIndex[0]+1;
+			seq_resolveTriggers(ev);
+			seq_flushLookahead();
+		}
+
+		//send the ack message to tell the front that a new pattern starts playing
+		uart_sendFrontpanelByte(FRONT_SEQ_CC);
+		uart_sendFrontpanelByte(FRONT_SEQ_CHANGE_PAT);
+		uart_sendFrontpanelByte(seq_activePattern);
+
+		// --AS send a pattern change message to midi/usb out
+		seq_sendProgChg(seq_activeBank*NUM_PATTERN + seq_activePattern);
+
+
+		// --AS all notes off here since we are switching patterns
+		voiceControl_noteOff(0xFF);
 	}
 
 	//---------- now check if the master track is at a full beat position to flash the start/stop button --------
-	if((masterStepPos&31) == 0)
+	if((ev->masterStepPos&31) == 0)
 	{
 		//&32 <=> %32
 		//a quarter beat occured (multiple of 32 steps in the 128 step pattern)
@@ -473,7 +721,7 @@ static void seq_nextStep()
 		uart_sendFrontpanelByte(FRONT_LED_PULSE_BEAT);
 		uart_sendFrontpanelByte(1);
 	}
-	else if ((masterStepPos&31) == 1)
+	else if ((ev->masterStepPos&31) == 1)
 	{
 		//TODO datenmenge zur front reduzieren
 		//turn it of again on the next step
@@ -483,67 +731,35 @@ static void seq_nextStep()
 	}
 
 	//--------- Time to process the single tracks -------------------------
-	trigger_clockTick(seq_stepIndex[0]+1);
+	trigger_clockTick(ev->clockTickPos);
+
+	memcpy(seq_stepIndex,ev->stepIndex,NUM_TRACKS);
+
+	//the som generator triggers all tracks at once
+	if(seq_SomModeActive)
+	{
+		som_tick(seq_stepIndex[0],seq_mutedTracks);
+	}
 
 	int i;
 	for(i=0;i<NUM_TRACKS;i++)
 	{
-		//increment the step index
-		seq_stepIndex[i]++;
-		//check if track end is reached
-
-		// --AS **PATROT we now use this for length
-		seqlen=seq_patternSet.seq_patternLengthRotate[seq_activePattern][i].length;
-		if(!seqlen)
-			seqlen=16;
-
-		if((seq_stepIndex[i] / 8) == seqlen || (seq_stepIndex[i] & 0x7f) == 0)
+		if(!seq_SomModeActive)
 		{
-			//if end is reached reset track to step 0
-			seq_stepIndex[i] = 0;
-		}
-
-
-		if(seq_SomModeActive)
-		{
-			som_tick(seq_stepIndex[0],seq_mutedTracks);
-
-		} else {
 			//if track is not muted
 			if(!(seq_mutedTracks & (1<<i) ) )
 			{
-				//if main step (associated with current substep) is active
-				if(seq_intIsMainStepActive(i,seq_stepIndex[i]/8,seq_activePattern)) {
-
-					// --AS **RECORD if we are in erase mode (shift clear while record and playing)
-					// and this is the active track on the front, we erase the note value
-					// only do so if we are on a main step while erase is active. in this case, the main step and
-					// all it's substeps are erased.
-					if(seq_eraseActive && i==frontParser_activeTrack && seq_stepIndex[i]%8==0) {
-						// erase the main step and all substeps
-						seq_eraseStepAndSubSteps(frontParser_activeTrack,seq_stepIndex[i]/8);
-					} else
-					// if sub-step is active
-					if(seq_intIsStepActive(i,seq_stepIndex[i],seq_activePattern))
-					{
-						//PROBABILITY
-						//every 8th step a new random value is generated
-						//thus every sub step block has only one random value to compare against
-						//allows randomisation of rolls by chance
-
-						if((seq_stepIndex[i] & 0x07) == 0x00) //every 8th step
-						{
-							seq_rndValue[i] = GetRngValue()&0x7f;
-						}
-
-						if( (seq_rndValue[i]) <= seq_patternSet.seq_subStepPattern[seq_activePattern][i][seq_stepIndex[i]].prob )
-						{
-							const uint8_t vol = seq_patternSet.seq_subStepPattern[seq_activePattern][i][seq_stepIndex[i]].volume&STEP_VOLUME_MASK;
-							const uint8_t note = seq_patternSet.seq_subStepPattern[seq_activePattern][i][seq_stepIndex[i]].note;
-							seq_triggerVoice(i,vol,note);
-						}
-					} // if sub step is active
-				} // if main step is active
+				// --AS **RECORD if we are in erase mode (shift clear while record and playing)
+				// and this is the active track on the front, we erase the note value
+				// only do so if we are on a main step while erase is active. in this case, the main step and
+				// all it's substeps are erased.
+				if(seq_eraseActive && i==frontParser_activeTrack && seq_stepIndex[i]%8==0
+						&& seq_intIsMainStepActive(i,seq_stepIndex[i]/8,seq_activePattern)) {
+					// erase the main step and all substeps
+					seq_eraseStepAndSubSteps(frontParser_activeTrack,seq_stepIndex[i]/8);
+				} else if(ev->trigMask & (1<<i)) {
+					seq_triggerVoice(i,ev->vol[i],ev->note[i]);
+				}
 			} // if this track is not muted
 		}
 
@@ -558,7 +774,7 @@ static void seq_nextStep()
 					{
 						const uint8_t vol = ROLL_VOLUME;
 
-						const uint8_t note = seq_patternSet.seq_subStepPattern[seq_activePattern][i][seq_stepIndex[i]].note;
+						const uint8_t note = pattern_getStep(seq_patterns[seq_activePattern], i, seq_stepIndex[i])->note;
 						seq_triggerVoice(i,vol,note);
 
 						seq_addNote(i,vol, note); // --AS todo should this be note or should it be SEQ_DEFAULT_NOTE (before my change it would have been SEQ_DEFAULT_NOTE)
@@ -601,9 +817,9 @@ void seq_armAutomationStep(uint8_t stepNr, uint8_t track,uint8_t isArmed)
 	}
 }
 //------------------------------------------------------------------------------
-void seq_setDeltaT(float delta)
+void seq_forceNextStep()
 {
-	seq_deltaT = delta;
+	seq_forceStepFlag = 1;
 }
 //------------------------------------------------------------------------------
 
@@ -621,7 +837,7 @@ void seq_triggerNextMasterStep(uint8_t stepSize)
 {
 	uint8_t i, sn, len;
 	for(i=0;i<NUM_TRACKS;i++) {
-		len = seq_patternSet.seq_patternLengthRotate[seq_activePattern][i].length;
+		len = seq_patterns[seq_activePattern]->seq_patternLengthRotate[i].length;
 		if(!len) // length of 0 means length of 16 (since we are using 4 bits)
 			len=16;
 		len *= 8; // need length in steps
@@ -640,8 +856,10 @@ void seq_triggerNextMasterStep(uint8_t stepSize)
 		if(seq_lastMasterStep[i] >= len)
 			seq_lastMasterStep[i] -= len;
 
-		//set time to next step to zero, forcing the sequencer to process the next step now
-		seq_setDeltaT(-1);
+		seq_flushLookahead();
+
+		//force the sequencer to process the next step now
+		seq_forceNextStep();
 	}
 }
 //------------------------------------------------------------------------------
@@ -653,99 +871,111 @@ void seq_resetDeltaAndTick()
 		seq_nextStep();
 	}
 
-	//is shuffle delay necessary?
-
-	if(seq_shuffle != 0)
+	//realign the internal clock to the external one. the sync step itself is played
+	//by the pulse emitted now, so it gets the same latency and shuffle delay as every other step
+	seq_delayedSyncStepFlag = 1;
+	seq_prescaleCounter = 0;
+	seqClock_restart(1);
+}
+//------------------------------------------------------------------------------
+// one pulse of the 96 ppq clock
+static void seq_clockPulse()
+{
+	if((seq_prescaleCounter%SEQ_PRESCALER_MASK) == 0)
 	{
-		//seq_deltaT = 0;^
-
-		seq_deltaT 	= (1000*60)/seq_tempo; 	//bei 12 = 500ms = time for one beat
-		seq_deltaT /= 96.f; //we run the internal clock at 96ppq -> seq clock 32 ppq == prescaler 3, midi clock 24 ppq == prescale 4
-		seq_deltaT *= 4;
+		//for external sync the clock is phase locked to the midi clock by the sync pll.
+		//steps only stop if the external clock is lost, the pll realigns on the next sync clock
 
-		seq_lastTick = systick_ticks;
+		if(seq_getExtSync()) {
+			seq_delayedSyncStepFlag = 0;
+			if(sync_isLocked()) {
+				seq_nextStep();
+			}
+		} else {
+			seq_nextStep();
+		}
+	}
 
-		uint8_t stepInHalfBeat = seq_masterStepCnt&0xf;
-		const float shuffleFactor = seq_shuffleTable[stepInHalfBeat] * seq_shuffle;
-		const float originalDeltaT = seq_deltaT;
+	seq_prescaleCounter++;
+	if(seq_prescaleCounter>=12)seq_prescaleCounter=0;
+}
+//------------------------------------------------------------------------------
+void seq_processClock(const uint32_t blockPos)
+{
+	uint32_t timestamp;
+	while(seqClock_peekPulse(&timestamp))
+	{
+		//internal clock is halted while external triggers drive the sequencer
+		if(seq_forcedStepActive)
+		{
+			if(systick_ticks-seq_forcedStepTime < SEQ_FORCED_STEP_HOLD)
+			{
+				seqClock_dropPulse();
+				continue;
+			}
+			seq_forcedStepActive = 0;
+		}
 
-		seq_deltaT = shuffleFactor * originalDeltaT * 16.f;
-		seq_lastShuffle = shuffleFactor;
+		uint32_t pulsePos = timestamp + SEQ_CLOCK_LATENCY + (uint32_t)seq_getShuffleDelay();
 
-		if(seq_deltaT <= 0)
+		//the shuffle delay shrinks again within a beat, never play a pulse before the previous one
+		if((int32_t)(pulsePos - seq_lastPulsePos) < 0)
 		{
-			seq_nextStep();
-			seq_lastTick = systick_ticks;
-			seq_calcDeltaT(seq_tempo);
-		} else
-		{
-			seq_delayedSyncStepFlag =1;
+			pulsePos = seq_lastPulsePos;
 		}
 
-		seq_prescaleCounter = 0;
+		//not in this block yet
+		if((int32_t)(pulsePos - (blockPos+OUTPUT_DMA_SIZE)) >= 0) break;
 
+		seqClock_dropPulse();
+		seq_lastPulsePos = pulsePos;
+
+		//late pulses (main loop stalled) are played at the block start
+		const int32_t offset = pulsePos - blockPos;
+		voiceTable_setEventOffset(offset > 0 ? offset : 0);
+		seq_clockPulse();
 	}
-	else
+	voiceTable_setEventOffset(0);
+}
+//------------------------------------------------------------------------------
+/** call periodically to process steps forced by external triggers and to resolve upcoming steps*/
+// send changes of pattern_poolFull to the front. nothing can be sent during a sysex transfer, seq_tick retries
+static void seq_reportPoolFull()
+{
+	if(pattern_poolFull != seq_reportedPoolFull && !frontParser_sysexActive)
 	{
-		//play next sync step
-		seq_nextStep();
-
-		seq_lastTick = systick_ticks;
-		seq_calcDeltaT(seq_tempo);
-
-		seq_prescaleCounter = 0;
+		seq_reportedPoolFull = pattern_poolFull;
+		uart_sendFrontpanelByte(FRONT_SEQ_CC);
+		uart_sendFrontpanelByte(FRONT_SEQ_POOL_FULL);
+		uart_sendFrontpanelByte(seq_reportedPoolFull);
 	}
-
-
 }
 //------------------------------------------------------------------------------
-/** call periodically to check if the next step has to be processed */
 void seq_tick()
 {
-	if(seq_deltaT == -1)
+	//step triggered by the trigger input
+	if(seq_forceStepFlag)
 	{
-		seq_deltaT = 32000;
+		seq_forceStepFlag = 0;
+		seq_forcedStepActive = 1;
+		seq_forcedStepTime = systick_ticks;
 		seq_nextStep();
-
-		return;
 	}
-	if(systick_ticks-seq_lastTick >= seq_deltaT)
-	{
 
-		float rest = systick_ticks-seq_lastTick - seq_deltaT;
-		seq_lastTick = systick_ticks;
-		seq_calcDeltaT(seq_tempo);
-		seq_deltaT = seq_deltaT - rest;
-
-		if((seq_prescaleCounter%SEQ_PRESCALER_MASK) == 0)
-		{
-			//for external sync we have a ratio of 3/4 ppq/steps
-			//so when the 3rd ppq is received we have to activate the 4th step etc
-			//advance only 2 steps automatically, then wait for sync message
+	//resolve upcoming steps outside of the audio calculation
+	seq_fillLookahead();
 
-			if(seq_getExtSync()) {
-				if(seq_isNextStepSyncStep()==0) {
-					seq_delayedSyncStepFlag = 0;
-
-					seq_nextStep();
-				}
-			} else {
-				seq_nextStep();
-			}
-		}
+	//tell the front when step data or locks could not be stored
+	seq_reportPoolFull();
 
-		if(!seq_getExtSync()) //only send internal MIDI clock to output when external sync is off
-		{
-			if((seq_prescaleCounter%MIDI_PRESCALER_MASK) == 0)
-			{
-				seq_sendRealtime(MIDI_CLOCK);
-			}
-		}
-		seq_prescaleCounter++;
-		if(seq_prescaleCounter>=12)seq_prescaleCounter=0;
+	//the clock interrupt sends the midi clock. only send internal MIDI clock to output when external sync is off
+	const uint8_t clockOut = !seq_getExtSync() && (midiParser_txRxFilter & 0x20);
+	if(clockOut != seqClock_getMidiClockOut())
+	{
+		seqClock_setMidiClockOut(clockOut);
+		//release midi data held back for a clock that is not sent anymore
+		uart_flushMidi();
 	}
-
-
 }
 //------------------------------------------------------------------------------
 void seq_setQuantisation(uint8_t value)
@@ -755,29 +985,28 @@ void seq_setQuantisation(uint8_t value)
 //------------------------------------------------------------------------------
 void seq_toggleStep(uint8_t voice, uint8_t stepNr, uint8_t patternNr)
 {
-	if((seq_patternSet.seq_subStepPattern[patternNr][voice][stepNr].volume&STEP_ACTIVE_MASK)==0)
-	{
-		seq_patternSet.seq_subStepPattern[patternNr][voice][stepNr].volume |= STEP_ACTIVE_MASK;
-	} else {
-		seq_patternSet.seq_subStepPattern[patternNr][voice][stepNr].volume &= ~STEP_ACTIVE_MASK;
-	}
+	Pattern * const p = seq_patterns[patternNr];
+	pattern_setStepActive(p, voice, stepNr, !pattern_isStepActive(p, voice, stepNr));
+	seq_flushLookahead();
 }
 //------------------------------------------------------------------------------
 void seq_toggleMainStep(uint8_t voice, uint8_t stepNr, uint8_t patternNr)
 {
-	seq_patternSet.seq_mainSteps[patternNr][voice] ^= (1<<stepNr);
+	seq_patterns[patternNr]->seq_mainSteps[voice] ^= (1<<stepNr);
+	seq_flushLookahead();
 }
 //------------------------------------------------------------------------------
 static void seq_setMainStep(uint8_t patternNr, uint8_t voice, uint8_t stepNr, uint8_t onOff)
 {
 	if(onOff)
 	{
-		seq_patternSet.seq_mainSteps[patternNr][voice] |= (1<<stepNr);
+		seq_patterns[patternNr]->seq_mainSteps[voice] |= (1<<stepNr);
 	}
 	else
 	{
-		seq_patternSet.seq_mainSteps[patternNr][voice] &= ~(1<<stepNr);
+		seq_patterns[patternNr]->seq_mainSteps[voice] &= ~(1<<stepNr);
 	}
+	seq_flushLookahead();
 }
 //------------------------------------------------------------------------------
 // --AS this appears unused
@@ -785,11 +1014,11 @@ static void seq_setMainStep(uint8_t patternNr, uint8_t voice, uint8_t stepNr, ui
 //{
 //	if(onOff)
 //	{
-//		seq_patternSet.seq_subStepPattern[seq_activePattern][voice][stepNr].volume |= STEP_ACTIVE_MASK;
+//		seq_patterns[seq_activePattern]->seq_subStepPattern[voice][stepNr].volume |= STEP_ACTIVE_MASK;
 //	}
 //	else
 //	{
-//		seq_patternSet.seq_subStepPattern[seq_activePattern][voice][stepNr].volume &= ~STEP_ACTIVE_MASK;
+//		seq_patterns[seq_activePattern]->seq_subStepPattern[voice][stepNr].volume &= ~STEP_ACTIVE_MASK;
 //	}
 //}
 //------------------------------------------------------------------------------
@@ -808,7 +1037,7 @@ void seq_setRunning(uint8_t isRunning)
 		// --AS reset all track rotations to 0. We are not saving rotated value. it's a performance tool.
 		uint8_t i;
 		for(i=0;i<NUM_TRACKS;i++) {
-			seq_patternSet.seq_patternLengthRotate[seq_activePattern][i].rotate=0;
+			seq_patterns[seq_activePattern]->seq_patternLengthRotate[i].rotate=0;
 			// let the front know this is happening
 			uart_sendFrontpanelByte(FRONT_SEQ_CC);
 			uart_sendFrontpanelByte(FRONT_SEQ_TRACK_ROTATION);
@@ -816,11 +1045,8 @@ void seq_setRunning(uint8_t isRunning)
 		}
 
 		//reset song position bar counter
-		seq_lastShuffle = 0;
 		seq_barCounter = 0;
 		seq_masterStepCnt = 0;
-		//so the next seq_tick call will trigger the next step immediately
-		seq_deltaT = 0;
 		seq_sendRealtime(MIDI_STOP);
 
 		//--AS send notes off on all channels that have notes playing and reset our bitmap to reflect that
@@ -834,19 +1060,23 @@ void seq_setRunning(uint8_t isRunning)
 		midiParser_checkMtc();
 	} else {
 		seq_prescaleCounter = 0;
+		//start has to go out before the first clock
 		seq_sendRealtime(MIDI_START);
+		//first step and clock play right away
+		seqClock_restart(1);
 		trigger_reset(1);
 	}
 
 	// set start points back to default (happens on start and stop. needs to happen on start
 	// in case the user has entered a rotate value while stopped)
 	seq_setStepIndexToStart();
+	seq_flushLookahead();
 
 }
 //------------------------------------------------------------------------------
 static uint8_t seq_intIsStepActive(uint8_t voice, uint8_t stepNr, uint8_t patternNr)
 {
-	return ((seq_patternSet.seq_subStepPattern[patternNr][voice][stepNr].volume & STEP_ACTIVE_MASK) > 0);
+	return pattern_isStepActive(seq_patterns[patternNr], voice, stepNr);
 }
 // --AS above will be inlined, below is for ext linkage
 uint8_t seq_isStepActive(uint8_t voice, uint8_t stepNr, uint8_t patternNr)
@@ -857,7 +1087,7 @@ uint8_t seq_isStepActive(uint8_t voice, uint8_t stepNr, uint8_t patternNr)
 //------------------------------------------------------------------------------
 static uint8_t seq_intIsMainStepActive(uint8_t voice, uint8_t mainStepNr, uint8_t pattern)
 {
-	return (seq_patternSet.seq_mainSteps[pattern][voice] & (1<<mainStepNr)) > 0;
+	return (seq_patterns[pattern]->seq_mainSteps[voice] & (1<<mainStepNr)) > 0;
 }
 // --AS above is inlined below for ext linkage
 uint8_t seq_isMainStepActive(uint8_t voice, uint8_t mainStepNr, uint8_t pattern)
@@ -904,15 +1134,29 @@ void seq_sendMainStepInfoToFront(uint16_t stepNr)
 	const uint8_t currentPattern	= stepNr / 7;
 	const uint8_t currentTrack  	= stepNr - currentPattern*7;
 
-	uint16_t dataToSend = seq_patternSet.seq_mainSteps[currentPattern][currentTrack];
+	uint16_t dataToSend = seq_patterns[currentPattern]->seq_mainSteps[currentTrack];
 
 	uart_sendFrontpanelSysExByte(  dataToSend	  & 0x7f); //1st 7 bit
 	uart_sendFrontpanelSysExByte( (dataToSend>>7) & 0x7f); //2nd 7 bit
 	uart_sendFrontpanelSysExByte( (dataToSend>>14)& 0x7f); //last 2 bit
 
 	// send the track length
-	uart_sendFrontpanelSysExByte( seq_patternSet.seq_patternLengthRotate[currentPattern][currentTrack].length);
+	uart_sendFrontpanelSysExByte( seq_patterns[currentPattern]->seq_patternLengthRotate[currentTrack].length);
+
+}
+//--------------------------------------------------------------------
+void seq_sendLockInfoToFront(uint8_t trackNr, uint16_t lockNr)
+{
+	const uint8_t currentPattern	= trackNr / 7;
+	const uint8_t currentTrack  	= trackNr - currentPattern*7;
+	uint8_t step = 0, dest = 0, value = 0;
+
+	const uint8_t found = pattern_getLockAt(seq_patterns[currentPattern], currentTrack, lockNr, &step, &dest, &value);
 
+	uart_sendFrontpanelSysExByte(step	& 0x7f);
+	uart_sendFrontpanelSysExByte(dest	& 0x7f);
+	uart_sendFrontpanelSysExByte(value	& 0x7f);
+	uart_sendFrontpanelSysExByte( ((dest & 0x80)>>7) | ((value & 0x80)>>6) | (found ? 0 : 0x04) );
 }
 //--------------------------------------------------------------------
 /** this one is more complicated than the 14 bit upper/lower nibble when transmitting the requested step number via SysEx.
@@ -947,7 +1191,10 @@ void seq_sendStepInfoToFront(uint16_t stepNr)
 	const uint8_t currentStep		= stepNr - absPat*128;
 
 	//encode the data and send it back
-	Step *dataToSend = &seq_patternSet.seq_subStepPattern[currentPattern][currentTrack][currentStep];
+	Step step = *pattern_getStep(seq_patterns[currentPattern], currentTrack, currentStep);
+	if(pattern_isStepActive(seq_patterns[currentPattern], currentTrack, currentStep))
+		step.volume |= STEP_ACTIVE_MASK;
+	const Step * const dataToSend = &step;
 
 	uart_sendFrontpanelSysExByte(dataToSend->volume	& 0x7f);
 	uart_sendFrontpanelSysExByte(dataToSend->prob	& 0x7f);
@@ -1067,9 +1314,9 @@ void seq_setRollRate(uint8_t rate)
 
 }
 //------------------------------------------------------------------------
-/** quantize a step to the seq_quantisation value*/
+/** quantize a (fractional) step to the seq_quantisation value*/
 #define QUANT(x) (NUM_STEPS/x)
-static int8_t seq_quantize(int8_t step)
+static int8_t seq_quantize(float step)
 {
 	uint8_t quantisationMultiplier=1;
 	switch(seq_quantisation)
@@ -1092,20 +1339,63 @@ static int8_t seq_quantize(int8_t step)
 
 	case NO_QUANTISATION:
 	default:
-		return step;
+		return (int16_t)floorf(step) & 0x7f;
 		break;
 	}
 
-	//now calc the quantisation
-	float frac = step/(float)quantisationMultiplier;
-	int8_t itg = (int8_t)frac;
-	frac = frac - itg;
+	//round to the nearest multiple, positions before step 0 wrap to the end of the bar
+	return ((int16_t)floorf(step/quantisationMultiplier + 0.5f) * quantisationMultiplier) & 0x7f;
+}
+//------------------------------------------------------------------------
+/** position of a track at playback position samplePos, in fractions of a step*/
+static float seq_stepAt(const uint8_t trackNr, const uint32_t samplePos)
+{
+	//the step counter runs ahead of what is heard by the audio latency, a note received
+	//before the last step was audible belongs to the step before
+	const float stepLen = seqClock_getPulseLength() * SEQ_PRESCALER_MASK;
+	float delta = (int32_t)(samplePos - seq_lastStepPos) / stepLen;
+
+	//stale positions (sequencer just started) are limited to one main step
+	if(delta < -8.f) delta = -8.f;
+	else if(delta > 8.f) delta = 8.f;
 
-	if(frac>=0.5f)
+	float pos = seq_stepIndex[trackNr] + delta;
+	if(pos < 0)
 	{
-		return ((itg + 1)*quantisationMultiplier)&0x7f;
+		//received during the end of the previous lap of the track
+		const uint8_t len = seq_patterns[seq_activePattern]->seq_patternLengthRotate[trackNr].length;
+		pos += (len ? len : 16) * 8;
+	}
+	return pos;
+}
+//------------------------------------------------------------------------
+/** store automation on the active automation track of a step.
+ *  automation track SEQ_AUTOM_TRACK_LOCKS adds a parameter lock instead of using a step slot*/
+static void seq_writeAutomation(uint8_t track, uint8_t stepNr, uint8_t dest, uint8_t value)
+{
+	Pattern * const p = seq_patterns[seq_activePattern];
+
+	if(seq_activeAutomTrack == SEQ_AUTOM_TRACK_LOCKS) {
+		if(!pattern_setLock(p, track, stepNr, dest, value)) {
+			//no pool memory left => automation is not recorded
+			seq_reportPoolFull();
+		}
+		return;
+	}
+
+	Step * const step = pattern_editStep(p, track, stepNr);
+	if(!step) {
+		//no pool memory left => automation is not recorded
+		seq_reportPoolFull();
+		return;
+	}
+	if(seq_activeAutomTrack == 0) {
+		step->param1Nr = dest;
+		step->param1Val = value;
+	} else {
+		step->param2Nr = dest;
+		step->param2Val = value;
 	}
-	return itg*quantisationMultiplier;
 }
 //------------------------------------------------------------------------
 void seq_recordAutomation(uint8_t voice, uint8_t dest, uint8_t value)
@@ -1118,13 +1408,7 @@ void seq_recordAutomation(uint8_t voice, uint8_t dest, uint8_t value)
 		if( seq_intIsMainStepActive(voice,quantizedStep/8,seq_activePattern) &&
 				seq_intIsStepActive(voice,quantizedStep,seq_activePattern))
 		{
-			if(seq_activeAutomTrack == 0) {
-				seq_patternSet.seq_subStepPattern[seq_activePattern][voice][quantizedStep].param1Nr = dest;
-				seq_patternSet.seq_subStepPattern[seq_activePattern][voice][quantizedStep].param1Val = value;
-			} else {
-				seq_patternSet.seq_subStepPattern[seq_activePattern][voice][quantizedStep].param2Nr = dest;
-				seq_patternSet.seq_subStepPattern[seq_activePattern][voice][quantizedStep].param2Val = value;
-			}
+			seq_writeAutomation(voice, quantizedStep, dest, value);
 		}
 	}
 
@@ -1132,44 +1416,32 @@ void seq_recordAutomation(uint8_t voice, uint8_t dest, uint8_t value)
 	{
 		//step button is held down
 		//-> set step automation parameters
-		if(seq_activeAutomTrack == 0) {
-			seq_patternSet.seq_subStepPattern[seq_activePattern]
-			                                  [seq_armedArmedAutomationTrack]
-			                                   [seq_armedArmedAutomationStep].param1Nr = dest;
-			seq_patternSet.seq_subStepPattern[seq_activePattern]
-			                                  [seq_armedArmedAutomationTrack]
-			                                   [seq_armedArmedAutomationStep].param1Val = value;
-		} else {
-			seq_patternSet.seq_subStepPattern[seq_activePattern]
-			                                  [seq_armedArmedAutomationTrack]
-			                                   [seq_armedArmedAutomationStep].param2Nr = dest;
-			seq_patternSet.seq_subStepPattern[seq_activePattern]
-			                                  [seq_armedArmedAutomationTrack]
-			                                   [seq_armedArmedAutomationStep].param2Val = value;
-		}
+		seq_writeAutomation(seq_armedArmedAutomationTrack, seq_armedArmedAutomationStep, dest, value);
 	}
 }
 //------------------------------------------------------------------------
-void seq_addNote(uint8_t trackNr,uint8_t vel, uint8_t note)
+static void seq_recordNote(uint8_t trackNr,uint8_t vel, uint8_t note, float stepPos)
 {
 	uint8_t targetPattern;
 	Step *stepPtr;
+	Pattern *p;
 	//only record notes when seq is running and recording
 	if(seq_running && seq_recordActive)
 	{
-		const int8_t quantizedStep = seq_quantize(seq_stepIndex[trackNr]);
+		const int8_t quantizedStep = seq_quantize(stepPos);
 
 
 		// --AS **RECORD fix for recording across patterns
-		if(quantizedStep==0 && seq_stepIndex[trackNr] > (NUM_STEPS/2)) {
+		if(quantizedStep==0 && stepPos > (NUM_STEPS/2)) {
 			// this means that we hit a note in 2nd half of the bar and quantization pushed
 			// the note to position 0 of the next bar.
 			// need to see if there is about to be a pattern change so that the note
 			// ends up on 0 of the next pattern
-			targetPattern=seq_determineNextPattern();
+			targetPattern=seq_determineNextPattern(seq_activePattern,seq_barCounter);
 
 		} else
 			targetPattern=seq_activePattern;
+		p = seq_patterns[targetPattern];
 
 		//special care must be taken when recording midi notes!
 		//since per default the 1st substep of a mainstep cluster is always active
@@ -1178,15 +1450,18 @@ void seq_addNote(uint8_t trackNr,uint8_t vel, uint8_t note)
 		{
 			//if the mainstep is not active, we clear the 1st substep
 			//to prevent double notes while recording
-			seq_patternSet.seq_subStepPattern[targetPattern][trackNr][(quantizedStep/8)*8].volume 	&= ~STEP_ACTIVE_MASK;
+			pattern_setStepActive(p, trackNr, (quantizedStep/8)*8, 0);
 		}
 
 		//set the current step in the requested track active
-		stepPtr=&seq_patternSet.seq_subStepPattern[targetPattern][trackNr][quantizedStep];
-		stepPtr->note 		= note;				// note (--AS was SEQ_DEFAULT_NOTE)
-		stepPtr->volume		= vel;				// new velocity
-		stepPtr->prob		= 127;				// 100% probability
-		stepPtr->volume 	|= STEP_ACTIVE_MASK;
+		stepPtr=pattern_editStep(p, trackNr, quantizedStep);
+		if(stepPtr)
+		{
+			stepPtr->note 		= note;				// note (--AS was SEQ_DEFAULT_NOTE)
+			stepPtr->volume		= vel;				// new velocity
+			stepPtr->prob		= 127;				// 100% probability
+		}
+		pattern_setStepActive(p, trackNr, quantizedStep, 1);
 
 		//activate corresponding main step
 		seq_setMainStep(targetPattern, trackNr, quantizedStep/8,1);
@@ -1204,23 +1479,32 @@ void seq_addNote(uint8_t trackNr,uint8_t vel, uint8_t note)
 		}
 	}
 }
+//------------------------------------------------------------------------
+void seq_addNote(uint8_t trackNr,uint8_t vel, uint8_t note)
+{
+	seq_recordNote(trackNr, vel, note, seq_stepIndex[trackNr]);
+}
+//------------------------------------------------------------------------
+void seq_addNoteAt(uint8_t trackNr,uint8_t vel, uint8_t note, uint32_t samplePos)
+{
+	if(seq_running && seq_recordActive) {
+		seq_recordNote(trackNr, vel, note, seq_stepAt(trackNr, samplePos));
+	}
+}
 
 //------------------------------------------------------------------------
 // --AS **RECORD erase a main step and all it's sub steps on the active pattern
 // for the specified voice
 static void seq_eraseStepAndSubSteps(const uint8_t voice, const uint8_t mainStep)
 {
-	uint8_t i;
 	// turn off the main step
 	seq_setMainStep(seq_activePattern, voice, mainStep,0);
 
 	// turn off all substeps
-	for(i=(uint8_t)(mainStep*8);i<(uint8_t)((mainStep+1)*8);i++) {
-		seq_resetNote(&seq_patternSet.seq_subStepPattern[seq_activePattern][voice][i]);
-	}
+	pattern_resetMainStep(seq_patterns[seq_activePattern], voice, mainStep);
 
 	// first substep needs to be made active
-	seq_patternSet.seq_subStepPattern[seq_activePattern][voice][(uint8_t)(mainStep*8)].volume |= STEP_ACTIVE_MASK;
+	pattern_setStepActive(seq_patterns[seq_activePattern], voice, (uint8_t)(mainStep*8), 1);
 
 	//if( (frontParser_shownPattern == seq_activePattern) && ( frontParser_activeTrack == voice) )
 	//{
@@ -1241,36 +1525,24 @@ void seq_setErasingMode(uint8_t active)
 	seq_eraseActive = active;
 }
 
-//------------------------------------------------------------------------------
-// --AS reset a step to it's default state
-static void seq_resetNote(Step *step)
-{
-	step->note 		= SEQ_DEFAULT_NOTE;
-	step->param1Nr 	= NO_AUTOMATION;
-	step->param1Val = 0;
-	step->param2Nr	= NO_AUTOMATION;
-	step->param2Val	= 0;
-	step->prob		= 127;
-	step->volume	= 100; // clears active bit as well
-}
 //------------------------------------------------------------------------------
 void seq_clearTrack(uint8_t trackNr, uint8_t pattern)
 {
 	int k;
-	for(k=0;k<128;k++)
-	{
-		seq_resetNote(&seq_patternSet.seq_subStepPattern[pattern][trackNr][k]);
+	pattern_resetSteps(seq_patterns[pattern], trackNr);
 
-		//every 1st step in a substep pattern active
-		if( (k%8) == 0)
-			seq_patternSet.seq_subStepPattern[pattern][trackNr][k].volume |= STEP_ACTIVE_MASK ;
+	//every 1st step in a substep pattern active
+	for(k=0;k<128;k+=8)
+	{
+		pattern_setStepActive(seq_patterns[pattern], trackNr, k, 1);
 	}
 
 	// all main steps off for this track
-	seq_patternSet.seq_mainSteps[pattern][trackNr] = 0;
+	seq_patterns[pattern]->seq_mainSteps[trackNr] = 0;
 
 	//**PATROT all pattern rotations off and all patterns set to length 16
-	seq_patternSet.seq_patternLengthRotate[pattern][trackNr].value=0;
+	seq_patterns[pattern]->seq_patternLengthRotate[trackNr].value=0;
+	seq_flushLookahead();
 
 }
 //------------------------------------------------------------------------------
@@ -1285,78 +1557,50 @@ void seq_clearPattern(uint8_t pattern)
 void seq_clearAutomation(uint8_t trackNr, uint8_t pattern, uint8_t automTrack)
 {
 	int k;
+	Pattern * const p = seq_patterns[pattern];
 
+	//steps with automation always have pool memory, default steps are skipped
 	if(automTrack==0)
 	{
 		for(k=0;k<128;k++)
 		{
-			seq_patternSet.seq_subStepPattern[pattern][trackNr][k].param1Nr 	= NO_AUTOMATION;
-			seq_patternSet.seq_subStepPattern[pattern][trackNr][k].param1Val 	= 0;
+			const Step * const step = pattern_getStep(p, trackNr, k);
+			if(step->param1Nr == NO_AUTOMATION && step->param1Val == 0) continue;
+			Step * const dst = pattern_editStep(p, trackNr, k);
+			dst->param1Nr 	= NO_AUTOMATION;
+			dst->param1Val 	= 0;
+		}
+	} else if(automTrack==1) {
+		for(k=0;k<128;k++)
+		{
+			const Step * const step = pattern_getStep(p, trackNr, k);
+			if(step->param2Nr == NO_AUTOMATION && step->param2Val == 0) continue;
+			Step * const dst = pattern_editStep(p, trackNr, k);
+			dst->param2Nr	= NO_AUTOMATION;
+			dst->param2Val	= 0;
 		}
 	} else {
 		for(k=0;k<128;k++)
 		{
-			seq_patternSet.seq_subStepPattern[pattern][trackNr][k].param2Nr		= NO_AUTOMATION;
-			seq_patternSet.seq_subStepPattern[pattern][trackNr][k].param2Val	= 0;
+			pattern_clearLocks(p, trackNr, k);
 		}
 	}
 }
 //------------------------------------------------------------------------------
 void seq_copyTrack(uint8_t srcNr, uint8_t dstNr, uint8_t pattern)
 {
-	// --AS todo this fn and the next are very similar. Add a new fn that takes src, dest track and src, dest pat
-	// and then have these two fn's call it instead.
-	int k;
-	Step *src, *dst;
-	for(k=0;k<128;k++)
-	{
-		dst=&seq_patternSet.seq_subStepPattern[pattern][dstNr][k];
-		src=&seq_patternSet.seq_subStepPattern[pattern][srcNr][k];
-		dst->note		= src->note;
-		dst->param1Nr 	= src->param1Nr;
-		dst->param1Val 	= src->param1Val;
-		dst->param2Nr	= src->param2Nr;
-		dst->param2Val	= src->param2Val;
-		dst->prob		= src->prob;
-		dst->volume		= src->volume;
-	}
-
-	// copy which main steps are on/off
-	seq_patternSet.seq_mainSteps[pattern][dstNr] = seq_patternSet.seq_mainSteps[pattern][srcNr];
-
-	// --AS copy length and rotation offset from source track
-	seq_patternSet.seq_patternLengthRotate[pattern][dstNr].value =
-			seq_patternSet.seq_patternLengthRotate[pattern][srcNr].value;
-
-
+	pattern_copyTrack(seq_patterns[pattern], dstNr, seq_patterns[pattern], srcNr);
+	seq_flushLookahead();
 }
 //------------------------------------------------------------------------------
 void seq_copyPattern(uint8_t src, uint8_t dst)
 {
-	int k,j;
-	Step *psrc, *pdst;
+	int j;
 	for(j=0;j<NUM_TRACKS;j++)
 	{
-		for(k=0;k<128;k++)
-		{
-			pdst=&seq_patternSet.seq_subStepPattern[dst][j][k];
-			psrc=&seq_patternSet.seq_subStepPattern[src][j][k];
-			pdst->note			= psrc->note;
-			pdst->param1Nr 		= psrc->param1Nr;
-			pdst->param1Val 	= psrc->param1Val;
-			pdst->param2Nr		= psrc->param2Nr;
-			pdst->param2Val		= psrc->param2Val;
-			pdst->prob			= psrc->prob;
-			pdst->volume		= psrc->volume;
-		}
-
-		seq_patternSet.seq_mainSteps[dst][j] = seq_patternSet.seq_mainSteps[src][j];
-
-		// --AS copy length and rotation offset from source pattern for the track
-		seq_patternSet.seq_patternLengthRotate[dst][j].value =
-					seq_patternSet.seq_patternLengthRotate[src][j].value;
-
+		pattern_copyTrack(seq_patterns[dst], j, seq_patterns[src], j);
 	}
+	seq_flushLookahead();
 }
 //------------------------------------------------------------------------------
 void seq_setActiveAutomationTrack(uint8_t trackNr)
@@ -1466,22 +1710,28 @@ static void seq_sendProgChg(const uint8_t ptn)
  *  This is called when the sequencer starts/stops running, also when a pattern change takes place
  */
 static void seq_setStepIndexToStart()
+{
+	uint8_t i;
+	seq_calcStepIndexStart(seq_activePattern, seq_stepIndex);
+	for(i=0;i<NUM_TRACKS;i++) {
+		// this is for external clock sync via trigger expansion kit (the ext tick will adjust this -1)
+		seq_lastMasterStep[i] = seq_stepIndex[i]+1;
+	}
+}
+//------------------------------------------------------------------------------
+static void seq_calcStepIndexStart(const uint8_t pattern, int8_t* stepIndex)
 {
 	uint8_t len, rot, i;
 	for(i=0;i<NUM_TRACKS;i++) {
-		// adjust rot in case the pattern length is less than the rotated amount
-		// len is 0-15 where a value of 0 means 16
-		rot=seq_patternSet.seq_patternLengthRotate[seq_activePattern][i].rotate;
-		len=seq_patternSet.seq_patternLengthRotate[seq_activePattern][i].length;
-		if(len && (rot > len))
+		// adjust rot in case the pattern length is not more than the rotated amount
+		// len is 0-15 where a value of 0 means 16. rotating by the full length starts at step 0,
+		// the first step of a new pattern is not wrapped by seq_resolveStep
+		rot=seq_patterns[pattern]->seq_patternLengthRotate[i].rotate;
+		len=seq_patterns[pattern]->seq_patternLengthRotate[i].length;
+		if(len && (rot >= len))
 			rot = rot % len;
 
-		// this is for external clock sync via trigger expansion kit (the ext tick will adjust this -1)
-		seq_lastMasterStep[i] = (8 * rot);
-
 		// -1 here because we increment it first thing when we start
-		seq_stepIndex[i] = ( 8 * rot) - 1;
-
+		stepIndex[i] = ( 8 * rot) - 1;
 	}
-
 }
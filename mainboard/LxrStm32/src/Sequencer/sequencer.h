@@ -41,22 +41,7 @@
 
 #include "stm32f4xx.h"
 #include "globals.h"
-
- /**<
-  * we have 6 voices
-  * 3 drums
-  * 1 snare/claps
-  * 1 cymbal/snare
-  * 1 hiHat
-  * track 7 is the open hh... it triggers the highhat voice but with longer decay. it chokes the closed hihat*/
-#define NUM_TRACKS 7
-#define NUM_PATTERN 8
-#define NUM_STEPS 128
-
-#define SEQ_DEFAULT_NOTE 63
-
-#define STEP_ACTIVE_MASK 0x80
-#define STEP_VOLUME_MASK 0x7f
+#include "pattern.h"
 
 // **PATROT these are not used anymore
 //#define PATTERN_END_MASK 0x7f
@@ -67,6 +52,9 @@
 
 #define ROLL_VOLUME 100
 
+#define SEQ_AUTOM_TRACK_LOCKS	2	/**< automation track that records parameter locks instead of step automation*/
+#define SEQ_MAX_STEP_LOCKS		8	/**< parameter locks applied per step and track*/
+
 enum Seq_QuantisationEnum
 {
 	NO_QUANTISATION,
@@ -76,58 +64,11 @@ enum Seq_QuantisationEnum
 	QUANT_64,
 };
 
-typedef struct StepStruct
-{
-	uint8_t 	volume;		// 0-127 volume -> 0x7f => lower 7 bit, upper bit => active
-	uint8_t  	prob;		//step probability (--AS todo we have one free bit here)
-	uint8_t		note;		//midi note value 0-127 -> 0x7f, --AS todo upper bit is now free for other usages
-
-	//parameter automation
-	uint8_t 	param1Nr;
-	uint8_t 	param1Val;
-
-	uint8_t 	param2Nr;
-	uint8_t 	param2Val;
-
-}Step;
-
-typedef struct PatternSettingsStruct
-{
-	uint8_t 	changeBar;		// change on every Nth bar to the next pattern
-	uint8_t  	nextPattern;	// [0:9] (0-7) are the 8 patterns, (8) is random previous, (9) is random all
-}PatternSetting;
-
-// --AS **PATROT
-typedef union {
-	uint8_t value;
-	struct {
-		unsigned length:4;	// length (0 = default 16 steps)
-		unsigned rotate:4;	// 0 means not rotated, 15 is max
-	};
-} LengthRotate;
-
-typedef struct PatternSetStruct
-{
-	Step seq_subStepPattern[NUM_PATTERN][NUM_TRACKS][NUM_STEPS];
-	uint16_t seq_mainSteps[NUM_PATTERN][NUM_TRACKS];
-	PatternSetting seq_patternSettings[NUM_PATTERN];
-	LengthRotate seq_patternLengthRotate[NUM_PATTERN][NUM_TRACKS];
-}PatternSet;
-
-typedef struct TempPatternStruct
-{
-	Step seq_subStepPattern[NUM_TRACKS][NUM_STEPS];
-	uint16_t seq_mainSteps[NUM_TRACKS];
-	PatternSetting seq_patternSettings;
-	LengthRotate seq_patternLengthRotate[NUM_TRACKS]; // only used for length
-}TempPattern;
-
 extern uint8_t seq_activePattern;
 extern uint8_t seq_newPatternAvailable;
 
-//extern PatternSet* seq_activePatternSetPtr;
-extern PatternSet seq_patternSet;
-extern TempPattern seq_tmpPattern;
+extern Pattern* seq_patterns[NUM_PATTERN];
+extern Pattern* seq_tmpPattern;				/**< spare slot the playing pattern is loaded into*/
 
 
 extern uint8_t seq_selectedStep;
@@ -151,22 +92,34 @@ uint8_t seq_getTrackRotation(uint8_t trackNr);
 //------------------------------------------------------------------------------
 void seq_init();
 //------------------------------------------------------------------------------
-/** call periodically to check if the next step has to be processed */
+/** call periodically to process steps forced by external triggers and to resolve upcoming steps*/
 void seq_tick();
 //------------------------------------------------------------------------------
+/** discard the resolved upcoming steps. call after pattern data of a playing pattern was changed*/
+void seq_flushLookahead();
+//------------------------------------------------------------------------------
 void seq_armAutomationStep(uint8_t stepNr, uint8_t track,uint8_t isArmed);
 //------------------------------------------------------------------------------
 void seq_resetDeltaAndTick();
 //------------------------------------------------------------------------------
-void seq_setDeltaT(float delta);
+/** play the next step at the next seq_tick call (used by external clock triggers)*/
+void seq_forceNextStep();
+//------------------------------------------------------------------------------
+/** play all internal clock pulses that fall into the audio block starting at sample position blockPos.
+ * call right before the block is calculated*/
+void seq_processClock(const uint32_t blockPos);
 //------------------------------------------------------------------------------
 void seq_triggerNextMasterStep(uint8_t stepSize);
 //------------------------------------------------------------------------------
 void seq_setBpm(uint16_t bpm);
 //------------------------------------------------------------------------------
+/** set the displayed tempo while the clock follows an external midi clock*/
+void seq_setSyncedBpm(uint16_t bpm);
+//------------------------------------------------------------------------------
 uint16_t seq_getBpm();
 //------------------------------------------------------------------------------
-void seq_sync();
+/** external midi clock received at playback position arrival*/
+void seq_sync(uint32_t arrival);
 //------------------------------------------------------------------------------
 //void seq_nextStep();
 //------------------------------------------------------------------------------
@@ -179,6 +132,10 @@ void seq_setExtSync(uint8_t isExt);
 /** switch to pattern patNr after the current pattern has finished*/
 void seq_setNextPattern(const uint8_t patNr);
 //------------------------------------------------------------------------------
+/** switch to pattern nr % 8 of bank nr / 8 after the current pattern has finished.
+ * a stopped sequencer switches the bank at once*/
+void seq_setNextBankPattern(const uint8_t nr);
+//------------------------------------------------------------------------------
 void seq_toggleStep(uint8_t voice, uint8_t stepNr, uint8_t patternNr);
 //------------------------------------------------------------------------------
 void seq_toggleMainStep(uint8_t voice, uint8_t stepNr, uint8_t patternNr);
@@ -203,12 +160,19 @@ void seq_sendStepInfoToFront(uint16_t stepNr);
 //------------------------------------------------------------------------------
 void seq_sendMainStepInfoToFront(uint16_t stepNr);
 //------------------------------------------------------------------------------
+/** send parameter lock lockNr of a track (pattern*7 + track) to the front.
+ * 4 bytes: step, dest, value, MSBs (bit0 dest, bit1 value). bit2 of the last byte is set if the track has no such lock*/
+void seq_sendLockInfoToFront(uint8_t trackNr, uint16_t lockNr);
+//------------------------------------------------------------------------------
 void seq_setRoll(uint8_t voice, uint8_t onOff);
 //------------------------------------------------------------------------------
 void seq_setRollRate(uint8_t rate);
 //------------------------------------------------------------------------------
 /** add a note to the current pattern position*/
 void seq_addNote(uint8_t trackNr,uint8_t vel, uint8_t note);
+/** add a note to the step that was audible at playback position samplePos (codec_getPlaybackPos),
+ * so recorded notes do not depend on how late the main loop handled them*/
+void seq_addNoteAt(uint8_t trackNr,uint8_t vel, uint8_t note, uint32_t samplePos);
 //------------------------------------------------------------------------------
 void seq_setRecordingMode(uint8_t active);
 //------------------------------------------------------------------------------
@@ -224,11 +188,14 @@ void seq_copyTrack(uint8_t srcNr, uint8_t dstNr, uint8_t pattern);
 //------------------------------------------------------------------------------
 void seq_copyPattern(uint8_t src, uint8_t dst);
 //------------------------------------------------------------------------------
-//selects the automation track (0:1) that is recorded to
+//selects the automation track (0:1) that is recorded to, SEQ_AUTOM_TRACK_LOCKS records parameter locks
 void seq_setActiveAutomationTrack(uint8_t trackNr);
 //------------------------------------------------------------------------------
 void seq_recordAutomation(uint8_t voice, uint8_t dest, uint8_t value);
 //------------------------------------------------------------------------------
+/** apply the parameter locks of the last triggered steps. called at the start of each audio block*/
+void seq_applyParamLocks();
+//------------------------------------------------------------------------------
 //uint8_t seq_isNextStepSyncStep();
 //------------------------------------------------------------------------------
 // send a note off for a channel if there is a note playing on that channel
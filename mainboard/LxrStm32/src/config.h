@@ -50,6 +50,9 @@
 
 #define UART_DEBUG_ECHO_MODE 0
 
+//if 1 a CC waiting in the midi out queue is updated instead of sending another CC with the same number
+#define MIDI_OUT_DROP_REDUNDANT_CC 1
+
 #define OUTPUT_DMA_SIZE 32
 #define DMA_MASK ((OUTPUT_DMA_SIZE*2)-1)
 #define UNIT_GAIN_DRIVE 0
@@ -91,6 +94,9 @@
 //the number of drum voices (bd tom1 tom2)
 #define NUM_VOICES 3
 
+//the number of synth voices in the voice table (drums, snare, cymbal, hihat)
+#define NUM_SYNTH_VOICES 6
+
 #if DMA_MODE_ACTIVE
 #define OUTPUT_DMA_SIZE 16
 #endif
@@ -42,6 +42,11 @@ extern volatile uint32_t systick_ticks;
 extern int16_t audioOutBuffer[2];
 extern   uint8_t bCurrentSampleValid;
 #define SAMPLE_VALID  0xff
+
+// cycle counter of the data watchpoint unit (not defined in the CMSIS version we use), enabled by mixer_init
+#define DWT_CTRL			(*(volatile uint32_t*)0xE0001000)
+#define DWT_CYCCNT			(*(volatile uint32_t*)0xE0001004)
+#define DWT_CTRL_CYCCNTENA	0x00000001
 #define FILTER_SHAPER -0.9f
 
 #endif
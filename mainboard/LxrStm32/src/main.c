@@ -54,6 +54,8 @@
 #include "CymbalVoice.h"
 #include "HiHat.h"
 #include "Snare.h"
+#include "voiceTable.h"
+#include "governor.h"
 #include "EuklidGenerator.h"
 #include "ParameterArray.h"
 #include "modulationNode.h"
@@ -61,6 +63,7 @@
 
 #include "usb_manager.h"
 #include "MidiParser.h"
+#include "SysexDump.h"
 
 #include "TriggerOut.h"
 #include <string.h>
@@ -179,12 +182,19 @@ void initAudioJackDiscoverPins()
 //---------------------------------------------------------
 inline void calcNextSampleBlock()
 {
+	//play the sequencer clock pulses falling into this block
+	seq_processClock(codec_getRenderPos());
+	//and the live midi notes
+	voiceControl_processLiveNotes(codec_getRenderPos());
+
 #if USE_DAC2
 	mixer_calcNextSampleBlock((int16_t*)&dma_buffer[bCurrentSampleValid*(OUTPUT_DMA_SIZE*2)],(int16_t*)&dma_buffer2[bCurrentSampleValid*(OUTPUT_DMA_SIZE*2)]);
 #else
 	mixer_calcNextSampleBlock(&dma_buffer[bCurrentSampleValid*(OUTPUT_DMA_SIZE*2)],&dma_buffer2[(1-bCurrentSampleValid)*(OUTPUT_DMA_SIZE*2)]);
 #endif
 	bCurrentSampleValid = SAMPLE_VALID;
+
+	governor_update(mixer_getCpuLoad());
 }
 //---------------------------------------------------------
 int main(void)
@@ -205,6 +215,7 @@ int main(void)
 	initAudioJackDiscoverPins();
 
 	mixer_init();
+	governor_init();
 
 	//precalc the first dma buffer block
 	calcNextSampleBlock();
@@ -217,7 +228,7 @@ int main(void)
 	trigger_init();
 
 	int i;
-	for(i=0;i<6;i++)
+	for(i=0;i<NUM_SYNTH_VOICES;i++)
 	{
 		modNode_init(&velocityModulators[i]);
 	}
@@ -239,10 +250,7 @@ int main(void)
 	memset(midi_MidiChannels,0,8);
 	memset(midi_NoteOverride,0,7);
 
-	initDrumVoice();
-	Snare_init();
-	HiHat_init();
-	Cymbal_init();
+	voiceTable_init();
 
 	usb_init();
 
@@ -268,6 +276,8 @@ int main(void)
     {
 
     	usb_tick();
+    	//usb sysex dump and restore
+    	sysexDump_tick();
     	//generate next sample if no valid sample is present
     	/*
     	if(bCurrentSampleValid!= SAMPLE_VALID)
@@ -283,7 +293,9 @@ int main(void)
 
 		//check if we have some usb midi messages and process them
 		MidiMsg msg;
-		if(usb_getMidi(&msg)) {
+		uint32_t arrival;
+		if(usb_getMidi(&msg, &arrival)) {
+			midiParser_setArrivalTime(arrival);
 			midiParser_parseMidiMessage(msg);
 		}
 
@@ -94,6 +94,8 @@ void OTG_FS_IRQHandler(void)
 #endif /* USE_USB_OTG_HS */
 {
   USBD_OTG_ISR_Handler (&USB_OTG_dev);
+  //send realtime messages queued from the sequencer clock interrupt
+  usb_midiInKick(&USB_OTG_dev);
 }
 
 #ifdef USB_OTG_HS_DEDICATED_EP1_ENABLED
@@ -0,0 +1,282 @@
+// LxrSysex.cpp : dump and restore the patterns, kit and globals of the LXR over usb midi sysex.
+// talks to a raw midi device (e.g. /dev/snd/midiC1D0 or /dev/midi1 on linux).
+// the dump is stored as a plain .syx file holding the record frames as sent by the LXR.
+//
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include "SysexProtocol.h"
+
+using namespace std;
+
+typedef vector<uint8_t> Frame;
+
+static const int TIMEOUT_MS = 2000;
+
+//------------------------------------------------------------------------------
+static Frame makeFrame(uint8_t cmd, const uint8_t* payload, uint16_t len)
+{
+	Frame f(LXR_SYSEX_HEADER_SIZE + lxrSysex_packedSize(len) + 2);
+	f[0] = 0xF0;
+	f[1] = LXR_SYSEX_ID;
+	f[2] = LXR_SYSEX_DEVICE;
+	f[3] = cmd;
+
+	const uint16_t n = lxrSysex_pack(payload, len, &f[LXR_SYSEX_HEADER_SIZE]);
+	uint8_t chk = cmd;
+	for(uint16_t i=0;i<n;i++)
+		chk ^= f[LXR_SYSEX_HEADER_SIZE+i];
+	f[LXR_SYSEX_HEADER_SIZE+n] = chk;
+	f[LXR_SYSEX_HEADER_SIZE+n+1] = 0xF7;
+	return f;
+}
+//------------------------------------------------------------------------------
+// header and checksum of a complete frame
+static bool checkFrame(const Frame& f)
+{
+	if(f.size() < LXR_SYSEX_HEADER_SIZE+2 || f[1] != LXR_SYSEX_ID || f[2] != LXR_SYSEX_DEVICE)
+		return false;
+
+	uint8_t chk = 0;
+	for(size_t i=3;i<f.size()-2;i++)
+		chk ^= f[i];
+	return chk == f[f.size()-2];
+}
+//------------------------------------------------------------------------------
+static vector<uint8_t> unpackPayload(const Frame& f)
+{
+	const uint16_t packed = f.size() - LXR_SYSEX_HEADER_SIZE - 2;
+	vector<uint8_t> data(packed);
+	data.resize(lxrSysex_unpack(&f[LXR_SYSEX_HEADER_SIZE], packed, data.data()));
+	return data;
+}
+//------------------------------------------------------------------------------
+static bool writeFrame(int fd, const Frame& f)
+{
+	size_t pos = 0;
+	while(pos < f.size())
+	{
+		const ssize_t n = write(fd, &f[pos], f.size()-pos);
+		if(n <= 0)
+			return false;
+		pos += n;
+	}
+	return true;
+}
+//------------------------------------------------------------------------------
+// read the next frame of the LXR. everything else on the port is skipped
+static bool readFrame(int fd, Frame& f)
+{
+	f.clear();
+	for(;;)
+	{
+		pollfd p = {fd, POLLIN, 0};
+		if(poll(&p, 1, TIMEOUT_MS) <= 0)
+			return false;
+
+		uint8_t b;
+		if(read(fd, &b, 1) != 1)
+			return false;
+
+		if(b >= 0xF8)
+			continue; //realtime messages may appear anywhere
+
+		if(b == 0xF0)
+			f.assign(1, b);
+		else if(!f.empty())
+		{
+			f.push_back(b);
+			if(b == 0xF7)
+			{
+				if(f.size() > 3 && f[1] == LXR_SYSEX_ID && f[2] == LXR_SYSEX_DEVICE)
+					return true;
+				f.clear();
+			}
+		}
+	}
+}
+//------------------------------------------------------------------------------
+static bool readFile(const char* name, vector<Frame>& frames)
+{
+	ifstream input(name, ios::binary | ios::in);
+	if(!input.is_open())
+	{
+		cerr << "Input file not found: " << name << endl;
+		return false;
+	}
+
+	Frame f;
+	char c;
+	while(input.get(c))
+	{
+		const uint8_t b = c;
+		if(b == 0xF0)
+			f.assign(1, b);
+		else if(!f.empty())
+		{
+			f.push_back(b);
+			if(b == 0xF7)
+			{
+				if(checkFrame(f) && f[3] == LXR_SYSEX_RECORD)
+					frames.push_back(f);
+				f.clear();
+			}
+		}
+	}
+	return true;
+}
+//------------------------------------------------------------------------------
+static bool dump(int fd, vector<Frame>& records)
+{
+	const Frame request = makeFrame(LXR_SYSEX_DUMP_REQUEST, 0, 0);
+	if(!writeFrame(fd, request))
+		return false;
+
+	Frame f;
+	while(readFrame(fd, f))
+	{
+		if(!checkFrame(f))
+		{
+			cerr << "Checksum error in record " << records.size() << endl;
+			return false;
+		}
+		if(f[3] == LXR_SYSEX_RECORD)
+			records.push_back(f);
+		else if(f[3] == LXR_SYSEX_END)
+		{
+			const vector<uint8_t> cnt = unpackPayload(f);
+			if(cnt.size() < 2 || (size_t)(cnt[0] | (cnt[1]<<8)) != records.size())
+			{
+				cerr << "Received " << records.size() << " records, the LXR sent more" << endl;
+				return false;
+			}
+			return true;
+		}
+	}
+	cerr << "Timeout after " << records.size() << " records" << endl;
+	return false;
+}
+//------------------------------------------------------------------------------
+// send one frame and wait for the ack
+static bool sendAcked(int fd, const Frame& frame, size_t idx)
+{
+	if(!writeFrame(fd, frame))
+		return false;
+
+	Frame f;
+	while(readFrame(fd, f))
+	{
+		if(!checkFrame(f) || f[3] != LXR_SYSEX_ACK)
+			continue;
+
+		const vector<uint8_t> status = unpackPayload(f);
+		if(status.empty() || status[0] == LXR_SYSEX_OK)
+			return true;
+
+		cerr << "Record " << idx << " failed, status " << (int)status[0] << endl;
+		//a full pool only lost data of this record, keep going
+		return status[0] == LXR_SYSEX_ERR_POOL;
+	}
+	cerr << "No answer for record " << idx << endl;
+	return false;
+}
+//------------------------------------------------------------------------------
+static bool restore(int fd, const vector<Frame>& records)
+{
+	for(size_t i=0;i<records.size();i++)
+	{
+		if(!sendAcked(fd, records[i], i))
+			return false;
+	}
+
+	const uint8_t cnt[2] = {(uint8_t)(records.size() & 0xff), (uint8_t)(records.size() >> 8)};
+	return sendAcked(fd, makeFrame(LXR_SYSEX_END, cnt, 2), records.size());
+}
+//------------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	if(argc < 4) {
+		cerr << "Dump and restore LXR patterns, kit and globals over usb midi\nUsage: " << argv[0] << " <dump|restore|verify> <midi device> <syx file>" << endl;
+		cerr << " dump    : save the LXR state to the file" << endl;
+		cerr << " restore : send the file to the LXR" << endl;
+		cerr << " verify  : restore the file, dump it back and compare" << endl;
+		return 1;
+	}
+
+	const string cmd = argv[1];
+	const char* devname = argv[2];
+	const char* filename = argv[3];
+
+	const int fd = open(devname, O_RDWR);
+	if(fd < 0)
+	{
+		cerr << "Could not open midi device " << devname << endl;
+		return -1;
+	}
+
+	int result = 0;
+	vector<Frame> records;
+	if(cmd == "dump")
+	{
+		if(dump(fd, records))
+		{
+			ofstream output(filename, ios::binary | ios::out);
+			size_t bytes = 0;
+			for(size_t i=0;i<records.size();i++) {
+				output.write((const char*)records[i].data(), records[i].size());
+				bytes += records[i].size();
+			}
+			cout << "Dumped " << records.size() << " records, " << bytes << " bytes to " << filename << endl;
+		}
+		else
+			result = -1;
+	}
+	else if(cmd == "restore" || cmd == "verify")
+	{
+		if(!readFile(filename, records) || records.empty())
+		{
+			cerr << "No records in " << filename << endl;
+			result = -1;
+		}
+		else if(!restore(fd, records))
+			result = -1;
+		else
+			cout << "Restored " << records.size() << " records from " << filename << endl;
+
+		vector<Frame> readBack;
+		if(result == 0 && cmd == "verify")
+		{
+			if(!dump(fd, readBack))
+				result = -1;
+			else
+			{
+				size_t errors = records.size() == readBack.size() ? 0 : 1;
+				for(size_t i=0;i<records.size() && i<readBack.size();i++)
+				{
+					if(records[i] != readBack[i]) {
+						cerr << "Record " << i << " differs" << endl;
+						errors++;
+					}
+				}
+				cout << (errors ? "Verify failed" : "Verify ok") << endl;
+				result = errors ? -1 : 0;
+			}
+		}
+	}
+	else
+	{
+		cerr << "Unknown command " << cmd << endl;
+		result = 1;
+	}
+
+	close(fd);
+	return result;
+}
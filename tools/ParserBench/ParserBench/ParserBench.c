@@ -0,0 +1,632 @@
+// ParserBench.c : test and benchmark of the midi and front panel byte parsers, runs on the host.
+// streams hand written and generated byte sequences through midiParser_parseUartData,
+// midiParser_handleStatusByte and frontParser_parseUartData and checks the resulting
+// voice, parameter and pattern state: running status, realtime bytes between and inside
+// messages, system common messages, sysex and malformed or out of range data.
+// the same streams are timed to report parsed messages per second.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hostTest.h"
+#include "halStubs.h"
+#include "MidiParser.h"
+#include "frontPanelParser.h"
+#include "sequencer.h"
+
+#define BENCH_MIDI_BYTES		2000000
+#define BENCH_DAW_REPEATS		20000
+#define BENCH_FRONT_CC			500000
+#define BENCH_STEP_TRANSFERS	20
+#define FUZZ_BYTES				1000000
+#define FUZZ_SYSEX_BYTES		50000
+
+#define GLOBAL_CHANNEL			9
+#define TEST_STORED_TRACKS		(PATTERN_STEP_BLOCKS/(NUM_PATTERN*NUM_STEPS/8))	/**< tracks of a dense step transfer that fit into the pool*/
+
+static uint32_t bench_seed = 0x1234567;
+
+// one beat of a drum track as a sequencer sends it at 24 ppq: notes on the global channel with
+// running status, zero velocity note offs, a cc ramp, a note on channel 1, an identity
+// request and clocks between and inside the messages
+static const uint8_t bench_dawBeat[] = {
+	0xfa,
+	0x99, 0x24, 0x64, 0x2a, 0x50,
+	0xf8, 0xf8, 0xf8, 0xf8, 0xf8, 0xf8,
+	0x24, 0x00, 0x2a, 0x00,
+	0xf8, 0xf8, 0xf8, 0xf8, 0xf8, 0xf8,
+	0xb9, 0x10, 0x20, 0x10, 0xf8, 0x28, 0x10, 0x30,
+	0xf8, 0xf8, 0xf8, 0xf8, 0xf8,
+	0x90, 0x26, 0x70, 0xf8, 0x26, 0x00,
+	0xf0, 0x7e, 0x7f, 0x06, 0x01, 0xf7,
+	0xf8, 0xf8, 0xf8, 0xf8, 0xf8,
+	0xfc,
+};
+#define BENCH_DAW_MESSAGES		36	/**< start, 6 notes, 3 ccs, sysex, 24 clocks, stop*/
+#define BENCH_DAW_NOTES			3
+#define BENCH_DAW_RECORDED		2
+#define BENCH_DAW_CLOCKS		24
+
+static uint8_t bench_midi[BENCH_MIDI_BYTES];
+static uint32_t bench_midiLen;
+static uint8_t bench_front[BENCH_FRONT_CC*3];
+//------------------------------------------------------------------------------
+static uint32_t bench_random()
+{
+	bench_seed = bench_seed*1664525u + 1013904223u;
+	return bench_seed>>8;
+}
+//------------------------------------------------------------------------------
+static double bench_seconds()
+{
+	return (double)clock() / CLOCKS_PER_SEC;
+}
+//------------------------------------------------------------------------------
+static void bench_report(const char* name, uint32_t messages, uint32_t bytes, double seconds)
+{
+	if(seconds <= 0) seconds = 1.0 / CLOCKS_PER_SEC;
+	printf("%-28s %9u messages %10.0f msgs/s %11.0f bytes/s\n", name, (unsigned)messages,
+			messages / seconds, bytes / seconds);
+}
+//------------------------------------------------------------------------------
+static void midi_stream(const uint8_t* data, uint32_t len)
+{
+	uint32_t i;
+	for(i=0;i<len;i++) {
+		midiParser_parseUartData(data[i]);
+	}
+}
+//------------------------------------------------------------------------------
+static void front_stream(const uint8_t* data, uint32_t len)
+{
+	uint32_t i;
+	for(i=0;i<len;i++) {
+		frontParser_parseUartData(data[i]);
+	}
+}
+#define MIDI(...)	do { const uint8_t d[] = {__VA_ARGS__}; midi_stream(d, sizeof(d)); } while(0)
+#define FRONT(...)	do { const uint8_t d[] = {__VA_ARGS__}; front_stream(d, sizeof(d)); } while(0)
+//------------------------------------------------------------------------------
+static void test_setup()
+{
+	uint8_t i;
+	for(i=0;i<7;i++) {
+		midi_MidiChannels[i] = i;
+		midi_NoteOverride[i] = 0;
+	}
+	midi_MidiChannels[7] = GLOBAL_CHANNEL;
+	midiParser_txRxFilter = 0xff;
+	midiParser_setRouting(0);
+	midiParser_setArrivalTime(0);
+	frontParser_activeTrack = 0;
+	//end any message or sysex a previous test left open
+	MIDI(0xf7, 0xf6);
+	FRONT(0xf7);
+	stub_reset();
+}
+//------------------------------------------------------------------------------
+static int test_note(uint32_t n, uint8_t voice, uint8_t note, uint8_t vel)
+{
+	return n < stub_noteCnt && stub_notes[n].voice == voice && stub_notes[n].note == note && stub_notes[n].vel == vel;
+}
+//------------------------------------------------------------------------------
+static void test_runningStatus()
+{
+	test_setup();
+
+	//data before the first status byte is ignored
+	MIDI(0x24, 0x64, 0x25);
+	CHECK(stub_noteCnt == 0, "data without status triggered %u notes", (unsigned)stub_noteCnt);
+
+	MIDI(0x90, 0x24, 0x64, 0x26, 0x50, 0x24, 0x00, 0x28, 0x01);
+	CHECK(stub_noteCnt == 3, "running status: %u notes instead of 3", (unsigned)stub_noteCnt);
+	CHECK(test_note(0, 0, 0x24, 0x64) && test_note(1, 0, 0x26, 0x50) && test_note(2, 0, 0x28, 0x01),
+			"running status: wrong notes");
+
+	//a new status byte ends an incomplete message
+	test_setup();
+	MIDI(0x90, 0x30, 0x91, 0x31, 0x41);
+	CHECK(stub_noteCnt == 1 && test_note(0, 1, 0x31, 0x41), "truncated message was not dropped");
+}
+//------------------------------------------------------------------------------
+static void test_realtime()
+{
+	test_setup();
+	midiParser_setArrivalTime(1000);
+
+	//clock between status and data bytes
+	MIDI(0x91, 0x3c, 0xf8, 0x64);
+	CHECK(test_note(0, 1, 0x3c, 0x64), "clock inside a note dropped the note");
+	CHECK(stub_syncCnt == 1 && stub_lastSyncArrival == 1000, "clock inside a note was not synced");
+	CHECK(stub_notes[0].samplePos == 1000, "note not stamped with its arrival time");
+
+	//realtime bytes between running status data bytes
+	MIDI(0x3e, 0xfa, 0xf8, 0x40, 0x3f, 0xfe, 0x41, 0xfc, 0x42, 0xff, 0x43);
+	CHECK(stub_noteCnt == 4, "realtime bytes broke running status: %u notes instead of 4", (unsigned)stub_noteCnt);
+	CHECK(test_note(1, 1, 0x3e, 0x40) && test_note(2, 1, 0x3f, 0x41) && test_note(3, 1, 0x42, 0x43),
+			"realtime bytes changed the note data");
+	CHECK(stub_syncCnt == 2 && stub_startCnt == 1 && stub_stopCnt == 1, "realtime messages lost");
+
+	//no clocks without external sync
+	stub_extSync = 0;
+	MIDI(0xf8, 0xf8);
+	CHECK(stub_syncCnt == 2, "clock synced with internal sync");
+}
+//------------------------------------------------------------------------------
+static void test_strayEnd()
+{
+	test_setup();
+
+	MIDI(0x92, 0x30, 0x40, 0xf7, 0x31, 0x41);
+	CHECK(stub_noteCnt == 2 && test_note(1, 2, 0x31, 0x41), "stray sysex end cancelled running status");
+}
+//------------------------------------------------------------------------------
+static void test_systemCommon()
+{
+	test_setup();
+	midiParser_setRouting(2);
+
+	//mtc quarter frame takes 1 data byte, data after it is no message
+	MIDI(0x93, 0x30, 0x40, 0xf1, 0x12, 0x31, 0x41);
+	CHECK(stub_noteCnt == 1, "data after mtc parsed as %u notes", (unsigned)stub_noteCnt - 1);
+	CHECK(stub_routedCnt == 2 && stub_routed[1].status == 0xf1 && stub_routed[1].data1 == 0x12,
+			"mtc: %u routed messages", (unsigned)stub_routedCnt);
+
+	//song select
+	stub_reset();
+	MIDI(0x93, 0x30, 0x40, 0xf3, 0x05, 0x31, 0x41, 0x32);
+	CHECK(stub_noteCnt == 1, "data after song select parsed as a note");
+	CHECK(stub_routedCnt == 2 && stub_routed[1].status == 0xf3 && stub_routed[1].data1 == 0x05,
+			"song select: %u routed messages", (unsigned)stub_routedCnt);
+
+	//song position pointer takes 2 data bytes
+	stub_reset();
+	MIDI(0x93, 0x30, 0x40, 0xf2, 0x10, 0x20, 0x31, 0x41);
+	CHECK(stub_noteCnt == 1, "data after song position parsed as a note");
+	CHECK(stub_routedCnt == 2 && stub_routed[1].status == 0xf2 &&
+			stub_routed[1].data1 == 0x10 && stub_routed[1].data2 == 0x20,
+			"song position not parsed with its 2 data bytes");
+
+	//undefined system common messages have no data
+	stub_reset();
+	MIDI(0x93, 0x30, 0x40, 0xf5, 0x31, 0x41, 0xf4, 0x32);
+	CHECK(stub_noteCnt == 1 && stub_routedCnt == 3, "undefined system common: %u notes, %u routed",
+			(unsigned)stub_noteCnt, (unsigned)stub_routedCnt);
+}
+//------------------------------------------------------------------------------
+static void test_sysex()
+{
+	test_setup();
+	midiParser_setRouting(2);
+
+	MIDI(0xf0, 0x43, 0xf8, 0x12, 0xf7, 0x30, 0x40);
+	CHECK(stub_syncCnt == 1, "clock inside sysex lost");
+	CHECK(stub_routedCnt == 5, "sysex: %u routed messages instead of 5", (unsigned)stub_routedCnt);
+	if(stub_routedCnt == 5) {
+		CHECK(stub_routed[0].status == 0xf0 && !stub_routed[0].bits.sysxbyte, "sysex start not routed");
+		CHECK(stub_routed[1].status == 0x43 && stub_routed[1].bits.sysxbyte, "sysex data not routed");
+		CHECK(stub_routed[2].status == 0xf8 && !stub_routed[2].bits.sysxbyte, "clock inside sysex not routed");
+		CHECK(stub_routed[3].status == 0x12 && stub_routed[3].bits.sysxbyte, "sysex continued wrong after clock");
+		CHECK(stub_routed[4].status == 0xf7 && !stub_routed[4].bits.sysxbyte, "sysex end not routed");
+	}
+	CHECK(stub_noteCnt == 0 && stub_paramCnt == 0, "sysex data interpreted");
+
+	//a status byte aborts an unterminated sysex
+	MIDI(0xf0, 0x01, 0x02, 0x95, 0x30, 0x40);
+	CHECK(stub_noteCnt == 1 && test_note(0, 5, 0x30, 0x40), "status byte did not end the sysex");
+}
+//------------------------------------------------------------------------------
+static void test_statusByte()
+{
+	test_setup();
+
+	//program change on the global channel requests the next pattern, 1 data byte with running status
+	midiParser_handleStatusByte(0xc0 | GLOBAL_CHANNEL);
+	MIDI(0x03);
+	CHECK(stub_nextPattern == 3, "program change not parsed");
+	MIDI(0x05);
+	CHECK(stub_nextPattern == 5, "program change running status not parsed");
+	//programs above 7 select the pattern banks
+	MIDI(0x1b);
+	CHECK(stub_nextPattern == 0x1b, "program change of pattern bank 3 not passed on");
+	MIDI(0x05);
+
+	//a system status ignores all data until the next status byte
+	midiParser_handleStatusByte(0xf4);
+	MIDI(0x06, 0x30, 0x40);
+	CHECK(stub_nextPattern == 5 && stub_noteCnt == 0, "data after an unknown status was parsed");
+
+	midiParser_handleStatusByte(0x96);
+	MIDI(0x30, 0x40);
+	CHECK(stub_noteCnt == 1 && test_note(0, 6, 0x30, 0x40), "note after handleStatusByte not parsed");
+}
+//------------------------------------------------------------------------------
+static void test_parameters()
+{
+	test_setup();
+
+	const uint8_t cc = 0xb0 | GLOBAL_CHANNEL;
+	MIDI(cc, 0x10, 0x55, 0x11, 0x66, 0x12, 0xf8, 0x77);
+	CHECK(stub_paramValues[0x0f] == 0x55 && stub_paramValues[0x10] == 0x66 && stub_paramValues[0x11] == 0x77,
+			"cc values not queued");
+	CHECK(midiParser_originalCcValues[0x10] == 0x55 && midiParser_originalCcValues[0x12] == 0x77,
+			"original cc values not stored");
+	CHECK(stub_frontOutCnt == 9 && stub_frontOut[0] == MIDI_CC && stub_frontOut[1] == 0x10 && stub_frontOut[2] == 0x55,
+			"cc not forwarded to the front");
+
+	//cc on a different channel
+	MIDI(0xb0, 0x10, 0x22);
+	CHECK(stub_paramValues[0x0f] == 0x55 && stub_paramCnt == 3, "cc on another channel applied");
+
+	//nrpn to a cc2 parameter
+	MIDI(cc, NRPN_COARSE, 0x00, NRPN_FINE, 0x05, NRPN_DATA_ENTRY_COARSE, 0x33);
+	CHECK(stub_paramValues[5+1+127] == 0x33 && midiParser_originalCcValues[5+1+127] == 0x33, "nrpn value not queued");
+
+	//nrpn mute of track 3, its notes are not played
+	MIDI(cc, NRPN_COARSE, CC2_MUTE_3>>7, NRPN_FINE, CC2_MUTE_3&0x7f, NRPN_DATA_ENTRY_COARSE, 0x01);
+	CHECK(stub_muted[2] == 1, "nrpn mute not applied");
+	MIDI(0x92, 0x30, 0x40, 0x91, 0x30, 0x40);
+	CHECK(stub_noteCnt == 1 && test_note(0, 1, 0x30, 0x40), "muted track played");
+
+	//notes on the global channel are played and recorded on the active track
+	frontParser_activeTrack = 4;
+	MIDI(0x90 | GLOBAL_CHANNEL, 0x24, 0x64);
+	CHECK(test_note(1, 4, 0x24, 0x64) && stub_recordedNoteCnt == 1, "global channel note not played on the active track");
+}
+//------------------------------------------------------------------------------
+static void test_frontMessages()
+{
+	test_setup();
+
+	//front parameter numbers are one below the midi cc numbers
+	FRONT(MIDI_CC, 0x0f, 0x40);
+	CHECK(stub_paramValues[0x0f] == 0x40 && midiParser_originalCcValues[0x10] == 0x40, "front cc not applied");
+	FRONT(FRONT_CC_2, 0x05, 0x22);
+	CHECK(stub_paramValues[5+1+127] == 0x22, "front cc2 not applied");
+
+	FRONT(FRONT_SEQ_CC, FRONT_SEQ_RUN_STOP, 0x01);
+	CHECK(stub_running == 1, "front run not applied");
+	FRONT(FRONT_SEQ_CC, FRONT_SEQ_RUN_STOP, 0x00);
+	CHECK(stub_running == 0, "front stop not applied");
+
+	FRONT(FRONT_SEQ_CC, FRONT_SEQ_SET_PAT_NEXT, 0x03);
+	CHECK(seq_patterns[0]->seq_patternSettings.nextPattern == 3, "front next pattern not applied");
+	seq_patterns[0]->seq_patternSettings.nextPattern = 0;
+}
+//------------------------------------------------------------------------------
+static void test_frontRequests()
+{
+	test_setup();
+
+	seq_patterns[3]->seq_patternSettings.nextPattern = 5;
+	seq_patterns[3]->seq_patternSettings.changeBar = 2;
+	FRONT(SYSEX_START, SYSEX_REQUEST_PATTERN_DATA, 3, 0x7f, NUM_PATTERN, SYSEX_END);
+	CHECK(stub_frontSysexCnt == 3, "pattern request: %u sysex bytes instead of 3", (unsigned)stub_frontSysexCnt);
+	CHECK(stub_frontSysex[0] == SYSEX_START && stub_frontSysex[1] == 5 && stub_frontSysex[2] == 2,
+			"pattern request: wrong answer");
+	seq_patterns[3]->seq_patternSettings.nextPattern = 0;
+	seq_patterns[3]->seq_patternSettings.changeBar = 0;
+
+	FRONT(SYSEX_START, SYSEX_REQUEST_MAIN_STEP_DATA, 0x00, 0x05, 0x7f, 0x7f, 0x00, NUM_TRACKS*NUM_PATTERN-1,
+			0x00, NUM_TRACKS*NUM_PATTERN, SYSEX_END);
+	CHECK(stub_mainStepReqCnt == 2 && stub_lastMainStepReq == NUM_TRACKS*NUM_PATTERN-1,
+			"main step request: %u answers, last %u", (unsigned)stub_mainStepReqCnt, stub_lastMainStepReq);
+
+	const uint16_t lastStep = NUM_STEPS*NUM_TRACKS*NUM_PATTERN-1;
+	FRONT(SYSEX_START, SYSEX_REQUEST_STEP_DATA, lastStep>>7, lastStep&0x7f, (lastStep+1)>>7, (lastStep+1)&0x7f,
+			0x7f, 0x7f, SYSEX_END);
+	CHECK(stub_stepReqCnt == 1 && stub_lastStepReq == lastStep,
+			"step request: %u answers, last %u", (unsigned)stub_stepReqCnt, stub_lastStepReq);
+
+	FRONT(SYSEX_START, SYSEX_REQUEST_LOCK_DATA, NUM_TRACKS*NUM_PATTERN-1, 0x00, 0x01,
+			NUM_TRACKS*NUM_PATTERN, 0x00, 0x00, 0x7f, 0x00, 0x00, SYSEX_END);
+	CHECK(stub_lockReqCnt == 1 && stub_lastLockReqTrack == NUM_TRACKS*NUM_PATTERN-1,
+			"lock request: %u answers", (unsigned)stub_lockReqCnt);
+}
+//------------------------------------------------------------------------------
+static uint16_t test_mainSteps(uint8_t idx)
+{
+	return (uint16_t)(idx*0x2f1 + 0x8001);
+}
+//------------------------------------------------------------------------------
+static void test_stepRecord(uint16_t stepNr, Step* s)
+{
+	const uint8_t step = stepNr & (NUM_STEPS-1);
+	memset(s, 0, sizeof(Step));
+	s->prob = 127;
+	s->note = SEQ_DEFAULT_NOTE;
+	if(step == 0 || step == NUM_STEPS-1) {
+		s->volume = (uint8_t)(0x80 | (stepNr&0x7f));
+		s->prob = 100;
+		s->note = (uint8_t)(stepNr>>7);
+		s->param1Nr = 0x80 | 3;
+		s->param1Val = (uint8_t)stepNr;
+		s->param2Nr = 7;
+		s->param2Val = 0xff;
+	}
+}
+//------------------------------------------------------------------------------
+static void front_sendStepRecord(const Step* s)
+{
+	const uint8_t* b = (const uint8_t*)s;
+	uint8_t msb = 0;
+	uint8_t i;
+	for(i=0;i<7;i++) {
+		frontParser_parseUartData(b[i] & 0x7f);
+		msb |= (uint8_t)((b[i]>>7)<<i);
+	}
+	frontParser_parseUartData(msb);
+}
+//------------------------------------------------------------------------------
+// 1 if step data of the transfer record stepNr is stored in the pattern
+static int test_stepStored(uint16_t stepNr)
+{
+	const uint8_t absPat = stepNr / NUM_STEPS;
+	const uint8_t track = absPat / NUM_PATTERN;
+	const uint8_t step = stepNr & (NUM_STEPS-1);
+	const Pattern* p = seq_patterns[absPat % NUM_PATTERN];
+	const Step* s = pattern_getStep(p, track, step);
+	Step expected;
+	test_stepRecord(stepNr, &expected);
+	return pattern_isStepActive(p, track, step) == (expected.volume>>7) &&
+			s->volume == (expected.volume&STEP_VOLUME_MASK) && s->note == expected.note &&
+			s->param1Nr == expected.param1Nr && s->param1Val == expected.param1Val &&
+			s->param2Val == expected.param2Val;
+}
+//------------------------------------------------------------------------------
+static void test_frontTransfers()
+{
+	uint16_t i;
+	uint8_t pat, track;
+
+	test_setup();
+
+	//main steps of all tracks, then more records than tracks
+	FRONT(SYSEX_START, SYSEX_RECEIVE_MAIN_STEP_DATA);
+	for(i=0;i<NUM_TRACKS*NUM_PATTERN+2;i++) {
+		const uint16_t v = i < NUM_TRACKS*NUM_PATTERN ? test_mainSteps((uint8_t)i) : 0x1234;
+		FRONT(v&0x7f, (v>>7)&0x7f, (v>>14)&0x03);
+	}
+	FRONT(SYSEX_END);
+	for(i=0;i<NUM_TRACKS*NUM_PATTERN;i++) {
+		CHECK(seq_patterns[i/7]->seq_mainSteps[i%7] == test_mainSteps((uint8_t)i), "main steps of track %u wrong", i);
+	}
+
+	//pattern lengths while running, the playing pattern goes to the spare slot
+	stub_running = 1;
+	seq_activePattern = 0;
+	FRONT(SYSEX_START, SYSEX_RECEIVE_PAT_LEN_DATA);
+	for(i=0;i<NUM_TRACKS*NUM_PATTERN+3;i++) {
+		FRONT(i < NUM_TRACKS*NUM_PATTERN ? i%15+1 : 0x7f);
+	}
+	FRONT(SYSEX_END);
+	for(i=0;i<NUM_TRACKS*NUM_PATTERN;i++) {
+		const Pattern* p = i < 7 ? seq_tmpPattern : seq_patterns[i/7];
+		CHECK(p->seq_patternLengthRotate[i%7].length == i%15+1, "length of track %u wrong", i);
+	}
+	CHECK(seq_patterns[0]->seq_patternLengthRotate[0].length == 0, "playing pattern overwritten");
+	CHECK(seq_newPatternAvailable == 1, "new pattern not signalled after the lengths");
+	stub_running = 0;
+	seq_newPatternAvailable = 0;
+
+	//step data of all tracks in track, pattern, step order, then more records than steps
+	FRONT(SYSEX_START, SYSEX_RECEIVE_STEP_DATA);
+	for(i=0;i<NUM_STEPS*NUM_TRACKS*NUM_PATTERN;i++) {
+		Step s;
+		test_stepRecord(i, &s);
+		front_sendStepRecord(&s);
+	}
+	for(i=0;i<3;i++) {
+		Step s;
+		memset(&s, 0x5a, sizeof(s));
+		front_sendStepRecord(&s);
+	}
+	FRONT(SYSEX_END);
+	//every main step has data, more than the pool holds. the tracks sent first are stored,
+	//the rest keeps the active flags and plays default data
+	for(track=0;track<NUM_TRACKS;track++) {
+		for(pat=0;pat<NUM_PATTERN;pat++) {
+			const uint16_t first = (uint16_t)((track*NUM_PATTERN + pat)*NUM_STEPS);
+			const uint16_t steps[2] = {first, (uint16_t)(first+NUM_STEPS-1)};
+			for(i=0;i<2;i++) {
+				const uint8_t step = steps[i] & (NUM_STEPS-1);
+				if(track < TEST_STORED_TRACKS)
+					CHECK(test_stepStored(steps[i]), "step %u of pattern %u track %u wrong", step, pat, track);
+				else
+					CHECK(pattern_isStepActive(seq_patterns[pat], track, step), "step %u of pattern %u track %u lost", step, pat, track);
+			}
+			CHECK(!pattern_isStepActive(seq_patterns[pat], track, 1), "inactive step %u/%u set", pat, track);
+		}
+	}
+	CHECK(pattern_poolFull == PATTERN_FULL_STEPS, "full step pool not reported");
+
+	//one lock on every second track, then locks for a track that does not exist
+	FRONT(SYSEX_START, SYSEX_RECEIVE_LOCK_DATA);
+	for(i=0;i<NUM_TRACKS*NUM_PATTERN+1;i++) {
+		if(i%2 == 0)
+			FRONT(i%7*3, i/7, i&0x7f, 0x03);
+		FRONT(0x00, 0x00, 0x00, 0x04);
+	}
+	FRONT(SYSEX_END);
+	for(i=0;i<NUM_TRACKS*NUM_PATTERN;i++) {
+		uint8_t step, dest, value;
+		const uint8_t found = pattern_getLockAt(seq_patterns[i/7], i%7, 0, &step, &dest, &value);
+		if(i%2 == 0)
+			CHECK(found && step == i%7*3 && dest == (0x80|(i/7)) && value == (0x80|i) &&
+					!pattern_getLockAt(seq_patterns[i/7], i%7, 1, &step, &dest, &value),
+					"lock of track %u wrong", i);
+		else
+			CHECK(!found, "lock on track %u without locks", i);
+	}
+}
+//------------------------------------------------------------------------------
+static void test_fuzz()
+{
+	uint32_t i;
+	uint8_t mode;
+
+	//random bytes through the midi parser, then it has to recover on the next status byte
+	test_setup();
+	midiParser_setRouting(5);
+	for(i=0;i<FUZZ_BYTES;i++) {
+		midiParser_parseUartData((uint8_t)bench_random());
+	}
+	midiParser_setRouting(0);
+	memset(stub_muted, 0, sizeof(stub_muted));
+	stub_reset();
+	MIDI(0x90, 0x24, 0x64);
+	CHECK(stub_noteCnt == 1 && test_note(0, 0, 0x24, 0x64), "midi parser did not recover from random data");
+
+	//random data in every front sysex mode, the pattern slots have to stay in place
+	Pattern* const slots[NUM_PATTERN] = {seq_patterns[0], seq_patterns[1], seq_patterns[2], seq_patterns[3],
+			seq_patterns[4], seq_patterns[5], seq_patterns[6], seq_patterns[7]};
+	for(mode=SYSEX_REQUEST_STEP_DATA;mode<=SYSEX_RECEIVE_LOCK_DATA;mode++) {
+		FRONT(SYSEX_START, mode);
+		for(i=0;i<FUZZ_SYSEX_BYTES;i++) {
+			frontParser_parseUartData((uint8_t)(bench_random() & 0x7f));
+		}
+		FRONT(SYSEX_END);
+	}
+	CHECK(memcmp(slots, seq_patterns, sizeof(slots)) == 0, "front sysex data moved the pattern slots");
+	stub_reset();
+	FRONT(FRONT_SEQ_CC, FRONT_SEQ_RUN_STOP, 0x01);
+	CHECK(stub_running == 1, "front parser did not recover from random sysex data");
+	stub_running = 0;
+}
+//------------------------------------------------------------------------------
+/** random notes and ccs with running status and clocks, returns the number of messages*/
+static uint32_t bench_buildMidi(uint32_t* notes, uint32_t* clocks)
+{
+	uint32_t len = 0;
+	uint32_t messages = 0;
+	uint8_t lastStatus = 0;
+	*notes = *clocks = 0;
+
+	while(len < BENCH_MIDI_BYTES - 8) {
+		const uint32_t r = bench_random();
+		uint8_t status, d1, d2;
+		switch(r%8) {
+		case 0:
+		case 1:
+			bench_midi[len++] = 0xf8;
+			(*clocks)++;
+			messages++;
+			continue;
+		case 2:
+			//sound parameters only, the nrpn ccs would mute tracks
+			status = (uint8_t)(0xb0 | GLOBAL_CHANNEL);
+			d1 = (uint8_t)(16 + (r>>3)%80);
+			break;
+		default:
+			//mostly one channel so running status is used
+			status = (uint8_t)(0x90 | ((r>>3)%4 ? 0 : (r>>5)%7));
+			d1 = (uint8_t)((r>>8) & 0x7f);
+			break;
+		}
+		d2 = (uint8_t)((r>>16) & 0x7f);
+		if(status != lastStatus)
+			bench_midi[len++] = status;
+		lastStatus = status;
+		bench_midi[len++] = d1;
+		if(bench_random()%4 == 0) {
+			bench_midi[len++] = 0xf8;
+			(*clocks)++;
+			messages++;
+		}
+		bench_midi[len++] = d2;
+		messages++;
+		if((status&0xf0) == 0x90 && d2)
+			(*notes)++;
+	}
+	bench_midiLen = len;
+	return messages;
+}
+//------------------------------------------------------------------------------
+static void bench_midiParser()
+{
+	uint32_t notes, clocks, i;
+	double t;
+
+	test_setup();
+	const uint32_t messages = bench_buildMidi(&notes, &clocks);
+	t = bench_seconds();
+	midi_stream(bench_midi, bench_midiLen);
+	t = bench_seconds() - t;
+	bench_report("midi generated", messages, bench_midiLen, t);
+	CHECK(stub_noteCnt == notes && stub_syncCnt == clocks, "generated midi: %u/%u notes, %u/%u clocks",
+			(unsigned)stub_noteCnt, (unsigned)notes, (unsigned)stub_syncCnt, (unsigned)clocks);
+
+	test_setup();
+	t = bench_seconds();
+	for(i=0;i<BENCH_DAW_REPEATS;i++) {
+		midi_stream(bench_dawBeat, sizeof(bench_dawBeat));
+	}
+	t = bench_seconds() - t;
+	bench_report("midi sequencer beat", BENCH_DAW_MESSAGES*BENCH_DAW_REPEATS, sizeof(bench_dawBeat)*BENCH_DAW_REPEATS, t);
+	CHECK(stub_noteCnt == BENCH_DAW_NOTES*BENCH_DAW_REPEATS && stub_recordedNoteCnt == BENCH_DAW_RECORDED*BENCH_DAW_REPEATS,
+			"sequencer beat: %u notes, %u recorded", (unsigned)stub_noteCnt, (unsigned)stub_recordedNoteCnt);
+	CHECK(stub_syncCnt == BENCH_DAW_CLOCKS*BENCH_DAW_REPEATS && stub_startCnt == BENCH_DAW_REPEATS &&
+			stub_stopCnt == BENCH_DAW_REPEATS, "sequencer beat: %u clocks", (unsigned)stub_syncCnt);
+	CHECK(stub_paramValues[0x0f] == 0x30 && stub_paramCnt == 3*BENCH_DAW_REPEATS, "sequencer beat: cc ramp wrong");
+}
+//------------------------------------------------------------------------------
+static void bench_frontParser()
+{
+	uint32_t i, n;
+	double t;
+
+	test_setup();
+	for(i=0;i<BENCH_FRONT_CC;i++) {
+		const uint32_t r = bench_random();
+		bench_front[i*3]	= MIDI_CC;
+		bench_front[i*3+1]	= (uint8_t)(15 + r%80);
+		bench_front[i*3+2]	= (uint8_t)((r>>8) & 0x7f);
+	}
+	t = bench_seconds();
+	front_stream(bench_front, sizeof(bench_front));
+	t = bench_seconds() - t;
+	bench_report("front cc", BENCH_FRONT_CC, sizeof(bench_front), t);
+	CHECK(stub_paramCnt == BENCH_FRONT_CC, "front cc: %u parameters", (unsigned)stub_paramCnt);
+
+	//full step data transfers, one message per step
+	t = bench_seconds();
+	for(n=0;n<BENCH_STEP_TRANSFERS;n++) {
+		FRONT(SYSEX_START, SYSEX_RECEIVE_STEP_DATA);
+		for(i=0;i<NUM_STEPS*NUM_TRACKS*NUM_PATTERN;i++) {
+			Step s;
+			test_stepRecord((uint16_t)i, &s);
+			front_sendStepRecord(&s);
+		}
+		FRONT(SYSEX_END);
+	}
+	t = bench_seconds() - t;
+	bench_report("front step transfer", NUM_STEPS*NUM_TRACKS*NUM_PATTERN*BENCH_STEP_TRANSFERS,
+			(NUM_STEPS*NUM_TRACKS*NUM_PATTERN*8+3)*BENCH_STEP_TRANSFERS, t);
+	//a leak would leave less memory for the last track that fits
+	CHECK(test_stepStored(TEST_STORED_TRACKS*NUM_PATTERN*NUM_STEPS-1), "repeated step transfers leaked pool memory");
+}
+//------------------------------------------------------------------------------
+int main()
+{
+	stub_init();
+
+	test_runningStatus();
+	test_realtime();
+	test_strayEnd();
+	test_systemCommon();
+	test_sysex();
+	test_statusByte();
+	test_parameters();
+	test_frontMessages();
+	test_frontRequests();
+	test_frontTransfers();
+	test_fuzz();
+
+	bench_midiParser();
+	bench_frontParser();
+
+	return test_report();
+}
@@ -0,0 +1,422 @@
+// halStubs.c : host replacements for the firmware parts the midi and front panel parsers talk to.
+// the voices, sequencer and uarts only record what the parsers asked them to do,
+// the patterns are plain slots handled by the real pattern.c.
+//
+
+#include <string.h>
+
+#include "halStubs.h"
+#include "globals.h"
+#include "MidiParser.h"
+#include "MidiVoiceControl.h"
+#include "ParameterArray.h"
+#include "sequencer.h"
+#include "clockSync.h"
+#include "EuklidGenerator.h"
+#include "SomGenerator.h"
+#include "TriggerOut.h"
+#include "groove.h"
+#include "Uart.h"
+#include "usb_manager.h"
+#include "DrumVoice.h"
+#include "Snare.h"
+#include "HiHat.h"
+#include "CymbalVoice.h"
+#include "SampleMemory.h"
+
+volatile uint32_t systick_ticks;
+
+DrumVoice voiceArray[NUM_VOICES];
+SnareVoice snareVoice;
+HiHatVoice hatVoice;
+CymbalVoice cymbalVoice;
+ModulationNode velocityModulators[NUM_SYNTH_VOICES];
+
+uint8_t trigger_dividerClockOut1;
+uint8_t trigger_dividerClockOut2;
+uint8_t trigger_prescalerClockInput;
+
+static Pattern stub_patternSlots[NUM_PATTERN];
+static Pattern stub_tmpSlot;
+Pattern* seq_patterns[NUM_PATTERN];
+Pattern* seq_tmpPattern;
+uint8_t seq_activePattern;
+uint8_t seq_newPatternAvailable;
+uint8_t seq_selectedStep;
+uint8_t seq_resetBarOnPatternChange;
+
+StubNote stub_notes[STUB_MAX_NOTES];
+uint32_t stub_noteCnt;
+uint32_t stub_recordedNoteCnt;
+uint32_t stub_syncCnt;
+uint32_t stub_lastSyncArrival;
+uint32_t stub_startCnt;
+uint32_t stub_stopCnt;
+uint8_t stub_paramValues[STUB_NUM_PARAMS];
+uint32_t stub_paramCnt;
+MidiMsg stub_routed[STUB_MAX_ROUTED];
+uint32_t stub_routedCnt;
+uint8_t stub_frontOut[STUB_FRONT_BUFFER];
+uint32_t stub_frontOutCnt;
+uint8_t stub_frontSysex[STUB_FRONT_BUFFER];
+uint32_t stub_frontSysexCnt;
+uint32_t stub_mainStepReqCnt;
+uint16_t stub_lastMainStepReq;
+uint32_t stub_stepReqCnt;
+uint16_t stub_lastStepReq;
+uint32_t stub_lockReqCnt;
+uint8_t stub_lastLockReqTrack;
+uint8_t stub_nextPattern;
+uint8_t stub_muted[NUM_TRACKS];
+uint8_t stub_running;
+uint8_t stub_extSync;
+//------------------------------------------------------------------------------
+void stub_init()
+{
+	uint8_t i;
+	memset(stub_patternSlots, 0, sizeof(stub_patternSlots));
+	memset(&stub_tmpSlot, 0, sizeof(stub_tmpSlot));
+	for(i=0;i<NUM_PATTERN;i++) {
+		seq_patterns[i] = &stub_patternSlots[i];
+	}
+	seq_tmpPattern = &stub_tmpSlot;
+	seq_activePattern = 0;
+	seq_newPatternAvailable = 0;
+	stub_reset();
+}
+//------------------------------------------------------------------------------
+void stub_reset()
+{
+	stub_noteCnt = stub_recordedNoteCnt = 0;
+	stub_syncCnt = stub_lastSyncArrival = 0;
+	stub_startCnt = stub_stopCnt = 0;
+	memset(stub_paramValues, 0, sizeof(stub_paramValues));
+	stub_paramCnt = 0;
+	stub_routedCnt = 0;
+	stub_frontOutCnt = stub_frontSysexCnt = 0;
+	stub_mainStepReqCnt = stub_stepReqCnt = stub_lockReqCnt = 0;
+	stub_lastMainStepReq = stub_lastStepReq = 0;
+	stub_lastLockReqTrack = 0;
+	stub_nextPattern = 0xff;
+	memset(stub_muted, 0, sizeof(stub_muted));
+	stub_running = 0;
+	stub_extSync = 1;
+}
+//------------------------------------------------------------------------------
+// voices and parameters
+//------------------------------------------------------------------------------
+void voiceControl_noteOnAt(uint8_t voice, uint8_t note, uint8_t vel, uint32_t samplePos)
+{
+	if(stub_noteCnt < STUB_MAX_NOTES) {
+		stub_notes[stub_noteCnt].voice = voice;
+		stub_notes[stub_noteCnt].note = note;
+		stub_notes[stub_noteCnt].vel = vel;
+		stub_notes[stub_noteCnt].samplePos = samplePos;
+	}
+	stub_noteCnt++;
+}
+//------------------------------------------------------------------------------
+void voiceControl_noteOff(uint8_t voice)
+{
+}
+//------------------------------------------------------------------------------
+void paramArray_queueValue(uint16_t idx, uint8_t value)
+{
+	if(idx < STUB_NUM_PARAMS)
+		stub_paramValues[idx] = value;
+	stub_paramCnt++;
+}
+//------------------------------------------------------------------------------
+void modNode_setDestination(ModulationNode* vm, uint16_t dest)
+{
+}
+//------------------------------------------------------------------------------
+void som_setFlux(uint8_t flux)
+{
+}
+//------------------------------------------------------------------------------
+void som_setFreq(uint8_t freq, uint8_t voice)
+{
+}
+//------------------------------------------------------------------------------
+void som_setX(uint8_t x)
+{
+}
+//------------------------------------------------------------------------------
+void som_setY(uint8_t y)
+{
+}
+//------------------------------------------------------------------------------
+void trigger_setGatemode(uint8_t onOff)
+{
+}
+//------------------------------------------------------------------------------
+void sampleMemory_init()
+{
+}
+//------------------------------------------------------------------------------
+void sampleMemory_loadSamples()
+{
+}
+//------------------------------------------------------------------------------
+uint8_t sampleMemory_getNumSamples()
+{
+	return 0;
+}
+//------------------------------------------------------------------------------
+void FLASH_Lock(void)
+{
+}
+//------------------------------------------------------------------------------
+// uarts and usb
+//------------------------------------------------------------------------------
+void uart_sendMidi(MidiMsg msg)
+{
+	if(stub_routedCnt < STUB_MAX_ROUTED)
+		stub_routed[stub_routedCnt] = msg;
+	stub_routedCnt++;
+}
+//------------------------------------------------------------------------------
+void usb_sendMidi(MidiMsg msg)
+{
+}
+//------------------------------------------------------------------------------
+void uart_sendFrontpanelByte(uint8_t data)
+{
+	if(stub_frontOutCnt < STUB_FRONT_BUFFER)
+		stub_frontOut[stub_frontOutCnt] = data;
+	stub_frontOutCnt++;
+}
+//------------------------------------------------------------------------------
+void uart_sendFrontpanelSysExByte(uint8_t data)
+{
+	if(stub_frontSysexCnt < STUB_FRONT_BUFFER)
+		stub_frontSysex[stub_frontSysexCnt] = data;
+	stub_frontSysexCnt++;
+}
+//------------------------------------------------------------------------------
+void uart_clearFrontFifo()
+{
+}
+//------------------------------------------------------------------------------
+// sequencer
+//------------------------------------------------------------------------------
+void seq_sync(uint32_t arrival)
+{
+	stub_syncCnt++;
+	stub_lastSyncArrival = arrival;
+}
+//------------------------------------------------------------------------------
+void sync_midiStartStop(uint8_t isStart)
+{
+	if(isStart)
+		stub_startCnt++;
+	else
+		stub_stopCnt++;
+}
+//------------------------------------------------------------------------------
+uint8_t seq_getExtSync()
+{
+	return stub_extSync;
+}
+//------------------------------------------------------------------------------
+void seq_setExtSync(uint8_t isExt)
+{
+	stub_extSync = isExt;
+}
+//------------------------------------------------------------------------------
+uint8_t seq_isRunning()
+{
+	return stub_running;
+}
+//------------------------------------------------------------------------------
+void seq_setRunning(uint8_t isRunning)
+{
+	stub_running = isRunning;
+}
+//------------------------------------------------------------------------------
+uint8_t seq_isTrackMuted(uint8_t trackNr)
+{
+	return stub_muted[trackNr];
+}
+//------------------------------------------------------------------------------
+void seq_setMute(uint8_t trackNr, uint8_t isMuted)
+{
+	if(trackNr < NUM_TRACKS)
+		stub_muted[trackNr] = isMuted;
+}
+//------------------------------------------------------------------------------
+void seq_setNextPattern(const uint8_t patNr)
+{
+	stub_nextPattern = patNr;
+}
+//------------------------------------------------------------------------------
+void seq_setNextBankPattern(const uint8_t nr)
+{
+	stub_nextPattern = nr;
+}
+//------------------------------------------------------------------------------
+void seq_addNoteAt(uint8_t trackNr,uint8_t vel, uint8_t note, uint32_t samplePos)
+{
+	stub_recordedNoteCnt++;
+}
+//------------------------------------------------------------------------------
+void seq_midiNoteOff(uint8_t chan)
+{
+}
+//------------------------------------------------------------------------------
+void seq_sendMidiNoteOn(const uint8_t channel, const uint8_t note, const uint8_t veloc)
+{
+}
+//------------------------------------------------------------------------------
+void seq_recordAutomation(uint8_t voice, uint8_t dest, uint8_t value)
+{
+}
+//------------------------------------------------------------------------------
+void seq_sendMainStepInfoToFront(uint16_t stepNr)
+{
+	stub_mainStepReqCnt++;
+	stub_lastMainStepReq = stepNr;
+}
+//------------------------------------------------------------------------------
+void seq_sendStepInfoToFront(uint16_t stepNr)
+{
+	stub_stepReqCnt++;
+	stub_lastStepReq = stepNr;
+}
+//------------------------------------------------------------------------------
+void seq_sendLockInfoToFront(uint8_t trackNr, uint16_t lockNr)
+{
+	stub_lockReqCnt++;
+	stub_lastLockReqTrack = trackNr;
+}
+//------------------------------------------------------------------------------
+void seq_flushLookahead()
+{
+}
+//------------------------------------------------------------------------------
+void seq_setBpm(uint16_t bpm)
+{
+}
+//------------------------------------------------------------------------------
+void seq_setShuffle(float shuffle)
+{
+}
+//------------------------------------------------------------------------------
+void seq_setQuantisation(uint8_t value)
+{
+}
+//------------------------------------------------------------------------------
+void seq_setRecordingMode(uint8_t active)
+{
+}
+//------------------------------------------------------------------------------
+void seq_setErasingMode(uint8_t active)
+{
+}
+//------------------------------------------------------------------------------
+void seq_setRoll(uint8_t voice, uint8_t onOff)
+{
+}
+//------------------------------------------------------------------------------
+void seq_setRollRate(uint8_t rate)
+{
+}
+//------------------------------------------------------------------------------
+void seq_setActiveAutomationTrack(uint8_t trackNr)
+{
+}
+//------------------------------------------------------------------------------
+void seq_armAutomationStep(uint8_t stepNr, uint8_t track,uint8_t isArmed)
+{
+}
+//------------------------------------------------------------------------------
+void seq_clearAutomation(uint8_t trackNr, uint8_t pattern, uint8_t automTrack)
+{
+}
+//------------------------------------------------------------------------------
+void seq_clearPattern(uint8_t pattern)
+{
+}
+//------------------------------------------------------------------------------
+void seq_clearTrack(uint8_t trackNr, uint8_t pattern)
+{
+}
+//------------------------------------------------------------------------------
+void seq_copyPattern(uint8_t src, uint8_t dst)
+{
+}
+//------------------------------------------------------------------------------
+void seq_copyTrack(uint8_t srcNr, uint8_t dstNr, uint8_t pattern)
+{
+}
+//------------------------------------------------------------------------------
+void seq_toggleStep(uint8_t voice, uint8_t stepNr, uint8_t patternNr)
+{
+}
+//------------------------------------------------------------------------------
+void seq_toggleMainStep(uint8_t voice, uint8_t stepNr, uint8_t patternNr)
+{
+}
+//------------------------------------------------------------------------------
+uint8_t seq_isStepActive(uint8_t voice, uint8_t stepNr, uint8_t patternNr)
+{
+	return 0;
+}
+//------------------------------------------------------------------------------
+uint8_t seq_isMainStepActive(uint8_t voice, uint8_t mainStepNr, uint8_t pattern)
+{
+	return 0;
+}
+//------------------------------------------------------------------------------
+void seq_setTrackLength(uint8_t trackNr, uint8_t length)
+{
+}
+//------------------------------------------------------------------------------
+uint8_t seq_getTrackLength(uint8_t trackNr)
+{
+	return NUM_STEPS;
+}
+//------------------------------------------------------------------------------
+void seq_setTrackRotation(uint8_t trackNr, const uint8_t rot)
+{
+}
+//------------------------------------------------------------------------------
+uint8_t seq_getTrackRotation(uint8_t trackNr)
+{
+	return 0;
+}
+//------------------------------------------------------------------------------
+void euklid_setLength(uint8_t trackNr, uint8_t value)
+{
+}
+//------------------------------------------------------------------------------
+uint8_t euklid_setSteps(uint8_t trackNr, uint8_t value, uint8_t patternNr)
+{
+	return 0;
+}
+//------------------------------------------------------------------------------
+uint8_t euklid_setRotation(uint8_t trackNr, uint8_t value, uint8_t patternNr)
+{
+	return 0;
+}
+//------------------------------------------------------------------------------
+uint8_t euklid_getLength(uint8_t trackNr)
+{
+	return 16;
+}
+//------------------------------------------------------------------------------
+uint8_t euklid_getSteps(uint8_t trackNr)
+{
+	return 0;
+}
+//------------------------------------------------------------------------------
+uint8_t euklid_getRotation(uint8_t trackNr)
+{
+	return 0;
+}
+//------------------------------------------------------------------------------
+uint8_t groove_select(uint8_t grooveNr)
+{
+	return grooveNr;
+}
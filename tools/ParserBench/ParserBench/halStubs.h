@@ -0,0 +1,62 @@
+// halStubs.h : recorded side effects of the host stubs used by the parser bench
+//
+
+#ifndef HALSTUBS_H_
+#define HALSTUBS_H_
+
+#include <stdint.h>
+
+#include "MidiMessages.h"
+#include "pattern.h"
+
+#define STUB_MAX_NOTES		64
+#define STUB_MAX_ROUTED		64
+#define STUB_FRONT_BUFFER	256
+#define STUB_NUM_PARAMS		0x200
+
+typedef struct
+{
+	uint8_t		voice;
+	uint8_t		note;
+	uint8_t		vel;
+	uint32_t	samplePos;
+} StubNote;
+
+extern StubNote stub_notes[STUB_MAX_NOTES];			/**< the first triggered notes*/
+extern uint32_t stub_noteCnt;
+extern uint32_t stub_recordedNoteCnt;				/**< notes handed to the sequencer recording*/
+
+extern uint32_t stub_syncCnt;
+extern uint32_t stub_lastSyncArrival;
+extern uint32_t stub_startCnt;
+extern uint32_t stub_stopCnt;
+
+extern uint8_t stub_paramValues[STUB_NUM_PARAMS];	/**< last value queued for each sound parameter*/
+extern uint32_t stub_paramCnt;
+
+extern MidiMsg stub_routed[STUB_MAX_ROUTED];		/**< the first messages routed to the midi out*/
+extern uint32_t stub_routedCnt;
+
+extern uint8_t stub_frontOut[STUB_FRONT_BUFFER];	/**< the first bytes sent to the front panel*/
+extern uint32_t stub_frontOutCnt;
+extern uint8_t stub_frontSysex[STUB_FRONT_BUFFER];	/**< the first sysex bytes sent to the front panel*/
+extern uint32_t stub_frontSysexCnt;
+
+extern uint32_t stub_mainStepReqCnt;
+extern uint16_t stub_lastMainStepReq;
+extern uint32_t stub_stepReqCnt;
+extern uint16_t stub_lastStepReq;
+extern uint32_t stub_lockReqCnt;
+extern uint8_t stub_lastLockReqTrack;
+
+extern uint8_t stub_nextPattern;					/**< 0xff until a pattern change is requested, bank*8 + pattern for program changes*/
+extern uint8_t stub_muted[NUM_TRACKS];
+extern uint8_t stub_running;
+extern uint8_t stub_extSync;
+
+/** empty patterns, call once. the pattern pool is not released*/
+void stub_init();
+/** clear the recorded side effects, the patterns are kept*/
+void stub_reset();
+
+#endif /* HALSTUBS_H_ */
@@ -0,0 +1,395 @@
+// SysexLoopback.c : dump and restore loopback test of the sysex protocol, runs on the host.
+// fills kit, globals, pattern settings and tracks (step data and parameter locks),
+// requests a dump through SysexDump.c, wipes everything, feeds the dump back and
+// compares the restored state with the original. the restored kit and globals have to
+// reach the front. malformed track records must be rejected without touching the track.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hostTest.h"
+#include "halStubs.h"
+#include "SysexDump.h"
+#include "MidiParser.h"
+#include "ParameterArray.h"
+#include "sequencer.h"
+
+#define KIT_SIZE			(END_OF_SOUND_PARAMETERS < 0xff ? END_OF_SOUND_PARAMETERS : 0xff)
+#define MAX_TICKS			1000000
+
+typedef struct
+{
+	uint8_t		lengthRotate;
+	uint16_t	mainSteps;
+	uint32_t	activeSteps[NUM_STEPS/32];
+	Step		steps[NUM_STEPS];
+	uint16_t	lockCnt;
+	uint8_t		locks[PATTERN_LOCK_POOL][3];
+} TrackState;
+
+typedef struct
+{
+	uint8_t			kit[0xff];
+	uint8_t			channels[8];
+	uint8_t			filter;
+	uint16_t		bpm;
+	PatternSetting	settings[NUM_PATTERN];
+	TrackState		tracks[NUM_PATTERN][NUM_TRACKS];
+} DeviceState;
+
+static DeviceState test_original;
+static DeviceState test_restored;
+static uint8_t test_dump[STUB_USB_BUFFER];
+static uint32_t test_dumpLen;
+//------------------------------------------------------------------------------
+static void test_snapshot(DeviceState* s)
+{
+	uint8_t pat, track;
+	uint16_t i;
+
+	memset(s, 0, sizeof(DeviceState));
+	memcpy(s->kit, midiParser_originalCcValues, sizeof(s->kit));
+	memcpy(s->channels, midi_MidiChannels, sizeof(s->channels));
+	s->filter = midiParser_txRxFilter;
+	s->bpm = seq_getBpm();
+
+	for(pat=0;pat<NUM_PATTERN;pat++)
+	{
+		const Pattern* p = seq_patterns[pat];
+		s->settings[pat] = p->seq_patternSettings;
+		for(track=0;track<NUM_TRACKS;track++)
+		{
+			TrackState* t = &s->tracks[pat][track];
+			t->lengthRotate = p->seq_patternLengthRotate[track].value;
+			t->mainSteps = p->seq_mainSteps[track];
+			memcpy(t->activeSteps, p->seq_activeSteps[track], sizeof(t->activeSteps));
+			for(i=0;i<NUM_STEPS;i++) {
+				t->steps[i] = *pattern_getStep(p, track, (uint8_t)i);
+			}
+			while(t->lockCnt < PATTERN_LOCK_POOL &&
+					pattern_getLockAt(p, track, t->lockCnt, &t->locks[t->lockCnt][0], &t->locks[t->lockCnt][1], &t->locks[t->lockCnt][2])) {
+				t->lockCnt++;
+			}
+		}
+	}
+}
+//------------------------------------------------------------------------------
+static void test_compare(const DeviceState* a, const DeviceState* b, const char* when)
+{
+	uint8_t pat, track;
+	uint16_t i;
+
+	//index 0 is no sound parameter and not restored
+	for(i=1;i<KIT_SIZE;i++) {
+		CHECK(a->kit[i] == b->kit[i], "%s: kit parameter %u is %u, expected %u", when, i, b->kit[i], a->kit[i]);
+	}
+	CHECK(memcmp(a->channels, b->channels, sizeof(a->channels)) == 0, "%s: midi channels differ", when);
+	CHECK(a->filter == b->filter, "%s: midi filter is 0x%02x, expected 0x%02x", when, b->filter, a->filter);
+	CHECK(a->bpm == b->bpm, "%s: bpm is %u, expected %u", when, b->bpm, a->bpm);
+
+	for(pat=0;pat<NUM_PATTERN;pat++)
+	{
+		CHECK(a->settings[pat].changeBar == b->settings[pat].changeBar &&
+				a->settings[pat].nextPattern == b->settings[pat].nextPattern, "%s: settings of pattern %u differ", when, pat);
+
+		for(track=0;track<NUM_TRACKS;track++)
+		{
+			const TrackState* ta = &a->tracks[pat][track];
+			const TrackState* tb = &b->tracks[pat][track];
+			CHECK(ta->lengthRotate == tb->lengthRotate, "%s: length/rotate of pattern %u track %u differ", when, pat, track);
+			CHECK(ta->mainSteps == tb->mainSteps, "%s: main steps of pattern %u track %u differ", when, pat, track);
+			CHECK(memcmp(ta->activeSteps, tb->activeSteps, sizeof(ta->activeSteps)) == 0,
+					"%s: active steps of pattern %u track %u differ", when, pat, track);
+			for(i=0;i<NUM_STEPS;i++) {
+				if(memcmp(&ta->steps[i], &tb->steps[i], sizeof(Step)) != 0) {
+					CHECK(0, "%s: step %u of pattern %u track %u differs", when, i, pat, track);
+					break;
+				}
+			}
+			CHECK(ta->lockCnt == tb->lockCnt, "%s: pattern %u track %u has %u locks, expected %u", when, pat, track, tb->lockCnt, ta->lockCnt);
+			if(ta->lockCnt == tb->lockCnt) {
+				CHECK(memcmp(ta->locks, tb->locks, ta->lockCnt*3) == 0, "%s: locks of pattern %u track %u differ", when, pat, track);
+			}
+		}
+	}
+}
+//------------------------------------------------------------------------------
+static void test_fill()
+{
+	uint8_t pat, track;
+	uint16_t i;
+
+	srand(1);
+	//parameter 0 is no sound parameter, the restore leaves it alone
+	for(i=1;i<0xff;i++) {
+		midiParser_originalCcValues[i] = (uint8_t)(rand() & 0x7f);
+	}
+	for(i=0;i<8;i++) {
+		midi_MidiChannels[i] = (uint8_t)(rand() & 0x0f);
+	}
+	midiParser_txRxFilter = 0x5a;
+	seq_setBpm(133);
+
+	for(pat=0;pat<NUM_PATTERN;pat++)
+	{
+		Pattern* p = seq_patterns[pat];
+		p->seq_patternSettings.changeBar = (uint8_t)(rand() & 0x7f);
+		p->seq_patternSettings.nextPattern = (uint8_t)(rand() % 10);
+		for(track=0;track<NUM_TRACKS;track++)
+		{
+			p->seq_mainSteps[track] = (uint16_t)rand();
+			p->seq_patternLengthRotate[track].value = (uint8_t)rand();
+			for(i=0;i<NUM_STEPS;i++)
+			{
+				if(rand()%3 == 0)
+				{
+					const Step step = {(uint8_t)rand(), (uint8_t)(rand()&0x7f), (uint8_t)(rand()&0x7f),
+							(uint8_t)rand(), (uint8_t)rand(), (uint8_t)rand(), (uint8_t)rand()};
+					pattern_writeStep(p, track, (uint8_t)i, &step);
+				}
+				else if(rand()%4 == 0)
+				{
+					pattern_setStepActive(p, track, (uint8_t)i, 1);
+				}
+				if(rand()%20 == 0) {
+					pattern_setLock(p, track, (uint8_t)i, (uint8_t)rand(), (uint8_t)rand());
+				}
+			}
+		}
+	}
+}
+//------------------------------------------------------------------------------
+static void test_wipe()
+{
+	uint8_t pat, track;
+
+	memset(midiParser_originalCcValues, 0, sizeof(midiParser_originalCcValues));
+	memset(midi_MidiChannels, 0, sizeof(midi_MidiChannels));
+	midiParser_txRxFilter = 0;
+	seq_setBpm(1);
+	stub_clearFront();
+	for(pat=0;pat<NUM_PATTERN;pat++)
+	{
+		Pattern* p = seq_patterns[pat];
+		p->seq_patternSettings.changeBar = 0;
+		p->seq_patternSettings.nextPattern = 0;
+		for(track=0;track<NUM_TRACKS;track++)
+		{
+			pattern_resetSteps(p, track);
+			p->seq_mainSteps[track] = 0;
+			p->seq_patternLengthRotate[track].value = 0;
+		}
+	}
+}
+//------------------------------------------------------------------------------
+/** the front has to show what was restored*/
+static void test_compareFront(const DeviceState* s)
+{
+	uint16_t i;
+	for(i=1;i<KIT_SIZE;i++) {
+		//the nrpn controls are not sent
+		if(i == NRPN_DATA_ENTRY_COARSE || i == NRPN_FINE || i == NRPN_COARSE) continue;
+		CHECK(stub_frontKit[i] == s->kit[i], "front: kit parameter %u is %u, expected %u", i, stub_frontKit[i], s->kit[i]);
+	}
+	CHECK(memcmp(stub_frontChannels, s->channels, sizeof(s->channels)) == 0, "front: midi channels differ");
+	CHECK(stub_frontFilter == s->filter, "front: midi filter is 0x%02x, expected 0x%02x", stub_frontFilter, s->filter);
+	CHECK(stub_frontBpm == s->bpm, "front: bpm is %u, expected %u", stub_frontBpm, s->bpm);
+}
+//------------------------------------------------------------------------------
+/** feed bytes to the device and run it until everything is parsed and answered*/
+static void test_send(const uint8_t* data, const uint32_t len)
+{
+	uint32_t ticks = 0;
+	uint32_t lastOut;
+	uint32_t lastFront;
+
+	memcpy(stub_usbIn, data, len);
+	stub_usbInLen = len;
+	stub_usbInPos = 0;
+	stub_usbOutLen = 0;
+
+	//keep ticking until the input is consumed and the output stays quiet
+	do
+	{
+		lastOut = stub_usbOutLen;
+		lastFront = stub_frontMsgCnt;
+		uint16_t i;
+		for(i=0;i<64;i++) sysexDump_tick();
+		ticks += 64;
+	} while((stub_usbInPos < stub_usbInLen || stub_usbOutLen != lastOut || stub_frontMsgCnt != lastFront) && ticks < MAX_TICKS);
+}
+//------------------------------------------------------------------------------
+/** count the frames in a byte stream and the acks with a status other than ok*/
+static uint32_t test_countFrames(const uint8_t* data, const uint32_t len, const uint8_t cmd, uint32_t* badAcks)
+{
+	uint32_t i, frames = 0;
+	if(badAcks) *badAcks = 0;
+	for(i=0;i+3<len;i++)
+	{
+		if(data[i] != SYSEX_START || data[i+1] != LXR_SYSEX_ID || data[i+2] != LXR_SYSEX_DEVICE || data[i+3] != cmd) continue;
+		frames++;
+		//ack payload: msb byte, status
+		if(badAcks && cmd == LXR_SYSEX_ACK && data[i+5] != LXR_SYSEX_OK) (*badAcks)++;
+	}
+	return frames;
+}
+//------------------------------------------------------------------------------
+/** ack status of the single answer in the usb output*/
+static int test_lastAck()
+{
+	if(stub_usbOutLen < 6 || stub_usbOut[3] != LXR_SYSEX_ACK) return -1;
+	return stub_usbOut[5];
+}
+//------------------------------------------------------------------------------
+/** frame nr n of the dump (kit, globals, patterns, tracks...), unpacked into rec. returns the record length*/
+static uint16_t test_getRecord(const uint32_t n, uint8_t* rec)
+{
+	uint32_t i, frame = 0;
+	for(i=0;i<test_dumpLen;i++)
+	{
+		if(test_dump[i] != SYSEX_START) continue;
+		if(frame++ != n) continue;
+
+		uint32_t end = i;
+		while(test_dump[end] != SYSEX_END) end++;
+		//payload without checksum
+		const uint16_t packedLen = (uint16_t)(end - i - LXR_SYSEX_HEADER_SIZE - 1);
+		return lxrSysex_unpack(&test_dump[i+LXR_SYSEX_HEADER_SIZE], packedLen, rec);
+	}
+	return 0;
+}
+//------------------------------------------------------------------------------
+static uint32_t test_makeFrame(const uint8_t cmd, const uint8_t* payload, const uint16_t len, uint8_t* f)
+{
+	f[0] = SYSEX_START;
+	f[1] = LXR_SYSEX_ID;
+	f[2] = LXR_SYSEX_DEVICE;
+	f[3] = cmd;
+	const uint16_t n = lxrSysex_pack(payload, len, &f[LXR_SYSEX_HEADER_SIZE]);
+	uint8_t chk = cmd;
+	uint16_t i;
+	for(i=0;i<n;i++) {
+		chk ^= f[LXR_SYSEX_HEADER_SIZE+i];
+	}
+	f[LXR_SYSEX_HEADER_SIZE+n] = chk;
+	f[LXR_SYSEX_HEADER_SIZE+n+1] = SYSEX_END;
+	return LXR_SYSEX_HEADER_SIZE+n+2;
+}
+//------------------------------------------------------------------------------
+/** send a broken copy of a track record, it has to be rejected without changes*/
+static void test_malformedTrack(const char* name, const uint32_t frameNr, void (*corrupt)(uint8_t* rec, uint16_t* len))
+{
+	static uint8_t rec[LXR_SYSEX_MAX_RECORD+8];
+	static uint8_t frame[LXR_SYSEX_HEADER_SIZE + ((LXR_SYSEX_MAX_RECORD+14)/7)*8 + 2];
+	uint16_t len = test_getRecord(frameNr, rec);
+
+	CHECK(len > 0 && rec[0] == LXR_RECORD_TRACK, "%s: frame %u is no track record", name, frameNr);
+	if(!len) return;
+
+	corrupt(rec, &len);
+	const uint32_t frameLen = test_makeFrame(LXR_SYSEX_RECORD, rec, len, frame);
+	test_send(frame, frameLen);
+	CHECK(test_lastAck() == LXR_SYSEX_ERR_RECORD, "%s: ack %d, expected LXR_SYSEX_ERR_RECORD", name, test_lastAck());
+
+	test_snapshot(&test_restored);
+	test_compare(&test_original, &test_restored, name);
+}
+//------------------------------------------------------------------------------
+// track record layout: type, pattern, track, length/rotate, main steps (2), active steps (16), block mask (2)
+#define TEST_MASK_POS	(6 + NUM_STEPS/8)
+static uint16_t test_lockCntPos(const uint8_t* rec)
+{
+	const uint16_t mask = rec[TEST_MASK_POS] | (rec[TEST_MASK_POS+1]<<8);
+	uint16_t pos = TEST_MASK_POS + 2;
+	uint8_t i;
+	for(i=0;i<NUM_STEPS/8;i++) {
+		if(mask & (1<<i)) pos += 8*sizeof(Step);
+	}
+	return pos;
+}
+static void test_corruptLockCnt(uint8_t* rec, uint16_t* len)
+{
+	const uint16_t pos = test_lockCntPos(rec);
+	rec[pos] = 0xff;
+	rec[pos+1] = 0x7f;
+	(void)len;
+}
+static void test_corruptLockStep(uint8_t* rec, uint16_t* len)
+{
+	const uint16_t pos = test_lockCntPos(rec);
+	const uint16_t cnt = rec[pos] | (rec[pos+1]<<8);
+	//last lock on a step past the pattern end
+	if(cnt) rec[pos+2+(cnt-1)*3] = NUM_STEPS;
+	(void)len;
+}
+static void test_corruptBlockMask(uint8_t* rec, uint16_t* len)
+{
+	//more step blocks announced than sent
+	rec[TEST_MASK_POS] = 0xff;
+	rec[TEST_MASK_POS+1] = 0xff;
+	*len = test_lockCntPos(rec) - 1;
+}
+static void test_corruptTruncate(uint8_t* rec, uint16_t* len)
+{
+	*len = test_lockCntPos(rec) + 1;
+}
+//------------------------------------------------------------------------------
+int main()
+{
+	const uint8_t request[] = {SYSEX_START, LXR_SYSEX_ID, LXR_SYSEX_DEVICE, LXR_SYSEX_DUMP_REQUEST, LXR_SYSEX_DUMP_REQUEST, SYSEX_END};
+	const uint8_t foreign[] = {SYSEX_START, 0x43, 0x10, 0x4c, 0x00, SYSEX_END};
+	static uint8_t restore[STUB_USB_BUFFER];
+	uint32_t badAcks;
+
+	stub_init();
+	test_fill();
+	test_snapshot(&test_original);
+
+	//---- dump
+	test_send(request, sizeof(request));
+	memcpy(test_dump, stub_usbOut, stub_usbOutLen);
+	test_dumpLen = stub_usbOutLen;
+
+	const uint32_t records = test_countFrames(test_dump, test_dumpLen, LXR_SYSEX_RECORD, 0);
+	CHECK(records == 2 + NUM_PATTERN + NUM_PATTERN*NUM_TRACKS, "dump has %u records, expected %u",
+			records, 2 + NUM_PATTERN + NUM_PATTERN*NUM_TRACKS);
+	CHECK(test_countFrames(test_dump, test_dumpLen, LXR_SYSEX_END, 0) == 1, "dump is not terminated");
+
+	uint32_t locks = 0;
+	uint8_t pat, track;
+	for(pat=0;pat<NUM_PATTERN;pat++)
+		for(track=0;track<NUM_TRACKS;track++)
+			locks += test_original.tracks[pat][track].lockCnt;
+	printf("dump: %u records, %u bytes, %u parameter locks\n", records, test_dumpLen, locks);
+
+	//---- wipe and restore, with a frame of another device in between
+	test_wipe();
+	memcpy(restore, foreign, sizeof(foreign));
+	memcpy(&restore[sizeof(foreign)], test_dump, test_dumpLen);
+	test_send(restore, sizeof(foreign) + test_dumpLen);
+
+	const uint32_t acks = test_countFrames(stub_usbOut, stub_usbOutLen, LXR_SYSEX_ACK, &badAcks);
+	CHECK(acks == records+1, "restore got %u acks, expected %u", acks, records+1);
+	CHECK(badAcks == 0, "restore got %u acks with an error", badAcks);
+	CHECK(stub_forwardedBytes == sizeof(foreign), "%u bytes of the foreign frame forwarded, expected %u",
+			stub_forwardedBytes, (uint32_t)sizeof(foreign));
+
+	test_snapshot(&test_restored);
+	test_compare(&test_original, &test_restored, "restore");
+	test_compareFront(&test_original);
+
+	//---- a second dump of the restored state has to be identical
+	test_send(request, sizeof(request));
+	CHECK(stub_usbOutLen == test_dumpLen && memcmp(stub_usbOut, test_dump, test_dumpLen) == 0, "second dump differs");
+
+	//---- malformed track records are rejected before the track is changed
+	const uint32_t firstTrack = 2 + NUM_PATTERN;
+	test_malformedTrack("lock count past the record end", firstTrack + 3, test_corruptLockCnt);
+	test_malformedTrack("lock on step 128", firstTrack + 5, test_corruptLockStep);
+	test_malformedTrack("missing step blocks", firstTrack + 9, test_corruptBlockMask);
+	test_malformedTrack("truncated lock list", firstTrack + 12, test_corruptTruncate);
+
+	return test_report();
+}
@@ -0,0 +1,158 @@
+// halStubs.c : host replacements for the firmware parts SysexDump.c talks to.
+// the sequencer keeps its patterns in plain slots, the midi parser only stores the values
+// and the usb sysex stream is read from / written to memory buffers.
+//
+
+#include <string.h>
+
+#include "halStubs.h"
+#include "MidiParser.h"
+#include "sequencer.h"
+#include "usb_manager.h"
+#include "Uart.h"
+#include "frontPanelParser.h"
+
+uint8_t midiParser_originalCcValues[0xff];
+uint8_t midi_MidiChannels[8];
+uint8_t midiParser_txRxFilter;
+uint8_t frontParser_sysexActive;
+
+static Pattern stub_patternSlots[NUM_PATTERN];
+Pattern* seq_patterns[NUM_PATTERN];
+static uint16_t stub_bpm = 120;
+
+uint8_t stub_usbOut[STUB_USB_BUFFER];
+uint32_t stub_usbOutLen;
+uint8_t stub_usbIn[STUB_USB_BUFFER];
+uint32_t stub_usbInLen;
+uint32_t stub_usbInPos;
+uint32_t stub_forwardedBytes;
+
+uint8_t stub_frontKit[0xff];
+uint8_t stub_frontChannels[8];
+uint8_t stub_frontFilter;
+uint16_t stub_frontBpm;
+uint32_t stub_frontMsgCnt;
+static uint8_t stub_frontMsg[3];
+static uint8_t stub_frontMsgPos;
+//------------------------------------------------------------------------------
+void stub_clearFront()
+{
+	memset(stub_frontKit, 0, sizeof(stub_frontKit));
+	memset(stub_frontChannels, 0, sizeof(stub_frontChannels));
+	stub_frontFilter = 0;
+	stub_frontBpm = 0;
+	stub_frontMsgCnt = 0;
+	stub_frontMsgPos = 0;
+}
+//------------------------------------------------------------------------------
+void stub_init()
+{
+	uint8_t i;
+	memset(stub_patternSlots, 0, sizeof(stub_patternSlots));
+	for(i=0;i<NUM_PATTERN;i++) {
+		seq_patterns[i] = &stub_patternSlots[i];
+	}
+	stub_usbOutLen = stub_usbInLen = stub_usbInPos = 0;
+	stub_forwardedBytes = 0;
+	stub_clearFront();
+}
+//------------------------------------------------------------------------------
+void seq_setBpm(uint16_t bpm)
+{
+	stub_bpm = bpm;
+}
+//------------------------------------------------------------------------------
+uint16_t seq_getBpm()
+{
+	return stub_bpm;
+}
+//------------------------------------------------------------------------------
+void seq_flushLookahead()
+{
+}
+//------------------------------------------------------------------------------
+void midiParser_setFilter(uint8_t is_tx, uint8_t value)
+{
+	if(is_tx)
+		midiParser_txRxFilter = (uint8_t)((value<<4) | (midiParser_txRxFilter&0x0f));
+	else
+		midiParser_txRxFilter = (uint8_t)((value&0x0f) | (midiParser_txRxFilter&0xf0));
+}
+//------------------------------------------------------------------------------
+void midiParser_ccHandler(MidiMsg msg, uint8_t updateOriginalValue)
+{
+	if(!updateOriginalValue) return;
+	if(msg.status == MIDI_CC)
+		midiParser_originalCcValues[msg.data1] = msg.data2;
+	else
+		midiParser_originalCcValues[msg.data1+128] = msg.data2;
+}
+//------------------------------------------------------------------------------
+void midiParser_parseMidiMessage(MidiMsg msg)
+{
+	//only sysex bytes of other devices arrive here
+	if(msg.bits.sysxbyte) stub_forwardedBytes++;
+}
+//------------------------------------------------------------------------------
+uint16_t usb_sendSysex(const uint8_t* data, const uint16_t len)
+{
+	//one usb packet buffer per call, like the real endpoint
+	uint16_t n = len > 48 ? 48 : len;
+	if(stub_usbOutLen + n > STUB_USB_BUFFER) n = (uint16_t)(STUB_USB_BUFFER - stub_usbOutLen);
+	memcpy(&stub_usbOut[stub_usbOutLen], data, n);
+	stub_usbOutLen += n;
+	return n;
+}
+//------------------------------------------------------------------------------
+uint8_t usb_getSysex(uint8_t* data)
+{
+	if(stub_usbInPos >= stub_usbInLen) return 0;
+	*data = stub_usbIn[stub_usbInPos++];
+	return 1;
+}
+//------------------------------------------------------------------------------
+uint8_t uart_getFrontTxFree()
+{
+	return STUB_FRONT_FREE;
+}
+//------------------------------------------------------------------------------
+void uart_sendFrontpanelByte(uint8_t data)
+{
+	//decode the messages the way the front parser does
+	if(data & 0x80) {
+		stub_frontMsg[0] = data;
+		stub_frontMsgPos = 1;
+		return;
+	}
+	if(stub_frontMsgPos == 0) return;
+	stub_frontMsg[stub_frontMsgPos++] = data;
+	if(stub_frontMsgPos < 3) return;
+	stub_frontMsgPos = 0;
+	stub_frontMsgCnt++;
+
+	const uint8_t data1 = stub_frontMsg[1];
+	const uint8_t data2 = stub_frontMsg[2];
+	switch(stub_frontMsg[0])
+	{
+	case MIDI_CC:
+		stub_frontKit[data1] = data2;
+		break;
+	case FRONT_CC_2:
+		stub_frontKit[data1+128] = data2;
+		break;
+	case FRONT_SET_BPM:
+		stub_frontBpm = (uint16_t)(data1 | (data2<<7));
+		break;
+	case FRONT_SEQ_CC:
+		if(data1 == FRONT_SEQ_MIDI_CHAN)
+			stub_frontChannels[data2>>4] = data2 & 0x0f;
+		else if(data1 == FRONT_SEQ_MIDI_TX_FILTER)
+			stub_frontFilter = (uint8_t)((data2<<4) | (stub_frontFilter&0x0f));
+		else if(data1 == FRONT_SEQ_MIDI_RX_FILTER)
+			stub_frontFilter = (uint8_t)((data2&0x0f) | (stub_frontFilter&0xf0));
+		break;
+	default:
+		break;
+	}
+}
@@ -0,0 +1,31 @@
+// halStubs.h : memory buffers of the host usb stub used by the loopback test
+//
+
+#ifndef HALSTUBS_H_
+#define HALSTUBS_H_
+
+#include <stdint.h>
+
+#define STUB_USB_BUFFER		200000
+
+extern uint8_t stub_usbOut[STUB_USB_BUFFER];	/**< everything the device sent*/
+extern uint32_t stub_usbOutLen;
+extern uint8_t stub_usbIn[STUB_USB_BUFFER];		/**< bytes the device reads*/
+extern uint32_t stub_usbInLen;
+extern uint32_t stub_usbInPos;
+extern uint32_t stub_forwardedBytes;			/**< sysex bytes routed to the midi parser*/
+
+#define STUB_FRONT_FREE		8					/**< room the front tx fifo reports, forces the restore to pace itself*/
+
+extern uint8_t stub_frontKit[0xff];				/**< kit values as the front received them*/
+extern uint8_t stub_frontChannels[8];
+extern uint8_t stub_frontFilter;
+extern uint16_t stub_frontBpm;
+extern uint32_t stub_frontMsgCnt;
+
+/** empty patterns and usb buffers*/
+void stub_init();
+/** forget the values the front received*/
+void stub_clearFront();
+
+#endif /* HALSTUBS_H_ */
@@ -0,0 +1,26 @@
+// hostTest.h : check macro and result report shared by the host tests of the firmware.
+// include once per test program.
+//
+
+#ifndef HOSTTEST_H_
+#define HOSTTEST_H_
+
+#include <stdio.h>
+
+static int test_failures = 0;
+
+/** print a failure message and count it, the test goes on*/
+#define CHECK(cond, ...) do { if(!(cond)) { printf("FAIL: " __VA_ARGS__); printf("\n"); test_failures++; } } while(0)
+
+/** print the result, returns the exit code of the test program*/
+static int test_report()
+{
+	if(test_failures) {
+		printf("%d checks failed\n", test_failures);
+		return 1;
+	}
+	printf("all checks passed\n");
+	return 0;
+}
+
+#endif /* HOSTTEST_H_ */
@@ -0,0 +1,42 @@
+###############################################################################
+#
+# Shared settings of the host test Makefiles
+#
+# The firmware sources are compiled for the host with the default CC. The test
+# binaries go to tools/build, which is not under version control.
+#
+###############################################################################
+
+BUILDDIR ?= ../build
+FWDIR=../../mainboard/LxrStm32
+
+# if VERBOSE is defined, spam output
+ifdef VERBOSE
+AT :=
+ECHO := @true
+else
+AT := @
+ECHO := @echo
+endif
+
+# the firmware headers pull in the cmsis device headers, they compile on the host.
+# some firmware headers define variables, -fcommon merges them like the arm toolchain does
+INC=-I../common \
+	-I$(FWDIR)/Libraries/CMSIS/Include \
+	-I$(FWDIR)/Libraries/Device/STM32F4xx/Include \
+	-I$(FWDIR)/Libraries/STM32F4xx_StdPeriph_Driver/inc \
+	-I$(FWDIR)/src \
+	-I$(FWDIR)/src/AudioCodecManager \
+	-I$(FWDIR)/src/DSPAudio \
+	-I$(FWDIR)/src/Hardware \
+	-I$(FWDIR)/src/Hardware/SD_FAT \
+	-I$(FWDIR)/src/Hardware/USB \
+	-I$(FWDIR)/src/MIDI \
+	-I$(FWDIR)/src/SampleRom \
+	-I$(FWDIR)/src/Sequencer \
+	-I$(FWDIR)/Libraries/STM32_USB_Device_Library/Core/inc \
+	-I$(FWDIR)/Libraries/STM32_USB_OTG_Driver/inc
+
+DEFS=-DSTM32F4XX -DUSE_STDPERIPH_DRIVER -DHSE_VALUE=8000000
+
+HOSTCFLAGS=-std=gnu99 -fcommon $(DEFS) $(INC)